@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) 2014 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Block wise fetching of the document matches of a posting iterator
+#ifndef _STRUS_POSTING_BLOCK_BUFFER_HPP_INCLUDED
+#define _STRUS_POSTING_BLOCK_BUFFER_HPP_INCLUDED
+#include "strus/postingIteratorInterface.hpp"
+#include "strus/index.hpp"
+#include <algorithm>
+#include <cstddef>
+
+namespace strus
+{
+
+/// \brief Buffer for the document matches of a posting iterator fetched block wise, for skipping through them without a virtual call per document
+/// \remark The state of the iterator buffered is not defined by the skips on the buffer, it has to be positioned with 'skipDoc( const Index&)' before accessing its positions or frequency
+/// \note Iterators not implementing block fetching are not buffered, the skips are passed to their 'skipDoc( const Index&)', because matches prefetched one by one are mostly wasted when skipping ahead
+class PostingBlockBuffer
+{
+public:
+	enum {BlockSize=128};
+
+	explicit PostingBlockBuffer( PostingIteratorInterface* itr_=0)
+		:m_itr(itr_),m_mindocno(0),m_size(0),m_idx(0),m_complete(false),m_unbuffered(false){}
+
+	/// \brief Get the iterator buffered
+	PostingIteratorInterface* itr() const
+	{
+		return m_itr;
+	}
+
+	/// \brief Return the next document match with a document number higher than or equal to a given document number, equivalent to 'skipDoc( const Index&)' of the iterator buffered
+	Index skipDoc( const Index& docno)
+	{
+		Index dn = (docno <= 0) ? 1 : docno;
+		if (m_unbuffered)
+		{
+			return m_itr->skipDoc( dn);
+		}
+		if (!m_size || dn < m_mindocno || dn > m_ar[ m_size-1])
+		{
+			if (m_size && dn > m_ar[ m_size-1] && m_complete)
+			{
+				// ... all matches from m_mindocno on are in the buffer
+				return 0;
+			}
+			if (!m_itr->skipDocBlock( dn, m_ar, 0, BlockSize, m_size))
+			{
+				// ... block fetching not implemented by the iterator, pass all skips to it
+				m_unbuffered = true;
+				m_size = 0;
+				return m_itr->skipDoc( dn);
+			}
+			m_mindocno = dn;
+			m_idx = 0;
+			m_complete = (m_size < (std::size_t)BlockSize);
+			if (!m_size) return 0;
+		}
+		// Search the match, skips are mostly ascending:
+		Index* start = (m_ar[ m_idx] <= dn) ? (m_ar + m_idx) : m_ar;
+		m_idx = std::lower_bound( start, m_ar + m_size, dn) - m_ar;
+		return m_ar[ m_idx];
+	}
+
+private:
+	PostingIteratorInterface* m_itr;	///< iterator buffered
+	Index m_ar[ BlockSize];			///< document numbers of the matches buffered
+	Index m_mindocno;			///< minimum document number of the last fetch
+	std::size_t m_size;			///< number of elements in m_ar
+	std::size_t m_idx;			///< index of the element returned by the last skip
+	bool m_complete;			///< true, if there are no matches after the last element in m_ar
+	bool m_unbuffered;			///< true, if the iterator does not implement block fetching and the skips are passed to it
+};
+
+}//namespace
+#endif
+
@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) 2014 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Array of plain data elements with a local buffer, that allocates memory only if the size exceeds the local buffer
+#ifndef _STRUS_SMALL_ARRAY_HPP_INCLUDED
+#define _STRUS_SMALL_ARRAY_HPP_INCLUDED
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+namespace strus
+{
+
+/// \brief Array of plain data elements (copied with memcpy) with a size defined at runtime
+/// \remark Up to LocalSize elements are stored in a buffer that is part of the object, only bigger arrays are allocated on the heap
+template <typename ElementType, std::size_t LocalSize>
+class SmallArray
+{
+public:
+	SmallArray()
+		:m_ar(m_localbuf),m_size(0),m_allocsize(LocalSize){}
+	explicit SmallArray( std::size_t size_)
+		:m_ar(m_localbuf),m_size(0),m_allocsize(LocalSize)
+	{
+		resize( size_);
+	}
+	SmallArray( const SmallArray& o)
+		:m_ar(m_localbuf),m_size(0),m_allocsize(LocalSize)
+	{
+		assign( o);
+	}
+	SmallArray& operator=( const SmallArray& o)
+	{
+		if (this != &o) assign( o);
+		return *this;
+	}
+	~SmallArray()
+	{
+		if (m_ar != m_localbuf) std::free( m_ar);
+	}
+
+	/// \brief Set the number of elements, preserving the elements within the new size
+	/// \note Pointers to elements are invalidated, if the new size exceeds the capacity
+	void resize( std::size_t size_)
+	{
+		if (size_ > m_allocsize) grow( size_);
+		m_size = size_;
+	}
+	/// \brief Ensure a capacity without changing the size
+	void reserve( std::size_t size_)
+	{
+		if (size_ > m_allocsize) grow( size_);
+	}
+	void clear()
+	{
+		m_size = 0;
+	}
+	void push_back( const ElementType& elem)
+	{
+		if (m_size == m_allocsize) grow( m_size+1);
+		m_ar[ m_size++] = elem;
+	}
+
+	std::size_t size() const		{return m_size;}
+	bool empty() const			{return m_size == 0;}
+
+	ElementType& operator[]( std::size_t idx)		{return m_ar[ idx];}
+	const ElementType& operator[]( std::size_t idx) const	{return m_ar[ idx];}
+
+	ElementType* ptr()			{return m_ar;}
+	const ElementType* ptr() const		{return m_ar;}
+
+private:
+	void grow( std::size_t size_)
+	{
+		std::size_t mm = m_allocsize * 2;
+		if (mm < size_) mm = size_;
+		if (mm * sizeof(ElementType) < mm) throw std::bad_alloc();
+		ElementType* ar_;
+		if (m_ar == m_localbuf)
+		{
+			ar_ = (ElementType*)std::malloc( mm * sizeof(ElementType));
+			if (!ar_) throw std::bad_alloc();
+			std::memcpy( ar_, m_localbuf, m_size * sizeof(ElementType));
+		}
+		else
+		{
+			ar_ = (ElementType*)std::realloc( m_ar, mm * sizeof(ElementType));
+			if (!ar_) throw std::bad_alloc();
+		}
+		m_ar = ar_;
+		m_allocsize = mm;
+	}
+	void assign( const SmallArray& o)
+	{
+		m_size = 0;
+		reserve( o.m_size);
+		std::memcpy( m_ar, o.m_ar, o.m_size * sizeof(ElementType));
+		m_size = o.m_size;
+	}
+
+private:
+	ElementType m_localbuf[ LocalSize];	///< local buffer used as long as the size does not exceed LocalSize
+	ElementType* m_ar;			///< pointer to the elements, either m_localbuf or allocated
+	std::size_t m_size;			///< number of elements
+	std::size_t m_allocsize;		///< capacity of m_ar in elements
+};
+
+}//namespace
+#endif
+
@@ -11,12 +11,14 @@
 #include <boost/dynamic_bitset.hpp>
 #include <boost/thread/mutex.hpp>
 #include <boost/thread/thread.hpp>
+#include <boost/thread/tss.hpp>
 #include <boost/shared_ptr.hpp>
 #include <boost/scoped_array.hpp>
 #include <stdint.h>			///... boost atomic needs this
 #include <boost/atomic/atomic.hpp>
 #include <boost/static_assert.hpp>
 #include <boost/unordered_map.hpp>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
 
 namespace strus {
 namespace utils {
@@ -127,6 +129,7 @@ private:
 typedef boost::mutex Mutex;
 typedef boost::mutex::scoped_lock ScopedLock;
 typedef boost::unique_lock<boost::mutex> UniqueLock;
+typedef boost::thread_group ThreadGroup;
 
 template <class X>
 class SharedPtr
@@ -154,6 +157,37 @@ public:
 		:boost::scoped_array<X>(){}
 };
 
+/// \brief Pointer to an object owned by the current thread, deleted when the thread exits
+template <class X>
+class ThreadSpecificPtr
+	:public boost::thread_specific_ptr<X>
+{
+public:
+	ThreadSpecificPtr()
+		:boost::thread_specific_ptr<X>(){}
+};
+
+/// \brief Wall clock stop watch measuring the time elapsed since its construction or its last restart
+class StopWatch
+{
+public:
+	StopWatch()
+		:m_start(boost::posix_time::microsec_clock::universal_time()){}
+	StopWatch( const StopWatch& o)
+		:m_start(o.m_start){}
+
+	void restart()
+	{
+		m_start = boost::posix_time::microsec_clock::universal_time();
+	}
+	int64_t elapsedMicroseconds() const
+	{
+		return (boost::posix_time::microsec_clock::universal_time() - m_start).total_microseconds();
+	}
+
+private:
+	boost::posix_time::ptime m_start;
+};
 
 template <typename IntegralCounterType>
 class AtomicCounter
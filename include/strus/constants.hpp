@@ -62,6 +62,7 @@ struct Constants
 	}
 	/// \brief Get the maximum position (counted from 1) in a document a token can have 
 	/// \note This is a limit given by the implementation of the position info block. Unfortunately it creeps through the system.
+	/// \remark The value returned (65535) is the limit for storages created without the configuration parameter 'largedocs'. Storages created with 'largedocs' (default) accept positions up to 2147483647
 	static unsigned int storage_max_position_info()
 	{
 		return 65535;
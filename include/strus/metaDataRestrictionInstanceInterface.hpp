@@ -26,6 +26,11 @@ public:
 	/// \return true, if it matches, false if not
 	/// \remark A deleted document has every metadata element nulled out. So it depends on the restriction expression wheter the document number matches or not. There esists no other flag for the document number in the system telling wheter it exists or not. 
 	virtual bool match( const Index& docno) const=0;
+
+	/// \brief Get the smallest document number bigger than or equal to docno, that matches the restriction condition
+	/// \param[in] docno local internal document number to start the search with
+	/// \return the document number found or 0, if there is none up to the maximum document number of the storage
+	virtual Index skipDoc( const Index& docno) const=0;
 };
 
 } //namespace
@@ -31,6 +31,17 @@ public:
 	/// \param[in] docno the minimum document number to fetch
 	virtual Index skipDocCandidate( const Index& docno)=0;
 
+	/// \brief Fetch the next document matches with a document number higher than or equal to a given document number in one call
+	/// \note Used for processing postings in tight loops without a virtual call per document
+	/// \param[in] docno the minimum document number to fetch
+	/// \param[out] docnos where to write the document numbers of the matches to in ascending order (array with at least maxsize elements)
+	/// \param[out] ffs where to write the feature frequencies of the matches to (array with at least maxsize elements) or NULL, if not needed
+	/// \param[in] maxsize maximum number of matches to fetch
+	/// \param[out] size number of matches fetched, 0 if there are no matches left
+	/// \return true on success, false if not implemented by the iterator and the caller has to call 'skipDoc( const Index&)' for each match instead
+	/// \remark After the call the iterator is positioned on the last match fetched, as if it was returned by 'skipDoc( const Index&)'
+	virtual bool skipDocBlock( const Index& docno, Index* docnos, unsigned int* ffs, std::size_t maxsize, std::size_t& size)=0;
+
 	/// \brief Return the next matching position higher than or equal to firstpos in the current document. The current document is the one returned with the last 'skipDoc( const Index&)' call.
 	/// \param[in] firstpos the minimum position to fetch
 	virtual Index skipPos( const Index& firstpos)=0;
@@ -48,6 +59,18 @@ public:
 	/// \return the feature frequency (aka 'ff' of 'tf')
 	virtual unsigned int frequency()=0;
 
+	/// \brief Get an upper bound for the feature frequency of the block of postings with the first candidates with a document number higher than or equal to a given document number, without changing the state of the iterator
+	/// \note Used for skipping whole blocks of documents in the ranking, whose best possible weight cannot make them get into the result (Block-Max pruning)
+	/// \param[in] docno the minimum document number of the block
+	/// \param[out] maxff upper bound for the feature frequency of the documents from docno to the returned block end document number, std::numeric_limits<unsigned int>::max() if not known
+	/// \return the block end document number (the last document number the bound is valid for), std::numeric_limits<Index>::max() if the iterator has no block structure, 0 if there are no postings with a document number higher than or equal to docno
+	virtual Index skipBlockMax( const Index& docno, unsigned int& maxff)=0;
+
+	/// \brief Get the number of data blocks loaded from the storage by this iterator since its creation
+	/// \note Used for profiling. Blocks loaded by the argument iterators of a join are not counted by the join
+	/// \return the number of blocks loaded
+	virtual unsigned int nofBlocksLoaded() const=0;
+
 	/// \brief Get the current document number
 	/// \return the document number
 	virtual Index docno() const=0;
@@ -0,0 +1,50 @@
+/*
+ * Copyright (c) 2014 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Limits of the resources a query evaluation is allowed to use
+/// \file queryBudget.hpp
+#ifndef _STRUS_QUERY_BUDGET_HPP_INCLUDED
+#define _STRUS_QUERY_BUDGET_HPP_INCLUDED
+
+namespace strus {
+
+/// \brief Limits of the resources a query evaluation is allowed to use (0 for no limit)
+/// \note A query evaluation exceeding its budget returns the best ranking found so far, marked as truncated (see 'QueryResult::truncated()')
+struct QueryBudget
+{
+	/// \brief Default constructor (no limits)
+	QueryBudget()
+		:m_maxNofDocumentsVisited(0),m_maxNofPostingOperations(0),m_maxMilliseconds(0){}
+	/// \brief Constructor
+	/// \param[in] maxNofDocumentsVisited_ maximum number of documents visited in the ranking
+	/// \param[in] maxNofPostingOperations_ maximum number of posting iterator operations (skipDoc,skipDocCandidate,skipPos,skipBlockMax calls on the query features and their subexpressions)
+	/// \param[in] maxMilliseconds_ wall clock deadline of the query evaluation in milliseconds
+	QueryBudget( unsigned int maxNofDocumentsVisited_, unsigned int maxNofPostingOperations_, unsigned int maxMilliseconds_)
+		:m_maxNofDocumentsVisited(maxNofDocumentsVisited_),m_maxNofPostingOperations(maxNofPostingOperations_),m_maxMilliseconds(maxMilliseconds_){}
+	/// \brief Copy constructor
+	QueryBudget( const QueryBudget& o)
+		:m_maxNofDocumentsVisited(o.m_maxNofDocumentsVisited),m_maxNofPostingOperations(o.m_maxNofPostingOperations),m_maxMilliseconds(o.m_maxMilliseconds){}
+
+	/// \brief Get the maximum number of documents visited in the ranking
+	unsigned int maxNofDocumentsVisited() const		{return m_maxNofDocumentsVisited;}
+	/// \brief Get the maximum number of posting iterator operations
+	unsigned int maxNofPostingOperations() const		{return m_maxNofPostingOperations;}
+	/// \brief Get the wall clock deadline of the query evaluation in milliseconds
+	unsigned int maxMilliseconds() const			{return m_maxMilliseconds;}
+
+	/// \brief Evaluate if any limit is defined
+	bool defined() const					{return m_maxNofDocumentsVisited || m_maxNofPostingOperations || m_maxMilliseconds;}
+
+private:
+	unsigned int m_maxNofDocumentsVisited;		///< maximum number of documents visited (0 for no limit)
+	unsigned int m_maxNofPostingOperations;		///< maximum number of posting iterator operations (0 for no limit)
+	unsigned int m_maxMilliseconds;			///< deadline in milliseconds (0 for no limit)
+};
+
+}//namespace
+#endif
+
@@ -9,6 +9,7 @@
 /// \file "queryEvalInterface.hpp"
 #ifndef _STRUS_QUERY_EVAL_INTERFACE_HPP_INCLUDED
 #define _STRUS_QUERY_EVAL_INTERFACE_HPP_INCLUDED
+#include "strus/queryResultCacheStatistics.hpp"
 #include <iostream>
 #include <vector>
 
@@ -47,6 +48,7 @@ public:
 	/// \brief Declare a set of features to be used for selection (declare what documents to weight)
 	/// \param[in] set_ name of the set of the selecting feature.
 	/// \remark If no selector feature is specified then the query evaluation fails
+	/// \remark Selection sets are evaluated in the order of their declaration, the documents of a set are only ranked if the ranklist is not complete with the documents of the sets before. The result ranklist contains only documents of the sets up to the one reported as evaluation pass in the query result
 	virtual void addSelectionFeature( const std::string& set_)=0;
 
 	/// \brief Define a set of features to be used as restriction (exclude documents that do not contain a feature of the set declared)
@@ -106,6 +108,28 @@ public:
 	virtual void defineWeightingFormula(
 			ScalarFunctionInterface* combinefunc)=0;
 
+	/// \brief Enable or disable dynamic pruning of documents that cannot make it into the result ranklist
+	/// \param[in] enable true, if documents should be skipped when the sum of the upper bounds of the weights of their features is below the weight of the last element in the ranklist (MaxScore)
+	/// \note The result ranklist is the same as without pruning, but the number of documents ranked reported in the query result is only a lower bound
+	/// \remark Pruning is only applied if no weighting formula is defined and all weighting functions provide upper bounds for the feature weights
+	virtual void setPruning( bool enable)=0;
+
+	/// \brief Enable or disable the selection of candidate documents by merging the postings of all selection features in ascending order of document numbers
+	/// \param[in] enable true, if all selection features should be traversed together, false if they should be traversed one after the other (default)
+	/// \note Every candidate document is visited exactly once and the selector state reported in the query result is the index of the first selection set matching the document, as without merging
+	/// \note The order in which candidate documents are visited changes, so the result of a query truncated by a budget ('QueryInterface::setBudget(const QueryBudget&)') may be different
+	virtual void setMergedSelection( bool enable)=0;
+
+	/// \brief Enable caching of the results of queries created from this query evaluation scheme
+	/// \param[in] maxMemoryUsage maximum number of bytes (estimated) used by the cached results, 0 to disable the cache
+	/// \note Results are cached by a canonical form of the query and the generation of the storage content ('StorageClientInterface::generation()'), so results become invalid with every transaction committed
+	/// \note Changing the query evaluation scheme clears the cache
+	virtual void defineResultCache( std::size_t maxMemoryUsage)=0;
+
+	/// \brief Get the hit/miss statistics and the memory usage of the result cache
+	/// \return the statistics (all zero if no result cache is defined)
+	virtual QueryResultCacheStatistics resultCacheStatistics() const=0;
+
 	/// \brief Create a new query
 	/// \param[in] storage storage to run the query on
 	/// \return a query instance for this query evaluation type
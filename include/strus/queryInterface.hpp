@@ -15,6 +15,7 @@
 #include "strus/numericVariant.hpp"
 #include "strus/termStatistics.hpp"
 #include "strus/globalStatistics.hpp"
+#include "strus/queryBudget.hpp"
 #include <string>
 #include <vector>
 #include <utility>
@@ -123,6 +124,28 @@ public:
 	/// \param[in] debug true for enabling debug mode on and false for disabling debug mode (diabled by default)
 	virtual void setDebugMode( bool debug)=0;
 
+	/// \brief Switch profiling mode on or off (default off). In case of profiling mode the time used by each phase of the query evaluation and the operations on the posting iterators of each query feature node are returned with the result (see 'QueryResult::profile()')
+	/// \param[in] profiling true for enabling profiling mode and false for disabling it
+	/// \note Queries evaluated in profiling mode do not use the result cache of the query evaluation scheme
+	virtual void setProfilingMode( bool profiling)=0;
+
+	/// \brief Define the number of threads evaluating the ranking in parallel on partitions of the document number range (default sequential evaluation)
+	/// \param[in] nofThreads_ number of threads, 0 or 1 for a sequential evaluation
+	/// \note The result of a parallel evaluation is the same as for a sequential evaluation
+	/// \remark The error buffer has to be created with slots for the additional threads
+	virtual void setParallelEvaluation( unsigned int nofThreads_)=0;
+
+	/// \brief Define limits of the resources the query evaluation is allowed to use (default no limits)
+	/// \param[in] budget_ limits for the number of documents visited, the number of posting iterator operations and the wall clock time
+	/// \note If a limit is exceeded, then the ranking and the summarization stop and the best result found so far is returned, marked as truncated (see 'QueryResult::truncated()')
+	virtual void setBudget( const QueryBudget& budget_)=0;
+
+	/// \brief Prepare the query for repeated evaluation
+	/// \remark Resolves the query terms and their statistics, builds the tree of posting iterators and creates the weighting and summarizer function contexts once and reuses them for every subsequent call of evaluate
+	/// \note The number of ranks, the ACL users, the meta data restrictions, the document evaluation set, the weighting variables and the debug mode can still be changed between evaluations of a prepared query. Defining features, variables or statistics discards the prepared structures (they are rebuilt on the next evaluation)
+	/// \note The prepared structures are rebuilt automatically, if the storage content has changed (see 'StorageClientInterface::generation()')
+	virtual void prepare()=0;
+
 	/// \brief Evaluate the query
 	/// \return result of query evaluation
 	virtual QueryResult evaluate() const=0;
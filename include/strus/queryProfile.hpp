@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) 2014 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Execution profile of a query evaluation
+/// \file queryProfile.hpp
+#ifndef _STRUS_QUERY_PROFILE_HPP_INCLUDED
+#define _STRUS_QUERY_PROFILE_HPP_INCLUDED
+#include <vector>
+#include <string>
+
+namespace strus {
+
+/// \brief Execution profile of a query evaluation, returned with the query result if the profiling mode is enabled (see 'QueryInterface::setProfilingMode(bool)')
+class QueryProfile
+{
+public:
+	/// \brief Time used by a phase of the query evaluation
+	class Phase
+	{
+	public:
+		/// \brief Constructor
+		Phase( const std::string& name_, unsigned int microseconds_)
+			:m_name(name_),m_microseconds(microseconds_){}
+		/// \brief Copy constructor
+		Phase( const Phase& o)
+			:m_name(o.m_name),m_microseconds(o.m_microseconds){}
+
+		/// \brief Get the name of the phase
+		const std::string& name() const			{return m_name;}
+		/// \brief Get the wall clock time used by the phase in microseconds
+		unsigned int microseconds() const		{return m_microseconds;}
+
+	private:
+		std::string m_name;
+		unsigned int m_microseconds;
+	};
+
+	/// \brief Operations on the posting iterator of a node of the query feature tree
+	class PostingNode
+	{
+	public:
+		/// \brief Constructor
+		PostingNode( const std::string& feature_, const std::string& description_, unsigned int level_,
+				unsigned int nofSkipDoc_, unsigned int nofSkipDocCandidate_, unsigned int nofSkipPos_, unsigned int nofBlocksLoaded_)
+			:m_feature(feature_),m_description(description_),m_level(level_)
+			,m_nofSkipDoc(nofSkipDoc_),m_nofSkipDocCandidate(nofSkipDocCandidate_),m_nofSkipPos(nofSkipPos_),m_nofBlocksLoaded(nofBlocksLoaded_){}
+		/// \brief Copy constructor
+		PostingNode( const PostingNode& o)
+			:m_feature(o.m_feature),m_description(o.m_description),m_level(o.m_level)
+			,m_nofSkipDoc(o.m_nofSkipDoc),m_nofSkipDocCandidate(o.m_nofSkipDocCandidate),m_nofSkipPos(o.m_nofSkipPos),m_nofBlocksLoaded(o.m_nofBlocksLoaded){}
+
+		/// \brief Get the name of the feature set of the feature this node is the root of (empty for subexpression nodes)
+		const std::string& feature() const		{return m_feature;}
+		/// \brief Get the description of the node (term, document field or join operator)
+		const std::string& description() const		{return m_description;}
+		/// \brief Get the depth of the node in the feature tree (0 for the feature root node, the subexpression nodes follow their parent node)
+		unsigned int level() const			{return m_level;}
+		/// \brief Get the number of calls of skipDoc
+		unsigned int nofSkipDoc() const			{return m_nofSkipDoc;}
+		/// \brief Get the number of calls of skipDocCandidate
+		unsigned int nofSkipDocCandidate() const	{return m_nofSkipDocCandidate;}
+		/// \brief Get the number of calls of skipPos
+		unsigned int nofSkipPos() const			{return m_nofSkipPos;}
+		/// \brief Get the number of data blocks loaded from the storage by the node (not including the blocks loaded by its subexpressions)
+		unsigned int nofBlocksLoaded() const		{return m_nofBlocksLoaded;}
+
+	private:
+		std::string m_feature;
+		std::string m_description;
+		unsigned int m_level;
+		unsigned int m_nofSkipDoc;
+		unsigned int m_nofSkipDocCandidate;
+		unsigned int m_nofSkipPos;
+		unsigned int m_nofBlocksLoaded;
+	};
+
+public:
+	/// \brief Default constructor
+	QueryProfile()
+		:m_phases(),m_postings(){}
+	/// \brief Copy constructor
+	QueryProfile( const QueryProfile& o)
+		:m_phases(o.m_phases),m_postings(o.m_postings){}
+
+	/// \brief Get the phases of the query evaluation in the order of their execution
+	const std::vector<Phase>& phases() const		{return m_phases;}
+	/// \brief Get the nodes of all query features in preorder (every feature tree root followed by its subexpressions)
+	const std::vector<PostingNode>& postings() const	{return m_postings;}
+	/// \brief Evaluate if the profile is empty (profiling mode not enabled)
+	bool empty() const					{return m_phases.empty();}
+
+	/// \brief Add the time used by a phase
+	void addPhase( const Phase& phase)			{m_phases.push_back( phase);}
+	/// \brief Add the profile of a posting iterator node
+	void addPostingNode( const PostingNode& node)		{m_postings.push_back( node);}
+
+private:
+	std::vector<Phase> m_phases;			///< time used by the phases of the query evaluation
+	std::vector<PostingNode> m_postings;		///< operations on the posting iterators of the query features
+};
+
+}//namespace
+#endif
+
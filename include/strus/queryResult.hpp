@@ -11,6 +11,7 @@
 #define _STRUS_QUERY_RESULT_HPP_INCLUDED
 #include "strus/index.hpp"
 #include "strus/resultDocument.hpp"
+#include "strus/queryProfile.hpp"
 #include <vector>
 #include <string>
 #include <utility>
@@ -27,23 +28,31 @@ public:
 		:m_evaluationPass(0)
 		,m_nofRanked(0)
 		,m_nofVisited(0)
-		,m_ranks(){}
+		,m_truncated(false)
+		,m_ranks()
+		,m_profile(){}
 	/// \brief Copy constructor
 	QueryResult( const QueryResult& o)
 		:m_evaluationPass(o.m_evaluationPass)
 		,m_nofRanked(o.m_nofRanked)
 		,m_nofVisited(o.m_nofVisited)
-		,m_ranks(o.m_ranks){}
+		,m_truncated(o.m_truncated)
+		,m_ranks(o.m_ranks)
+		,m_profile(o.m_profile){}
 	/// \brief Constructor
 	QueryResult(
 			unsigned int evaluationPass_,
 			unsigned int nofRanked_,
 			unsigned int nofVisited_,
-			const std::vector<ResultDocument>& ranks_)
+			const std::vector<ResultDocument>& ranks_,
+			bool truncated_=false,
+			const QueryProfile& profile_=QueryProfile())
 		:m_evaluationPass(evaluationPass_)
 		,m_nofRanked(nofRanked_)
 		,m_nofVisited(nofVisited_)
-		,m_ranks(ranks_){}
+		,m_truncated(truncated_)
+		,m_ranks(ranks_)
+		,m_profile(profile_){}
 
 	/// \brief Get the last query evaluation pass used (level of selection features used)
 	unsigned int evaluationPass() const				{return m_evaluationPass;}
@@ -51,15 +60,23 @@ public:
 	unsigned int nofRanked() const					{return m_nofRanked;}
 	/// \brief Get the total number of matches that were visited (after applying ACL restrictions, but before applying other restrictions)
 	unsigned int nofVisited() const					{return m_nofVisited;}
+	/// \brief Evaluate if the query evaluation was stopped because it exceeded its budget (see 'QueryInterface::setBudget(const QueryBudget&)')
+	/// \note The ranklist of a truncated result is the best found till the stop. Result documents summarized after the stop have no summary elements
+	bool truncated() const						{return m_truncated;}
 
 	/// \brief Get the list of result elements
 	const std::vector<ResultDocument>& ranks() const		{return m_ranks;}
 
+	/// \brief Get the execution profile of the query evaluation (empty if the profiling mode was not enabled)
+	const QueryProfile& profile() const				{return m_profile;}
+
 private:
 	unsigned int m_evaluationPass;			///< query evaluation passes used (level of selection features used)
 	unsigned int m_nofRanked;			///< total number of matches for a query with applying restrictions (might be an estimate)
 	unsigned int m_nofVisited;			///< total number of matches for a query without applying restrictions but ACL restrictions (might be an estimate)
+	bool m_truncated;				///< true, if the evaluation was stopped because it exceeded its budget
 	std::vector<ResultDocument> m_ranks;		///< list of result documents (part of the total result)
+	QueryProfile m_profile;				///< execution profile of the query evaluation (empty if not enabled)
 };
 
 }//namespace
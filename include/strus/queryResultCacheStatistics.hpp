@@ -0,0 +1,47 @@
+/*
+ * Copyright (c) 2014 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Statistics of the query result cache of a query evaluation scheme
+/// \file queryResultCacheStatistics.hpp
+#ifndef _STRUS_QUERY_RESULT_CACHE_STATISTICS_HPP_INCLUDED
+#define _STRUS_QUERY_RESULT_CACHE_STATISTICS_HPP_INCLUDED
+#include <cstddef>
+
+namespace strus {
+
+/// \brief Statistics of the query result cache of a query evaluation scheme
+struct QueryResultCacheStatistics
+{
+	/// \brief Default constructor
+	QueryResultCacheStatistics()
+		:m_nofHits(0),m_nofMisses(0),m_nofEntries(0),m_memoryUsage(0){}
+	/// \brief Constructor
+	QueryResultCacheStatistics( unsigned int nofHits_, unsigned int nofMisses_, std::size_t nofEntries_, std::size_t memoryUsage_)
+		:m_nofHits(nofHits_),m_nofMisses(nofMisses_),m_nofEntries(nofEntries_),m_memoryUsage(memoryUsage_){}
+	/// \brief Copy constructor
+	QueryResultCacheStatistics( const QueryResultCacheStatistics& o)
+		:m_nofHits(o.m_nofHits),m_nofMisses(o.m_nofMisses),m_nofEntries(o.m_nofEntries),m_memoryUsage(o.m_memoryUsage){}
+
+	/// \brief Get the number of query evaluations answered from the cache
+	unsigned int nofHits() const		{return m_nofHits;}
+	/// \brief Get the number of query evaluations not found in the cache
+	unsigned int nofMisses() const		{return m_nofMisses;}
+	/// \brief Get the number of results currently stored in the cache
+	std::size_t nofEntries() const		{return m_nofEntries;}
+	/// \brief Get the estimated number of bytes currently used by the results stored in the cache
+	std::size_t memoryUsage() const		{return m_memoryUsage;}
+
+private:
+	unsigned int m_nofHits;			///< number of cache hits
+	unsigned int m_nofMisses;		///< number of cache misses
+	std::size_t m_nofEntries;		///< number of entries in the cache
+	std::size_t m_memoryUsage;		///< estimated memory usage of the entries in the cache in bytes
+};
+
+}//namespace
+#endif
+
@@ -132,6 +132,11 @@ public:
 			const std::string& type,
 			const std::string& term) const=0;
 
+	/// \brief Get the generation of the storage content seen by this client
+	/// \return a number that changes with every transaction committed by this client and that is unique among all storage clients of the process
+	/// \remark Used as part of cache keys for results depending on the storage content (e.g. the query result cache) for invalidating them on changes
+	virtual GlobalCounter generation() const=0;
+
 	/// \brief Get the highest document number used in this stogage
 	/// \return the document number, or 0, if no documents are inserted
 	virtual Index maxDocumentNumber() const=0;
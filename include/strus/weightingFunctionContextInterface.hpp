@@ -12,6 +12,7 @@
 #include "strus/index.hpp"
 #include "strus/termStatistics.hpp"
 #include <string>
+#include <cstddef>
 
 namespace strus
 {
@@ -49,6 +50,22 @@ public:
 	/// \return the calculated weight of the document
 	virtual double call( const Index& docno)=0;
 
+	/// \brief Call the weighting function for an array of documents in one call
+	/// \param[out] weights where to write the calculated weights of the documents to (array of size nofDocnos)
+	/// \param[in] docnos array of document numbers to weight (in ascending order within a selection, but not necessarily sorted)
+	/// \param[in] nofDocnos number of documents in docnos
+	/// \return true on success, false if the weighting function does not implement batch weighting and 'call( const Index&)' has to be called for every document instead
+	/// \remark The results have to be the same as calling 'call( const Index&)' for each element of docnos
+	virtual bool callBatch( double* weights, const Index* docnos, std::size_t nofDocnos)=0;
+
+	/// \brief Get an upper bound for the weight contributed to the result of 'call( const Index&)' by a feature
+	/// \param[in] postingIterator_ iterator of a feature added with 'addWeightingFeature' or NULL for the part of the weight not depending on the occurrence of any feature
+	/// \param[in] maxff upper bound for the feature frequency of postingIterator_ in the documents considered (e.g. a block maximum returned by 'PostingIteratorInterface::skipBlockMax( const Index&, unsigned int&)'), std::numeric_limits<unsigned int>::max() if not known
+	/// \return the upper bound or std::numeric_limits<double>::infinity() if no upper bound can be determined
+	/// \note The weight of a document must not exceed the sum of the upper bounds of the features occurring in the document plus the upper bound returned for NULL
+	/// \remark Used for dynamic pruning (MaxScore, Block-Max) of documents that cannot make it into the ranklist
+	virtual double maxFeatureWeight( const PostingIteratorInterface* postingIterator_, unsigned int maxff) const=0;
+
 	/// \brief Get debug info dumped as string of the weighting call for one document
 	/// \param[in] docno document to get the debug info from
 	/// \return the debug info as string
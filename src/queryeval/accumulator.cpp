@@ -16,6 +16,7 @@
 #include "private/internationalization.hpp"
 #include <cstdlib>
 #include <limits>
+#include <algorithm>
 #include <stdexcept>
 #include <cmath>
 #include <iostream>
@@ -23,11 +24,14 @@
 using namespace strus;
 
 #undef STRUS_LOWLEVEL_DEBUG
+/// \brief Maximum number of candidate documents weighted in one batch
+#define WEIGHTING_BATCH_SIZE 128
 
 void Accumulator::addSelector(
 		PostingIteratorInterface* iterator, int setindex)
 {
 	m_selectorPostings.push_back( SelectorPostings( false/*negative*/, setindex, iterator));
+	m_selectorBlocks.push_back( PostingBlockBuffer( iterator));
 }
 
 void Accumulator::addFeatureRestriction( PostingIteratorInterface* iterator, bool isNegative)
@@ -36,10 +40,12 @@ void Accumulator::addFeatureRestriction( PostingIteratorInterface* iterator, boo
 }
 
 void Accumulator::addWeightingElement(
-		WeightingFunctionContextInterface* function_)
+		const Reference<WeightingFunctionContextInterface>& function_,
+		const std::vector<PostingIteratorInterface*>& features_)
 {
-	m_weightingElements.push_back( WeightingElement( function_));
+	m_weightingElements.push_back( function_);
 	m_weights.push_back( 0.0);
+	m_weightingFeatures.insert( m_weightingFeatures.end(), features_.begin(), features_.end());
 }
 
 void Accumulator::addAlternativeAclRestriction(
@@ -53,52 +59,377 @@ void Accumulator::defineWeightingVariableValue( std::size_t index, const std::st
 	m_weightingElements[ index]->setVariableValue( varname, value);
 }
 
-bool Accumulator::nextRank(
-		Index& docno,
-		unsigned int& selectorState,
-		double& weight)
+void Accumulator::initPruning()
+{
+	m_pruningInitialized = true;
+	if (m_weightingFormula)
+	{
+		// ... we do not know if the weighting formula is monotonic in its arguments
+		m_pruning = false;
+		return;
+	}
+	m_pruningBaseWeight = 0.0;
+	std::vector<WeightingElement>::const_iterator
+		wi = m_weightingElements.begin(), we = m_weightingElements.end();
+	for (; wi != we; ++wi)
+	{
+		m_pruningBaseWeight += (*wi)->maxFeatureWeight( 0, std::numeric_limits<unsigned int>::max());
+	}
+	if (m_pruningBaseWeight >= std::numeric_limits<double>::infinity())
+	{
+		// ... upper bound of weight not depending on features not defined
+		m_pruning = false;
+		return;
+	}
+	std::vector<PostingIteratorInterface*> features( m_weightingFeatures);
+	std::sort( features.begin(), features.end());
+	features.erase( std::unique( features.begin(), features.end()), features.end());
+
+	std::vector<PostingIteratorInterface*>::const_iterator
+		fi = features.begin(), fe = features.end();
+	for (; fi != fe; ++fi)
+	{
+		double maxWeight = 0.0;
+		for (wi = m_weightingElements.begin(); wi != we; ++wi)
+		{
+			maxWeight += (*wi)->maxFeatureWeight( *fi, std::numeric_limits<unsigned int>::max());
+		}
+		m_pruningFeatures.push_back( PruningFeature( *fi, maxWeight));
+	}
+	std::sort( m_pruningFeatures.begin(), m_pruningFeatures.end());
+}
+
+// Leave some tolerance for rounding errors in the sum of weights:
+static double pruningThresholdOfWeight( double weight)
+{
+	return weight - std::fabs( weight) * 1e-6 - std::numeric_limits<double>::epsilon();
+}
+
+void Accumulator::defineMinRankWeight( double weight)
+{
+	if (!m_pruning) return;
+	if (!m_pruningInitialized)
+	{
+		initPruning();
+		if (!m_pruning) return;
+	}
+	raisePruningThreshold( pruningThresholdOfWeight( weight));
+}
+
+void Accumulator::defineMinRankWeight( double weight, unsigned int selectorState)
+{
+	if (!m_pruning) return;
+	if (!m_pruningInitialized)
+	{
+		initPruning();
+		if (!m_pruning) return;
+	}
+	if (m_pruningStateThresholds.empty())
+	{
+		// ... one threshold for every selection set, the ones without a complete ranklist yet prune nothing
+		int maxSetIndex = 0;
+		std::vector<SelectorPostings>::const_iterator si = m_selectorPostings.begin(), se = m_selectorPostings.end();
+		for (; si != se; ++si)
+		{
+			if (si->setindex > maxSetIndex) maxSetIndex = si->setindex;
+		}
+		m_pruningStateThresholds.resize( maxSetIndex+1, -std::numeric_limits<double>::infinity());
+	}
+	if (selectorState >= m_pruningStateThresholds.size()) return;
+	double threshold = pruningThresholdOfWeight( weight);
+	if (threshold <= m_pruningStateThresholds[ selectorState]) return;
+	m_pruningStateThresholds[ selectorState] = threshold;
+
+	// Documents are skipped before their selector state is known, this is only allowed with the threshold of all states:
+	raisePruningThreshold( *std::min_element( m_pruningStateThresholds.begin(), m_pruningStateThresholds.end()));
+}
+
+void Accumulator::raisePruningThreshold( double threshold)
+{
+	if (threshold <= m_pruningThreshold) return;
+	m_pruningThreshold = threshold;
+
+	// Calculate the features that cannot make a document competitive without an essential feature occurring in it:
+	double sum = m_pruningBaseWeight;
+	std::size_t fidx = 0, fsize = m_pruningFeatures.size();
+	for (; fidx < fsize && sum + m_pruningFeatures[ fidx].maxWeight < m_pruningThreshold; ++fidx)
+	{
+		sum += m_pruningFeatures[ fidx].maxWeight;
+	}
+	m_nofNonEssentialFeatures = fidx;
+}
+
+Index Accumulator::skipEssentialFeatures( const Index& docno)
+{
+	Index rt = 0;
+	std::vector<PruningFeature>::const_iterator
+		fi = m_pruningFeatures.begin() + m_nofNonEssentialFeatures,
+		fe = m_pruningFeatures.end();
+	for (; fi != fe; ++fi)
+	{
+		Index dn = fi->postings->skipDocCandidate( docno);
+		if (dn && (!rt || dn < rt))
+		{
+			rt = dn;
+			if (rt == docno) break;
+		}
+	}
+	return rt;
+}
+
+double Accumulator::blockMaxWeight( PruningFeature& feature, const Index& docno) const
+{
+	if (!feature.blockStart || docno < feature.blockStart || docno > feature.blockEnd)
+	{
+		unsigned int maxff = 0;
+		Index blockEnd = feature.postings->skipBlockMax( docno, maxff);
+		feature.blockStart = docno;
+		if (!blockEnd)
+		{
+			// ... no postings left from docno on
+			feature.blockEnd = std::numeric_limits<Index>::max();
+			feature.blockMaxWeight = 0.0;
+		}
+		else if (blockEnd < docno || maxff == std::numeric_limits<unsigned int>::max())
+		{
+			// ... no block bound known
+			feature.blockEnd = std::max( blockEnd, docno);
+			feature.blockMaxWeight = feature.maxWeight;
+		}
+		else
+		{
+			feature.blockEnd = blockEnd;
+			double maxWeight = 0.0;
+			std::vector<WeightingElement>::const_iterator
+				wi = m_weightingElements.begin(), we = m_weightingElements.end();
+			for (; wi != we; ++wi)
+			{
+				maxWeight += (*wi)->maxFeatureWeight( feature.postings, maxff);
+			}
+			feature.blockMaxWeight = std::min( maxWeight, feature.maxWeight);
+		}
+	}
+	return feature.blockMaxWeight;
+}
+
+Index Accumulator::skipNonCompetitiveBlocks( const Index& docno)
+{
+	double maxWeight = m_pruningBaseWeight;
+	if (maxWeight >= m_pruningThreshold) return 0;
+
+	// Sum up the block upper bounds of all features, the biggest first:
+	Index rt = std::numeric_limits<Index>::max();
+	std::vector<PruningFeature>::reverse_iterator
+		fi = m_pruningFeatures.rbegin(), fe = m_pruningFeatures.rend();
+	for (; fi != fe; ++fi)
+	{
+		maxWeight += blockMaxWeight( *fi, docno);
+		if (maxWeight >= m_pruningThreshold) return 0;
+		if (fi->blockEnd < rt) rt = fi->blockEnd;
+	}
+	// ... no document up to the end of the smallest block can get into the ranklist
+	return rt;
+}
+
+bool Accumulator::isCompetitive( const Index& docno, unsigned int selectorState)
 {
-	// For all selectors:
-	std::vector<SelectorPostings>::const_iterator
-		si = m_selectorPostings.begin() + m_selectoridx,
-		se = m_selectorPostings.end();
-	if (si == se)
+	double threshold = m_pruningThreshold;
+	if (selectorState < m_pruningStateThresholds.size() && m_pruningStateThresholds[ selectorState] > threshold)
+	{
+		threshold = m_pruningStateThresholds[ selectorState];
+	}
+	double maxWeight = m_pruningBaseWeight;
+	if (maxWeight >= threshold) return true;
+
+	// Sum up the upper bounds of the features occurring, the biggest first:
+	std::vector<PruningFeature>::reverse_iterator
+		fi = m_pruningFeatures.rbegin(), fe = m_pruningFeatures.rend();
+	for (; fi != fe; ++fi)
+	{
+		double featureMaxWeight = blockMaxWeight( *fi, docno);
+		if (featureMaxWeight > 0.0 && docno == fi->postings->skipDoc( docno))
+		{
+			maxWeight += featureMaxWeight;
+			if (maxWeight >= threshold) return true;
+		}
+	}
+	return false;
+}
+
+Index Accumulator::skipMergedSelection( const Index& docno)
+{
+	if (!m_mergedSelectionInitialized)
+	{
+		m_mergedSelectors.reserve( m_selectorPostings.size());
+		for (std::size_t sidx=0; sidx != m_selectorPostings.size(); ++sidx)
+		{
+			m_mergedSelectors.push_back( MergedSelector( 0, sidx));
+		}
+		m_mergedSelectionInitialized = true;
+	}
+	// Move all selectors with a document smaller than docno and restore the heap:
+	while (!m_mergedSelectors.empty() && m_mergedSelectors[0].docno < docno)
+	{
+		std::pop_heap( m_mergedSelectors.begin(), m_mergedSelectors.end());
+		MergedSelector& selector = m_mergedSelectors.back();
+		selector.docno = m_selectorBlocks[ selector.selectoridx].skipDoc( docno);
+		if (selector.docno)
+		{
+			std::push_heap( m_mergedSelectors.begin(), m_mergedSelectors.end());
+		}
+		else
+		{
+			m_mergedSelectors.pop_back();
+		}
+	}
+	return m_mergedSelectors.empty() ? 0 : m_mergedSelectors[0].docno;
+}
+
+Index Accumulator::skipSelection( const Index& docno)
+{
+	if (m_mergedSelection)
+	{
+		return skipMergedSelection( docno);
+	}
+	else
+	{
+		return m_selectorBlocks[ m_selectoridx].skipDoc( docno);
+	}
+}
+
+void Accumulator::closeSelectionPass()
+{
+	m_docno = 0;
+	if (m_mergedSelection)
+	{
+		// ... one pass over all selectors together
+		m_selectoridx = m_selectorPostings.size();
+		m_mergedSelectors.clear();
+	}
+	else
+	{
+		++m_selectoridx;
+	}
+}
+
+unsigned int Accumulator::currentSelectorState() const
+{
+	if (m_mergedSelection)
+	{
+		// ... the state of the first selector matching, like in the traversal of the selectors one after the other
+		std::size_t selectoridx = m_selectorPostings.size();
+		std::vector<MergedSelector>::const_iterator
+			mi = m_mergedSelectors.begin(), me = m_mergedSelectors.end();
+		for (; mi != me; ++mi)
+		{
+			if (mi->docno == m_docno && mi->selectoridx < selectoridx)
+			{
+				selectoridx = mi->selectoridx;
+			}
+		}
+		return m_selectorPostings[ selectoridx].setindex;
+	}
+	else
+	{
+		return m_selectorPostings[ m_selectoridx].setindex;
+	}
+}
+
+void Accumulator::countState( std::vector<unsigned int>& counters, unsigned int selectorState)
+{
+	if (selectorState >= counters.size())
+	{
+		counters.resize( selectorState+1, 0);
+	}
+	++counters[ selectorState];
+}
+
+unsigned int Accumulator::sumStateCounters( const std::vector<unsigned int>& counters, unsigned int maxSelectorState)
+{
+	unsigned int rt = 0;
+	std::vector<unsigned int>::const_iterator ci = counters.begin(), ce = counters.end();
+	for (unsigned int cidx=0; ci != ce && cidx <= maxSelectorState; ++ci,++cidx)
+	{
+		rt += *ci;
+	}
+	return rt;
+}
+
+bool Accumulator::nextCandidate( Index& docno, unsigned int& selectorState)
+{
+	// For all selectors (one after the other or all together in the merged selection):
+	if (m_selectorPostings.empty())
 	{
 		throw strus::runtime_error( "%s", _TXT( "query has no valid selection set defined"));
 	}
-	while (si != se)
+	while (m_selectoridx < m_selectorPostings.size())
 	{
+		if (m_budget && m_budget->exceeded( m_nofDocumentsVisited))
+		{
+			// ... stop selecting documents, the ranking gets truncated
+			return false;
+		}
 		// Select candidate document:
+		Index skipdn = (m_docno >= m_minDocumentNumber) ? (m_docno+1) : m_minDocumentNumber;
+		if (m_nofNonEssentialFeatures)
+		{
+			// ... skip documents without any feature that could make them get into the ranklist
+			skipdn = skipEssentialFeatures( skipdn);
+			if (!skipdn)
+			{
+				closeSelectionPass();
+				continue;
+			}
+		}
 		if (m_evaluationSetIterator)
 		{
 			// ... we evaluate the query on a document subset defined by a posting iterator
-			Index dn = m_docno+1;
 			do
 			{
-				m_docno = m_evaluationSetIterator->skipDoc( dn);
-				dn = si->postings->skipDoc( m_docno);
+				m_docno = m_evaluationSetIterator->skipDoc( skipdn);
+				skipdn = skipSelection( m_docno);
 			}
-			while (m_docno != 0 && dn != 0 && dn != m_docno);
+			while (m_docno != 0 && skipdn != 0 && skipdn != m_docno);
 		}
 		else
 		{
 			// ... we evaluate the query on all documents
-			m_docno = si->postings->skipDoc( m_docno+1);
+			m_docno = skipSelection( skipdn);
 		}
 		if (!m_docno)
 		{
-			++si;
-			++m_selectoridx;
+			closeSelectionPass();
 			continue;
 		}
-		// Test if it already has been visited:
-		if (m_docno > m_maxDocumentNumber || m_visited.test( m_docno-1))
+		if (m_pruning && m_pruningInitialized)
+		{
+			// ... skip blocks of documents without a chance to get into the ranklist
+			Index blockEnd = skipNonCompetitiveBlocks( m_docno);
+			if (blockEnd)
+			{
+				if (blockEnd >= m_maxDocumentNumber)
+				{
+					closeSelectionPass();
+				}
+				else
+				{
+					m_docno = blockEnd;
+				}
+				continue;
+			}
+		}
+		if (m_docno > m_maxDocumentNumber)
+		{
+			// ... documents with docno bigger than m_maxDocumentNumber are out of the
+			//	range evaluated or were just inserted and are not respected in this query.
+			closeSelectionPass();
+			continue;
+		}
+		// Test if it already has been visited (in the merged selection every document is visited only once):
+		if (!m_mergedSelection && !m_visited.insert( m_docno))
 		{
-			// ... documents with docno bigger than m_maxDocumentNumber 
-			//	were just inserted and are not respected in this query.
 			continue;
 		}
-		m_visited.set( m_docno-1);
 
 		// Check if any ACL restriction (alternatives combined with OR):
 		if (m_aclRestrictions.size())
@@ -130,14 +461,14 @@ bool Accumulator::nextRank(
 				}
 				else
 				{
-					m_docno = 0;
-					++m_selectoridx;
-					++si;
+					closeSelectionPass();
 					continue;
 				}
 			}
 		}
 		++m_nofDocumentsVisited;
+		unsigned int state = currentSelectorState();
+		countState( m_nofDocumentsVisitedStates, state);
 
 		// Check meta data restrictions:
 		if (m_metaDataRestriction.get() && !m_metaDataRestriction->match(m_docno))
@@ -157,41 +488,104 @@ bool Accumulator::nextRank(
 			}
 		}
 		if (ri != re) continue;
+		countState( m_nofDocumentsRankedStates, state);
+
+		// Check if the document can get into the ranklist:
+		if (m_pruning && !isCompetitive( m_docno, state)) continue;
 
-		// Init result:
 		docno = m_docno;
-		selectorState = m_selectorPostings[ m_selectoridx].setindex;
-		++m_nofDocumentsRanked;
+		selectorState = state;
+		return true;
+	}
+	return false;
+}
+
+void Accumulator::callWeightingElement( WeightingFunctionContextInterface* element, double* weights)
+{
+	const Index* docnos = m_batchDocnos.data();
+	std::size_t nofDocnos = m_batchDocnos.size();
+	if (!element->callBatch( weights, docnos, nofDocnos))
+	{
+		// ... batch weighting not implemented by the function, call it for every document:
+		for (std::size_t di=0; di != nofDocnos; ++di)
+		{
+			weights[ di] = element->call( docnos[ di]);
+		}
+	}
+}
+
+bool Accumulator::fillBatch()
+{
+	m_batchDocnos.clear();
+	m_batchSelectorStates.clear();
+	m_batchIdx = 0;
+
+	// Select the candidates:
+	Index docno;
+	unsigned int selectorState;
+	while (m_batchDocnos.size() < WEIGHTING_BATCH_SIZE && nextCandidate( docno, selectorState))
+	{
+		m_batchDocnos.push_back( docno);
+		m_batchSelectorStates.push_back( selectorState);
+	}
+	std::size_t nofDocnos = m_batchDocnos.size();
+	if (!nofDocnos) return false;
 
 #ifdef STRUS_LOWLEVEL_DEBUG
-		std::cerr << "Weighting document " << m_docno << std::endl;
+	std::cerr << "Weighting " << nofDocnos << " documents starting with " << m_batchDocnos[0] << std::endl;
 #endif
-		std::vector<WeightingElement>::iterator
-			ai = m_weightingElements.begin(), ae = m_weightingElements.end();
-		if (m_weightingFormula)
+	// Calculate the weights of the candidates:
+	std::vector<WeightingElement>::iterator
+		ai = m_weightingElements.begin(), ae = m_weightingElements.end();
+	m_batchWeights.resize( nofDocnos);
+	if (m_weightingFormula)
+	{
+		// Calculate a weight for every element and call the weighting formula with the result:
+		m_batchElementWeights.resize( nofDocnos * m_weightingElements.size());
+		for (std::size_t aidx=0; ai != ae; ++ai,++aidx)
+		{
+			callWeightingElement( ai->get(), m_batchElementWeights.data() + aidx * nofDocnos);
+		}
+		for (std::size_t di=0; di != nofDocnos; ++di)
 		{
-			// Calculate a weight for every element and call the weighting formula with the result:
-			for (std::size_t aidx=0; ai != ae; ++ai,++aidx)
+			for (std::size_t aidx=0; aidx != m_weights.size(); ++aidx)
 			{
-				m_weights[ aidx] = (*ai)->call( m_docno);
+				m_weights[ aidx] = m_batchElementWeights[ aidx * nofDocnos + di];
 			}
-			weight = m_weightingFormula->call( m_weights.data(), m_weights.size());
+			m_batchWeights[ di] = m_weightingFormula->call( m_weights.data(), m_weights.size());
 		}
-		else
+	}
+	else
+	{
+		// Add a weight to the result for every element:
+		m_batchElementWeights.resize( nofDocnos);
+		std::fill( m_batchWeights.begin(), m_batchWeights.end(), 0.0);
+		for (; ai != ae; ++ai)
 		{
-			// Add a weight to the result for every element:
-			weight = 0.0;
-			for (; ai != ae; ++ai)
+			callWeightingElement( ai->get(), m_batchElementWeights.data());
+			for (std::size_t di=0; di != nofDocnos; ++di)
 			{
-				weight += (*ai)->call( m_docno);
-#ifdef STRUS_LOWLEVEL_DEBUG
-				std::cerr << "weight +" << (weight_result * ai->weight) << " (" << weight_result << "*" << ai->weight << ") = " << weight << std::endl;
-#endif
+				m_batchWeights[ di] += m_batchElementWeights[ di];
 			}
 		}
-		return true;
 	}
-	return false;
+	return true;
+}
+
+bool Accumulator::nextRank(
+		Index& docno,
+		unsigned int& selectorState,
+		double& weight)
+{
+	if (m_batchIdx >= m_batchDocnos.size())
+	{
+		if (!fillBatch()) return false;
+	}
+	docno = m_batchDocnos[ m_batchIdx];
+	selectorState = m_batchSelectorStates[ m_batchIdx];
+	weight = m_batchWeights[ m_batchIdx];
+	++m_batchIdx;
+	return true;
 }
 
 std::string Accumulator::getWeightingDebugInfo( std::size_t fidx, const Index& docno)
@@ -15,6 +15,9 @@
 #include "strus/metaDataRestrictionInterface.hpp"
 #include "strus/metaDataRestrictionInstanceInterface.hpp"
 #include "private/utils.hpp"
+#include "private/postingBlockBuffer.hpp"
+#include "queryBudgetState.hpp"
+#include "visitedSet.hpp"
 #include <vector>
 #include <list>
 #include <limits>
@@ -37,7 +40,7 @@ class MetaDataReaderInterface;
 class InvAclIteratorInterface;
 
 /// \class Accumulator
-/// \brief Accumulator for weights of matches
+/// \brief Accumulator for weights of matches in a range of document numbers
 /// \remark This class represents an object that should be used only one time, for one ranklist calculation. It keeps its state.
 class Accumulator
 {
@@ -49,19 +52,29 @@ public:
 			const MetaDataRestrictionInterface* metaDataRestriction_,
 			const ScalarFunctionInstanceInterface* weightingFormula_,
 			std::size_t maxNofRanks_,
-			std::size_t maxDocumentNumber_)
+			const Index& minDocumentNumber_,
+			const Index& maxDocumentNumber_)
 		:m_storage(storage_)
 		,m_metadata(metadata_)
 		,m_metaDataRestriction(metaDataRestriction_?metaDataRestriction_->createInstance():0)
 		,m_weightingFormula(weightingFormula_)
 		,m_selectoridx(0)
 		,m_docno(0)
-		,m_visited(maxDocumentNumber_)
+		,m_visited(minDocumentNumber_,maxDocumentNumber_)
 		,m_maxNofRanks(maxNofRanks_)
+		,m_minDocumentNumber(minDocumentNumber_)
 		,m_maxDocumentNumber(maxDocumentNumber_)
-		,m_nofDocumentsRanked(0)
 		,m_nofDocumentsVisited(0)
 		,m_evaluationSetIterator(0)
+		,m_budget(0)
+		,m_mergedSelection(false)
+		,m_mergedSelectionInitialized(false)
+		,m_batchIdx(0)
+		,m_pruning(false)
+		,m_pruningInitialized(false)
+		,m_pruningBaseWeight(0.0)
+		,m_pruningThreshold(-std::numeric_limits<double>::infinity())
+		,m_nofNonEssentialFeatures(0)
 	{}
 
 	~Accumulator(){}
@@ -74,16 +87,48 @@ public:
 	void addSelector( PostingIteratorInterface* iterator, int setindex);
 
 	void addWeightingElement(
-			WeightingFunctionContextInterface* function_);
+			const Reference<WeightingFunctionContextInterface>& function_,
+			const std::vector<PostingIteratorInterface*>& features_);
 
 	void addFeatureRestriction( PostingIteratorInterface* iterator, bool isNegative);
 
 	void addAlternativeAclRestriction( const Reference<InvAclIteratorInterface>& iterator);
 
+	/// \brief Enable dynamic pruning (MaxScore and Block-Max) of documents that cannot make it into the ranklist
+	void usePruning( bool enable)
+	{
+		m_pruning = enable;
+	}
+
+	/// \brief Enable the traversal of all selection features together in ascending order of document numbers, instead of one after the other
+	void useMergedSelection( bool enable)
+	{
+		m_mergedSelection = enable;
+	}
+
+	/// \brief Define the budget checked for stopping the selection of documents, if exceeded
+	void defineBudget( QueryBudgetState* budget_)
+	{
+		m_budget = budget_;
+	}
+
+	/// \brief Define the weight of the last element of the complete ranklist, a document has to beat to get in
+	/// \note Not for the merged selection, where documents of a selector state must not be pruned with the weights of documents of the following states
+	void defineMinRankWeight( double weight);
+
+	/// \brief Define the weight of the last element of the complete ranklist of the documents with a selector state up to a given one, a document of this selector state has to beat to get in (merged selection)
+	/// \param[in] weight minimum weight of the ranklist of the documents with a selector state up to selectorState
+	/// \param[in] selectorState selector state the threshold applies to
+	void defineMinRankWeight( double weight, unsigned int selectorState);
+
 	bool nextRank( Index& docno, unsigned int& selectorState, double& weight);
 
-	unsigned int nofDocumentsRanked() const		{return m_nofDocumentsRanked;}
-	unsigned int nofDocumentsVisited() const	{return m_nofDocumentsVisited;}
+	/// \brief Get the number of documents ranked with a selector state up to a given one
+	/// \remark Includes the documents selected for the weighting in the current batch, but not returned by nextRank yet
+	unsigned int nofDocumentsRanked( unsigned int maxSelectorState) const		{return sumStateCounters( m_nofDocumentsRankedStates, maxSelectorState);}
+	/// \brief Get the number of documents visited with a selector state up to a given one
+	/// \remark Same conditions as for nofDocumentsRanked(unsigned int)
+	unsigned int nofDocumentsVisited( unsigned int maxSelectorState) const		{return sumStateCounters( m_nofDocumentsVisitedStates, maxSelectorState);}
 
 	std::string getWeightingDebugInfo( std::size_t fidx, const Index& docno);
 
@@ -91,6 +136,20 @@ public:
 
 private:
 	bool isRelevantSelectionFeature( PostingIteratorInterface& itr) const;
+	bool nextCandidate( Index& docno, unsigned int& selectorState);
+	Index skipSelection( const Index& docno);
+	Index skipMergedSelection( const Index& docno);
+	void closeSelectionPass();
+	unsigned int currentSelectorState() const;
+	static void countState( std::vector<unsigned int>& counters, unsigned int selectorState);
+	static unsigned int sumStateCounters( const std::vector<unsigned int>& counters, unsigned int maxSelectorState);
+	bool fillBatch();
+	void callWeightingElement( WeightingFunctionContextInterface* element, double* weights);
+	void initPruning();
+	Index skipEssentialFeatures( const Index& docno);
+	Index skipNonCompetitiveBlocks( const Index& docno);
+	bool isCompetitive( const Index& docno, unsigned int selectorState);
+	void raisePruningThreshold( double weight);
 
 private:
 	typedef Reference< WeightingFunctionContextInterface> WeightingElement;
@@ -116,16 +175,77 @@ private:
 	std::vector<WeightingElement> m_weightingElements;
 	std::vector<double> m_weights;
 	std::vector<SelectorPostings> m_selectorPostings;
+	std::vector<PostingBlockBuffer> m_selectorBlocks;		///< document matches of the elements in m_selectorPostings fetched block wise
 	std::vector<SelectorPostings> m_featureRestrictions;
 	std::vector<Reference<InvAclIteratorInterface> > m_aclRestrictions;
 	unsigned int m_selectoridx;
 	Index m_docno;
-	utils::DynamicBitset m_visited;
+	VisitedSet m_visited;						///< documents visited, allocated in chunks for the regions of the document range visited
 	std::size_t m_maxNofRanks;
-	Index m_maxDocumentNumber;
-	unsigned int m_nofDocumentsRanked;
-	unsigned int m_nofDocumentsVisited;
+	Index m_minDocumentNumber;					///< first document number of the range evaluated
+	Index m_maxDocumentNumber;					///< last document number of the range evaluated
+	unsigned int m_nofDocumentsVisited;				///< number of documents visited, for checking the budget
 	PostingIteratorInterface* m_evaluationSetIterator;
+	QueryBudgetState* m_budget;					///< budget of the query evaluation or 0, if not defined
+
+	/// \brief Current document of a selection feature in the merged selection
+	struct MergedSelector
+	{
+		Index docno;				///< current document of the selector (0, if not positioned yet)
+		std::size_t selectoridx;		///< index of the selector in m_selectorPostings
+
+		MergedSelector( const Index& docno_, std::size_t selectoridx_)
+			:docno(docno_),selectoridx(selectoridx_){}
+		MergedSelector( const MergedSelector& o)
+			:docno(o.docno),selectoridx(o.selectoridx){}
+
+		/// \brief Order for a heap with the smallest document number on top
+		bool operator < ( const MergedSelector& o) const
+		{
+			return docno == o.docno ? selectoridx > o.selectoridx : docno > o.docno;
+		}
+	};
+	bool m_mergedSelection;						///< true, if all selection features are traversed together in ascending order of document numbers
+	bool m_mergedSelectionInitialized;				///< true, if m_mergedSelectors has been initialized
+	std::vector<MergedSelector> m_mergedSelectors;			///< heap of the selection features not exhausted yet in the merged selection
+	std::vector<unsigned int> m_nofDocumentsRankedStates;		///< number of documents ranked per selector state
+	std::vector<unsigned int> m_nofDocumentsVisitedStates;		///< number of documents visited per selector state
+
+	std::vector<Index> m_batchDocnos;				///< candidate documents weighted in one batch
+	std::vector<unsigned int> m_batchSelectorStates;		///< selector states the elements in m_batchDocnos were selected in
+	std::vector<double> m_batchWeights;				///< weights of the elements in m_batchDocnos
+	std::vector<double> m_batchElementWeights;			///< weights of the elements in m_batchDocnos calculated by one (or with a formula by each) weighting element
+	std::size_t m_batchIdx;						///< index of the next element in m_batchDocnos to return with nextRank
+
+	struct PruningFeature
+	{
+		PostingIteratorInterface* postings;
+		double maxWeight;			///< upper bound of the weight contributed by the feature
+		Index blockStart;			///< start of the document range blockMaxWeight is valid for
+		Index blockEnd;				///< end of the document range blockMaxWeight is valid for
+		double blockMaxWeight;			///< upper bound of the weight contributed by the feature in the current block
+
+		PruningFeature( PostingIteratorInterface* postings_, double maxWeight_)
+			:postings(postings_),maxWeight(maxWeight_),blockStart(0),blockEnd(0),blockMaxWeight(maxWeight_){}
+		PruningFeature( const PruningFeature& o)
+			:postings(o.postings),maxWeight(o.maxWeight)
+			,blockStart(o.blockStart),blockEnd(o.blockEnd),blockMaxWeight(o.blockMaxWeight){}
+
+		bool operator < ( const PruningFeature& o) const
+		{
+			return maxWeight < o.maxWeight;
+		}
+	};
+	double blockMaxWeight( PruningFeature& feature, const Index& docno) const;
+
+	std::vector<PostingIteratorInterface*> m_weightingFeatures;	///< all features referenced by weighting functions
+	bool m_pruning;							///< true, if pruning (MaxScore and Block-Max) is enabled
+	bool m_pruningInitialized;					///< true, if the upper bounds of the features for pruning have been calculated
+	double m_pruningBaseWeight;					///< upper bound of the weight not depending on features
+	double m_pruningThreshold;					///< weight a document has to beat to get into the ranklist
+	std::vector<double> m_pruningStateThresholds;			///< weight a document of a selector state has to beat to get into the ranklist (merged selection), m_pruningThreshold is the minimum of all states
+	std::vector<PruningFeature> m_pruningFeatures;			///< features with their upper bound weights in ascending order
+	std::size_t m_nofNonEssentialFeatures;				///< number of features at start of m_pruningFeatures that cannot make a document competitive alone
 };
 
 }//namespace
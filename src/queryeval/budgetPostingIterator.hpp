@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) 2014 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Posting iterator counting the operations on another posting iterator for the query budget
+/// \file "budgetPostingIterator.hpp"
+#ifndef _STRUS_BUDGET_POSTING_ITERATOR_HPP_INCLUDED
+#define _STRUS_BUDGET_POSTING_ITERATOR_HPP_INCLUDED
+#include "strus/postingIteratorInterface.hpp"
+#include "strus/reference.hpp"
+#include "queryBudgetState.hpp"
+
+namespace strus
+{
+
+/// \brief Posting iterator counting the operations on the posting iterator it wraps
+/// \note Only used if a limit of posting operations is defined in the query budget
+class BudgetPostingIterator
+	:public PostingIteratorInterface
+{
+public:
+	/// \brief Constructor
+	/// \param[in] itr_ posting iterator wrapped (ownership passed)
+	/// \param[in] budget_ pointer to the pointer to the budget state of the current evaluation (the referenced pointer may be 0 for no counting)
+	BudgetPostingIterator( PostingIteratorInterface* itr_, QueryBudgetState* const* budget_)
+		:m_itr(itr_),m_budget(budget_){}
+
+	virtual ~BudgetPostingIterator(){}
+
+	virtual Index skipDoc( const Index& docno_)
+	{
+		count();
+		return m_itr->skipDoc( docno_);
+	}
+
+	virtual Index skipDocCandidate( const Index& docno_)
+	{
+		count();
+		return m_itr->skipDocCandidate( docno_);
+	}
+
+	virtual bool skipDocBlock( const Index& docno_, Index* docnos, unsigned int* ffs, std::size_t maxsize, std::size_t& size)
+	{
+		if (!m_itr->skipDocBlock( docno_, docnos, ffs, maxsize, size)) return false;
+		// ... every document fetched is counted as one posting operation
+		for (std::size_t di=0; di < size; ++di) count();
+		return true;
+	}
+
+	virtual Index skipPos( const Index& firstpos)
+	{
+		count();
+		return m_itr->skipPos( firstpos);
+	}
+
+	virtual const char* featureid() const
+	{
+		return m_itr->featureid();
+	}
+
+	virtual Index documentFrequency() const
+	{
+		return m_itr->documentFrequency();
+	}
+
+	virtual unsigned int frequency()
+	{
+		return m_itr->frequency();
+	}
+
+	virtual Index skipBlockMax( const Index& docno_, unsigned int& maxff)
+	{
+		count();
+		return m_itr->skipBlockMax( docno_, maxff);
+	}
+
+	virtual unsigned int nofBlocksLoaded() const
+	{
+		return m_itr->nofBlocksLoaded();
+	}
+
+	virtual Index docno() const
+	{
+		return m_itr->docno();
+	}
+
+	virtual Index posno() const
+	{
+		return m_itr->posno();
+	}
+
+	virtual Index length() const
+	{
+		return m_itr->length();
+	}
+
+private:
+	void count()
+	{
+		if (*m_budget) (*m_budget)->countPostingOperation();
+	}
+
+private:
+	Reference<PostingIteratorInterface> m_itr;	///< posting iterator wrapped
+	QueryBudgetState* const* m_budget;		///< reference to the budget state of the current evaluation
+};
+
+}//namespace
+#endif
+
@@ -10,6 +10,7 @@
 #ifndef _STRUS_DOCSET_POSTING_ITERATOR_HPP_INCLUDED
 #define _STRUS_DOCSET_POSTING_ITERATOR_HPP_INCLUDED
 #include "strus/postingIteratorInterface.hpp"
+#include <limits>
 
 namespace strus
 {
@@ -36,6 +37,11 @@ public:
 		return skipDocImpl( docno_);
 	}
 
+	virtual bool skipDocBlock( const Index&, Index*, unsigned int*, std::size_t, std::size_t&)
+	{
+		return false;
+	}
+
 	virtual Index skipPos( const Index& firstpos)
 	{
 		return (m_itr == m_end && firstpos <= 1)?0:1;
@@ -61,6 +67,17 @@ public:
 		return (m_itr == m_end)?0:1;
 	}
 
+	virtual Index skipBlockMax( const Index&, unsigned int& maxff)
+	{
+		maxff = 1;
+		return std::numeric_limits<Index>::max();
+	}
+
+	virtual unsigned int nofBlocksLoaded() const
+	{
+		return 0;
+	}
+
 	virtual Index docno() const
 	{
 		return (m_itr == m_end)?0:*m_itr;
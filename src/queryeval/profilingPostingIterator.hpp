@@ -0,0 +1,141 @@
+/*
+ * Copyright (c) 2014 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Posting iterator counting the operations on another posting iterator for the query profile
+/// \file "profilingPostingIterator.hpp"
+#ifndef _STRUS_PROFILING_POSTING_ITERATOR_HPP_INCLUDED
+#define _STRUS_PROFILING_POSTING_ITERATOR_HPP_INCLUDED
+#include "strus/postingIteratorInterface.hpp"
+#include "strus/reference.hpp"
+
+namespace strus
+{
+
+/// \brief Posting iterator counting the operations on the posting iterator it wraps
+/// \note Only used if the profiling mode of the query is enabled
+class ProfilingPostingIterator
+	:public PostingIteratorInterface
+{
+public:
+	/// \brief Counters of the operations on a posting iterator
+	struct Counters
+	{
+		unsigned int nofSkipDoc;		///< number of calls of skipDoc
+		unsigned int nofSkipDocCandidate;	///< number of calls of skipDocCandidate
+		unsigned int nofSkipPos;		///< number of calls of skipPos
+		unsigned int nofBlocksLoaded;		///< number of blocks loaded from the storage
+
+		Counters()
+			:nofSkipDoc(0),nofSkipDocCandidate(0),nofSkipPos(0),nofBlocksLoaded(0){}
+		Counters( const Counters& o)
+			:nofSkipDoc(o.nofSkipDoc),nofSkipDocCandidate(o.nofSkipDocCandidate),nofSkipPos(o.nofSkipPos),nofBlocksLoaded(o.nofBlocksLoaded){}
+
+		Counters& operator += ( const Counters& o)
+		{
+			nofSkipDoc += o.nofSkipDoc;
+			nofSkipDocCandidate += o.nofSkipDocCandidate;
+			nofSkipPos += o.nofSkipPos;
+			nofBlocksLoaded += o.nofBlocksLoaded;
+			return *this;
+		}
+	};
+
+	/// \brief Constructor
+	/// \param[in] itr_ posting iterator wrapped (ownership passed)
+	explicit ProfilingPostingIterator( PostingIteratorInterface* itr_)
+		:m_itr(itr_),m_counters(),m_nofBlocksLoadedBase(0){}
+
+	virtual ~ProfilingPostingIterator(){}
+
+	/// \brief Reset the counters (for the next evaluation of a prepared query)
+	void resetCounters()
+	{
+		m_counters = Counters();
+		m_nofBlocksLoadedBase = m_itr->nofBlocksLoaded();
+	}
+
+	/// \brief Get the counters of the operations since the creation or the last reset
+	Counters counters() const
+	{
+		Counters rt( m_counters);
+		rt.nofBlocksLoaded = m_itr->nofBlocksLoaded() - m_nofBlocksLoadedBase;
+		return rt;
+	}
+
+	virtual Index skipDoc( const Index& docno_)
+	{
+		++m_counters.nofSkipDoc;
+		return m_itr->skipDoc( docno_);
+	}
+
+	virtual Index skipDocCandidate( const Index& docno_)
+	{
+		++m_counters.nofSkipDocCandidate;
+		return m_itr->skipDocCandidate( docno_);
+	}
+
+	virtual bool skipDocBlock( const Index& docno_, Index* docnos, unsigned int* ffs, std::size_t maxsize, std::size_t& size)
+	{
+		++m_counters.nofSkipDoc;
+		return m_itr->skipDocBlock( docno_, docnos, ffs, maxsize, size);
+	}
+
+	virtual Index skipPos( const Index& firstpos)
+	{
+		++m_counters.nofSkipPos;
+		return m_itr->skipPos( firstpos);
+	}
+
+	virtual const char* featureid() const
+	{
+		return m_itr->featureid();
+	}
+
+	virtual Index documentFrequency() const
+	{
+		return m_itr->documentFrequency();
+	}
+
+	virtual unsigned int frequency()
+	{
+		return m_itr->frequency();
+	}
+
+	virtual Index skipBlockMax( const Index& docno_, unsigned int& maxff)
+	{
+		return m_itr->skipBlockMax( docno_, maxff);
+	}
+
+	virtual unsigned int nofBlocksLoaded() const
+	{
+		return m_itr->nofBlocksLoaded();
+	}
+
+	virtual Index docno() const
+	{
+		return m_itr->docno();
+	}
+
+	virtual Index posno() const
+	{
+		return m_itr->posno();
+	}
+
+	virtual Index length() const
+	{
+		return m_itr->length();
+	}
+
+private:
+	Reference<PostingIteratorInterface> m_itr;	///< posting iterator wrapped
+	Counters m_counters;				///< counters of the operations
+	unsigned int m_nofBlocksLoadedBase;		///< number of blocks loaded by the wrapped iterator at the last reset
+};
+
+}//namespace
+#endif
+
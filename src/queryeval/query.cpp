@@ -22,6 +22,9 @@
 #include "strus/reference.hpp"
 #include "strus/summaryElement.hpp"
 #include "docsetPostingIterator.hpp"
+#include "budgetPostingIterator.hpp"
+#include "queryBudgetState.hpp"
+#include "queryPhaseProfiler.hpp"
 #include "private/utils.hpp"
 #include "strus/base/snprintf.h"
 #include "strus/base/local_ptr.hpp"
@@ -33,6 +36,8 @@
 #include <utility>
 #include <algorithm>
 #include <cstdio>
+#include <sstream>
+#include <iomanip>
 
 #undef STRUS_LOWLEVEL_DEBUG
 
@@ -59,6 +64,11 @@ Query::Query( const QueryEval* queryEval_, const StorageClientInterface* storage
 	,m_termstatsmap()
 	,m_globstats()
 	,m_debugMode(false)
+	,m_profilingMode(false)
+	,m_nofThreads(0)
+	,m_budget()
+	,m_prepared(false)
+	,m_preparedContext()
 	,m_errorhnd(errorhnd_)
 {
 	if (!m_metaDataReader.get()) throw strus::runtime_error( "%s", _TXT("error creating meta data reader"));
@@ -173,6 +183,7 @@ void Query::attachVariable( const std::string& name_)
 			m_errorhnd->report( _TXT( "cannot attach variable (query stack empty)"));
 		}
 		m_variableAssignments.insert( std::pair<NodeAddress,std::string>( m_stack.back(), name_));
+		m_preparedContext.reset();
 	}
 	CATCH_ERROR_MAP( _TXT("error attaching variables to query: %s"), *m_errorhnd);
 }
@@ -190,6 +201,7 @@ void Query::defineFeature( const std::string& set_, double weight_)
 		if (m_stack.empty()) throw strus::runtime_error( "%s", _TXT("no term or expression defined"));
 		m_features.push_back( Feature( utils::tolower(set_), m_stack.back(), weight_));
 		m_stack.pop_back();
+		m_preparedContext.reset();
 	}
 	CATCH_ERROR_MAP( _TXT("error define feature of query: %s"), *m_errorhnd);
 }
@@ -235,7 +247,13 @@ void Query::print( std::ostream& out) const
 		printNode( out, fi->node, 1);
 		out << std::endl;
 	}
-	if (m_debugMode) out << _TXT("debug mode enabled") << std::endl;
+	if (m_debugMode)
+	{
+		out << _TXT("debug mode enabled") << std::endl;
+		printPlan( out);
+	}
+	if (m_profilingMode) out << _TXT("profiling mode enabled") << std::endl;
+	if (m_nofThreads > 1) out << "nofThreads = " << m_nofThreads << std::endl;
 	out << "maxNofRanks = " << m_nofRanks << std::endl;
 	out << "minRank = " << m_minRank << std::endl;
 	std::vector<Index>::const_iterator di = m_evalset_docnolist.begin(), de = m_evalset_docnolist.end();
@@ -269,6 +287,91 @@ std::string Query::tostring() const
 	return out.str();
 }
 
+std::string Query::resultCacheKey() const
+{
+	// Canonical serialization of everything (except the query evaluation scheme owning the cache) the query result depends on:
+	std::ostringstream out;
+	out << std::setprecision( 17);
+	out << "S" << (const void*)m_storage << ":" << m_storage->generation() << "\n";
+	std::vector<Term>::const_iterator ti = m_terms.begin(), te = m_terms.end();
+	for (; ti != te; ++ti)
+	{
+		out << "T" << ti->type.size() << ":" << ti->type << ti->value.size() << ":" << ti->value << " " << ti->length << "\n";
+	}
+	std::vector<DocField>::const_iterator di = m_docfields.begin(), de = m_docfields.end();
+	for (; di != de; ++di)
+	{
+		out << "D" << di->metadataRangeStart << " " << di->metadataRangeEnd << "\n";
+	}
+	std::vector<Expression>::const_iterator ei = m_expressions.begin(), ee = m_expressions.end();
+	for (; ei != ee; ++ei)
+	{
+		out << "E" << ei->operation->getDescription().name() << " " << ei->range << " " << ei->cardinality;
+		std::vector<NodeAddress>::const_iterator ni = ei->subnodes.begin(), ne = ei->subnodes.end();
+		for (; ni != ne; ++ni)
+		{
+			out << " " << *ni;
+		}
+		out << "\n";
+	}
+	std::vector<Feature>::const_iterator fi = m_features.begin(), fe = m_features.end();
+	for (; fi != fe; ++fi)
+	{
+		out << "F" << fi->set.size() << ":" << fi->set << fi->node << " " << fi->weight << "\n";
+	}
+	std::multimap<NodeAddress,std::string>::const_iterator
+		vi = m_variableAssignments.begin(), ve = m_variableAssignments.end();
+	for (; vi != ve; ++vi)
+	{
+		out << "V" << vi->first << " " << vi->second << "\n";
+	}
+	if (m_metaDataRestriction.get())
+	{
+		out << "M" << m_metaDataRestriction->tostring() << "\n";
+	}
+	if (m_evalset_defined)
+	{
+		out << "X";
+		std::vector<Index>::const_iterator xi = m_evalset_docnolist.begin(), xe = m_evalset_docnolist.end();
+		for (; xi != xe; ++xi)
+		{
+			out << " " << *xi;
+		}
+		out << "\n";
+	}
+	if (!m_usernames.empty())
+	{
+		// ... the order of the alternative users does not matter
+		std::vector<std::string> usernames( m_usernames);
+		std::sort( usernames.begin(), usernames.end());
+		usernames.erase( std::unique( usernames.begin(), usernames.end()), usernames.end());
+		std::vector<std::string>::const_iterator ui = usernames.begin(), ue = usernames.end();
+		for (; ui != ue; ++ui)
+		{
+			out << "U" << *ui << "\n";
+		}
+	}
+	TermStatisticsMap::const_iterator si = m_termstatsmap.begin(), se = m_termstatsmap.end();
+	for (; si != se; ++si)
+	{
+		out << "Q" << si->first.type.size() << ":" << si->first.type << si->first.value.size() << ":" << si->first.value << " " << si->second.documentFrequency() << "\n";
+	}
+	out << "G" << m_globstats.nofDocumentsInserted() << "\n";
+	std::vector<WeightingVariableValueAssignment>::const_iterator
+		wi = m_weightingvars.begin(), we = m_weightingvars.end();
+	for (; wi != we; ++wi)
+	{
+		out << "W" << wi->index << " " << wi->varname << "=" << wi->value << "\n";
+	}
+	wi = m_summaryweightvars.begin(), we = m_summaryweightvars.end();
+	for (; wi != we; ++wi)
+	{
+		out << "Z" << wi->index << " " << wi->varname << "=" << wi->value << "\n";
+	}
+	out << "R" << m_nofRanks << " " << m_minRank << (m_debugMode ? " debug":"") << "\n";
+	return out.str();
+}
+
 void Query::printVariables( std::ostream& out, NodeAddress adr) const
 {
 	typedef std::multimap<NodeAddress,std::string>::const_iterator Itr;
@@ -332,6 +435,104 @@ void Query::printNode( std::ostream& out, NodeAddress adr, std::size_t indent) c
 	}
 }
 
+struct PlanNodeOrder
+{
+	Index df;
+	std::size_t argidx;
+
+	PlanNodeOrder( Index df_, std::size_t argidx_)
+		:df(df_),argidx(argidx_){}
+	PlanNodeOrder( const PlanNodeOrder& o)
+		:df(o.df),argidx(o.argidx){}
+
+	bool operator<( const PlanNodeOrder& o) const
+	{
+		if (df == o.df) return argidx < o.argidx;
+		return df < o.df;
+	}
+};
+
+void Query::printPlan( std::ostream& out) const
+{
+	out << _TXT("evaluation plan:") << std::endl;
+	try
+	{
+		NodeStorageDataMap nodeStorageDataMap;
+		std::vector<Reference<PostingIteratorInterface> > postings;
+
+		std::vector<Feature>::const_iterator fi = m_features.begin(), fe = m_features.end();
+		for (; fi != fe; ++fi)
+		{
+			postings.push_back( createNodePostingIterator( fi->node, nodeStorageDataMap, 0));
+			if (m_errorhnd->hasError())
+			{
+				out << _TXT("error building the evaluation plan: ") << m_errorhnd->fetchError() << std::endl;
+				return;
+			}
+			out << _TXT("feature '") << fi->set << "':" << std::endl;
+			printPlanNode( out, fi->node, nodeStorageDataMap, 1);
+		}
+	}
+	catch (const std::bad_alloc&)
+	{
+		out << _TXT("out of memory building the evaluation plan") << std::endl;
+	}
+	catch (const std::runtime_error& err)
+	{
+		out << _TXT("error building the evaluation plan: ") << err.what() << std::endl;
+	}
+}
+
+void Query::printPlanNode( std::ostream& out, NodeAddress adr, const NodeStorageDataMap& nodeStorageDataMap, std::size_t indent) const
+{
+	std::string indentstr( indent*2, ' ');
+	NodeStorageDataMap::const_iterator pi = nodeStorageDataMap.find( adr);
+	Index df = (pi == nodeStorageDataMap.end() || !pi->second.itr) ? 0 : pi->second.itr->documentFrequency();
+	switch (nodeType( adr))
+	{
+		case NullNode:
+			out << indentstr << "NULL" << std::endl;
+			break;
+		case TermNode:
+		{
+			const Term& term = m_terms[ nodeIndex( adr)];
+			out << indentstr << "term " << term.type << " '" << term.value << "' df=" << df << std::endl;
+			break;
+		}
+		case DocFieldNode:
+		{
+			const DocField& docfield = m_docfields[ nodeIndex( adr)];
+			out << indentstr << "docfield " << docfield.metadataRangeStart << " : " << docfield.metadataRangeEnd << " df=" << df << std::endl;
+			break;
+		}
+		case ExpressionNode:
+		{
+			const Expression& expr = m_expressions[ nodeIndex( adr)];
+			out << indentstr << expr.operation->getDescription().name() << " df=" << df << ":" << std::endl;
+
+			// Arguments listed in the order joins matching all of them visit them (rarest first):
+			std::vector<PlanNodeOrder> order;
+			std::vector<NodeAddress>::const_iterator
+				ni = expr.subnodes.begin(),
+				ne = expr.subnodes.end();
+			for (std::size_t nidx=0; ni != ne; ++ni,++nidx)
+			{
+				NodeStorageDataMap::const_iterator si = nodeStorageDataMap.find( *ni);
+				Index subdf = (si == nodeStorageDataMap.end() || !si->second.itr) ? 0 : si->second.itr->documentFrequency();
+				order.push_back( PlanNodeOrder( subdf, nidx));
+			}
+			std::sort( order.begin(), order.end());
+			std::vector<PlanNodeOrder>::const_iterator oi = order.begin(), oe = order.end();
+			for (; oi != oe; ++oi)
+			{
+				out << indentstr << "  [" << oi->argidx << "]" << std::endl;
+				printPlanNode( out, expr.subnodes[ oi->argidx], nodeStorageDataMap, indent+1);
+			}
+			break;
+		}
+	}
+}
+
 Query::NodeAddress Query::duplicateNode( Query::NodeAddress adr)
 {
 	Query::NodeAddress rtadr = nodeAddress( NullNode, 0);
@@ -398,13 +599,64 @@ void Query::addAccess( const std::string& username_)
 	CATCH_ERROR_MAP( _TXT("error adding user to query: %s"), *m_errorhnd);
 }
 
-PostingIteratorInterface* Query::createExpressionPostingIterator( const Expression& expr, NodeStorageDataMap& nodeStorageDataMap) const
+/// \brief Data structures for the evaluation of the query on a range of document numbers
+struct Query::EvaluationContext
 {
-	enum {MaxNofJoinopArguments=256};
-	if (expr.subnodes.size() > MaxNofJoinopArguments)
+	struct WeightingElement
+	{
+		Reference<WeightingFunctionContextInterface> function;	///< weighting function context
+		std::vector<PostingIteratorInterface*> features;	///< features weighted by the function
+
+		explicit WeightingElement( WeightingFunctionContextInterface* function_)
+			:function(function_),features(){}
+		WeightingElement( const WeightingElement& o)
+			:function(o.function),features(o.features){}
+	};
+
+	NodeStorageDataMap nodeStorageDataMap;				///< map of query nodes to their posting iterators
+	std::vector<Reference<PostingIteratorInterface> > postings;	///< posting iterators of the query features
+	std::vector<WeightingElement> weightingElements;		///< weighting function contexts with their features
+	std::vector<Reference<SummarizerFunctionContextInterface> > summarizers; ///< summarizer function contexts (created on demand)
+	GlobalCounter generation;					///< generation of the storage content the structures were created for
+	DocsetPostingIterator evalset_itr;				///< document subset to evaluate the query on
+	Reference<Accumulator> accumulator;				///< accumulator for the weights of the documents
+	QueryBudgetState* budget;					///< budget state of the current evaluation, referenced by the posting iterators counting operations
+	std::map<NodeAddress,ProfilingPostingIterator*> profiledNodes;	///< posting iterators of the query nodes counting operations (profiling mode only)
+
+	EvaluationContext()
+		:generation(0),budget(0){}
+
+private:
+	EvaluationContext( const EvaluationContext&);	//... non copyable
+	void operator=( const EvaluationContext&);	//... non copyable
+};
+
+PostingIteratorInterface* Query::instrumentPostingIterator( PostingIteratorInterface* itr, const NodeAddress& nodeadr, EvaluationContext* ctx) const
+{
+	if (!ctx || !itr) return itr;
+	try
+	{
+		if (m_budget.maxNofPostingOperations())
+		{
+			itr = new BudgetPostingIterator( itr, &ctx->budget);
+		}
+		if (m_profilingMode)
+		{
+			ProfilingPostingIterator* pitr = new ProfilingPostingIterator( itr);
+			ctx->profiledNodes[ nodeadr] = pitr;
+			itr = pitr;
+		}
+		return itr;
+	}
+	catch (const std::bad_alloc&)
 	{
-		throw strus::runtime_error( "%s",  _TXT( "number of arguments of feature join expression in query out of range"));
+		delete itr;
+		throw std::bad_alloc();
 	}
+}
+
+PostingIteratorInterface* Query::createExpressionPostingIterator( const Expression& expr, NodeStorageDataMap& nodeStorageDataMap, EvaluationContext* ctx) const
+{
 	std::vector<Reference<PostingIteratorInterface> > joinargs;
 	std::vector<NodeAddress>::const_iterator
 		ni = expr.subnodes.begin(), ne = expr.subnodes.end();
@@ -417,7 +669,7 @@ PostingIteratorInterface* Query::createExpressionPostingIterator( const Expressi
 			case TermNode:
 			{
 				const Term& term = m_terms[ nodeIndex( *ni)];
-				joinargs.push_back( m_storage->createTermPostingIterator( term.type, term.value, term.length));
+				joinargs.push_back( instrumentPostingIterator( m_storage->createTermPostingIterator( term.type, term.value, term.length), *ni, ctx));
 				if (!joinargs.back().get()) throw strus::runtime_error( "%s", _TXT("error creating subexpression posting iterator"));
 
 				nodeStorageDataMap[ *ni] = NodeStorageData( joinargs.back().get(), getTermStatistics( term.type, term.value));
@@ -426,7 +678,7 @@ PostingIteratorInterface* Query::createExpressionPostingIterator( const Expressi
 			case DocFieldNode:
 			{
 				const DocField& docfield = m_docfields[ nodeIndex( *ni)];
-				joinargs.push_back( m_storage->createFieldPostingIterator( docfield.metadataRangeStart, docfield.metadataRangeEnd));
+				joinargs.push_back( instrumentPostingIterator( m_storage->createFieldPostingIterator( docfield.metadataRangeStart, docfield.metadataRangeEnd), *ni, ctx));
 				if (!joinargs.back().get()) throw strus::runtime_error( "%s", _TXT("error creating subexpression (doc field) posting iterator"));
 				TermStatistics termstats( m_globstats.nofDocumentsInserted());
 				// ... Doc Field features get the global statistics, because they are supposed to appear in every document
@@ -434,8 +686,8 @@ PostingIteratorInterface* Query::createExpressionPostingIterator( const Expressi
 				break;
 			}
 			case ExpressionNode:
-				joinargs.push_back( createExpressionPostingIterator(
-							m_expressions[ nodeIndex(*ni)], nodeStorageDataMap));
+				joinargs.push_back( instrumentPostingIterator( createExpressionPostingIterator(
+							m_expressions[ nodeIndex(*ni)], nodeStorageDataMap, ctx), *ni, ctx));
 				if (!joinargs.back().get()) throw strus::runtime_error( "%s", _TXT("error creating subexpression posting iterator"));
 
 				nodeStorageDataMap[ *ni] = NodeStorageData( joinargs.back().get());
@@ -446,7 +698,7 @@ PostingIteratorInterface* Query::createExpressionPostingIterator( const Expressi
 }
 
 
-PostingIteratorInterface* Query::createNodePostingIterator( const NodeAddress& nodeadr, NodeStorageDataMap& nodeStorageDataMap) const
+PostingIteratorInterface* Query::createNodePostingIterator( const NodeAddress& nodeadr, NodeStorageDataMap& nodeStorageDataMap, EvaluationContext* ctx) const
 {
 	PostingIteratorInterface* rt = 0;
 	switch (nodeType( nodeadr))
@@ -456,7 +708,7 @@ PostingIteratorInterface* Query::createNodePostingIterator( const NodeAddress& n
 		{
 			std::size_t nidx = nodeIndex( nodeadr);
 			const Term& term = m_terms[ nidx];
-			rt = m_storage->createTermPostingIterator( term.type, term.value, term.length);
+			rt = instrumentPostingIterator( m_storage->createTermPostingIterator( term.type, term.value, term.length), nodeadr, ctx);
 			if (!rt) break;
 			nodeStorageDataMap[ nodeadr] = NodeStorageData( rt, getTermStatistics( term.type, term.value));
 			break;
@@ -464,7 +716,7 @@ PostingIteratorInterface* Query::createNodePostingIterator( const NodeAddress& n
 		case DocFieldNode:
 		{
 			const DocField& docfield = m_docfields[ nodeIndex( nodeadr)];
-			rt = m_storage->createFieldPostingIterator( docfield.metadataRangeStart, docfield.metadataRangeEnd);
+			rt = instrumentPostingIterator( m_storage->createFieldPostingIterator( docfield.metadataRangeStart, docfield.metadataRangeEnd), nodeadr, ctx);
 			if (!rt) break;
 			TermStatistics termstats( m_globstats.nofDocumentsInserted());
 			// ... Doc Field features get the global statistics, because they are supposed to appear in every document
@@ -473,7 +725,7 @@ PostingIteratorInterface* Query::createNodePostingIterator( const NodeAddress& n
 		}
 		case ExpressionNode:
 			std::size_t nidx = nodeIndex( nodeadr);
-			rt = createExpressionPostingIterator( m_expressions[ nidx], nodeStorageDataMap);
+			rt = instrumentPostingIterator( createExpressionPostingIterator( m_expressions[ nidx], nodeStorageDataMap, ctx), nodeadr, ctx);
 			if (!rt) break;
 			nodeStorageDataMap[ nodeadr] = NodeStorageData( rt);
 			break;
@@ -533,12 +785,14 @@ void Query::defineTermStatistics(
 		const TermStatistics& stats_)
 {
 	m_termstatsmap[ TermKey( type_, value_)] = stats_;
+	m_preparedContext.reset();
 }
 
 void Query::defineGlobalStatistics(
 		const GlobalStatistics& stats_)
 {
 	m_globstats = stats_;
+	m_preparedContext.reset();
 }
 
 const TermStatistics& Query::getTermStatistics( const std::string& type_, const std::string& value_) const
@@ -583,243 +837,740 @@ void Query::setDebugMode( bool debug)
 	m_debugMode = debug;
 }
 
-QueryResult Query::evaluate() const
+void Query::setProfilingMode( bool profiling)
+{
+	if (m_profilingMode != profiling)
+	{
+		// ... prepared posting iterators have to be rebuilt with or without counting of operations
+		m_preparedContext.reset();
+	}
+	m_profilingMode = profiling;
+}
+
+void Query::setParallelEvaluation( unsigned int nofThreads_)
+{
+	m_nofThreads = nofThreads_;
+}
+
+void Query::setBudget( const QueryBudget& budget_)
+{
+	if ((m_budget.maxNofPostingOperations() != 0) != (budget_.maxNofPostingOperations() != 0))
+	{
+		// ... prepared posting iterators have to be rebuilt with or without counting of operations
+		m_preparedContext.reset();
+	}
+	m_budget = budget_;
+}
+
+void Query::prepare()
 {
-	const char* evaluationPhase = "query feature postings initialization";
 	try
 	{
+		m_prepared = true;
+		m_preparedContext.reset();
+		(void)preparedEvaluationContext();
+	}
+	CATCH_ERROR_MAP( _TXT("error preparing query: %s"), *m_errorhnd);
+}
+
+
+bool Query::initPostings( EvaluationContext& ctx) const
+{
+	// [3] Create the posting sets of the query features:
+	std::vector<Feature>::const_iterator
+		fi = m_features.begin(), fe = m_features.end();
+	for (; fi != fe; ++fi)
+	{
+		Reference<PostingIteratorInterface> postingsElem(
+			createNodePostingIterator( fi->node, ctx.nodeStorageDataMap, &ctx));
+		if (!postingsElem.get()) return false;
+		ctx.postings.push_back( postingsElem);
+	}
+	return true;
+}
+
+void Query::initWeightingFunctions(
+		EvaluationContext& ctx,
+		MetaDataReaderInterface* metaDataReader) const
+{
+	// [3.1] Create the weighting functions with their features:
+	{
+		std::vector<WeightingDef>::const_iterator
+			wi = m_queryEval->weightingFunctions().begin(),
+			we = m_queryEval->weightingFunctions().end();
+		for (; wi != we; ++wi)
+		{
+			WeightingFunctionContextInterface* execContext =
+				wi->function()->createFunctionContext(
+					m_storage, metaDataReader, m_globstats);
+			if (!execContext) throw strus::runtime_error( "%s", _TXT("error creating weighting function context"));
+			ctx.weightingElements.push_back( EvaluationContext::WeightingElement( execContext));
+			std::vector<PostingIteratorInterface*>& weightingFeatures = ctx.weightingElements.back().features;
+
+			std::vector<QueryEvalInterface::FeatureParameter>::const_iterator
+				si = wi->featureParameters().begin(),
+				se = wi->featureParameters().end();
+			for (; si != se; ++si)
+			{
+				std::vector<Feature>::const_iterator
+					fi = m_features.begin(), fe = m_features.end();
+				for (; fi != fe; ++fi)
+				{
+					if (si->featureSet() == fi->set)
+					{
+						const NodeStorageData& nd = nodeStorageData( fi->node, ctx.nodeStorageDataMap);
+						execContext->addWeightingFeature(
+							si->parameterName(), nd.itr, fi->weight, nd.stats);
+						weightingFeatures.push_back( nd.itr);
 #ifdef STRUS_LOWLEVEL_DEBUG
-		std::cout << "evaluate query:" << std::endl;
-		print( std::cout);
+						std::cout << "add feature parameter " << si->parameterName() << "=" << fi->set << ' ' << fi->weight << std::endl;
 #endif
-		// [1] Check initial conditions:
-		if (m_nofRanks == 0)
+					}
+				}
+			}
+#ifdef STRUS_LOWLEVEL_DEBUG
+			std::cout << "add feature " << wi->functionName() << std::endl;
+#endif
+		}
+	}
+}
+
+bool Query::initEvaluationStructures(
+		EvaluationContext& ctx,
+		MetaDataReaderInterface* metaDataReader) const
+{
+	if (!initPostings( ctx)) return false;
+	initWeightingFunctions( ctx, metaDataReader);
+	return true;
+}
+
+void Query::initAccumulator(
+		EvaluationContext& ctx,
+		MetaDataReaderInterface* metaDataReader,
+		const Index& firstDocno,
+		const Index& lastDocno) const
+{
+	// [4] Create the accumulator:
+	ctx.accumulator.reset( new Accumulator(
+		m_storage,
+		metaDataReader, m_metaDataRestriction.get(), m_weightingFormula.get(),
+		m_minRank + m_nofRanks, firstDocno, lastDocno));
+	Accumulator& accumulator = *ctx.accumulator;
+
+	accumulator.usePruning( m_queryEval->pruning());
+	accumulator.useMergedSelection( m_queryEval->mergedSelection());
+
+	// [4.1] Define document subset to evaluate query on:
+	if (m_evalset_defined)
+	{
+		ctx.evalset_itr = DocsetPostingIterator( m_evalset_docnolist);
+		accumulator.defineEvaluationSet( &ctx.evalset_itr);
+	}
+	// [4.2] Add document selection postings:
+	{
+		std::vector<std::string>::const_iterator
+			si = m_queryEval->selectionSets().begin(),
+			se = m_queryEval->selectionSets().end();
+
+		for (int sidx=0; si != se; ++si,++sidx)
 		{
-			return QueryResult();
+			std::vector<Feature>::const_iterator
+				fi = m_features.begin(), fe = m_features.end();
+			for (; fi != fe; ++fi)
+			{
+				if (*si == fi->set)
+				{
+					accumulator.addSelector(
+						nodeStorageData( fi->node, ctx.nodeStorageDataMap).itr, sidx);
+				}
+			}
 		}
-		if (m_queryEval->weightingFunctions().empty())
+	}
+	// [4.3] Add the weighting functions:
+	std::vector<EvaluationContext::WeightingElement>::const_iterator
+		ei = ctx.weightingElements.begin(), ee = ctx.weightingElements.end();
+	for (; ei != ee; ++ei)
+	{
+		accumulator.addWeightingElement( ei->function, ei->features);
+	}
+	// [4.3.1] Define feature weighting variable values:
+	std::vector<WeightingVariableValueAssignment>::const_iterator
+		vi = m_weightingvars.begin(), ve = m_weightingvars.end();
+	for (; vi != ve; ++vi)
+	{
+		accumulator.defineWeightingVariableValue( vi->index, vi->varname, vi->value);
+	}
+
+	// [4.4] Define the user ACL restrictions:
+	std::vector<std::string>::const_iterator ui = m_usernames.begin(), ue = m_usernames.end();
+	for (; ui != ue; ++ui)
+	{
+		Reference<InvAclIteratorInterface> invAcl( m_storage->createInvAclIterator( *ui));
+		if (invAcl.get())
 		{
-			m_errorhnd->report( _TXT( "cannot evaluate query, no weighting function defined"));
-			return QueryResult();
+			accumulator.addAlternativeAclRestriction( invAcl);
 		}
-		if (m_queryEval->selectionSets().empty())
+		else if (m_errorhnd->hasError())
 		{
-			m_errorhnd->report( _TXT( "cannot evaluate query, no selection features defined"));
-			return QueryResult();
+			throw strus::runtime_error( "%s", _TXT( "storage built without ACL resrictions, cannot handle username passed with query"));
 		}
-		NodeStorageDataMap nodeStorageDataMap;
-
-		// [3] Create the posting sets of the query features:
-		std::vector<Reference<PostingIteratorInterface> > postings;
+	}
+	// [4.5] Define the feature restrictions:
+	{
+		std::vector<std::string>::const_iterator
+			xi = m_queryEval->restrictionSets().begin(),
+			xe = m_queryEval->restrictionSets().end();
+		for (; xi != xe; ++xi)
 		{
 			std::vector<Feature>::const_iterator
 				fi = m_features.begin(), fe = m_features.end();
 			for (; fi != fe; ++fi)
 			{
-				Reference<PostingIteratorInterface> postingsElem(
-					createNodePostingIterator( fi->node, nodeStorageDataMap));
-				if (!postingsElem.get()) return QueryResult();
-				postings.push_back( postingsElem);
+				if (*xi == fi->set)
+				{
+					accumulator.addFeatureRestriction(
+						nodeStorageData( fi->node, ctx.nodeStorageDataMap).itr, false);
+				}
 			}
 		}
-		// [4] Create the accumulator:
-		DocsetPostingIterator evalset_itr;
-		Accumulator accumulator(
-			m_storage,
-			m_metaDataReader.get(), m_metaDataRestriction.get(), m_weightingFormula.get(),
-			m_minRank + m_nofRanks, m_storage->maxDocumentNumber());
-
-		// [4.1] Define document subset to evaluate query on:
-		if (m_evalset_defined)
+	}
+	// [4.6] Define the feature exclusions:
+	{
+		std::vector<std::string>::const_iterator
+			xi = m_queryEval->exclusionSets().begin(),
+			xe = m_queryEval->exclusionSets().end();
+		for (; xi != xe; ++xi)
 		{
-			evalset_itr = DocsetPostingIterator( m_evalset_docnolist);
-			accumulator.defineEvaluationSet( &evalset_itr);
+			std::vector<Feature>::const_iterator
+				fi = m_features.begin(), fe = m_features.end();
+			for (; fi != fe; ++fi)
+			{
+				if (*xi == fi->set)
+				{
+					accumulator.addFeatureRestriction(
+						nodeStorageData( fi->node, ctx.nodeStorageDataMap).itr, true);
+				}
+			}
 		}
-		// [4.2] Add document selection postings:
+	}
+}
+
+bool Query::initEvaluationContext(
+		EvaluationContext& ctx,
+		MetaDataReaderInterface* metaDataReader,
+		const Index& firstDocno,
+		const Index& lastDocno) const
+{
+	if (!initEvaluationStructures( ctx, metaDataReader)) return false;
+	initAccumulator( ctx, metaDataReader, firstDocno, lastDocno);
+	return true;
+}
+
+Query::EvaluationContext* Query::preparedEvaluationContext() const
+{
+	GlobalCounter generation = m_storage->generation();
+	if (!m_preparedContext.get() || m_preparedContext->generation != generation)
+	{
+		// ... the structures are (re)built if not yet prepared or if the storage has changed
+		m_preparedContext.reset();
+		Reference<EvaluationContext> ctx( new EvaluationContext());
+		ctx->generation = generation;
+		if (!initEvaluationStructures( *ctx, m_metaDataReader.get())) return 0;
+		m_preparedContext = ctx;
+	}
+	return m_preparedContext.get();
+}
+
+void Query::initSummarizers( EvaluationContext& ctx) const
+{
+	std::vector<SummarizerDef>::const_iterator
+		zi = m_queryEval->summarizers().begin(),
+		ze = m_queryEval->summarizers().end();
+	for (; zi != ze; ++zi)
+	{
+		// [6.1.1] Create the summarizer:
+		ctx.summarizers.push_back(
+			zi->function()->createFunctionContext(
+				m_storage, m_metaDataReader.get(), m_globstats));
+		SummarizerFunctionContextInterface* closure = ctx.summarizers.back().get();
+		if (!closure) throw strus::runtime_error( "%s", _TXT("error creating summarizer context"));
+
+		// [6.1.2] Add features with their variables assigned to summarizer:
+		std::vector<QueryEvalInterface::FeatureParameter>::const_iterator
+			si = zi->featureParameters().begin(),
+			se = zi->featureParameters().end();
+		for (; si != se; ++si)
 		{
-			std::vector<std::string>::const_iterator
-				si = m_queryEval->selectionSets().begin(),
-				se = m_queryEval->selectionSets().end();
-	
-			for (int sidx=0; si != se; ++si,++sidx)
+			std::vector<Feature>::const_iterator
+				fi = m_features.begin(), fe = m_features.end();
+			for (; fi != fe; ++fi)
 			{
-				std::vector<Feature>::const_iterator
-					fi = m_features.begin(), fe = m_features.end();
-				for (; fi != fe; ++fi)
+				if (fi->set == si->featureSet())
 				{
-					if (*si == fi->set)
-					{
-						accumulator.addSelector(
-							nodeStorageData( fi->node, nodeStorageDataMap).itr, sidx);
-					}
+					std::vector<SummarizationVariable> variables;
+					collectSummarizationVariables( variables, fi->node, ctx.nodeStorageDataMap);
+
+					const NodeStorageData& nd = nodeStorageData( fi->node, ctx.nodeStorageDataMap);
+					closure->addSummarizationFeature(
+						si->parameterName(), nd.itr,
+						variables, fi->weight, nd.stats);
 				}
 			}
 		}
-		evaluationPhase = "weighting functions initialization";
-		// [4.3.1] Add features for weighting:
+	}
+}
+
+void Query::evaluatePartition( RankingPartition& partition, unsigned int nofPartitions, const utils::StopWatch& evaluationClock) const
+{
+	try
+	{
+		Reference<MetaDataReaderInterface> metaDataReader( m_storage->createMetaDataReader());
+		if (!metaDataReader.get()) throw strus::runtime_error( "%s", _TXT("error creating meta data reader"));
+
+		// Every partition gets its share of the budget, the deadline is the one of the whole evaluation:
+		QueryBudgetState budgetState( m_budget, nofPartitions, evaluationClock.elapsedMicroseconds());
+		EvaluationContext ctx;
+		if (m_budget.defined()) ctx.budget = &budgetState;
+		if (!initEvaluationContext( ctx, metaDataReader.get(), partition.firstDocno, partition.lastDocno))
+		{
+			return;
+		}
+		Accumulator& accumulator = *ctx.accumulator;
+		accumulator.defineBudget( ctx.budget);
+
+		rankPartition( partition, accumulator);
+		partition.truncated = budgetState.hasExceeded();
+		if (m_profilingMode)
+		{
+			collectPostingProfiles( partition.postingProfiles, ctx);
+		}
+	}
+	CATCH_ERROR_MAP( _TXT("error evaluating query on document range: %s"), *m_errorhnd);
+}
+
+void Query::rankPartition( RankingPartition& partition, Accumulator& accumulator) const
+{
+	std::size_t nofStates = m_queryEval->selectionSets().size();
+	std::size_t maxNofRanks = m_nofRanks + m_minRank;
+	for (std::size_t sidx=0; sidx<nofStates; ++sidx)
+	{
+		partition.rankers.push_back( Reference<Ranker>( new Ranker( maxNofRanks)));
+	}
+	partition.nofDocumentsRanked.resize( nofStates, 0);
+	partition.nofDocumentsVisited.resize( nofStates, 0);
+
+	// Ranklists for the pruning thresholds, the one of a selector state contains the documents of this state and the states before.
+	//	The selector states come one after the other without merged selection, the last ranklist can be used for all of them.
+	//	With merged selection a document of a state must not be pruned with the weights of documents of a following state,
+	//	because the documents of the following state are dropped if the ranklist gets complete without them:
+	bool mergedSelection = m_queryEval->mergedSelection();
+	std::vector<Reference<Ranker> > pruningRankers;
+	std::size_t nofPruningRankers = mergedSelection ? nofStates : 1;
+	for (std::size_t sidx=0; sidx<nofPruningRankers; ++sidx)
+	{
+		pruningRankers.push_back( Reference<Ranker>( new Ranker( maxNofRanks)));
+	}
+	Index docno = 0;
+	unsigned int state = 0;
+	double weight = 0.0;
+
+	while (accumulator.nextRank( docno, state, weight))
+	{
+		partition.rankers[ state]->insert( WeightedDocument( docno, weight));
+		if (mergedSelection)
 		{
-			std::vector<WeightingDef>::const_iterator
-				wi = m_queryEval->weightingFunctions().begin(),
-				we = m_queryEval->weightingFunctions().end();
-			for (; wi != we; ++wi)
+			for (unsigned int sidx=state; sidx<nofPruningRankers; ++sidx)
 			{
-				strus::local_ptr<WeightingFunctionContextInterface> execContext(
-					wi->function()->createFunctionContext(
-						m_storage, m_metaDataReader.get(), m_globstats));
-				if (!execContext.get()) throw strus::runtime_error( "%s", _TXT("error creating weighting function context"));
-	
-				std::vector<QueryEvalInterface::FeatureParameter>::const_iterator
-					si = wi->featureParameters().begin(),
-					se = wi->featureParameters().end();
-				for (; si != se; ++si)
+				Ranker& pruningRanker = *pruningRankers[ sidx];
+				pruningRanker.insert( WeightedDocument( docno, weight));
+				if (pruningRanker.complete())
 				{
-					std::vector<Feature>::const_iterator
-						fi = m_features.begin(), fe = m_features.end();
-					for (; fi != fe; ++fi)
-					{
-						if (si->featureSet() == fi->set)
-						{
-							const NodeStorageData& nd = nodeStorageData( fi->node, nodeStorageDataMap);
-							execContext->addWeightingFeature(
-								si->parameterName(), nd.itr, fi->weight, nd.stats);
-#ifdef STRUS_LOWLEVEL_DEBUG
-							std::cout << "add feature parameter " << si->parameterName() << "=" << fi->set << ' ' << fi->weight << std::endl;
-#endif
-						}
-					}
+					accumulator.defineMinRankWeight( pruningRanker.minWeight(), sidx);
 				}
-#ifdef STRUS_LOWLEVEL_DEBUG
-				std::cout << "add feature " << wi->functionName() << std::endl;
-#endif
-				accumulator.addWeightingElement( execContext.release());
 			}
 		}
-		// [4.3.1] Define feature weighting variable values:
-		std::vector<WeightingVariableValueAssignment>::const_iterator
-			vi = m_weightingvars.begin(), ve = m_weightingvars.end();
-		for (; vi != ve; ++vi)
+		else
 		{
-			accumulator.defineWeightingVariableValue( vi->index, vi->varname, vi->value);
+			Ranker& pruningRanker = *pruningRankers[ 0];
+			pruningRanker.insert( WeightedDocument( docno, weight));
+			if (pruningRanker.complete())
+			{
+				accumulator.defineMinRankWeight( pruningRanker.minWeight());
+			}
 		}
+	}
+	// The accumulator counts the documents of every selector state, the sum of the counters over all partitions
+	// is the number of documents a single pass stopping after the selector state would have counted:
+	for (unsigned int sidx=0; sidx < nofStates; ++sidx)
+	{
+		partition.nofDocumentsRanked[ sidx] = accumulator.nofDocumentsRanked( sidx);
+		partition.nofDocumentsVisited[ sidx] = accumulator.nofDocumentsVisited( sidx);
+	}
+}
 
-		evaluationPhase = "restrictions initialization";
-		// [4.4] Define the user ACL restrictions:
-		std::vector<std::string>::const_iterator ui = m_usernames.begin(), ue = m_usernames.end();
-		for (; ui != ue; ++ui)
+namespace {
+/// \brief Thread procedure evaluating query ranking partitions until there are no more left
+class RankingPartitionWorker
+{
+public:
+	RankingPartitionWorker(
+			const Query* query_,
+			std::vector<Query::RankingPartition>* partitions_,
+			utils::AtomicCounter<unsigned int>* nextPartition_,
+			const utils::StopWatch* evaluationClock_,
+			ErrorBufferInterface* errorhnd_)
+		:m_query(query_),m_partitions(partitions_),m_nextPartition(nextPartition_),m_evaluationClock(evaluationClock_),m_errorhnd(errorhnd_){}
+	RankingPartitionWorker( const RankingPartitionWorker& o)
+		:m_query(o.m_query),m_partitions(o.m_partitions),m_nextPartition(o.m_nextPartition),m_evaluationClock(o.m_evaluationClock),m_errorhnd(o.m_errorhnd){}
+
+	void operator()()
+	{
+		m_errorhnd->allocContext();
+		unsigned int pidx;
+		while ((pidx = m_nextPartition->allocIncrement()) < m_partitions->size())
 		{
-			Reference<InvAclIteratorInterface> invAcl( m_storage->createInvAclIterator( *ui));
-			if (invAcl.get())
+			Query::RankingPartition& partition = (*m_partitions)[ pidx];
+			m_query->evaluatePartition( partition, m_partitions->size(), *m_evaluationClock);
+			if (m_errorhnd->hasError())
 			{
-				accumulator.addAlternativeAclRestriction( invAcl);
+				// ... pass the error to the thread merging the results
+				partition.error = m_errorhnd->fetchError();
 			}
-			else if (m_errorhnd->hasError())
+		}
+		m_errorhnd->releaseContext();
+	}
+
+private:
+	const Query* m_query;
+	std::vector<Query::RankingPartition>* m_partitions;
+	utils::AtomicCounter<unsigned int>* m_nextPartition;
+	const utils::StopWatch* m_evaluationClock;
+	ErrorBufferInterface* m_errorhnd;
+};
+}//anonymous namespace
+
+// Number of partitions per thread for balancing the load of the threads:
+#define NOF_RANKING_PARTITIONS_PER_THREAD 4
+// Minimum number of documents of a partition evaluated by one thread:
+#define MIN_RANKING_PARTITION_SIZE 4096
+
+void Query::rankDocumentsParallel(
+		std::vector<WeightedDocument>& resultlist,
+		unsigned int& state,
+		unsigned int& nofDocumentsRanked,
+		unsigned int& nofDocumentsVisited,
+		bool& truncated,
+		PostingProfileMap& postingProfiles,
+		const Index& maxDocumentNumber,
+		const utils::StopWatch& evaluationClock) const
+{
+	// [5.1] Split the document number range into partitions and rank them in parallel:
+	std::size_t nofPartitions = m_nofThreads * NOF_RANKING_PARTITIONS_PER_THREAD;
+	if (nofPartitions > (std::size_t)maxDocumentNumber / MIN_RANKING_PARTITION_SIZE)
+	{
+		nofPartitions = (std::size_t)maxDocumentNumber / MIN_RANKING_PARTITION_SIZE;
+	}
+	if (nofPartitions == 0) nofPartitions = 1;
+
+	std::vector<RankingPartition> partitions;
+	Index partitionSize = maxDocumentNumber / nofPartitions;
+	Index partitionRest = maxDocumentNumber % nofPartitions;
+	Index firstDocno = 1;
+	for (std::size_t pidx=0; pidx<nofPartitions; ++pidx)
+	{
+		Index lastDocno = firstDocno + partitionSize - 1 + (((Index)pidx < partitionRest)?1:0);
+		partitions.push_back( RankingPartition( firstDocno, lastDocno));
+		firstDocno = lastDocno + 1;
+	}
+	utils::AtomicCounter<unsigned int> nextPartition( 0);
+	{
+		unsigned int nofThreads = (m_nofThreads < nofPartitions) ? m_nofThreads : nofPartitions;
+		utils::ThreadGroup threads;
+		for (unsigned int tidx=0; tidx<nofThreads; ++tidx)
+		{
+			threads.create_thread( RankingPartitionWorker( this, &partitions, &nextPartition, &evaluationClock, m_errorhnd));
+		}
+		threads.join_all();
+	}
+	std::vector<RankingPartition>::const_iterator pi = partitions.begin(), pe = partitions.end();
+	for (; pi != pe; ++pi)
+	{
+		if (!pi->error.empty())
+		{
+			throw strus::runtime_error( _TXT("error ranking documents %d to %d: %s"), (int)pi->firstDocno, (int)pi->lastDocno, pi->error.c_str());
+		}
+		if (pi->truncated) truncated = true;
+		PostingProfileMap::const_iterator xi = pi->postingProfiles.begin(), xe = pi->postingProfiles.end();
+		for (; xi != xe; ++xi)
+		{
+			postingProfiles[ xi->first] += xi->second;
+		}
+	}
+	mergeRankingPartitions( partitions, resultlist, state, nofDocumentsRanked, nofDocumentsVisited);
+}
+
+void Query::mergeRankingPartitions(
+		const std::vector<RankingPartition>& partitions,
+		std::vector<WeightedDocument>& resultlist,
+		unsigned int& state,
+		unsigned int& nofDocumentsRanked,
+		unsigned int& nofDocumentsVisited) const
+{
+	std::vector<RankingPartition>::const_iterator pi = partitions.begin(), pe = partitions.end();
+	// [5.2] Determine the selector state where a sequential evaluation would have stopped,
+	//	that is before the first document of a follow state when the ranklist is complete:
+	std::size_t nofStates = m_queryEval->selectionSets().size();
+	std::size_t maxNofRanks = m_nofRanks + m_minRank;
+	std::size_t nofRanks = 0;
+	state = 0;
+	for (unsigned int sidx=0; sidx<nofStates; ++sidx)
+	{
+		std::size_t nofStateRanks = 0;
+		for (pi = partitions.begin(); pi != pe; ++pi)
+		{
+			nofStateRanks += pi->rankers[ sidx]->nofRanks();
+		}
+		if (!nofStateRanks) continue;
+		if (nofRanks >= maxNofRanks) break;
+		nofRanks += nofStateRanks;
+		state = sidx;
+	}
+	// [5.3] Merge the ranklists and the counters of the partitions:
+	Ranker ranker( maxNofRanks);
+	nofDocumentsRanked = 0;
+	nofDocumentsVisited = 0;
+	for (pi = partitions.begin(); pi != pe; ++pi)
+	{
+		for (unsigned int sidx=0; sidx<=state; ++sidx)
+		{
+			std::vector<WeightedDocument> ranks = pi->rankers[ sidx]->result( 0);
+			std::vector<WeightedDocument>::const_iterator ri = ranks.begin(), re = ranks.end();
+			for (; ri != re; ++ri)
 			{
-				throw strus::runtime_error( "%s", _TXT( "storage built without ACL resrictions, cannot handle username passed with query"));
+				ranker.insert( *ri);
 			}
 		}
-		// [4.5] Define the feature restrictions:
+		nofDocumentsRanked += pi->nofDocumentsRanked[ state];
+		nofDocumentsVisited += pi->nofDocumentsVisited[ state];
+	}
+	resultlist = ranker.result( m_minRank);
+}
+
+void Query::collectPostingProfiles( PostingProfileMap& postingProfiles, const EvaluationContext& ctx) const
+{
+	std::map<NodeAddress,ProfilingPostingIterator*>::const_iterator
+		ni = ctx.profiledNodes.begin(), ne = ctx.profiledNodes.end();
+	for (; ni != ne; ++ni)
+	{
+		postingProfiles[ ni->first] += ni->second->counters();
+	}
+}
+
+void Query::buildPostingProfile(
+		QueryProfile& profile,
+		const std::string& feature,
+		const NodeAddress& nodeadr,
+		unsigned int level,
+		const PostingProfileMap& postingProfiles) const
+{
+	std::ostringstream description;
+	switch (nodeType( nodeadr))
+	{
+		case NullNode:
+			return;
+		case TermNode:
+		{
+			const Term& term = m_terms[ nodeIndex( nodeadr)];
+			description << "term " << term.type << " '" << term.value << "'";
+			break;
+		}
+		case DocFieldNode:
+		{
+			const DocField& docfield = m_docfields[ nodeIndex( nodeadr)];
+			description << "docfield " << docfield.metadataRangeStart << " : " << docfield.metadataRangeEnd;
+			break;
+		}
+		case ExpressionNode:
+		{
+			const Expression& expr = m_expressions[ nodeIndex( nodeadr)];
+			description << expr.operation->getDescription().name() << " range=" << expr.range << " cardinality=" << expr.cardinality;
+			break;
+		}
+	}
+	ProfilingPostingIterator::Counters counters;
+	PostingProfileMap::const_iterator pi = postingProfiles.find( nodeadr);
+	if (pi != postingProfiles.end())
+	{
+		counters = pi->second;
+	}
+	profile.addPostingNode( QueryProfile::PostingNode(
+		feature, description.str(), level,
+		counters.nofSkipDoc, counters.nofSkipDocCandidate, counters.nofSkipPos, counters.nofBlocksLoaded));
+
+	if (nodeType( nodeadr) == ExpressionNode)
+	{
+		const Expression& expr = m_expressions[ nodeIndex( nodeadr)];
+		std::vector<NodeAddress>::const_iterator ni = expr.subnodes.begin(), ne = expr.subnodes.end();
+		for (; ni != ne; ++ni)
+		{
+			buildPostingProfile( profile, std::string(), *ni, level+1, postingProfiles);
+		}
+	}
+}
+
+QueryResult Query::evaluate() const
+{
+	const char* evaluationPhase = "query evaluation initialization";
+	try
+	{
+#ifdef STRUS_LOWLEVEL_DEBUG
+		std::cout << "evaluate query:" << std::endl;
+		print( std::cout);
+#endif
+		utils::StopWatch evaluationClock;
+		QueryBudgetState budgetState( m_budget);
+		QueryBudgetState* budget = m_budget.defined() ? &budgetState : 0;
+		QueryPhaseProfiler profiler( m_profilingMode);
+		profiler.startPhase( evaluationPhase);
+
+		// [1] Check initial conditions:
+		if (m_nofRanks == 0)
 		{
-			std::vector<std::string>::const_iterator
-				xi = m_queryEval->restrictionSets().begin(),
-				xe = m_queryEval->restrictionSets().end();
-			for (; xi != xe; ++xi)
+			return QueryResult();
+		}
+		if (m_queryEval->weightingFunctions().empty())
+		{
+			m_errorhnd->report( _TXT( "cannot evaluate query, no weighting function defined"));
+			return QueryResult();
+		}
+		if (m_queryEval->selectionSets().empty())
+		{
+			m_errorhnd->report( _TXT( "cannot evaluate query, no selection features defined"));
+			return QueryResult();
+		}
+		// [1.1] Lookup the result in the cache (not in profiling mode, where we want to see the evaluation):
+		QueryResultCache* resultCache = m_profilingMode ? 0 : m_queryEval->resultCache();
+		std::string cacheKey;
+		if (resultCache)
+		{
+			evaluationPhase = "result cache lookup";
+			cacheKey = resultCacheKey();
+			QueryResult cachedResult;
+			if (resultCache->get( cachedResult, cacheKey))
 			{
-				std::vector<Feature>::const_iterator
-					fi = m_features.begin(), fe = m_features.end();
-				for (; fi != fe; ++fi)
-				{
-					if (*xi == fi->set)
-					{
-						accumulator.addFeatureRestriction(
-							nodeStorageData( fi->node, nodeStorageDataMap).itr, false);
-					}
-				}
+				return cachedResult;
 			}
+			evaluationPhase = "query evaluation initialization";
+		}
+		// [2] Create the posting sets, the accumulator and the weighting functions for the whole document number range:
+		EvaluationContext localContext;
+		EvaluationContext* ctxref = &localContext;
+		if (m_prepared)
+		{
+			// ... take the posting sets and the weighting functions of the prepared query
+			evaluationPhase = "prepared query initialization";
+			profiler.startPhase( evaluationPhase);
+			ctxref = preparedEvaluationContext();
+			if (!ctxref) return QueryResult();
+		}
+		else
+		{
+			evaluationPhase = "posting creation";
+			profiler.startPhase( evaluationPhase);
+			if (!initPostings( localContext)) return QueryResult();
+
+			evaluationPhase = "weighting initialization";
+			profiler.startPhase( evaluationPhase);
+			initWeightingFunctions( localContext, m_metaDataReader.get());
 		}
-		// [4.6] Define the feature exclusions:
+		EvaluationContext& ctx = *ctxref;
+		ctx.budget = budget;
+		if (m_profilingMode)
 		{
-			std::vector<std::string>::const_iterator
-				xi = m_queryEval->exclusionSets().begin(),
-				xe = m_queryEval->exclusionSets().end();
-			for (; xi != xe; ++xi)
+			// ... the posting iterators of a prepared query have counted the operations of previous evaluations
+			std::map<NodeAddress,ProfilingPostingIterator*>::const_iterator
+				ni = ctx.profiledNodes.begin(), ne = ctx.profiledNodes.end();
+			for (; ni != ne; ++ni)
 			{
-				std::vector<Feature>::const_iterator
-					fi = m_features.begin(), fe = m_features.end();
-				for (; fi != fe; ++fi)
-				{
-					if (*xi == fi->set)
-					{
-						accumulator.addFeatureRestriction(
-							nodeStorageData( fi->node, nodeStorageDataMap).itr, true);
-					}
-				}
+				ni->second->resetCounters();
 			}
 		}
+		evaluationPhase = "accumulator initialization";
+		profiler.startPhase( evaluationPhase);
+		Index maxDocumentNumber = m_storage->maxDocumentNumber();
+		initAccumulator( ctx, m_metaDataReader.get(), 1, maxDocumentNumber);
+		Accumulator& accumulator = *ctx.accumulator;
+		accumulator.defineBudget( budget);
+
 		evaluationPhase = "document ranking";
-		// [5] Do the ranking:
+		profiler.startPhase( evaluationPhase);
 		std::vector<ResultDocument> ranks;
-		Ranker ranker( m_nofRanks + m_minRank);
-		Index docno = 0;
+		std::vector<WeightedDocument> resultlist;
 		unsigned int state = 0;
-		unsigned int prev_state = 0;
-		double weight = 0.0;
-	
-		while (accumulator.nextRank( docno, state, weight))
+		unsigned int nofDocumentsRanked = 0;
+		unsigned int nofDocumentsVisited = 0;
+		bool truncated = false;
+		PostingProfileMap postingProfiles;
+
+		if (m_nofThreads > 1 && (std::size_t)maxDocumentNumber >= 2 * MIN_RANKING_PARTITION_SIZE)
 		{
-			ranker.insert( WeightedDocument( docno, weight));
-			if (state > prev_state && ranker.nofRanks() >= m_nofRanks + m_minRank)
+			// [5] Do the ranking in parallel on partitions of the document number range:
+			rankDocumentsParallel( resultlist, state, nofDocumentsRanked, nofDocumentsVisited, truncated, postingProfiles, maxDocumentNumber, evaluationClock);
+		}
+		else if (m_queryEval->mergedSelection())
+		{
+			// [5] Do the ranking of the documents of all selector states in one pass:
+			std::vector<RankingPartition> partitions;
+			partitions.push_back( RankingPartition( 1, maxDocumentNumber));
+			rankPartition( partitions.back(), accumulator);
+			mergeRankingPartitions( partitions, resultlist, state, nofDocumentsRanked, nofDocumentsVisited);
+			truncated = budgetState.hasExceeded();
+		}
+		else
+		{
+			// [5] Do the ranking:
+			Ranker ranker( m_nofRanks + m_minRank);
+			Index docno = 0;
+			unsigned int prev_state = 0;
+			double weight = 0.0;
+		
+			while (accumulator.nextRank( docno, state, weight))
 			{
-				state = prev_state;
-				break;
+				if (state > prev_state && ranker.complete())
+				{
+					// ... the ranklist is complete with the documents of the previous selector states,
+					//	the first document of the next selector state does not get into it:
+					state = prev_state;
+					break;
+				}
+				ranker.insert( WeightedDocument( docno, weight));
+				if (ranker.complete())
+				{
+					accumulator.defineMinRankWeight( ranker.minWeight());
+				}
+				prev_state = state;
 			}
-			prev_state = state;
-		}
-		std::vector<WeightedDocument>
 			resultlist = ranker.result( m_minRank);
+			nofDocumentsRanked = accumulator.nofDocumentsRanked( state);
+			nofDocumentsVisited = accumulator.nofDocumentsVisited( state);
+			truncated = budgetState.hasExceeded();
+		}
 	
 		// [6] Summarization:
 		evaluationPhase = "summarization";
-		std::vector<Reference<SummarizerFunctionContextInterface> > summarizers;
+		profiler.startPhase( evaluationPhase);
+		std::vector<Reference<SummarizerFunctionContextInterface> >& summarizers = ctx.summarizers;
 		if (!resultlist.empty())
 		{
-			// [6.1] Create the summarizers:
-			std::vector<SummarizerDef>::const_iterator
-				zi = m_queryEval->summarizers().begin(),
-				ze = m_queryEval->summarizers().end();
-			for (; zi != ze; ++zi)
+			// [6.1] Create the summarizers (only once for a prepared query):
+			if (summarizers.size() != m_queryEval->summarizers().size())
 			{
-				// [5.1] Create the summarizer:
-				summarizers.push_back(
-					zi->function()->createFunctionContext(
-						m_storage, m_metaDataReader.get(), m_globstats));
-				SummarizerFunctionContextInterface* closure = summarizers.back().get();
-				if (!closure) throw strus::runtime_error( "%s", _TXT("error creating summarizer context"));
-
-				// [5.2] Add features with their variables assigned to summarizer:
-				std::vector<QueryEvalInterface::FeatureParameter>::const_iterator
-					si = zi->featureParameters().begin(),
-					se = zi->featureParameters().end();
-				for (; si != se; ++si)
-				{
-					std::vector<Feature>::const_iterator
-						fi = m_features.begin(), fe = m_features.end();
-					for (; fi != fe; ++fi)
-					{
-						if (fi->set == si->featureSet())
-						{
-							std::vector<SummarizationVariable> variables;
-							collectSummarizationVariables( variables, fi->node, nodeStorageDataMap);
-
-							const NodeStorageData& nd = nodeStorageData( fi->node, nodeStorageDataMap);
-							closure->addSummarizationFeature(
-								si->parameterName(), nd.itr,
-								variables, fi->weight, nd.stats);
-						}
-					}
-				}
+				summarizers.clear();
+				initSummarizers( ctx);
 			}
 			// [6.2] Define feature summarizer weighting variable values:
-			vi = m_summaryweightvars.begin(), ve = m_summaryweightvars.end();
+			std::vector<WeightingVariableValueAssignment>::const_iterator
+				vi = m_summaryweightvars.begin(), ve = m_summaryweightvars.end();
 			for (; vi != ve; ++vi)
 			{
 				summarizers[ vi->index]->setVariableValue( vi->varname, vi->value);
@@ -827,6 +1578,7 @@ QueryResult Query::evaluate() const
 		}
 
 		evaluationPhase = "building of the result";
+		profiler.startPhase( evaluationPhase);
 		// [7] Build the result:
 		std::vector<WeightedDocument>::const_iterator ri=resultlist.begin(),re=resultlist.end();
 		for (; ri != re; ++ri)
@@ -835,7 +1587,13 @@ QueryResult Query::evaluate() const
 			std::cout << "result rank docno=" << ri->docno() << ", weight=" << ri->weight() << std::endl;
 #endif
 			std::vector<SummaryElement> summaries;
-
+			if (budget && budgetState.deadlineExceeded())
+			{
+				// ... the documents not summarized anymore before the deadline are returned without summary
+				truncated = true;
+				ranks.push_back( ResultDocument( *ri, summaries));
+				continue;
+			}
 			std::vector<Reference<SummarizerFunctionContextInterface> >::iterator
 				si = summarizers.begin(), se = summarizers.end();
 			for (;si != se; ++si)
@@ -877,7 +1635,25 @@ QueryResult Query::evaluate() const
 		{
 			throw strus::runtime_error( _TXT("error evaluating query: %s"), m_errorhnd->fetchError());
 		}
-		return QueryResult( state, accumulator.nofDocumentsRanked(), accumulator.nofDocumentsVisited(), ranks);
+		ctx.budget = 0;
+		profiler.finish();
+		if (m_profilingMode)
+		{
+			// [8] Collect the operations on the posting iterators of all query feature nodes:
+			collectPostingProfiles( postingProfiles, ctx);
+			std::vector<Feature>::const_iterator fi = m_features.begin(), fe = m_features.end();
+			for (; fi != fe; ++fi)
+			{
+				buildPostingProfile( profiler.profile(), fi->set, fi->node, 0, postingProfiles);
+			}
+		}
+		QueryResult result( state, nofDocumentsRanked, nofDocumentsVisited, ranks, truncated, profiler.profile());
+		if (resultCache && !truncated)
+		{
+			// ... results truncated by the budget are not cached, because they depend on the load of the system
+			resultCache->put( cacheKey, result);
+		}
+		return result;
 	}
 	CATCH_ERROR_ARG1_MAP_RETURN( _TXT("error during %s when evaluating query: %s"), evaluationPhase, *m_errorhnd, QueryResult());
 }
@@ -13,6 +13,9 @@
 #include "private/internationalization.hpp"
 #include "strus/metaDataRestrictionInterface.hpp"
 #include "strus/scalarFunctionInstanceInterface.hpp"
+#include "strus/weightedDocument.hpp"
+#include "private/utils.hpp"
+#include "profilingPostingIterator.hpp"
 #include <vector>
 #include <string>
 #include <map>
@@ -32,6 +35,16 @@ class QueryEval;
 class PostingIteratorInterface;
 /// \brief Forward declaration
 class ErrorBufferInterface;
+/// \brief Forward declaration
+class MetaDataReaderInterface;
+/// \brief Forward declaration
+class Ranker;
+/// \brief Forward declaration
+class QueryBudgetState;
+/// \brief Forward declaration
+class QueryPhaseProfiler;
+/// \brief Forward declaration
+class Accumulator;
 
 /// \brief Implementation of the query interface
 class Query
@@ -89,6 +102,14 @@ public:
 
 	virtual void setDebugMode( bool debug);
 
+	virtual void setProfilingMode( bool profiling);
+
+	virtual void setParallelEvaluation( unsigned int nofThreads_);
+
+	virtual void setBudget( const QueryBudget& budget_);
+
+	virtual void prepare();
+
 	virtual QueryResult evaluate() const;
 	virtual std::string tostring() const;
 
@@ -195,6 +216,36 @@ public:
 
 	void print( std::ostream& out) const;
 
+	/// \brief Map of query nodes to the counters of the operations on their posting iterators
+	typedef std::map<NodeAddress,ProfilingPostingIterator::Counters> PostingProfileMap;
+
+	/// \brief Ranking of the query evaluated on a range of document numbers
+	struct RankingPartition
+	{
+		Index firstDocno;					///< first document number of the range
+		Index lastDocno;					///< last document number of the range
+		std::vector<Reference<Ranker> > rankers;		///< ranklist for every selector state
+		std::vector<unsigned int> nofDocumentsRanked;		///< number of documents ranked with a selector state up to the index
+		std::vector<unsigned int> nofDocumentsVisited;		///< number of documents visited with a selector state up to the index
+		bool truncated;						///< true, if the evaluation stopped because its share of the budget was exceeded
+		PostingProfileMap postingProfiles;			///< counters of the operations on the posting iterators (profiling mode only)
+		std::string error;					///< error message, if the evaluation failed
+
+		RankingPartition( const Index& firstDocno_, const Index& lastDocno_)
+			:firstDocno(firstDocno_),lastDocno(lastDocno_),truncated(false){}
+		RankingPartition( const RankingPartition& o)
+			:firstDocno(o.firstDocno),lastDocno(o.lastDocno)
+			,rankers(o.rankers)
+			,nofDocumentsRanked(o.nofDocumentsRanked)
+			,nofDocumentsVisited(o.nofDocumentsVisited)
+			,truncated(o.truncated)
+			,postingProfiles(o.postingProfiles)
+			,error(o.error){}
+	};
+
+	///\brief Evaluate the ranking of the query on a range of document numbers (called by the threads of a parallel evaluation)
+	void evaluatePartition( RankingPartition& partition, unsigned int nofPartitions, const utils::StopWatch& evaluationClock) const;
+
 private:
 	const TermStatistics& getTermStatistics( const std::string& type_, const std::string& value_) const;
 
@@ -225,16 +276,65 @@ private:
 			:varname(o.varname),index(o.index),value(o.value){}
 	};
 
-	PostingIteratorInterface* createExpressionPostingIterator( const Expression& expr, NodeStorageDataMap& nodeStorageDataMap) const;
-	PostingIteratorInterface* createNodePostingIterator( const NodeAddress& nodeadr, NodeStorageDataMap& nodeStorageDataMap) const;
+	struct EvaluationContext;
+	PostingIteratorInterface* instrumentPostingIterator( PostingIteratorInterface* itr, const NodeAddress& nodeadr, EvaluationContext* ctx) const;
+	PostingIteratorInterface* createExpressionPostingIterator( const Expression& expr, NodeStorageDataMap& nodeStorageDataMap, EvaluationContext* ctx) const;
+	PostingIteratorInterface* createNodePostingIterator( const NodeAddress& nodeadr, NodeStorageDataMap& nodeStorageDataMap, EvaluationContext* ctx) const;
 	void collectSummarizationVariables(
 				std::vector<SummarizationVariable>& variables,
 				const NodeAddress& nodeadr,
 				const NodeStorageDataMap& nodeStorageDataMap) const;
 	const NodeStorageData& nodeStorageData( const NodeAddress& nodeadr, const NodeStorageDataMap& nodeStorageDataMap) const;
 
+	bool initPostings( EvaluationContext& ctx) const;
+	void initWeightingFunctions(
+			EvaluationContext& ctx,
+			MetaDataReaderInterface* metaDataReader) const;
+	bool initEvaluationStructures(
+			EvaluationContext& ctx,
+			MetaDataReaderInterface* metaDataReader) const;
+	void initAccumulator(
+			EvaluationContext& ctx,
+			MetaDataReaderInterface* metaDataReader,
+			const Index& firstDocno,
+			const Index& lastDocno) const;
+	void initSummarizers( EvaluationContext& ctx) const;
+	EvaluationContext* preparedEvaluationContext() const;
+	bool initEvaluationContext(
+			EvaluationContext& ctx,
+			MetaDataReaderInterface* metaDataReader,
+			const Index& firstDocno,
+			const Index& lastDocno) const;
+	void rankPartition( RankingPartition& partition, Accumulator& accumulator) const;
+	void mergeRankingPartitions(
+			const std::vector<RankingPartition>& partitions,
+			std::vector<WeightedDocument>& resultlist,
+			unsigned int& state,
+			unsigned int& nofDocumentsRanked,
+			unsigned int& nofDocumentsVisited) const;
+	void rankDocumentsParallel(
+			std::vector<WeightedDocument>& resultlist,
+			unsigned int& state,
+			unsigned int& nofDocumentsRanked,
+			unsigned int& nofDocumentsVisited,
+			bool& truncated,
+			PostingProfileMap& postingProfiles,
+			const Index& maxDocumentNumber,
+			const utils::StopWatch& evaluationClock) const;
+	void collectPostingProfiles( PostingProfileMap& postingProfiles, const EvaluationContext& ctx) const;
+	void buildPostingProfile(
+			QueryProfile& profile,
+			const std::string& feature,
+			const NodeAddress& nodeadr,
+			unsigned int level,
+			const PostingProfileMap& postingProfiles) const;
+
+	std::string resultCacheKey() const;
+
 	void printNode( std::ostream& out, NodeAddress adr, std::size_t indent) const;
 	void printVariables( std::ostream& out, NodeAddress adr) const;
+	void printPlan( std::ostream& out) const;
+	void printPlanNode( std::ostream& out, NodeAddress adr, const NodeStorageDataMap& nodeStorageDataMap, std::size_t indent) const;
 	NodeAddress duplicateNode( NodeAddress adr);
 	void printStack( std::ostream& out, std::size_t indent) const;
 
@@ -261,6 +361,11 @@ private:
 	std::vector<WeightingVariableValueAssignment> m_weightingvars;	///< non constant weight variables (defined by query and not the query eval)
 	std::vector<WeightingVariableValueAssignment> m_summaryweightvars; ///< non constant summarization weight variables (defined by query and not the query eval)
 	bool m_debugMode;						///< true if debug mode is enabled
+	bool m_profilingMode;						///< true if profiling mode is enabled
+	unsigned int m_nofThreads;					///< number of threads for evaluating the ranking, 0 or 1 for sequential evaluation
+	QueryBudget m_budget;						///< limits of the resources the query evaluation is allowed to use
+	bool m_prepared;						///< true if the query is prepared for repeated evaluation
+	mutable Reference<EvaluationContext> m_preparedContext;		///< posting sets, weighting and summarizer functions of a prepared query
 	ErrorBufferInterface* m_errorhnd;				///< buffer for error messages
 };
 
@@ -0,0 +1,114 @@
+/*
+ * Copyright (c) 2014 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Resources used by a query evaluation checked against the query budget
+/// \file "queryBudgetState.hpp"
+#ifndef _STRUS_QUERY_BUDGET_STATE_HPP_INCLUDED
+#define _STRUS_QUERY_BUDGET_STATE_HPP_INCLUDED
+#include "strus/queryBudget.hpp"
+#include "private/utils.hpp"
+
+namespace strus
+{
+
+/// \brief Number of checks of the budget between two reads of the wall clock
+#define QUERY_BUDGET_CLOCK_CHECK_INTERVAL 64
+
+/// \brief Resources used by a query evaluation (or by one partition of a parallel query evaluation) checked against the query budget
+/// \remark Not thread safe, every thread evaluating a partition of the document range has its own instance
+class QueryBudgetState
+{
+public:
+	/// \brief Constructor
+	/// \param[in] budget the budget of the query
+	/// \param[in] nofShares number of partitions the budget of documents visited and posting operations is split into
+	/// \param[in] microsecondsUsed time already elapsed since the start of the query evaluation
+	explicit QueryBudgetState( const QueryBudget& budget, unsigned int nofShares=1, int64_t microsecondsUsed=0)
+		:m_maxNofDocumentsVisited(share( budget.maxNofDocumentsVisited(), nofShares))
+		,m_maxNofPostingOperations(share( budget.maxNofPostingOperations(), nofShares))
+		,m_maxMicroseconds(budget.maxMilliseconds() ? remainingMicroseconds( budget.maxMilliseconds(), microsecondsUsed) : 0)
+		,m_nofPostingOperations(0)
+		,m_checkCount(0)
+		,m_exceeded(false)
+		,m_stopWatch(){}
+
+	/// \brief Count a call of a posting iterator method
+	void countPostingOperation()
+	{
+		++m_nofPostingOperations;
+	}
+
+	/// \brief Evaluate if the budget is exceeded (remains exceeded, once it got exceeded)
+	/// \param[in] nofDocumentsVisited number of documents visited so far
+	bool exceeded( unsigned int nofDocumentsVisited)
+	{
+		if (m_exceeded) return true;
+		if ((m_maxNofDocumentsVisited && nofDocumentsVisited >= m_maxNofDocumentsVisited)
+		||  (m_maxNofPostingOperations && m_nofPostingOperations >= m_maxNofPostingOperations))
+		{
+			m_exceeded = true;
+		}
+		else if (m_maxMicroseconds && ++m_checkCount >= QUERY_BUDGET_CLOCK_CHECK_INTERVAL)
+		{
+			// ... reading the clock is expensive compared with the other checks, so we do it only every n-th time
+			m_checkCount = 0;
+			m_exceeded = (m_stopWatch.elapsedMicroseconds() >= m_maxMicroseconds);
+		}
+		return m_exceeded;
+	}
+
+	/// \brief Evaluate if the deadline or the limit of posting operations is exceeded, reading the clock on every call
+	/// \note Used for the coarse grained steps (e.g. summarization of one result document) after the ranking, where the number of documents visited does not matter anymore
+	bool deadlineExceeded()
+	{
+		if ((m_maxNofPostingOperations && m_nofPostingOperations >= m_maxNofPostingOperations)
+		||  (m_maxMicroseconds && m_stopWatch.elapsedMicroseconds() >= m_maxMicroseconds))
+		{
+			m_exceeded = true;
+			return true;
+		}
+		return false;
+	}
+
+	/// \brief Evaluate if the budget got exceeded in a previous check
+	bool hasExceeded() const
+	{
+		return m_exceeded;
+	}
+
+	/// \brief Get the time elapsed since the creation of this state in microseconds
+	int64_t elapsedMicroseconds() const
+	{
+		return m_stopWatch.elapsedMicroseconds();
+	}
+
+private:
+	static int64_t remainingMicroseconds( unsigned int maxMilliseconds, int64_t microsecondsUsed)
+	{
+		int64_t rt = (int64_t)maxMilliseconds * 1000 - microsecondsUsed;
+		return rt > 0 ? rt : 1;
+	}
+	static unsigned int share( unsigned int limit, unsigned int nofShares)
+	{
+		if (!limit || nofShares <= 1) return limit;
+		unsigned int rt = limit / nofShares;
+		return rt ? rt : 1;
+	}
+
+private:
+	unsigned int m_maxNofDocumentsVisited;		///< maximum number of documents visited (0 for no limit)
+	unsigned int m_maxNofPostingOperations;		///< maximum number of posting iterator operations (0 for no limit)
+	int64_t m_maxMicroseconds;			///< deadline in microseconds relative to m_stopWatch (0 for no limit)
+	unsigned int m_nofPostingOperations;		///< number of posting iterator operations counted
+	unsigned int m_checkCount;			///< number of checks since the last read of the clock
+	bool m_exceeded;				///< true, if the budget has been exceeded
+	utils::StopWatch m_stopWatch;			///< clock started with the query evaluation (or the partition evaluation)
+};
+
+}//namespace
+#endif
+
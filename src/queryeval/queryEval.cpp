@@ -39,6 +39,7 @@ void QueryEval::addTerm(
 {
 	try
 	{
+		clearResultCache();
 		m_terms.push_back( TermConfig( set_, type_, value_));
 	}
 	CATCH_ERROR_MAP( _TXT("error adding term: %s"), *m_errorhnd);
@@ -48,6 +49,7 @@ void QueryEval::addSelectionFeature( const std::string& set_)
 {
 	try
 	{
+		clearResultCache();
 		m_selectionSets.push_back( set_);
 	}
 	CATCH_ERROR_MAP( _TXT("error adding selection feature: %s"), *m_errorhnd);
@@ -57,6 +59,7 @@ void QueryEval::addRestrictionFeature( const std::string& set_)
 {
 	try
 	{
+		clearResultCache();
 		m_restrictionSets.push_back( set_);
 	}
 	CATCH_ERROR_MAP( _TXT("error adding restriction feature: %s"), *m_errorhnd);
@@ -66,6 +69,7 @@ void QueryEval::addExclusionFeature( const std::string& set_)
 {
 	try
 	{
+		clearResultCache();
 		m_exclusionSets.push_back( set_);
 	}
 	CATCH_ERROR_MAP( _TXT("error adding exclusion feature: %s"), *m_errorhnd);
@@ -79,6 +83,7 @@ void QueryEval::addSummarizerFunction(
 {
 	try
 	{
+		clearResultCache();
 		Reference<SummarizerFunctionInstanceInterface> functionref( function);
 		defineVariableAssignments(
 			functionref->getVariables(),
@@ -97,6 +102,7 @@ void QueryEval::addWeightingFunction(
 {
 	try
 	{
+		clearResultCache();
 		Reference<WeightingFunctionInstanceInterface> functionref( function);
 		defineVariableAssignments(
 			functionref->getVariables(),
@@ -112,6 +118,7 @@ void QueryEval::defineWeightingFormula(
 {
 	try
 	{
+		clearResultCache();
 		m_weightingFormula.reset( combinefunc);
 		defineVariableAssignments(
 			combinefunc->getVariables(),
@@ -121,6 +128,51 @@ void QueryEval::defineWeightingFormula(
 	CATCH_ERROR_MAP( _TXT("error adding weighting formula: %s"), *m_errorhnd);
 }
 
+void QueryEval::setPruning( bool enable)
+{
+	clearResultCache();
+	m_pruning = enable;
+}
+
+void QueryEval::setMergedSelection( bool enable)
+{
+	clearResultCache();
+	m_mergedSelection = enable;
+}
+
+void QueryEval::clearResultCache()
+{
+	if (m_resultCache.get())
+	{
+		m_resultCache->clear();
+	}
+}
+
+void QueryEval::defineResultCache( std::size_t maxMemoryUsage)
+{
+	try
+	{
+		if (maxMemoryUsage)
+		{
+			m_resultCache.reset( new QueryResultCache( maxMemoryUsage));
+		}
+		else
+		{
+			m_resultCache.reset();
+		}
+	}
+	CATCH_ERROR_MAP( _TXT("error defining query result cache: %s"), *m_errorhnd);
+}
+
+QueryResultCacheStatistics QueryEval::resultCacheStatistics() const
+{
+	try
+	{
+		return m_resultCache.get() ? m_resultCache->statistics() : QueryResultCacheStatistics();
+	}
+	CATCH_ERROR_MAP_RETURN( _TXT("error getting query result cache statistics: %s"), *m_errorhnd, QueryResultCacheStatistics());
+}
+
 void QueryEval::print( std::ostream& out) const
 {
 	try
@@ -192,6 +244,14 @@ void QueryEval::print( std::ostream& out) const
 			}
 			out << ");" << std::endl;
 		}
+		if (m_pruning)
+		{
+			out << "PRUNING;" << std::endl;
+		}
+		if (m_mergedSelection)
+		{
+			out << "MERGED SELECTION;" << std::endl;
+		}
 	}
 	CATCH_ERROR_MAP( _TXT("error printing query evaluation structure: %s"), *m_errorhnd);
 }
@@ -13,6 +13,7 @@
 #include "termConfig.hpp"
 #include "summarizerDef.hpp"
 #include "weightingDef.hpp"
+#include "queryResultCache.hpp"
 #include <string>
 #include <vector>
 #include <map>
@@ -30,7 +31,7 @@ class QueryEval
 {
 public:
 	explicit QueryEval( ErrorBufferInterface* errorhnd_)
-		:m_errorhnd(errorhnd_){}
+		:m_pruning(false),m_mergedSelection(false),m_errorhnd(errorhnd_){}
 
 	QueryEval( const QueryEval& o)
 		:m_selectionSets(o.m_selectionSets)
@@ -39,6 +40,8 @@ public:
 		,m_weightingFunctions(o.m_weightingFunctions)
 		,m_summarizers(o.m_summarizers)
 		,m_terms(o.m_terms)
+		,m_pruning(o.m_pruning)
+		,m_mergedSelection(o.m_mergedSelection)
 	{}
 
 	virtual QueryInterface* createQuery(
@@ -69,6 +72,14 @@ public:
 	virtual void defineWeightingFormula(
 			ScalarFunctionInterface* combinefunc);
 
+	virtual void setPruning( bool enable);
+
+	virtual void setMergedSelection( bool enable);
+
+	virtual void defineResultCache( std::size_t maxMemoryUsage);
+
+	virtual QueryResultCacheStatistics resultCacheStatistics() const;
+
 	void print( std::ostream& out) const;
 
 
@@ -80,6 +91,9 @@ public:/*Query*/
 	const std::vector<std::string>& exclusionSets() const		{return m_exclusionSets;}
 	const std::vector<WeightingDef>& weightingFunctions() const	{return m_weightingFunctions;}
 	const ScalarFunctionInterface* weightingFormula() const		{return m_weightingFormula.get();}
+	bool pruning() const						{return m_pruning;}
+	bool mergedSelection() const					{return m_mergedSelection;}
+	QueryResultCache* resultCache() const				{return m_resultCache.get();}
 
 public:/*Query*/
 	struct VariableAssignment
@@ -99,6 +113,7 @@ public:/*Query*/
 
 private:
 	void defineVariableAssignments( const std::vector<std::string>& variables, VariableAssignment::Target target, std::size_t index);
+	void clearResultCache();
 
 private:
 	std::vector<std::string> m_selectionSets;			///< posting sets selecting the documents to match
@@ -110,6 +125,9 @@ private:
 
 	std::vector<TermConfig> m_terms;				///< list of predefined terms used in query evaluation but not part of the query (e.g. punctuation)
 	std::multimap<std::string,VariableAssignment> m_varassignmap;	///< map of weight variable assignments
+	bool m_pruning;							///< true, if documents that cannot make it into the ranklist are skipped (MaxScore)
+	bool m_mergedSelection;						///< true, if the postings of all selection features are traversed together in docno order
+	Reference<QueryResultCache> m_resultCache;			///< cache for results of queries created from this (not copied)
 	ErrorBufferInterface* m_errorhnd;				///< buffer for error messages
 };
 
@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) 2014 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Measurement of the time used by the phases of a query evaluation
+/// \file "queryPhaseProfiler.hpp"
+#ifndef _STRUS_QUERY_PHASE_PROFILER_HPP_INCLUDED
+#define _STRUS_QUERY_PHASE_PROFILER_HPP_INCLUDED
+#include "strus/queryProfile.hpp"
+#include "private/utils.hpp"
+
+namespace strus
+{
+
+/// \brief Measurement of the time used by the phases of a query evaluation
+/// \note Does nothing but a flag test per phase if not enabled
+class QueryPhaseProfiler
+{
+public:
+	explicit QueryPhaseProfiler( bool enabled_)
+		:m_enabled(enabled_),m_phase(0),m_stopWatch(),m_profile(){}
+
+	bool enabled() const
+	{
+		return m_enabled;
+	}
+
+	/// \brief Close the measurement of the current phase and start a new one
+	void startPhase( const char* phase)
+	{
+		if (!m_enabled) return;
+		closePhase();
+		m_phase = phase;
+	}
+
+	/// \brief Close the measurement of the current phase
+	void finish()
+	{
+		if (!m_enabled) return;
+		closePhase();
+	}
+
+	QueryProfile& profile()
+	{
+		return m_profile;
+	}
+
+private:
+	void closePhase()
+	{
+		if (m_phase)
+		{
+			m_profile.addPhase( QueryProfile::Phase( m_phase, (unsigned int)m_stopWatch.elapsedMicroseconds()));
+			m_phase = 0;
+		}
+		m_stopWatch.restart();
+	}
+
+private:
+	bool m_enabled;				///< true, if profiling is enabled
+	const char* m_phase;			///< name of the phase currently measured
+	utils::StopWatch m_stopWatch;		///< clock started with the current phase
+	QueryProfile m_profile;			///< profile built
+};
+
+}//namespace
+#endif
+
@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2014 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#include "queryResultCache.hpp"
+
+using namespace strus;
+
+/// \brief Estimated memory overhead of a cache entry (list and map node)
+#define ENTRY_OVERHEAD 128
+
+std::size_t QueryResultCache::memoryUsage( const std::string& key, const QueryResult& result)
+{
+	std::size_t rt = ENTRY_OVERHEAD + 2*key.size() + sizeof(Entry);
+	std::vector<ResultDocument>::const_iterator
+		ri = result.ranks().begin(), re = result.ranks().end();
+	for (; ri != re; ++ri)
+	{
+		rt += sizeof(ResultDocument);
+		std::vector<SummaryElement>::const_iterator
+			si = ri->summaryElements().begin(), se = ri->summaryElements().end();
+		for (; si != se; ++si)
+		{
+			rt += sizeof(SummaryElement) + si->name().size() + si->value().size();
+		}
+	}
+	return rt;
+}
+
+bool QueryResultCache::get( QueryResult& result, const std::string& key)
+{
+	utils::ScopedLock lock( m_mutex);
+	EntryMap::iterator mi = m_map.find( key);
+	if (mi == m_map.end())
+	{
+		++m_nofMisses;
+		return false;
+	}
+	// ... move the entry to the front of the least recently used list:
+	m_lru.splice( m_lru.begin(), m_lru, mi->second);
+	result = mi->second->result;
+	++m_nofHits;
+	return true;
+}
+
+void QueryResultCache::put( const std::string& key, const QueryResult& result)
+{
+	std::size_t entryMemoryUsage = memoryUsage( key, result);
+	if (entryMemoryUsage > m_maxMemoryUsage) return;
+
+	utils::ScopedLock lock( m_mutex);
+	EntryMap::iterator mi = m_map.find( key);
+	if (mi != m_map.end())
+	{
+		// ... entry inserted by another thread evaluating the same query
+		m_lru.splice( m_lru.begin(), m_lru, mi->second);
+		return;
+	}
+	evict( m_maxMemoryUsage - entryMemoryUsage);
+	m_lru.push_front( Entry( key, result, entryMemoryUsage));
+	m_map[ key] = m_lru.begin();
+	m_memoryUsage += entryMemoryUsage;
+}
+
+void QueryResultCache::evict( std::size_t maxMemoryUsage)
+{
+	while (m_memoryUsage > maxMemoryUsage && !m_lru.empty())
+	{
+		m_memoryUsage -= m_lru.back().memoryUsage;
+		m_map.erase( m_lru.back().key);
+		m_lru.pop_back();
+	}
+}
+
+void QueryResultCache::clear()
+{
+	utils::ScopedLock lock( m_mutex);
+	m_map.clear();
+	m_lru.clear();
+	m_memoryUsage = 0;
+}
+
+QueryResultCacheStatistics QueryResultCache::statistics() const
+{
+	utils::ScopedLock lock( m_mutex);
+	return QueryResultCacheStatistics( m_nofHits, m_nofMisses, m_map.size(), m_memoryUsage);
+}
+
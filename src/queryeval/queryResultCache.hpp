@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2014 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#ifndef _STRUS_QUERYEVAL_QUERY_RESULT_CACHE_HPP_INCLUDED
+#define _STRUS_QUERYEVAL_QUERY_RESULT_CACHE_HPP_INCLUDED
+#include "strus/queryResult.hpp"
+#include "strus/queryResultCacheStatistics.hpp"
+#include "private/utils.hpp"
+#include <string>
+#include <list>
+#include <map>
+
+namespace strus
+{
+
+/// \class QueryResultCache
+/// \brief Cache for query results with a memory limit and least recently used eviction
+/// \remark The keys are a canonical serialization of the query with the storage generation, so entries of an older storage generation are never found again and are evicted when they become the least recently used
+/// \note Thread safe
+class QueryResultCache
+{
+public:
+	/// \brief Constructor
+	/// \param[in] maxMemoryUsage_ maximum number of bytes used by the cache entries (estimated)
+	explicit QueryResultCache( std::size_t maxMemoryUsage_)
+		:m_maxMemoryUsage(maxMemoryUsage_),m_memoryUsage(0),m_nofHits(0),m_nofMisses(0){}
+
+	/// \brief Lookup a query result
+	/// \param[out] result the result found
+	/// \param[in] key the canonical query key
+	/// \return true if found, false else
+	bool get( QueryResult& result, const std::string& key);
+
+	/// \brief Store a query result, evicting the least recently used entries if the memory limit is exceeded
+	/// \param[in] key the canonical query key
+	/// \param[in] result the result to store
+	void put( const std::string& key, const QueryResult& result);
+
+	/// \brief Remove all entries
+	void clear();
+
+	/// \brief Get the statistics of the cache
+	QueryResultCacheStatistics statistics() const;
+
+private:
+	static std::size_t memoryUsage( const std::string& key, const QueryResult& result);
+	void evict( std::size_t maxMemoryUsage);
+
+private:
+	struct Entry
+	{
+		std::string key;
+		QueryResult result;
+		std::size_t memoryUsage;
+
+		Entry( const std::string& key_, const QueryResult& result_, std::size_t memoryUsage_)
+			:key(key_),result(result_),memoryUsage(memoryUsage_){}
+		Entry( const Entry& o)
+			:key(o.key),result(o.result),memoryUsage(o.memoryUsage){}
+	};
+	typedef std::list<Entry> EntryList;
+	typedef std::map<std::string,EntryList::iterator> EntryMap;
+
+	mutable utils::Mutex m_mutex;				///< mutual exclusion of all accesses
+	std::size_t m_maxMemoryUsage;				///< memory limit
+	std::size_t m_memoryUsage;				///< estimated memory used by the entries
+	EntryList m_lru;					///< entries ordered from the most recently used to the least recently used
+	EntryMap m_map;						///< map of keys to entries
+	unsigned int m_nofHits;					///< number of cache hits
+	unsigned int m_nofMisses;				///< number of cache misses
+};
+
+}//namespace
+#endif
+
@@ -9,10 +9,10 @@
 #define _STRUS_QUERYEVAL_RANKER_HPP_INCLUDED
 #include "strus/index.hpp"
 #include "strus/weightedDocument.hpp"
-#include "private/localStructAllocator.hpp"
 #include "private/internationalization.hpp"
-#include <set>
 #include <vector>
+#include <algorithm>
+#include <functional>
 #include <cstring>
 
 namespace strus
@@ -20,6 +20,7 @@ namespace strus
 
 /// \class Ranker
 /// \brief Data structure to keep the N best ranked documents in sorted order
+/// \remark Uses a sorted array for small N and a contiguous min-heap with the N-th best document on top for big N
 class Ranker
 {
 public:
@@ -41,7 +42,7 @@ public:
 		}
 		else
 		{
-			multisetInsert( doc);
+			heapInsert( doc);
 		}
 	}
 
@@ -53,7 +54,7 @@ public:
 		}
 		else
 		{
-			return multisetResult( firstRank);
+			return heapResult( firstRank);
 		}
 	}
 
@@ -62,30 +63,50 @@ public:
 		return m_nofRanks;
 	}
 
-private:
-	void multisetInsert( const WeightedDocument& doc)
+	/// \brief Evaluate if the ranklist has reached its maximum size, so that a document has to beat the last element to get in
+	bool complete() const
+	{
+		return m_nofRanks >= m_maxNofRanks;
+	}
+
+	/// \brief Get the weight of the last element in the ranklist, the admission threshold a document has to beat to get in
+	/// \remark Only defined if the ranklist is complete
+	double minWeight() const
 	{
-		m_rankset.insert( doc);
-		if (m_maxNofRanks < ++m_nofRanks)
+		if (m_maxNofRanks < MaxIndexSize)
+		{
+			return m_brute_ar[ m_brute_index[ m_maxNofRanks-1]].weight();
+		}
+		else
 		{
-			m_rankset.erase( m_rankset.begin());
+			return m_heap.front().weight();
 		}
 	}
 
-	std::vector<WeightedDocument> multisetResult( std::size_t firstRank) const
+private:
+	void heapInsert( const WeightedDocument& doc)
 	{
-		std::vector<WeightedDocument> rt;
-		RankSet::reverse_iterator ri=m_rankset.rbegin(),re=m_rankset.rend();
-		std::size_t ridx = 0;
-		for (; ri != re; ++ri,++ridx)
+		// The heap is ordered with std::greater, so that the worst document is on top:
+		if (m_heap.size() < m_maxNofRanks)
 		{
-			if (ridx >= firstRank) break;
+			m_heap.push_back( doc);
+			std::push_heap( m_heap.begin(), m_heap.end(), std::greater<WeightedDocument>());
 		}
-		for (; ri != re && ridx < m_nofRanks; ++ri,++ridx)
+		else if (m_heap.front() < doc)
 		{
-			if (ridx > m_nofRanks) break;
-			rt.push_back( *ri);
+			std::pop_heap( m_heap.begin(), m_heap.end(), std::greater<WeightedDocument>());
+			m_heap.back() = doc;
+			std::push_heap( m_heap.begin(), m_heap.end(), std::greater<WeightedDocument>());
 		}
+		++m_nofRanks;
+	}
+
+	std::vector<WeightedDocument> heapResult( std::size_t firstRank) const
+	{
+		if (firstRank >= m_heap.size()) return std::vector<WeightedDocument>();
+		std::vector<WeightedDocument> rt( m_heap);
+		std::sort( rt.begin(), rt.end(), std::greater<WeightedDocument>());
+		rt.erase( rt.begin(), rt.begin() + firstRank);
 		return rt;
 	}
 
@@ -156,11 +177,7 @@ private:
 	}
 
 private:
-	typedef std::multiset<
-			WeightedDocument,
-			std::less<WeightedDocument>,
-			LocalStructAllocator<WeightedDocument> > RankSet;
-	RankSet m_rankset;
+	std::vector<WeightedDocument> m_heap;
 	enum {MaxIndexSize=128};
 
 	unsigned char m_brute_index[ MaxIndexSize];
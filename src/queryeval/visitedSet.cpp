@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) 2014 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#include "visitedSet.hpp"
+#include "private/utils.hpp"
+#include <cstring>
+#include <new>
+
+using namespace strus;
+
+namespace {
+/// \brief Chunks released by the visited sets of the queries evaluated in one thread
+class ChunkPool
+{
+public:
+	ChunkPool(){}
+	~ChunkPool()
+	{
+		std::vector<uint64_t*>::iterator ci = m_chunks.begin(), ce = m_chunks.end();
+		for (; ci != ce; ++ci) delete [] *ci;
+	}
+
+	/// \brief Get a zeroed chunk from the pool or allocate a new one
+	uint64_t* get()
+	{
+		if (m_chunks.empty())
+		{
+			uint64_t* rt = new uint64_t[ VISITED_SET_CHUNK_NOFWORDS];
+			std::memset( rt, 0, VISITED_SET_CHUNK_NOFWORDS * sizeof(uint64_t));
+			return rt;
+		}
+		uint64_t* rt = m_chunks.back();
+		m_chunks.pop_back();
+		return rt;
+	}
+
+	/// \brief Give back a chunk, that is zeroed for the next user or freed if the pool is full
+	void release( uint64_t* chunk)
+	{
+		if (m_chunks.size() >= VISITED_SET_MAX_POOLED_CHUNKS)
+		{
+			delete [] chunk;
+			return;
+		}
+		try
+		{
+			std::memset( chunk, 0, VISITED_SET_CHUNK_NOFWORDS * sizeof(uint64_t));
+			m_chunks.push_back( chunk);
+		}
+		catch (const std::bad_alloc&)
+		{
+			delete [] chunk;
+		}
+	}
+
+private:
+	std::vector<uint64_t*> m_chunks;
+};
+}//anonymous namespace
+
+static utils::ThreadSpecificPtr<ChunkPool> g_chunkPool;
+
+static ChunkPool* threadChunkPool()
+{
+	ChunkPool* rt = g_chunkPool.get();
+	if (!rt)
+	{
+		rt = new (std::nothrow) ChunkPool();
+		if (rt) g_chunkPool.reset( rt);
+	}
+	return rt;
+}
+
+VisitedSet::VisitedSet( const Index& minDocumentNumber_, const Index& maxDocumentNumber_)
+	:m_minDocumentNumber(minDocumentNumber_)
+	,m_chunks(maxDocumentNumber_ >= minDocumentNumber_ ? (((std::size_t)(maxDocumentNumber_ - minDocumentNumber_) >> VISITED_SET_CHUNK_SHIFT) + 1) : 0, 0)
+	,m_allocated()
+{}
+
+VisitedSet::~VisitedSet()
+{
+	// ... the visited set may be destroyed in another thread than the one it was filled in,
+	//	so the chunks go to the pool of the thread destroying it
+	ChunkPool* pool = threadChunkPool();
+	std::vector<std::size_t>::const_iterator ai = m_allocated.begin(), ae = m_allocated.end();
+	for (; ai != ae; ++ai)
+	{
+		if (pool)
+		{
+			pool->release( m_chunks[ *ai]);
+		}
+		else
+		{
+			delete [] m_chunks[ *ai];
+		}
+	}
+}
+
+uint64_t* VisitedSet::allocChunk( std::size_t chunkidx)
+{
+	ChunkPool* pool = threadChunkPool();
+	if (!pool) throw std::bad_alloc();
+	m_allocated.reserve( m_allocated.size() + 1);
+	uint64_t* rt = pool->get();
+	m_allocated.push_back( chunkidx);
+	return m_chunks[ chunkidx] = rt;
+}
+
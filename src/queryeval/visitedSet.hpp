@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2014 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Set of the documents visited by the accumulator in a query evaluation
+/// \file "visitedSet.hpp"
+#ifndef _STRUS_QUERYEVAL_VISITED_SET_HPP_INCLUDED
+#define _STRUS_QUERYEVAL_VISITED_SET_HPP_INCLUDED
+#include "strus/index.hpp"
+#include <vector>
+#include <cstddef>
+#include <stdint.h>
+
+namespace strus
+{
+
+/// \brief Number of bits needed to address a document inside a chunk of the visited set
+#define VISITED_SET_CHUNK_SHIFT 16
+/// \brief Number of documents covered by a chunk of the visited set (one chunk has 8K of memory)
+#define VISITED_SET_CHUNK_SIZE (1 << VISITED_SET_CHUNK_SHIFT)
+/// \brief Number of 64 bit words of a chunk of the visited set
+#define VISITED_SET_CHUNK_NOFWORDS (VISITED_SET_CHUNK_SIZE / 64)
+/// \brief Maximum number of unused chunks kept for reuse by a thread
+#define VISITED_SET_MAX_POOLED_CHUNKS 1024
+
+/// \brief Chunked bitmap of the documents in a range of document numbers, where the chunks are allocated on the first insert of a document covered
+/// \remark The memory needed depends on the number of distinct regions of documents visited and not on the size of the collection. The chunks released are kept in a pool owned by the current thread for reuse by the next query evaluated in this thread.
+class VisitedSet
+{
+public:
+	/// \brief Constructor
+	/// \param[in] minDocumentNumber_ first document number of the range covered
+	/// \param[in] maxDocumentNumber_ last document number of the range covered
+	VisitedSet( const Index& minDocumentNumber_, const Index& maxDocumentNumber_);
+	/// \brief Destructor, releasing the chunks allocated to the pool of the current thread
+	~VisitedSet();
+
+	/// \brief Insert a document
+	/// \param[in] docno document number (in the range of the set)
+	/// \return true, if the document has been inserted, false if it had already been in the set before
+	bool insert( const Index& docno)
+	{
+		std::size_t idx = docno - m_minDocumentNumber;
+		uint64_t* chunk = m_chunks[ idx >> VISITED_SET_CHUNK_SHIFT];
+		if (!chunk)
+		{
+			chunk = allocChunk( idx >> VISITED_SET_CHUNK_SHIFT);
+		}
+		uint64_t& word = chunk[ (idx & (VISITED_SET_CHUNK_SIZE-1)) >> 6];
+		uint64_t mask = (uint64_t)1 << (idx & 63);
+		if (word & mask) return false;
+		word |= mask;
+		return true;
+	}
+
+	/// \brief Get the number of chunks allocated
+	std::size_t nofChunksAllocated() const
+	{
+		return m_allocated.size();
+	}
+
+private:
+	VisitedSet( const VisitedSet&){}	//... non copyable
+	void operator=( const VisitedSet&){}	//... non copyable
+
+	uint64_t* allocChunk( std::size_t chunkidx);
+
+private:
+	Index m_minDocumentNumber;		///< first document number of the range covered
+	std::vector<uint64_t*> m_chunks;	///< chunk directory, the chunks not allocated yet are NULL
+	std::vector<std::size_t> m_allocated;	///< indices of the chunks allocated in m_chunks
+};
+
+}//namespace
+#endif
+
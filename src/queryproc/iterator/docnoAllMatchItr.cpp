@@ -99,12 +99,12 @@ Index DocnoAllMatchItr::skipDoc( const Index& docno_)
 
 Index DocnoAllMatchItr::maxDocumentFrequency() const
 {
-	return m_args[0]->documentFrequency();
+	return m_args.back()->documentFrequency();
 }
 
 Index DocnoAllMatchItr::minDocumentFrequency() const
 {
-	return m_args.back()->documentFrequency();
+	return m_args[0]->documentFrequency();
 }
 
 
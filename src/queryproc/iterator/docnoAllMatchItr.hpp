@@ -40,13 +40,13 @@ public:
 	/// \return the upper bound or 0 if it does not exist
 	Index skipDocCandidate( const Index& docno_);
 
-	/// \brief Get the minimum document frequency (first element df)
+	/// \brief Get the maximum document frequency (last element df)
 	Index maxDocumentFrequency() const;
-	/// \brief Get the minimum document frequency (last element df)
+	/// \brief Get the minimum document frequency (first element df)
 	Index minDocumentFrequency() const;
 
 private:
-	std::vector<PostingIteratorReference> m_args;	///< argument posting iterators
+	std::vector<PostingIteratorReference> m_args;	///< argument posting iterators ordered by ascending df (the rarest drives the matching)
 	Index m_curdocno;				///< current last docno match
 	Index m_curdocno_candidate;			///< current last docno match candidate
 };
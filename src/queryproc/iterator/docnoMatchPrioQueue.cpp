@@ -16,18 +16,17 @@ using namespace strus;
 
 DocnoMatchPrioQueue::DocnoMatchPrioQueue( const std::vector<PostingIteratorReference>& args_, unsigned int cardinality_)
 	:m_args(args_)
+	,m_ar(args_.size())
+	,m_quear(args_.size())
 	,m_arsize(0)
 	,m_quearsize(0)
-	,m_cardinality((unsigned char)cardinality_)
+	,m_cardinality(cardinality_)
 	,m_curdocno(0)
 	,m_curdocno_candidate(0)
 	,m_maxdocno(0)
 	,m_maxdocno_candidate(0)
 {
-	// if (m_cardinality > MaxNofElements) throw strus::runtime_error(_TXT("cardinality out of range: %u"), m_cardinality);
-	// ... allways true
 	if (m_args.size() == 0) throw strus::runtime_error( "%s", _TXT("initializing allmatch priority queue with no arguments"));
-	if (m_args.size() > MaxNofElements) throw strus::runtime_error(_TXT("number of arguments out of range: %u"), (unsigned int)m_args.size());
 	if (m_cardinality == 0) m_cardinality = m_args.size();
 }
 
@@ -46,8 +45,6 @@ void DocnoMatchPrioQueue::init( const Index& docno_)
 		Index dn = (*ai)->skipDocCandidate( docno_);
 		if (dn)
 		{
-			// if (m_arsize >= MaxNofElements) throw strus::runtime_error( _TXT("number of arguments for get first matches iterator out of range: %u"), (unsigned int)m_arsize);
-			// ... allways true
 			insertElement( Element( dn, ai-m_args.begin()));
 		}
 	}
@@ -56,32 +53,32 @@ void DocnoMatchPrioQueue::init( const Index& docno_)
 void DocnoMatchPrioQueue::insertElement( const Element& elem)
 {
 	m_ar[ m_arsize] = elem;
-	unsigned char qi=0;
+	std::size_t qi=0;
 	for (; qi < m_quearsize && m_ar[ m_quear[ qi]].docno <= elem.docno; ++qi){}
 	if (qi < m_quearsize)
 	{
-		std::memmove( m_quear+qi+1, m_quear+qi, (m_quearsize-qi)*sizeof(*m_quear));
+		std::memmove( m_quear.ptr()+qi+1, m_quear.ptr()+qi, (m_quearsize-qi)*sizeof(std::size_t));
 	}
 	m_quear[ qi] = m_arsize;
 	++m_arsize;
 	++m_quearsize;
 }
 
-void DocnoMatchPrioQueue::removeQueueElement( unsigned char qi)
+void DocnoMatchPrioQueue::removeQueueElement( std::size_t qi)
 {
 	// reset the position of the deleted element:
 	m_ar[ m_quear[ qi]].docno = 0;
 	// remove queue element:
 	if (qi+1 < m_quearsize)
 	{
-		std::memmove( m_quear+qi, m_quear+qi+1, (m_quearsize-qi-1)*sizeof(*m_quear));
+		std::memmove( m_quear.ptr()+qi, m_quear.ptr()+qi+1, (m_quearsize-qi-1)*sizeof(std::size_t));
 	}
 	--m_quearsize;
 }
 
-void DocnoMatchPrioQueue::shiftQueueElement( unsigned char qi, const Index& docno_)
+void DocnoMatchPrioQueue::shiftQueueElement( std::size_t qi, const Index& docno_)
 {
-	unsigned char aridx = m_quear[ qi];
+	std::size_t aridx = m_quear[ qi];
 	if (docno_ < m_ar[ aridx].docno)
 	{
 		throw strus::runtime_error( "%s", _TXT("bad all match prio queue operation (shift with smaller docno)"));
@@ -210,8 +207,8 @@ Index DocnoMatchPrioQueue::skipDoc( const Index& docno_)
 		}
 		// [2] Check if the candidate result matches by counting the skipDoc matches of the
 		//	the topmost elements of the queue with same docno:
-		unsigned char matchcnt = 0;
-		unsigned char qi=0;
+		std::size_t matchcnt = 0;
+		std::size_t qi=0;
 		for (; qi<m_quearsize && matchcnt<m_cardinality && dn == m_ar[ m_quear[ qi]].docno; qi++)
 		{
 			if (dn==m_args[ m_ar[ m_quear[ qi]].argidx]->skipDoc(dn))
@@ -241,12 +238,12 @@ DocnoMatchPrioQueue::CandidateList DocnoMatchPrioQueue::getCandidateList()
 	if (m_quearsize == 0) return rt;
 
 	Index dn = m_ar[m_quear[0]].docno;
-	rt.ar[0] = m_args[ m_ar[m_quear[0]].argidx].get();
+	rt.ar.push_back( m_args[ m_ar[m_quear[0]].argidx].get());
 
-	unsigned char qi=1,qe=m_quearsize;
+	std::size_t qi=1,qe=m_quearsize;
 	for (; qi<qe && m_ar[m_quear[qi]].docno == dn; ++qi)
 	{
-		rt.ar[qi] = m_args[ m_ar[m_quear[qi]].argidx].get();
+		rt.ar.push_back( m_args[ m_ar[m_quear[qi]].argidx].get());
 	}
 	rt.arsize = qi;
 	return rt;
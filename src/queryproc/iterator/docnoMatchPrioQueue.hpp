@@ -12,6 +12,7 @@
 #include "strus/index.hpp"
 #include "strus/reference.hpp"
 #include "strus/postingIteratorInterface.hpp"
+#include "private/smallArray.hpp"
 #include <vector>
 
 namespace strus
@@ -30,18 +31,18 @@ public:
 	/// \brief Destructor
 	~DocnoMatchPrioQueue(){}
 
-	/// \brief The maximum number of arguments is fixed, because we use a static array for the queue
-	enum {MaxNofElements=256};
+	/// \brief Number of arguments handled without allocating memory, more arguments are possible
+	enum {LocalNofElements=256};
 
 	/// \brief Element of the all match priority queue
 	struct Element
 	{
 		Index docno;			///< element document number
-		unsigned char argidx;		///< index into argument posting iterators passed with queue constructor
+		std::size_t argidx;		///< index into argument posting iterators passed with queue constructor
 
 		Element()
 			:docno(0),argidx(0){}
-		Element( const Index& docno_, unsigned char argidx_)
+		Element( const Index& docno_, std::size_t argidx_)
 			:docno(docno_),argidx(argidx_){}
 		Element( const Element& o)
 			:docno(o.docno),argidx(o.argidx){}
@@ -50,8 +51,13 @@ public:
 	/// \brief List of top elements with same docno of the queue
 	struct CandidateList
 	{
-		PostingIteratorInterface* ar[ MaxNofElements];	///< top element iterators
-		std::size_t arsize;				///< number of top element iterators
+		SmallArray<PostingIteratorInterface*,LocalNofElements> ar;	///< top element iterators
+		std::size_t arsize;						///< number of top element iterators
+
+		CandidateList()
+			:ar(),arsize(0){}
+		CandidateList( const CandidateList& o)
+			:ar(o.ar),arsize(o.arsize){}
 	};
 
 	/// \brief Find the first match queue configuration with the first [cardinality] elements 
@@ -90,20 +96,20 @@ private:
 
 	/// \brief Remove the element addressed  by queue index from the queue.
 	/// \param[in] qi queue element index to remove
-	void removeQueueElement( unsigned char qi);
+	void removeQueueElement( std::size_t qi);
 
 	/// \brief Shift up the queue element addressed by queue index to a place specified by document number
 	/// \param[in] qi element index of the queue element to shift up
 	/// \param[in] docno_ new document number (must be bigger or equal than before) of the element to shift
-	void shiftQueueElement( unsigned char qi, const Index& docno_);
+	void shiftQueueElement( std::size_t qi, const Index& docno_);
 
 private:
 	std::vector<PostingIteratorReference> m_args;	///< argument posting iterators
-	Element m_ar[ MaxNofElements];			///< processed elements
-	unsigned char m_quear[ MaxNofElements];		///< number of processed elements
-	unsigned char m_arsize;				///< number of currently processed elements
-	unsigned char m_quearsize;			///< size of queue
-	unsigned char m_cardinality;			///< cardinality of the result set
+	SmallArray<Element,LocalNofElements> m_ar;	///< processed elements
+	SmallArray<std::size_t,LocalNofElements> m_quear;///< queue of indices of processed elements ordered by document number
+	std::size_t m_arsize;				///< number of currently processed elements
+	std::size_t m_quearsize;			///< size of queue
+	std::size_t m_cardinality;			///< cardinality of the result set
 	Index m_curdocno;				///< current last docno match
 	Index m_curdocno_candidate;			///< current last docno match candidate
 	Index m_maxdocno;				///< first document found without upperbound match
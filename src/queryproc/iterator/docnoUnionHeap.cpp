@@ -0,0 +1,121 @@
+/*
+ * Copyright (c) 2014 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Binary heap of posting iterators keyed by their current document candidate, for unions with many arguments
+#include "docnoUnionHeap.hpp"
+#include "private/internationalization.hpp"
+#include "private/errorUtils.hpp"
+
+using namespace strus;
+
+DocnoUnionHeap::DocnoUnionHeap( const std::vector<PostingIteratorReference>& args_)
+	:m_args(args_)
+	,m_heap()
+	,m_stack()
+	,m_base(0)
+	,m_initialized(false)
+{
+	if (m_args.empty()) throw strus::runtime_error( "%s", _TXT("passed empty set of argument postings to union heap"));
+	m_heap.reserve( m_args.size());
+	m_stack.reserve( m_args.size());
+}
+
+void DocnoUnionHeap::siftDown( std::size_t hi)
+{
+	std::size_t nn = m_heap.size();
+	Element elem = m_heap[ hi];
+	for (;;)
+	{
+		std::size_t ci = (hi << 1) + 1;
+		if (ci >= nn) break;
+		if (ci+1 < nn && m_heap[ ci+1].docno < m_heap[ ci].docno) ++ci;
+		if (m_heap[ ci].docno >= elem.docno) break;
+		m_heap[ hi] = m_heap[ ci];
+		hi = ci;
+	}
+	m_heap[ hi] = elem;
+}
+
+void DocnoUnionHeap::popTop()
+{
+	m_heap[ 0] = m_heap.back();
+	m_heap.pop_back();
+	if (!m_heap.empty()) siftDown( 0);
+}
+
+void DocnoUnionHeap::init( const Index& docno_)
+{
+	m_heap.clear();
+	std::vector<PostingIteratorReference>::iterator ai = m_args.begin(), ae = m_args.end();
+	for (std::size_t aidx=0; ai != ae; ++ai,++aidx)
+	{
+		Index dn = (*ai)->skipDocCandidate( docno_);
+		if (dn) m_heap.push_back( Element( dn, aidx));
+	}
+	std::size_t hi = m_heap.size() >> 1;
+	while (hi > 0)
+	{
+		siftDown( --hi);
+	}
+	m_base = docno_;
+	m_initialized = true;
+}
+
+void DocnoUnionHeap::advance( const Index& docno_)
+{
+	// Only the arguments with a candidate behind the new base are touched:
+	while (!m_heap.empty() && m_heap[ 0].docno < docno_)
+	{
+		Index dn = m_args[ m_heap[ 0].argidx]->skipDocCandidate( docno_);
+		if (dn)
+		{
+			m_heap[ 0].docno = dn;
+			siftDown( 0);
+		}
+		else
+		{
+			popTop();
+		}
+	}
+	m_base = docno_;
+}
+
+void DocnoUnionHeap::collectSelected( utils::BitSet& selected)
+{
+	// The elements with the key of the top element form a subtree at the root of the heap:
+	Index top = m_heap[ 0].docno;
+	std::size_t nn = m_heap.size();
+	m_stack.clear();
+	m_stack.push_back( 0);
+	while (!m_stack.empty())
+	{
+		std::size_t hi = m_stack.back();
+		m_stack.pop_back();
+		selected.set( m_heap[ hi].argidx);
+
+		std::size_t ci = (hi << 1) + 1;
+		if (ci < nn && m_heap[ ci].docno == top) m_stack.push_back( ci);
+		if (ci+1 < nn && m_heap[ ci+1].docno == top) m_stack.push_back( ci+1);
+	}
+}
+
+Index DocnoUnionHeap::skipDocCandidate( const Index& docno_, utils::BitSet& selected)
+{
+	selected.reset();
+	if (!m_initialized || docno_ < m_base)
+	{
+		init( docno_);
+	}
+	else
+	{
+		advance( docno_);
+	}
+	if (m_heap.empty()) return 0;
+	collectSelected( selected);
+	return m_heap[ 0].docno;
+}
+
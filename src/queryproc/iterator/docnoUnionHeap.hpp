@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2014 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Binary heap of posting iterators keyed by their current document candidate, for unions with many arguments
+#ifndef _STRUS_DOCNO_UNION_HEAP_HPP_INCLUDED
+#define _STRUS_DOCNO_UNION_HEAP_HPP_INCLUDED
+#include "strus/index.hpp"
+#include "strus/reference.hpp"
+#include "strus/postingIteratorInterface.hpp"
+#include "private/utils.hpp"
+#include <vector>
+
+namespace strus
+{
+
+/// \brief Binary heap of posting iterators keyed by their current document candidate
+/// \remark For ascending skips only the arguments behind the document number skipped to are advanced and re-heaped, instead of scanning all arguments
+class DocnoUnionHeap
+{
+public:
+	typedef Reference< PostingIteratorInterface> PostingIteratorReference;
+
+	/// \brief Minimum number of arguments, for which a union uses the heap instead of a linear scan
+	enum {MinNofArguments=16};
+
+	/// \brief Constructor
+	/// \param[in] args_ argument posting iterators
+	explicit DocnoUnionHeap( const std::vector<PostingIteratorReference>& args_);
+	/// \brief Destructor
+	~DocnoUnionHeap(){}
+
+	/// \brief Find the least upper bound of all candidate matches of docno_
+	/// \param[in] docno_ the minimal document number
+	/// \param[out] selected set of the indices of the arguments positioned on the document returned
+	/// \return the upper bound or 0 if it does not exist
+	Index skipDocCandidate( const Index& docno_, utils::BitSet& selected);
+
+private:
+	/// \brief Element of the heap
+	struct Element
+	{
+		Index docno;			///< current document candidate of the argument
+		std::size_t argidx;		///< index of the argument
+
+		Element()
+			:docno(0),argidx(0){}
+		Element( const Index& docno_, std::size_t argidx_)
+			:docno(docno_),argidx(argidx_){}
+		Element( const Element& o)
+			:docno(o.docno),argidx(o.argidx){}
+	};
+
+	/// \brief Refill the heap with all arguments skipped to a document number
+	void init( const Index& docno_);
+	/// \brief Advance the arguments with a document candidate smaller than a document number
+	void advance( const Index& docno_);
+	/// \brief Restore the heap order for an element with a bigger key than before
+	void siftDown( std::size_t hi);
+	/// \brief Remove the top element of the heap
+	void popTop();
+	/// \brief Collect the arguments with the document candidate of the top element
+	void collectSelected( utils::BitSet& selected);
+
+private:
+	std::vector<PostingIteratorReference> m_args;	///< argument posting iterators
+	std::vector<Element> m_heap;			///< heap of arguments with a document candidate, ordered by document candidate
+	std::vector<std::size_t> m_stack;		///< buffer for traversing the heap when collecting the selected arguments
+	Index m_base;					///< document number of the last skip, all heap elements have a document candidate bigger or equal
+	bool m_initialized;				///< true, if the heap has been filled
+};
+
+}//namespace
+#endif
+
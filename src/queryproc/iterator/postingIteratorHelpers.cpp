@@ -37,7 +37,7 @@ struct IteratorDf
 	bool operator<( const IteratorDf& o) const
 	{
 		if (df == o.df) return argidx < o.argidx;
-		return df > o.df;
+		return df < o.df;
 	}
 };
 
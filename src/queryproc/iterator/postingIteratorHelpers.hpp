@@ -22,6 +22,8 @@ void encodeInteger( std::string& buf, int val);
 
 typedef Reference<PostingIteratorInterface> PostingIteratorReference;
 
+/// \brief Get the argument postings ordered by ascending document frequency (order of arguments with equal df preserved)
+/// \remark Joins matching all arguments are driven by the rarest argument, so that the fewest skips reach the postings with a high df
 std::vector<PostingIteratorReference>
 	orderByDocumentFrequency(
 		std::vector<PostingIteratorReference>::const_iterator ai,
@@ -19,13 +19,13 @@ using namespace strus;
 IteratorIntersect::IteratorIntersect( const std::vector<Reference< PostingIteratorInterface> >& args, ErrorBufferInterface* errorhnd_)
 	:m_docno(0)
 	,m_posno(0)
-	,m_argar(args)
+	,m_argar(orderByDocumentFrequency( args.begin(), args.end()))
 	,m_docnoAllMatchItr(args)
 	,m_documentFrequency(-1)
 	,m_errorhnd(errorhnd_)
 {
 	std::vector<Reference< PostingIteratorInterface> >::const_iterator
-		ai = m_argar.begin(), ae = m_argar.end();
+		ai = args.begin(), ae = args.end();
 	for (int aidx=0; ai != ae; ++ai,++aidx)
 	{
 		if (aidx) m_featureid.push_back('=');
@@ -92,6 +92,28 @@ Index IteratorIntersect::skipDoc( const Index& docno_)
 	return m_docno;
 }
 
+bool IteratorIntersect::skipDocBlock( const Index& docno_, Index* docnos, unsigned int* ffs, std::size_t maxsize, std::size_t& size)
+{
+	// ... a match of an intersection needs a common position of all arguments, so the
+	//	matches are checked one by one, but without a virtual call per document:
+	size = 0;
+	if (!maxsize) return true;
+	Index dn = IteratorIntersect::skipDoc( docno_);
+	while (dn)
+	{
+		docnos[ size] = dn;
+		if (ffs) ffs[ size] = frequency();
+		if (++size == maxsize) break;
+		dn = IteratorIntersect::skipDoc( dn+1);
+	}
+	if (!dn && size)
+	{
+		// ... position the iterator on the last match fetched
+		IteratorIntersect::skipDoc( docnos[ size-1]);
+	}
+	return true;
+}
+
 Index IteratorIntersectWithCardinality::skipDoc( const Index& docno_)
 {
 	Index next = m_docnoMatchPrioQueue.skipDocCandidate( docno_);
@@ -155,7 +177,7 @@ Index IteratorIntersectWithCardinality::skipPos( const Index& pos_)
 	else
 	{
 		DocnoMatchPrioQueue::CandidateList candiates = m_docnoMatchPrioQueue.getCandidateList();
-		m_positionWindow.init( candiates.ar, candiates.arsize, 0, m_cardinality, 0, PositionWindow::MaxWin);
+		m_positionWindow.init( candiates.ar.ptr(), candiates.arsize, 0, m_cardinality, 0, PositionWindow::MaxWin);
 		m_windowIsInitialized = true;
 		m_call_posno = 0;
 	}
@@ -34,6 +34,7 @@ public:
 	}
 	virtual Index skipDoc( const Index& docno_);
 	virtual Index skipDocCandidate( const Index& docno_);
+	virtual bool skipDocBlock( const Index& docno_, Index* docnos, unsigned int* ffs, std::size_t maxsize, std::size_t& size);
 	virtual Index skipPos( const Index& pos);
 
 	virtual Index documentFrequency() const;
@@ -53,7 +54,7 @@ public:
 private:
 	Index m_docno;							///< current document number
 	Index m_posno;							///< current position
-	std::vector<Reference< PostingIteratorInterface> > m_argar;	///< arguments
+	std::vector<Reference< PostingIteratorInterface> > m_argar;	///< arguments ordered by ascending df (position matching driven by the rarest)
 	DocnoAllMatchItr m_docnoAllMatchItr;				///< document all match joiner
 	std::string m_featureid;					///< unique id of the feature expression
 	mutable Index m_documentFrequency;				///< document frequency (of the rarest subexpression)
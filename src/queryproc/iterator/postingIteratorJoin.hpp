@@ -21,6 +21,12 @@ class IteratorJoin
 public:
 	virtual ~IteratorJoin(){}
 
+	virtual bool skipDocBlock( const Index&, Index*, unsigned int*, std::size_t, std::size_t&)
+	{
+		// ... fetching the matches one by one by the caller
+		return false;
+	}
+
 	virtual unsigned int frequency()
 	{
 		Index idx=0;
@@ -30,6 +36,19 @@ public:
 				++idx,++rt){}
 		return rt;
 	}
+
+	virtual Index skipBlockMax( const Index&, unsigned int& maxff)
+	{
+		// ... no block structure and no bound known for the frequency of joined postings
+		maxff = std::numeric_limits<unsigned int>::max();
+		return std::numeric_limits<Index>::max();
+	}
+
+	virtual unsigned int nofBlocksLoaded() const
+	{
+		// ... joins do not load blocks, only their arguments do
+		return 0;
+	}
 };
 
 }//namespace
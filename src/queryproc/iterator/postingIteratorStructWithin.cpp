@@ -10,6 +10,7 @@
 #include "strus/errorBufferInterface.hpp"
 #include "private/internationalization.hpp"
 #include "private/errorUtils.hpp"
+#include "private/smallArray.hpp"
 #include <stdexcept>
 #include <vector>
 #include <cstdlib>
@@ -40,11 +41,6 @@ IteratorStructWithin::IteratorStructWithin(
 	,m_documentFrequency(-1)
 	,m_errorhnd(errorhnd_)
 {
-	// Some integrity checks:
-	if (args.size() > MaxNofArguments)
-	{
-		throw strus::runtime_error(_TXT("too many arguments for '%s' join iterator"), "within");
-	}
 	// Create feature identifier string:
 	std::vector<Reference< PostingIteratorInterface> >::iterator
 		ai = m_argar.begin(), ae = m_argar.end();
@@ -108,14 +104,11 @@ struct WithinMatch
 struct WithinMatchArray
 {
 	WithinMatchArray()
-		:size(0){}
+		:ar(),size(0){}
 	WithinMatchArray( const WithinMatchArray& o)
-		:size(o.size)
-	{
-		std::memcpy( ar, o.ar, size * sizeof(*ar));
-	}
+		:ar(o.ar),size(o.size){}
 
-	WithinMatch ar[ IteratorStructWithin::MaxNofArguments];
+	SmallArray<WithinMatch,IteratorStructWithin::LocalNofArguments> ar;
 	std::size_t size;
 
 	std::string tostring() const
@@ -130,11 +123,12 @@ struct WithinMatchArray
 
 	void insert( const Index& pos, std::size_t argidx)
 	{
+		ar.resize( size+1);
 		std::size_t wi=0;
 		for (;wi<size && pos >= ar[wi].pos; ++wi){}
 		if (wi < size)
 		{
-			std::memmove( ar+wi+1, ar+wi, (size-wi)*sizeof(WithinMatch));
+			std::memmove( ar.ptr()+wi+1, ar.ptr()+wi, (size-wi)*sizeof(WithinMatch));
 		}
 		ar[wi].pos = pos;
 		ar[wi].argidx = argidx;
@@ -60,7 +60,7 @@ private:
 	Index positionCut( const Index& minpos, const Index& maxpos);
 
 public:
-	enum {MaxNofArguments=256};
+	enum {LocalNofArguments=64};					///< number of arguments handled without allocating memory, more arguments are possible
 private:
 	Index m_docno;							///< current document number
 	Index m_docno_cut;						///< next document number after m_docno that contains a cut element
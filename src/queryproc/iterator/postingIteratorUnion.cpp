@@ -21,6 +21,8 @@ IteratorUnion::IteratorUnion( const std::vector<Reference<PostingIteratorInterfa
 	,m_posno(0)
 	,m_argar(args_)
 	,m_selected(args_.size())
+	,m_heap()
+	,m_argblocks()
 	,m_documentFrequency(-1)
 	,m_errorhnd(errorhnd_)
 {
@@ -32,6 +34,10 @@ IteratorUnion::IteratorUnion( const std::vector<Reference<PostingIteratorInterfa
 		m_featureid.append( (*ai)->featureid());
 	}
 	m_featureid.push_back( 'U');
+	if (args_.size() >= (std::size_t)DocnoUnionHeap::MinNofArguments)
+	{
+		m_heap.reset( new DocnoUnionHeap( args_));
+	}
 }
 
 IteratorUnion::~IteratorUnion()
@@ -69,10 +75,14 @@ Index IteratorUnion::skipDocCandidate( const Index& docno_)
 	{
 		return m_docno;
 	}
+	Index base = docno_?docno_:1;
+	if (m_heap.get())
+	{
+		return m_docno = m_heap->skipDocCandidate( base, m_selected);
+	}
 	m_docno = docno_;
 	std::vector<Reference<PostingIteratorInterface> >::iterator
 		ai = m_argar.begin(), ae = m_argar.end();
-	Index base = docno_?docno_:1;
 	Index minimum = 0;
 
 	clearSelected();
@@ -115,10 +125,10 @@ Index IteratorUnion::skipDoc( const Index& docno_)
 		if (!docno_iter) return m_docno=0;
 
 		int si = m_selected.first(), se = -1;
-		for (unsigned int aidx=0; si != se; si=m_selected.next(si),++aidx)
+		for (; si != se; si=m_selected.next(si))
 		{
 			if (docno_iter == m_argar[si]->skipDoc( docno_iter)) break;
-			unsetSelected( aidx); //... because we break, when we found one, we might not unset all non matching candidates
+			unsetSelected( si); //... because we break, when we found one, we might not unset all non matching candidates
 		}
 		if (si == se && m_selected.empty())
 		{
@@ -130,6 +140,60 @@ Index IteratorUnion::skipDoc( const Index& docno_)
 	return m_docno = docno_iter;
 }
 
+bool IteratorUnion::skipDocBlock( const Index& docno_, Index* docnos, unsigned int* ffs, std::size_t maxsize, std::size_t& size)
+{
+	size = 0;
+	if (!maxsize) return true;
+	if (ffs || m_heap.get())
+	{
+		// ... the frequency of a union is counted on the positions of the current document and
+		//	unions with many arguments are faster with the heap, fetch the matches one by one:
+		Index dn = IteratorUnion::skipDoc( docno_);
+		while (dn)
+		{
+			docnos[ size] = dn;
+			if (ffs) ffs[ size] = frequency();
+			if (++size == maxsize) break;
+			dn = IteratorUnion::skipDoc( dn+1);
+		}
+		if (!dn && size)
+		{
+			// ... position the iterator on the last match fetched
+			IteratorUnion::skipDoc( docnos[ size-1]);
+		}
+		return true;
+	}
+	// Merge the matches of the arguments fetched block wise into their buffers:
+	if (m_argblocks.empty())
+	{
+		m_argblocks.reserve( m_argar.size());
+		std::vector<Reference<PostingIteratorInterface> >::const_iterator
+			ai = m_argar.begin(), ae = m_argar.end();
+		for (; ai != ae; ++ai)
+		{
+			m_argblocks.push_back( PostingBlockBuffer( ai->get()));
+		}
+	}
+	Index dn = docno_;
+	while (size < maxsize)
+	{
+		Index minimum = 0;
+		std::vector<PostingBlockBuffer>::iterator bi = m_argblocks.begin(), be = m_argblocks.end();
+		for (; bi != be; ++bi)
+		{
+			Index next = bi->skipDoc( dn);
+			if (next && (!minimum || next < minimum)) minimum = next;
+		}
+		if (!minimum) break;
+		docnos[ size++] = minimum;
+		dn = minimum+1;
+	}
+	// Position the union and its arguments on the last match fetched:
+	m_docno = 0;
+	if (size) IteratorUnion::skipDoc( docnos[ size-1]);
+	return true;
+}
+
 Index IteratorUnion::skipPos( const Index& pos_)
 {
 	int si = m_selected.first(), se = -1;
@@ -8,10 +8,12 @@
 #ifndef _STRUS_ITERATOR_UNION_HPP_INCLUDED
 #define _STRUS_ITERATOR_UNION_HPP_INCLUDED
 #include "postingIteratorJoin.hpp"
+#include "docnoUnionHeap.hpp"
 #include "strus/postingJoinOperatorInterface.hpp"
 #include "strus/reference.hpp"
 #include "strus/postingIteratorInterface.hpp"
 #include "private/utils.hpp"
+#include "private/postingBlockBuffer.hpp"
 #include "private/internationalization.hpp"
 #include <vector>
 
@@ -20,6 +22,8 @@ namespace strus
 /// \brief Forward declaration
 class ErrorBufferInterface;
 
+/// \brief Union of posting sets
+/// \remark Unions with few arguments scan all arguments on every step, unions with many arguments (e.g. synonym expansions) use a heap ordered by document candidate
 class IteratorUnion
 	:public IteratorJoin
 {
@@ -34,6 +38,7 @@ public:
 
 	virtual Index skipDoc( const Index& docno_);
 	virtual Index skipDocCandidate( const Index& docno_);
+	virtual bool skipDocBlock( const Index& docno_, Index* docnos, unsigned int* ffs, std::size_t maxsize, std::size_t& size);
 	virtual Index skipPos( const Index& pos_);
 
 	virtual Index documentFrequency() const;
@@ -85,6 +90,8 @@ private:
 	Index m_posno;							///< current position
 	std::vector<Reference<PostingIteratorInterface> > m_argar;	///< arguments
 	strus::utils::BitSet m_selected;
+	utils::SharedPtr<DocnoUnionHeap> m_heap;			///< heap of arguments for unions with many arguments, NULL if the arguments are scanned
+	std::vector<PostingBlockBuffer> m_argblocks;			///< buffers of the arguments for skipDocBlock, if the arguments are scanned
 	std::string m_featureid;					///< unique id of the feature expression
 	mutable Index m_documentFrequency;				///< document frequency (of the most frequent subexpression)
 	ErrorBufferInterface* m_errorhnd;				///< buffer for error messages
@@ -29,6 +29,11 @@ public:
 		return m_ref->skipDocCandidate( docno_);
 	}
 
+	virtual bool skipDocBlock( const Index& docno_, Index* docnos, unsigned int* ffs, std::size_t maxsize, std::size_t& size)
+	{
+		return m_ref->skipDocBlock( docno_, docnos, ffs, maxsize, size);
+	}
+
 	virtual Index skipPos( const Index& firstpos)
 	{
 		return m_ref->skipPos( firstpos);
@@ -49,6 +54,16 @@ public:
 		return m_ref->frequency();
 	}
 
+	virtual Index skipBlockMax( const Index& docno_, unsigned int& maxff)
+	{
+		return m_ref->skipBlockMax( docno_, maxff);
+	}
+
+	virtual unsigned int nofBlocksLoaded() const
+	{
+		return m_ref->nofBlocksLoaded();
+	}
+
 	virtual Index docno() const
 	{
 		return m_ref->docno();
@@ -46,6 +46,7 @@ SummarizerFunctionContextAccumulateNear::SummarizerFunctionContextAccumulateNear
 	,m_data(data_)
 	,m_nofCollectionDocuments(nofCollectionDocuments_)
 	,m_idfar()
+	,m_itrar(),m_structar(),m_normfactorar()
 	,m_itrarsize(0)
 	,m_structarsize(0)
 	,m_cardinality(data_->cardinality)
@@ -73,12 +74,12 @@ void SummarizerFunctionContextAccumulateNear::addSummarizationFeature(
 	{
 		if (utils::caseInsensitiveEquals( name, "struct"))
 		{
-			if (m_structarsize > MaxNofArguments) throw strus::runtime_error( "%s",  _TXT("number of structure features out of range"));
+			m_structar.resize( m_structarsize+1);
 			m_structar[ m_structarsize++] = itr;
 		}
 		else if (utils::caseInsensitiveEquals( name, "match"))
 		{
-			if (m_itrarsize > MaxNofArguments) throw strus::runtime_error( "%s",  _TXT("number of weighting features out of range"));
+			m_itrar.resize( m_itrarsize+1);
 
 			double df = termstats.documentFrequency()>=0?termstats.documentFrequency():(GlobalCounter)itr->documentFrequency();
 			double idf = logl( (m_nofCollectionDocuments - df + 0.5) / (df + 0.5));
@@ -148,6 +149,7 @@ void SummarizerFunctionContextAccumulateNear::initializeContext()
 	ProximityWeightAccumulator::proportionalAssignment( m_weightincr, 1.0, m_data->cprop, m_idfar);
 
 	double factor = 1.0;
+	m_normfactorar.resize( m_itrarsize);
 	for (std::size_t ii=0; ii<m_itrarsize; ++ii)
 	{
 		m_normfactorar[ ii] = factor / sqrt(m_itrarsize - ii);
@@ -224,11 +226,13 @@ double SummarizerFunctionContextAccumulateNear::candidateWeight( const Candidate
 void SummarizerFunctionContextAccumulateNear::initEntityMap( EntityMap& entitymap, const Index& docno)
 {
 	// Initialize posting iterators
-	PostingIteratorInterface* valid_itrar[ MaxNofArguments];	//< valid array if weighted features
-	PostingIteratorInterface* valid_structar[ MaxNofArguments];	//< valid array of end of structure elements
+	SmallArray<PostingIteratorInterface*,LocalNofArguments> valid_itrar_buf( m_itrarsize);		//< valid array if weighted features
+	SmallArray<PostingIteratorInterface*,LocalNofArguments> valid_structar_buf( m_structarsize);	//< valid array of end of structure elements
+	PostingIteratorInterface** valid_itrar = valid_itrar_buf.ptr();
+	PostingIteratorInterface** valid_structar = valid_structar_buf.ptr();
 	
-	callSkipDoc( docno, m_itrar, m_itrarsize, valid_itrar);
-	callSkipDoc( docno, m_structar, m_structarsize, valid_structar);
+	callSkipDoc( docno, m_itrar.ptr(), m_itrarsize, valid_itrar);
+	callSkipDoc( docno, m_structar.ptr(), m_structarsize, valid_structar);
 	m_forwardindex->skipDoc( docno);
 
 	// Fetch entities and weight them:
@@ -327,11 +331,13 @@ std::string SummarizerFunctionContextAccumulateNear::debugCall( const Index& doc
 	}
 
 	// Initialize posting iterators
-	PostingIteratorInterface* valid_itrar[ MaxNofArguments];	//< valid array if weighted features
-	PostingIteratorInterface* valid_structar[ MaxNofArguments];	//< valid array of end of structure elements
+	SmallArray<PostingIteratorInterface*,LocalNofArguments> valid_itrar_buf( m_itrarsize);		//< valid array if weighted features
+	SmallArray<PostingIteratorInterface*,LocalNofArguments> valid_structar_buf( m_structarsize);	//< valid array of end of structure elements
+	PostingIteratorInterface** valid_itrar = valid_itrar_buf.ptr();
+	PostingIteratorInterface** valid_structar = valid_structar_buf.ptr();
 	
-	callSkipDoc( docno, m_itrar, m_itrarsize, valid_itrar);
-	callSkipDoc( docno, m_structar, m_structarsize, valid_structar);
+	callSkipDoc( docno, m_itrar.ptr(), m_itrarsize, valid_itrar);
+	callSkipDoc( docno, m_structar.ptr(), m_structarsize, valid_structar);
 	m_forwardindex->skipDoc( docno);
 
 	// Fetch entities and print them with weight:
@@ -15,6 +15,7 @@
 #include "strus/summarizationVariable.hpp"
 #include "strus/reference.hpp"
 #include "private/internationalization.hpp"
+#include "private/smallArray.hpp"
 #include "proximityWeightAccumulator.hpp"
 #include <vector>
 #include <string>
@@ -113,12 +114,12 @@ private:
 	const QueryProcessorInterface* m_processor;			///< query processor interface for object creation
 	Reference<ForwardIteratorInterface>m_forwardindex;		///< forward index iterators for extracting features
 	Reference<AccumulateNearData> m_data;				///< parameters
-	enum {MaxNofArguments=256};
+	enum {LocalNofArguments=256};					///< number of arguments handled without allocating memory, more arguments are possible
 	double m_nofCollectionDocuments;				///< number of documents in the collection
 	ProximityWeightAccumulator::WeightArray m_idfar;		///< array of idfs
-	PostingIteratorInterface* m_itrar[ MaxNofArguments];		///< array if weighted features
-	PostingIteratorInterface* m_structar[ MaxNofArguments];		///< array of end of structure elements
-	double m_normfactorar[ MaxNofArguments];			///< normalization factor punishing missing features
+	SmallArray<PostingIteratorInterface*,LocalNofArguments> m_itrar;	///< array if weighted features
+	SmallArray<PostingIteratorInterface*,LocalNofArguments> m_structar;	///< array of end of structure elements
+	SmallArray<double,LocalNofArguments> m_normfactorar;		///< normalization factor punishing missing features
 	std::size_t m_itrarsize;					///< number of weighted features
 	std::size_t m_structarsize;					///< number of end of structure elements
 	unsigned int m_cardinality;					///< calculated cardinality
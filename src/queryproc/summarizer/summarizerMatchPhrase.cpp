@@ -46,6 +46,7 @@ SummarizerFunctionContextMatchPhrase::SummarizerFunctionContextMatchPhrase(
 	,m_forwardindex(storage_->createForwardIterator(parameter_->m_type))
 	,m_parameter(parameter_)
 	,m_nofCollectionDocuments(nofCollectionDocuments_)
+	,m_itrar(),m_structar()
 	,m_itrarsize(0)
 	,m_structarsize(0)
 	,m_paraarsize(0)
@@ -79,19 +80,19 @@ void SummarizerFunctionContextMatchPhrase::addSummarizationFeature(
 		}
 		else if (utils::caseInsensitiveEquals( name, "struct"))
 		{
-			if (m_paraarsize + m_structarsize > MaxNofArguments) throw strus::runtime_error( "%s",  _TXT("number of structure features out of range"));
+			m_structar.resize( m_structarsize + m_paraarsize + 1);
 			m_structar[ m_structarsize + m_paraarsize] = m_structar[ m_structarsize];
 			m_structar[ m_structarsize++] = itr;
 		}
 		else if (utils::caseInsensitiveEquals( name, "para"))
 		{
-			if (m_paraarsize + m_structarsize > MaxNofArguments) throw strus::runtime_error( "%s",  _TXT("number of structure features out of range"));
+			m_structar.resize( m_structarsize + m_paraarsize + 1);
 			m_structar[ m_structarsize + m_paraarsize] = itr;
 			m_paraarsize++;
 		}
 		else if (utils::caseInsensitiveEquals( name, "match"))
 		{
-			if (m_itrarsize > MaxNofArguments) throw strus::runtime_error( "%s",  _TXT("number of weighting features out of range"));
+			m_itrar.resize( m_itrarsize + 1);
 
 			double df = termstats.documentFrequency()>=0?termstats.documentFrequency():(GlobalCounter)itr->documentFrequency();
 			double idf = logl( (m_nofCollectionDocuments - df + 0.5) / (df + 0.5));
@@ -138,33 +139,33 @@ double SummarizerFunctionContextMatchPhrase::windowWeight(
 		ProximityWeightAccumulator::weight_same_sentence(
 			weightar, m_parameter->m_weight_same_sentence, m_weightincr,
 			window, windowsize,
-			wdata.valid_itrar, m_itrarsize,
+			wdata.valid_itrar.ptr(), m_itrarsize,
 			structframe);
 		ProximityWeightAccumulator::weight_invdist(
 			weightar, m_parameter->m_weight_invdist, m_weightincr,
 			window, windowsize,
-			wdata.valid_itrar, m_itrarsize);
+			wdata.valid_itrar.ptr(), m_itrarsize);
 	}
 	if (windowpos < 1000)
 	{
 		// Weight distance to start of document:
 		ProximityWeightAccumulator::weight_invpos(
 			weightar, m_parameter->m_weight_invpos_start, m_weightincr, 1,
-			window, windowsize, wdata.valid_itrar, m_itrarsize);
+			window, windowsize, wdata.valid_itrar.ptr(), m_itrarsize);
 	}
 	if (paraframe.first)
 	{
 		// Weight inv distance to paragraph start:
 		ProximityWeightAccumulator::weight_invpos(
 			weightar, m_parameter->m_weight_invpos_para, m_weightincr, paraframe.first,
-			window, windowsize, wdata.valid_itrar, m_itrarsize);
+			window, windowsize, wdata.valid_itrar.ptr(), m_itrarsize);
 	}
 	if (structframe.first)
 	{
 		// Weight inv distance to paragraph start:
 		ProximityWeightAccumulator::weight_invpos(
 			weightar, m_parameter->m_weight_invpos_struct, m_weightincr, structframe.first,
-			window, windowsize, wdata.valid_itrar, m_itrarsize);
+			window, windowsize, wdata.valid_itrar.ptr(), m_itrarsize);
 	}
 	weightar.multiply( m_idfar);
 	return weightar.sum();
@@ -292,7 +293,7 @@ SummarizerFunctionContextMatchPhrase::Match SummarizerFunctionContextMatchPhrase
 SummarizerFunctionContextMatchPhrase::Match
 	SummarizerFunctionContextMatchPhrase::findBestMatch( WeightingData& wdata)
 {
-	return findBestMatch_( wdata, m_cardinality, wdata.valid_itrar);
+	return findBestMatch_( wdata, m_cardinality, wdata.valid_itrar.ptr());
 }
 
 
@@ -328,14 +329,14 @@ void SummarizerFunctionContextMatchPhrase::fetchNoTitlePostings(
 SummarizerFunctionContextMatchPhrase::Match
 	SummarizerFunctionContextMatchPhrase::findBestMatchNoTitle( WeightingData& wdata)
 {
-	PostingIteratorInterface* noTitle_itrar[ MaxNofArguments];
+	SmallArray<PostingIteratorInterface*,LocalNofArguments> noTitle_itrar( m_itrarsize);
 	Index cntTitleTerms = 0;
 	Index cntNoTitleTerms = 0;
-	fetchNoTitlePostings( wdata, noTitle_itrar, cntTitleTerms, cntNoTitleTerms);
+	fetchNoTitlePostings( wdata, noTitle_itrar.ptr(), cntTitleTerms, cntNoTitleTerms);
 	if (cntNoTitleTerms)
 	{
 		unsigned int noTitleCardinality = m_cardinality > (unsigned int)cntTitleTerms ? (m_cardinality - cntTitleTerms) : 1;
-		return findBestMatch_( wdata, noTitleCardinality, noTitle_itrar);
+		return findBestMatch_( wdata, noTitleCardinality, noTitle_itrar.ptr());
 	}
 	else
 	{
@@ -346,14 +347,14 @@ SummarizerFunctionContextMatchPhrase::Match
 SummarizerFunctionContextMatchPhrase::Match
 	SummarizerFunctionContextMatchPhrase::logFindBestMatchNoTitle( std::ostream& out, WeightingData& wdata)
 {
-	PostingIteratorInterface* noTitle_itrar[ MaxNofArguments];
+	SmallArray<PostingIteratorInterface*,LocalNofArguments> noTitle_itrar( m_itrarsize);
 	Index cntTitleTerms = 0;
 	Index cntNoTitleTerms = 0;
-	fetchNoTitlePostings( wdata, noTitle_itrar, cntTitleTerms, cntNoTitleTerms);
+	fetchNoTitlePostings( wdata, noTitle_itrar.ptr(), cntTitleTerms, cntNoTitleTerms);
 	if (cntNoTitleTerms)
 	{
 		unsigned int noTitleCardinality = (Index)m_cardinality > cntTitleTerms ? (m_cardinality - cntTitleTerms) : 1;
-		return logFindBestMatch_( out, wdata, noTitleCardinality, noTitle_itrar);
+		return logFindBestMatch_( out, wdata, noTitleCardinality, noTitle_itrar.ptr());
 	}
 	else
 	{
@@ -385,7 +386,7 @@ SummarizerFunctionContextMatchPhrase::Match
 	SummarizerFunctionContextMatchPhrase::logFindAbstractMatch( std::ostream& out, WeightingData& wdata)
 {
 	out << _TXT("find best match with all features:") << std::endl;
-	Match rt = logFindBestMatch_( out, wdata, m_cardinality, wdata.valid_itrar);
+	Match rt = logFindBestMatch_( out, wdata, m_cardinality, wdata.valid_itrar.ptr());
 	if (!rt.isDefined() && m_titleitr)
 	{
 		//... we did not find a window with m_cardinality terms, so we try to find one
@@ -448,7 +449,7 @@ SummarizerFunctionContextMatchPhrase::Abstract
 			// .... heuristics for minimal size of abstract we want to show
 		}
 		Index nextparapos = callSkipPos( rt.start + rt.span, wdata.valid_paraar, m_paraarsize);
-		Index eospos = callSkipPos( rt.start + rt.span + minincr, wdata.valid_structar, m_structarsize + m_paraarsize);
+		Index eospos = callSkipPos( rt.start + rt.span + minincr, wdata.valid_structar.ptr(), m_structarsize + m_paraarsize);
 		if (eospos)
 		{
 			if (nextparapos && nextparapos <= eospos) eospos = nextparapos - 1;
@@ -499,7 +500,7 @@ SummarizerFunctionContextMatchPhrase::Abstract
 					break;
 				}
 			}
-			eoppos = callSkipPos( parapos+1, wdata.valid_structar, m_structarsize);
+			eoppos = callSkipPos( parapos+1, wdata.valid_structar.ptr(), m_structarsize);
 			if (eoppos && eoppos - parapos < MaxParaTitleSize)
 			{
 				if (eoppos >= phrase_match.pos)
@@ -553,7 +554,7 @@ std::string SummarizerFunctionContextMatchPhrase::getPhraseString( const Abstrac
 	Index pi = phrase_abstract.start, pe = phrase_abstract.start + phrase_abstract.span;
 	while (pi < pe)
 	{
-		std::pair<Index,Index> minpos = callSkipPosWithLen( pi, wdata.valid_itrar, m_itrarsize);
+		std::pair<Index,Index> minpos = callSkipPosWithLen( pi, wdata.valid_itrar.ptr(), m_itrarsize);
 		if (minpos.first && minpos.first < pe)
 		{
 			Index li = 0, le = minpos.second;
@@ -663,8 +664,8 @@ void SummarizerFunctionContextMatchPhrase::initializeContext()
 
 void SummarizerFunctionContextMatchPhrase::initWeightingData( WeightingData& wdata, const Index& docno)
 {
-	callSkipDoc( docno, m_itrar, m_itrarsize, wdata.valid_itrar);
-	callSkipDoc( docno, m_structar, m_structarsize + m_paraarsize, wdata.valid_structar);
+	callSkipDoc( docno, m_itrar.ptr(), m_itrarsize, wdata.valid_itrar.ptr());
+	callSkipDoc( docno, m_structar.ptr(), m_structarsize + m_paraarsize, wdata.valid_structar.ptr());
 
 	if (m_titleitr && m_titleitr->skipDoc( docno) == docno)
 	{
@@ -703,7 +704,7 @@ std::vector<SummaryElement>
 			return std::vector<SummaryElement>();
 		}
 		// Init document iterators:
-		WeightingData wdata( m_structarsize, m_paraarsize, m_parameter->m_sentencesize, m_parameter->m_paragraphsize);
+		WeightingData wdata( m_itrarsize, m_structarsize, m_paraarsize, m_parameter->m_sentencesize, m_parameter->m_paragraphsize);
 		initWeightingData( wdata, docno);
 
 		m_forwardindex->skipDoc( docno);
@@ -743,7 +744,7 @@ std::string SummarizerFunctionContextMatchPhrase::debugCall( const Index& docno)
 		return std::string();
 	}
 	// Init document iterators:
-	WeightingData wdata( m_structarsize, m_paraarsize, m_parameter->m_sentencesize, m_parameter->m_paragraphsize);
+	WeightingData wdata( m_itrarsize, m_structarsize, m_paraarsize, m_parameter->m_sentencesize, m_parameter->m_paragraphsize);
 	initWeightingData( wdata, docno);
 
 	m_forwardindex->skipDoc( docno);
@@ -13,6 +13,7 @@
 #include "strus/postingIteratorInterface.hpp"
 #include "strus/reference.hpp"
 #include "private/internationalization.hpp"
+#include "private/smallArray.hpp"
 #include "proximityWeightAccumulator.hpp"
 #include "structureIterator.hpp"
 #include <vector>
@@ -116,21 +117,22 @@ public:
 	virtual std::string debugCall( const Index& docno);
 
 public:
-	enum {MaxNofArguments=64};				///< chosen to fit in a bitfield of 64 bits
+	enum {LocalNofArguments=64};				///< number of arguments handled without allocating memory, more arguments are possible
 
 private:
 	struct WeightingData
 	{
-		explicit WeightingData( std::size_t structarsize_, std::size_t paraarsize_, const Index& structwindowsize_, const Index& parawindowsize_)
-			:titlestart(1),titleend(1)
+		WeightingData( std::size_t itrarsize_, std::size_t structarsize_, std::size_t paraarsize_, const Index& structwindowsize_, const Index& parawindowsize_)
+			:valid_itrar(itrarsize_),valid_structar(structarsize_+paraarsize_)
+			,titlestart(1),titleend(1)
 		{
-			valid_paraar = &valid_structar[ structarsize_];
+			valid_paraar = valid_structar.ptr() + structarsize_;
 			paraiter.init( parawindowsize_, valid_paraar, paraarsize_);
-			structiter.init( structwindowsize_, valid_structar, structarsize_);
+			structiter.init( structwindowsize_, valid_structar.ptr(), structarsize_);
 		}
 
-		PostingIteratorInterface* valid_itrar[ MaxNofArguments];	//< valid array if weighted features
-		PostingIteratorInterface* valid_structar[ MaxNofArguments];	//< valid array of end of structure elements
+		SmallArray<PostingIteratorInterface*,LocalNofArguments> valid_itrar;		//< valid array if weighted features
+		SmallArray<PostingIteratorInterface*,LocalNofArguments> valid_structar;	//< valid array of end of structure elements
 		PostingIteratorInterface** valid_paraar;			//< valid array of end of paragraph elements
 		Index titlestart;						//< start position of the title
 		Index titleend;							//< end position of the title (first item after the title)
@@ -211,8 +213,8 @@ private:
 	Reference<SummarizerFunctionParameterMatchPhrase> m_parameter;
 	double m_nofCollectionDocuments;			///< number of documents in the collection
 	ProximityWeightAccumulator::WeightArray m_idfar;	///< array of idfs
-	PostingIteratorInterface* m_itrar[ MaxNofArguments];	///< array if weighted features
-	PostingIteratorInterface* m_structar[ MaxNofArguments];	///< array of end of structure elements
+	SmallArray<PostingIteratorInterface*,LocalNofArguments> m_itrar;	///< array if weighted features
+	SmallArray<PostingIteratorInterface*,LocalNofArguments> m_structar;	///< array of end of structure elements
 	std::size_t m_itrarsize;				///< number of weighted features
 	std::size_t m_structarsize;				///< number of end of structure elements
 	std::size_t m_paraarsize;				///< number of paragraph elements (now summary accross paragraph borders)
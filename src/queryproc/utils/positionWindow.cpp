@@ -31,7 +31,8 @@ static printWindow( unsigned int nofelem, PostingIteratorInterface* itrar, Index
 #endif
 
 PositionWindow::PositionWindow()
-	:m_arsize(0)
+	:m_itrar(),m_window(),m_posar()
+	,m_arsize(0)
 	,m_range(0)
 	,m_cardinality(0)
 	,m_windowsize(0)
@@ -46,7 +47,8 @@ PositionWindow::PositionWindow(
 		unsigned int cardinality_,
 		Index firstpos_,
 		EvaluationType evaluationType_)
-	:m_isnew_bitset(0)
+	:m_itrar(),m_window(),m_posar()
+	,m_isnew_bitset(0)
 {
 	init( args, nofargs, range_, cardinality_, firstpos_, evaluationType_);
 }
@@ -66,16 +68,14 @@ void PositionWindow::init(
 	m_isnew_bitset = strus::utils::BitSet( nofargs);
 	m_evaluationType = evaluationType_;
 
-	if (nofargs > MaxNofArguments)
-	{
-		throw strus::runtime_error(_TXT("too many arguments for position window (max %u): %u"),
-						(unsigned int)MaxNofArguments, (unsigned int)nofargs);
-	}
 	if (nofargs == 0)
 	{
 		throw strus::runtime_error(_TXT("too few arguments for position window (min 1): %u"),
 						(unsigned int)nofargs);
 	}
+	m_itrar.resize( nofargs);
+	m_window.resize( nofargs);
+	m_posar.resize( nofargs);
 	std::size_t ai = 0, ae = nofargs;
 	for (; ai != ae; ++ai)
 	{
@@ -86,8 +86,8 @@ void PositionWindow::init(
 			// Insert element:
 			std::size_t pi = 0, pe = m_arsize;
 			for (; pi != pe && m_posar[pi] < wpos; ++pi){}
-			std::memmove( m_posar+pi+1, m_posar+pi, (pe-pi)*sizeof(Index));
-			std::memmove( m_window+pi+1, m_window+pi, (pe-pi)*sizeof(PostingIteratorInterface*));
+			std::memmove( m_posar.ptr()+pi+1, m_posar.ptr()+pi, (pe-pi)*sizeof(Index));
+			std::memmove( m_window.ptr()+pi+1, m_window.ptr()+pi, (pe-pi)*sizeof(std::size_t));
 			++m_arsize;
 			m_posar[ pi] = wpos;
 			m_window[ pi] = ai;
@@ -159,8 +159,8 @@ bool PositionWindow::advance( const Index& advancepos)
 		--m_arsize;
 		if (m_arsize)
 		{
-			std::memmove( &m_posar[0], &m_posar[1], m_arsize * sizeof(*m_posar));
-			std::memmove( &m_window[0], &m_window[1], m_arsize * sizeof(*m_window));
+			std::memmove( &m_posar[0], &m_posar[1], m_arsize * sizeof(Index));
+			std::memmove( &m_window[0], &m_window[1], m_arsize * sizeof(std::size_t));
 		}
 	}
 	// Return, if there is valid window left:
@@ -11,6 +11,7 @@
 #include "strus/postingIteratorInterface.hpp"
 #include "strus/base/stdint.h"
 #include "private/utils.hpp"
+#include "private/smallArray.hpp"
 
 namespace strus {
 
@@ -75,7 +76,7 @@ public:
 	/// \brief Return a pointer to the elements of the current window
 	const std::size_t* window() const
 	{
-		return m_windowsize?m_window:0;
+		return m_windowsize?m_window.ptr():0;
 	}
 
 	/// \brief Get a bitset that specifies what elements in the current window are new (not part of a previous window visited)
@@ -85,8 +86,8 @@ public:
 	}
 
 private:
-	/// \brief We use fixed size arrays and restrict the maximum number of features to a reasonable amount.
-	enum {MaxNofArguments=128};
+	/// \brief Number of features handled without allocating memory, more features are possible
+	enum {LocalNofArguments=128};
 
 	/// \brief Get the size of the current minimal window:
 	unsigned int getMinWinSize();
@@ -96,9 +97,9 @@ private:
 	bool advance( const Index& advancepos=0);
 
 private:
-	PostingIteratorInterface* m_itrar[ MaxNofArguments];	///< element iterators
-	std::size_t m_window[ MaxNofArguments];			///< window element references
-	Index m_posar[ MaxNofArguments];			///< element positions
+	SmallArray<PostingIteratorInterface*,LocalNofArguments> m_itrar;	///< element iterators
+	SmallArray<std::size_t,LocalNofArguments> m_window;			///< window element references
+	SmallArray<Index,LocalNofArguments> m_posar;				///< element positions
 	unsigned int m_arsize;					///< current number of elements
 	unsigned int m_range;					///< maximum proximity range
 	unsigned int m_cardinality;				///< number of elements for a candidate window
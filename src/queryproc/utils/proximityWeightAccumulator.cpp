@@ -83,7 +83,7 @@ void ProximityWeightAccumulator::weight_invdist(
 	PostingIteratorInterface** featar, std::size_t featarsize)
 {
 	std::size_t wi = 0;
-	Index win_pos[ MaxNofArguments];
+	SmallArray<Index,LocalNofArguments> win_pos( windowsize);
 
 	for (wi = 0; wi < windowsize; ++wi)
 	{
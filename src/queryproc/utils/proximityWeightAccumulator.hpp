@@ -10,6 +10,7 @@
 #include "positionWindow.hpp"
 #include "private/internationalization.hpp"
 #include "strus/base/string_format.hpp"
+#include "private/smallArray.hpp"
 #include <cstring>
 
 namespace strus {
@@ -20,35 +21,39 @@ class PostingIteratorInterface;
 class ProximityWeightAccumulator
 {
 public:
-	enum {MaxNofArguments=64};
+	enum {LocalNofArguments=64};	///< number of features handled without allocating memory, more features are possible
 
 	struct WeightArray
 	{
 		WeightArray()
-			:arsize(0){}
+			:ar(),arsize(0){}
 
 		explicit WeightArray( std::size_t arsize_, double initvalue)
+			:ar(),arsize(0)
 		{
 			init( arsize_, initvalue);
 		}
 		WeightArray( double* ar_, std::size_t arsize_)
+			:ar(),arsize(0)
 		{
 			init( ar_, arsize_);
 		}
+		WeightArray( const WeightArray& o)
+			:ar(o.ar),arsize(o.arsize){}
 
-		double ar[ MaxNofArguments];
+		SmallArray<double,LocalNofArguments> ar;
 		std::size_t arsize;
 
 		void init( double* ar_, std::size_t arsize_)
 		{
+			ar.resize( arsize_);
 			arsize = arsize_;
-			if (arsize_ > MaxNofArguments) throw strus::runtime_error( "number of features out of range");
-			std::memcpy( ar, ar_, arsize_ * sizeof( *ar));
+			std::memcpy( ar.ptr(), ar_, arsize_ * sizeof(double));
 		}
 		void init( std::size_t arsize_, double initvalue=0.0)
 		{
+			ar.resize( arsize_);
 			arsize = arsize_;
-			if (arsize_ > MaxNofArguments) throw strus::runtime_error( "number of features out of range");
 			for (std::size_t ai=0; ai<arsize; ++ai)
 			{
 				ar[ ai] = initvalue;
@@ -65,7 +70,7 @@ public:
 		}
 		void push( double value)
 		{
-			if (arsize > MaxNofArguments) throw strus::runtime_error( "number of features out of range");
+			ar.resize( arsize+1);
 			ar[ arsize++] = value;
 		}
 
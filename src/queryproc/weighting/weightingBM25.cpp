@@ -12,6 +12,7 @@
 #include "strus/constants.hpp"
 #include "strus/base/string_format.hpp"
 #include <cmath>
+#include <limits>
 #include <ctime>
 #include <iomanip>
 #include <iostream>
@@ -122,6 +123,78 @@ double WeightingFunctionContextBM25::call( const Index& docno)
 	return rt;
 }
 
+bool WeightingFunctionContextBM25::callBatch( double* weights, const Index* docnos, std::size_t nofDocnos)
+{
+	// Document length normalization evaluated on demand, but only once per document for all features:
+	m_doclenNormBuf.assign( nofDocnos, -1.0);
+	std::size_t di = 0;
+	for (; di != nofDocnos; ++di)
+	{
+		weights[ di] = 0.0;
+	}
+	std::vector<Feature>::const_iterator fi = m_featar.begin(), fe = m_featar.end();
+	for ( ;fi != fe; ++fi)
+	{
+		for (di = 0; di != nofDocnos; ++di)
+		{
+			if (docnos[ di] != fi->itr->skipDoc( docnos[ di])) continue;
+			double ff = fi->itr->frequency();
+			if (ff == 0.0) continue;
+
+			double& norm = m_doclenNormBuf[ di];
+			if (norm < 0.0)
+			{
+				if (m_parameter.b)
+				{
+					m_metadata->skipDoc( docnos[ di]);
+					double doclen = m_metadata->getValue( m_metadata_doclen);
+					double rel_doclen = (doclen+1) / m_parameter.avgDocLength;
+					norm = m_parameter.k1 * (1.0 - m_parameter.b + m_parameter.b * rel_doclen);
+				}
+				else
+				{
+					norm = m_parameter.k1 * 1.0;
+				}
+			}
+			weights[ di] += fi->weight * fi->idf
+					* (ff * (m_parameter.k1 + 1.0))
+					/ (ff + norm);
+		}
+	}
+	return true;
+}
+
+double WeightingFunctionContextBM25::maxFeatureWeight( const PostingIteratorInterface* itr_, unsigned int maxff) const
+{
+	if (!itr_) return 0.0;
+	if (m_parameter.k1 < 0.0 || m_parameter.b < 0.0 || m_parameter.b > 1.0)
+	{
+		// ... the saturation of the ff is only guaranteed for a non negative denominator
+		return std::numeric_limits<double>::infinity();
+	}
+	// ... ff / (ff + k1 * (1 - b + b * rel_doclen)) is always smaller than 1,
+	// with a bound for ff it is smaller than maxff / (maxff + k1 * (1 - b)):
+	double saturation = 1.0;
+	if (maxff == 0)
+	{
+		return 0.0;
+	}
+	else if (maxff != std::numeric_limits<unsigned int>::max())
+	{
+		saturation = (double)maxff / ((double)maxff + m_parameter.k1 * (1.0 - m_parameter.b));
+	}
+	double rt = 0.0;
+	std::vector<Feature>::const_iterator fi = m_featar.begin(), fe = m_featar.end();
+	for ( ;fi != fe; ++fi)
+	{
+		if (fi->itr == itr_ && fi->weight > 0.0)
+		{
+			rt += fi->weight * fi->idf * (m_parameter.k1 + 1.0) * saturation;
+		}
+	}
+	return rt;
+}
+
 std::string WeightingFunctionContextBM25::debugCall( const Index& docno)
 {
 	std::ostringstream out;
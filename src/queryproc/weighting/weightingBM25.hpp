@@ -78,6 +78,10 @@ public:
 
 	virtual double call( const Index& docno);
 
+	virtual bool callBatch( double* weights, const Index* docnos, std::size_t nofDocnos);
+
+	virtual double maxFeatureWeight( const PostingIteratorInterface* itr_, unsigned int maxff) const;
+
 	virtual std::string debugCall( const Index& docno);
 
 private:
@@ -89,6 +93,7 @@ private:
 	std::vector<Feature> m_featar;
 	MetaDataReaderInterface* m_metadata;
 	int m_metadata_doclen;
+	std::vector<double> m_doclenNormBuf;				///< buffer for the document length normalization of the documents in callBatch
 	ErrorBufferInterface* m_errorhnd;				///< buffer for error messages
 };
 
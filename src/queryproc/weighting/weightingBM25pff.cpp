@@ -13,6 +13,7 @@
 #include "strus/constants.hpp"
 #include "strus/base/string_format.hpp"
 #include <cmath>
+#include <limits>
 #include <ctime>
 #include <iomanip>
 #include <iostream>
@@ -32,10 +33,12 @@ WeightingFunctionContextBM25pff::WeightingFunctionContextBM25pff(
 	:m_parameter(parameter_)
 	,m_nofCollectionDocuments(nofCollectionDocuments_)
 	,m_cardinality(parameter_.cardinality)
+	,m_itrar(),m_structar()
 	,m_itrarsize(0)
 	,m_structarsize(0)
 	,m_paraarsize(0)
 	,m_nof_maxdf_features(0)
+	,m_relevantfeat()
 	,m_initialized(false)
 	,m_metadata(metadata_)
 	,m_metadata_doclen(metadata_->elementHandle( metadata_doclen_.empty()?std::string("doclen"):metadata_doclen_))
@@ -68,19 +71,20 @@ void WeightingFunctionContextBM25pff::addWeightingFeature(
 		}
 		else if (utils::caseInsensitiveEquals( name, "struct"))
 		{
-			if (m_structarsize + m_structarsize > MaxNofArguments) throw strus::runtime_error( "%s",  _TXT("number of structure features out of range"));
+			m_structar.resize( m_structarsize + m_paraarsize + 1);
 			m_structar[ m_structarsize + m_paraarsize] = m_structar[ m_structarsize];
 			m_structar[ m_structarsize++] = itr;
 		}
 		else if (utils::caseInsensitiveEquals( name, "para"))
 		{
-			if (m_paraarsize + m_structarsize > MaxNofArguments) throw strus::runtime_error( "%s",  _TXT("number of structure features out of range"));
+			m_structar.resize( m_structarsize + m_paraarsize + 1);
 			m_structar[ m_structarsize + m_paraarsize] = itr;
 			m_paraarsize++;
 		}
 		else if (utils::caseInsensitiveEquals( name, "match"))
 		{
-			if (m_itrarsize > MaxNofArguments) throw strus::runtime_error( "%s",  _TXT("number of weighting features out of range"));
+			m_itrar.resize( m_itrarsize + 1);
+			m_relevantfeat.resize( m_itrarsize + 1);
 
 			double df = termstats.documentFrequency()>=0?termstats.documentFrequency():(GlobalCounter)itr->documentFrequency();
 			double idf = std::log10( (m_nofCollectionDocuments - df + 0.5) / (df + 0.5));
@@ -190,32 +194,32 @@ void WeightingFunctionContextBM25pff::calcWindowWeight(
 	// Calculate the ff increment for the current window and add it to the result:
 	ProximityWeightAccumulator::weight_same_sentence(
 		result, m_parameter.weight_same_sentence, m_weightincr, window, windowsize,
-		wdata.valid_itrar, m_itrarsize,
+		wdata.valid_itrar.ptr(), m_itrarsize,
 		structframe);
 	ProximityWeightAccumulator::weight_invdist(
 		result, m_parameter.weight_invdist, m_weightincr, window, windowsize,
-		wdata.valid_itrar, m_itrarsize);
+		wdata.valid_itrar.ptr(), m_itrarsize);
 
 	if (windowpos < 1000)
 	{
 		// Weight distance to start of document:
 		ProximityWeightAccumulator::weight_invpos(
 			result, m_parameter.weight_invpos_start, m_weightincr, 1,
-			window, windowsize, wdata.valid_itrar, m_itrarsize);
+			window, windowsize, wdata.valid_itrar.ptr(), m_itrarsize);
 	}
 	if (paraframe.first)
 	{
 		// Weight inv distance to paragraph start:
 		ProximityWeightAccumulator::weight_invpos(
 			result, m_parameter.weight_invpos_para, m_weightincr, paraframe.first,
-			window, windowsize, wdata.valid_itrar, m_itrarsize);
+			window, windowsize, wdata.valid_itrar.ptr(), m_itrarsize);
 	}
 	if (structframe.first)
 	{
 		// Weight inv distance to paragraph start:
 		ProximityWeightAccumulator::weight_invpos(
 			result, m_parameter.weight_invpos_struct, m_weightincr, structframe.first,
-			window, windowsize, wdata.valid_itrar, m_itrarsize);
+			window, windowsize, wdata.valid_itrar.ptr(), m_itrarsize);
 	}
 }
 
@@ -225,7 +229,7 @@ void WeightingFunctionContextBM25pff::calcProximityFfIncrements(
 {
 	Index lastEndPos = 0;
 	unsigned int lastElementCnt = 0;
-	PositionWindow poswin( wdata.valid_itrar, m_itrarsize, m_parameter.windowsize, m_cardinality,
+	PositionWindow poswin( wdata.valid_itrar.ptr(), m_itrarsize, m_parameter.windowsize, m_cardinality,
 				1U/*firstpos*/, PositionWindow::MaxWin);
 	bool more = poswin.first();
 	for (;more; more = poswin.next())
@@ -259,7 +263,7 @@ void WeightingFunctionContextBM25pff::logCalcProximityFfIncrements(
 {
 	Index lastEndPos = 0;
 	unsigned int lastElementCnt = 0;
-	PositionWindow poswin( wdata.valid_itrar, m_itrarsize, m_parameter.windowsize, m_cardinality,
+	PositionWindow poswin( wdata.valid_itrar.ptr(), m_itrarsize, m_parameter.windowsize, m_cardinality,
 				1U/*firstpos*/, PositionWindow::MaxWin);
 	bool more = poswin.first();
 	for (;more; more = poswin.next())
@@ -319,8 +323,8 @@ void WeightingFunctionContextBM25pff::initializeContext()
 
 void WeightingFunctionContextBM25pff::initWeightingData( WeightingData& wdata, const Index& docno)
 {
-	callSkipDoc( docno, m_itrar, m_itrarsize, wdata.valid_itrar);
-	callSkipDoc( docno, m_structar, m_structarsize + m_paraarsize, wdata.valid_structar);
+	callSkipDoc( docno, m_itrar.ptr(), m_itrarsize, wdata.valid_itrar.ptr());
+	callSkipDoc( docno, m_structar.ptr(), m_structarsize + m_paraarsize, wdata.valid_structar.ptr());
 	m_metadata->skipDoc( docno);
 	wdata.doclen = m_metadata->getValue( m_metadata_doclen);
 }
@@ -402,6 +406,26 @@ double WeightingFunctionContextBM25pff::call( const Index& docno)
 	CATCH_ERROR_ARG1_MAP_RETURN( _TXT("error calling weighting function '%s': %s"), METHOD_NAME, *m_errorhnd, 0.0);
 }
 
+double WeightingFunctionContextBM25pff::maxFeatureWeight( const PostingIteratorInterface* itr_, unsigned int) const
+{
+	if (!itr_) return 0.0;
+	if (m_parameter.k1 < 0.0 || m_parameter.b < 0.0 || m_parameter.b > 1.0)
+	{
+		return std::numeric_limits<double>::infinity();
+	}
+	// Structure and title features contribute only with ff increments to the features weighted:
+	double rt = 0.0;
+	std::size_t fi = 0;
+	for (; fi != m_itrarsize; ++fi)
+	{
+		if (m_itrar[ fi] == itr_ && m_idfar[ fi] > 0.0)
+		{
+			rt += m_idfar[ fi] * (m_parameter.k1 + 1.0);
+		}
+	}
+	return rt;
+}
+
 std::string WeightingFunctionContextBM25pff::debugCall( const Index& docno)
 {
 	if (m_itrarsize == 0) return std::string();
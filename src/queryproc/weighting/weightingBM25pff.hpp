@@ -17,6 +17,7 @@
 #include "strus/postingIteratorInterface.hpp"
 #include "private/internationalization.hpp"
 #include "private/utils.hpp"
+#include "private/smallArray.hpp"
 #include "proximityWeightAccumulator.hpp"
 #include "structureIterator.hpp"
 #include <vector>
@@ -99,24 +100,32 @@ public:
 
 	virtual double call( const Index& docno);
 
+	virtual bool callBatch( double*, const Index*, std::size_t)
+	{
+		return false;// ... no batch weighting implemented, call( const Index&) is used
+	}
+
+	virtual double maxFeatureWeight( const PostingIteratorInterface* itr_, unsigned int maxff) const;
+
 	virtual std::string debugCall( const Index& docno);
 
 public:
-	enum {MaxNofArguments=64};				///< maximum number of arguments fix because of extensive use of fixed size arrays
+	enum {LocalNofArguments=64};				///< number of arguments handled without allocating memory, more arguments are possible
 
 private:
 	struct WeightingData
 	{
 		WeightingData( std::size_t itrarsize_, std::size_t structarsize_, std::size_t paraarsize_, const Index& structwindowsize_, const Index& parawindowsize_)
-			:doclen(0),titlestart(1),titleend(1),ffincrar( itrarsize_,0.0)
+			:valid_itrar(itrarsize_),valid_structar(structarsize_+paraarsize_)
+			,doclen(0),titlestart(1),titleend(1),ffincrar( itrarsize_,0.0)
 		{
-			valid_paraar = &valid_structar[ structarsize_];
+			valid_paraar = valid_structar.ptr() + structarsize_;
 			paraiter.init( parawindowsize_, valid_paraar, paraarsize_);
-			structiter.init( structwindowsize_, valid_structar, structarsize_);
+			structiter.init( structwindowsize_, valid_structar.ptr(), structarsize_);
 		}
 
-		PostingIteratorInterface* valid_itrar[ MaxNofArguments];	//< valid array if weighted features
-		PostingIteratorInterface* valid_structar[ MaxNofArguments];	//< valid array of end of structure elements
+		SmallArray<PostingIteratorInterface*,LocalNofArguments> valid_itrar;		//< valid array if weighted features
+		SmallArray<PostingIteratorInterface*,LocalNofArguments> valid_structar;	//< valid array of end of structure elements
 		PostingIteratorInterface** valid_paraar;			//< valid array of end of paragraph elements
 		double doclen;							//< length of the document
 		Index titlestart;						//< start position of the title
@@ -149,13 +158,13 @@ private:
 	double m_nofCollectionDocuments;			///< number of documents in the collection
 	unsigned int m_cardinality;				///< calculated cardinality
 	ProximityWeightAccumulator::WeightArray m_idfar;	///< array of idfs
-	PostingIteratorInterface* m_itrar[ MaxNofArguments];	///< array if weighted features
-	PostingIteratorInterface* m_structar[ MaxNofArguments];	///< array of end of structure elements
+	SmallArray<PostingIteratorInterface*,LocalNofArguments> m_itrar;	///< array if weighted features
+	SmallArray<PostingIteratorInterface*,LocalNofArguments> m_structar;	///< array of end of structure elements
 	std::size_t m_itrarsize;				///< number of weighted features
 	std::size_t m_structarsize;				///< number of end of structure elements
 	std::size_t m_paraarsize;				///< number of paragraph elements (now summary accross paragraph borders)
 	std::size_t m_nof_maxdf_features;			///< number of features with a df bigger than maximum
-	bool m_relevantfeat[ MaxNofArguments];			///< marker for features with a df smaller than maxdf
+	SmallArray<bool,LocalNofArguments> m_relevantfeat;	///< marker for features with a df smaller than maxdf
 	ProximityWeightAccumulator::WeightArray m_weightincr;	///< array of proportional weight increments 
 	bool m_initialized;					///< true, if the structures have already been initialized
 	MetaDataReaderInterface* m_metadata;			///< meta data reader
@@ -81,6 +81,52 @@ double WeightingFunctionContextConstant::call( const Index& docno)
 	return rt;
 }
 
+bool WeightingFunctionContextConstant::callBatch( double* weights, const Index* docnos, std::size_t nofDocnos)
+{
+	std::size_t di = 0;
+	if (m_precalc)
+	{
+		for (; di != nofDocnos; ++di)
+		{
+			std::map<Index,double>::const_iterator mi = m_precalcmap.find( docnos[ di]);
+			weights[ di] = (mi != m_precalcmap.end()) ? mi->second : 0.0;
+		}
+	}
+	else
+	{
+		for (; di != nofDocnos; ++di)
+		{
+			weights[ di] = 0.0;
+		}
+		std::vector<Feature>::const_iterator fi = m_featar.begin(), fe = m_featar.end();
+		for (;fi != fe; ++fi)
+		{
+			for (di = 0; di != nofDocnos; ++di)
+			{
+				if (docnos[ di]==fi->itr->skipDoc( docnos[ di]))
+				{
+					weights[ di] += fi->weight * m_weight;
+				}
+			}
+		}
+	}
+	return true;
+}
+
+double WeightingFunctionContextConstant::maxFeatureWeight( const PostingIteratorInterface* itr_, unsigned int) const
+{
+	double rt = 0.0;
+	std::vector<Feature>::const_iterator fi = m_featar.begin(), fe = m_featar.end();
+	for (;fi != fe; ++fi)
+	{
+		if (fi->itr == itr_ && fi->weight * m_weight > 0.0)
+		{
+			rt += fi->weight * m_weight;
+		}
+	}
+	return rt;
+}
+
 std::string WeightingFunctionContextConstant::debugCall( const Index& docno)
 {
 	std::ostringstream out;
@@ -58,6 +58,10 @@ public:
 
 	virtual double call( const Index& docno);
 
+	virtual bool callBatch( double* weights, const Index* docnos, std::size_t nofDocnos);
+
+	virtual double maxFeatureWeight( const PostingIteratorInterface* itr_, unsigned int maxff) const;
+
 	virtual std::string debugCall( const Index& docno);
 
 private:
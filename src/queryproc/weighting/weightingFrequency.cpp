@@ -16,6 +16,7 @@
 #include <iomanip>
 #include <iostream>
 #include <sstream>
+#include <limits>
 
 using namespace strus;
 
@@ -60,6 +61,46 @@ double WeightingFunctionContextTermFrequency::call( const Index& docno)
 	return rt;
 }
 
+bool WeightingFunctionContextTermFrequency::callBatch( double* weights, const Index* docnos, std::size_t nofDocnos)
+{
+	std::size_t di = 0;
+	for (; di != nofDocnos; ++di)
+	{
+		weights[ di] = 0.0;
+	}
+	std::vector<Feature>::const_iterator fi = m_featar.begin(), fe = m_featar.end();
+	for (;fi != fe; ++fi)
+	{
+		for (di = 0; di != nofDocnos; ++di)
+		{
+			if (docnos[ di]==fi->itr->skipDoc( docnos[ di]))
+			{
+				weights[ di] += fi->weight * fi->itr->frequency();
+			}
+		}
+	}
+	return true;
+}
+
+double WeightingFunctionContextTermFrequency::maxFeatureWeight( const PostingIteratorInterface* itr_, unsigned int maxff) const
+{
+	double rt = 0.0;
+	std::vector<Feature>::const_iterator fi = m_featar.begin(), fe = m_featar.end();
+	for (;fi != fe; ++fi)
+	{
+		if (fi->itr == itr_ && fi->weight > 0.0)
+		{
+			if (maxff == std::numeric_limits<unsigned int>::max())
+			{
+				// ... the ff has no upper bound
+				return std::numeric_limits<double>::infinity();
+			}
+			rt += fi->weight * maxff;
+		}
+	}
+	return rt;
+}
+
 std::string WeightingFunctionContextTermFrequency::debugCall( const Index& docno)
 {
 	std::ostringstream out;
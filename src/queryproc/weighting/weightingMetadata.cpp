@@ -16,6 +16,7 @@
 #include <iomanip>
 #include <iostream>
 #include <sstream>
+#include <limits>
 
 using namespace strus;
 
@@ -57,6 +58,23 @@ double WeightingFunctionContextMetadata::call( const Index& docno)
 	return m_weight * (double)m_metadata->getValue( m_elementHandle);
 }
 
+bool WeightingFunctionContextMetadata::callBatch( double* weights, const Index* docnos, std::size_t nofDocnos)
+{
+	std::size_t di = 0;
+	for (; di != nofDocnos; ++di)
+	{
+		m_metadata->skipDoc( docnos[ di]);
+		weights[ di] = m_weight * (double)m_metadata->getValue( m_elementHandle);
+	}
+	return true;
+}
+
+double WeightingFunctionContextMetadata::maxFeatureWeight( const PostingIteratorInterface* itr_, unsigned int) const
+{
+	if (itr_ || m_weight == 0.0) return 0.0;
+	return std::numeric_limits<double>::infinity();
+}
+
 std::string WeightingFunctionContextMetadata::debugCall( const Index& docno)
 {
 	std::ostringstream out;
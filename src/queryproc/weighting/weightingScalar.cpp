@@ -21,6 +21,7 @@
 #include <sstream>
 #include <iostream>
 #include <iomanip>
+#include <limits>
 
 #define METHOD_NAME "scalar"
 #define NOF_IMPLICIT_ARGUMENTS 1
@@ -87,6 +88,12 @@ double WeightingFunctionContextScalar::call( const Index& docno)
 	return m_func->call( param, nofParam);
 }
 
+double WeightingFunctionContextScalar::maxFeatureWeight( const PostingIteratorInterface*, unsigned int) const
+{
+	// ... the scalar function result is not bounded
+	return std::numeric_limits<double>::infinity();
+}
+
 std::string WeightingFunctionContextScalar::debugCall( const Index& docno)
 {
 	std::ostringstream out;
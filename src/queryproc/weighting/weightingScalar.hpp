@@ -61,6 +61,13 @@ public:
 
 	virtual double call( const Index& docno);
 
+	virtual bool callBatch( double*, const Index*, std::size_t)
+	{
+		return false;// ... no batch weighting implemented, call( const Index&) is used
+	}
+
+	virtual double maxFeatureWeight( const PostingIteratorInterface* itr_, unsigned int maxff) const;
+
 	virtual std::string debugCall( const Index& docno);
 
 public:
@@ -21,6 +21,7 @@
 #include <sstream>
 #include <iostream>
 #include <iomanip>
+#include <limits>
 
 #define METHOD_NAME "SMART"
 #define NOF_IMPLICIT_ARGUMENTS 4
@@ -114,6 +115,12 @@ double WeightingFunctionContextSmart::call( const Index& docno)
 	return rt;
 }
 
+double WeightingFunctionContextSmart::maxFeatureWeight( const PostingIteratorInterface*, unsigned int) const
+{
+	// ... the scalar function result is not bounded and it is also called for features not occurring in the document
+	return std::numeric_limits<double>::infinity();
+}
+
 std::string WeightingFunctionContextSmart::debugCall( const Index& docno)
 {
 	std::ostringstream out;
@@ -0,0 +1,185 @@
+/*
+ * Copyright (c) 2014 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#include "aclBitmapCache.hpp"
+#include "databaseAdapter.hpp"
+#include "booleanBlock.hpp"
+#include <cstring>
+
+using namespace strus;
+
+AclBitmap::~AclBitmap()
+{
+	std::vector<uint64_t*>::iterator ci = m_chunks.begin(), ce = m_chunks.end();
+	for (; ci != ce; ++ci)
+	{
+		if (*ci) delete [] *ci;
+	}
+}
+
+uint64_t* AclBitmap::chunk( std::size_t ci)
+{
+	if (ci >= m_chunks.size())
+	{
+		m_chunks.resize( ci+1, 0);
+		m_fullChunks.resize( ci+1, false);
+	}
+	if (!m_chunks[ ci])
+	{
+		uint64_t* chk = new uint64_t[ ChunkNofWords];
+		std::memset( chk, 0, ChunkNofWords * sizeof(uint64_t));
+		m_chunks[ ci] = chk;
+		++m_nofChunksAllocated;
+	}
+	return m_chunks[ ci];
+}
+
+void AclBitmap::setRange( const Index& from, const Index& to)
+{
+	std::size_t dn = from, de = (std::size_t)to + 1;
+	while (dn < de)
+	{
+		uint64_t* chk = chunk( dn >> ChunkShift);
+		std::size_t widx = (dn & (ChunkSize-1)) >> 6;
+		std::size_t bitidx = dn & 63;
+		std::size_t nofbits = 64 - bitidx;
+		if (nofbits > de - dn) nofbits = de - dn;
+		uint64_t mask = (nofbits == 64) ? ~(uint64_t)0 : ((((uint64_t)1 << nofbits) - 1) << bitidx);
+		chk[ widx] |= mask;
+		dn += nofbits;
+	}
+}
+
+void AclBitmap::compress()
+{
+	std::size_t ci = 0, ce = m_chunks.size();
+	for (; ci != ce; ++ci)
+	{
+		uint64_t* chk = m_chunks[ ci];
+		if (!chk) continue;
+		std::size_t widx = 0;
+		for (; widx != ChunkNofWords && chk[ widx] == ~(uint64_t)0; ++widx){}
+		if (widx == ChunkNofWords)
+		{
+			// ... all documents of the chunk are members, the chunk memory is not needed
+			delete [] chk;
+			m_chunks[ ci] = 0;
+			m_fullChunks[ ci] = true;
+			--m_nofChunksAllocated;
+		}
+	}
+}
+
+/// \brief Get the index of the lowest bit set in a word that is not 0
+static inline Index firstBit( uint64_t word)
+{
+	Index rt = 0;
+	if (!(word & (uint64_t)0xffffffffU)) {rt += 32; word >>= 32;}
+	if (!(word & (uint64_t)0xffffU)) {rt += 16; word >>= 16;}
+	if (!(word & (uint64_t)0xffU)) {rt += 8; word >>= 8;}
+	if (!(word & (uint64_t)0xfU)) {rt += 4; word >>= 4;}
+	if (!(word & (uint64_t)0x3U)) {rt += 2; word >>= 2;}
+	if (!(word & (uint64_t)0x1U)) {rt += 1;}
+	return rt;
+}
+
+Index AclBitmap::skip( const Index& docno) const
+{
+	std::size_t ci = (std::size_t)docno >> ChunkShift, ce = m_chunks.size();
+	std::size_t widx = ((std::size_t)docno & (ChunkSize-1)) >> 6;
+	uint64_t mask = ~(uint64_t)0 << (docno & 63);
+	for (; ci < ce; ++ci,widx=0,mask=~(uint64_t)0)
+	{
+		if (m_fullChunks[ ci])
+		{
+			return (Index)((ci << ChunkShift) + (widx << 6)) + firstBit( mask);
+		}
+		const uint64_t* chk = m_chunks[ ci];
+		if (!chk) continue;
+		for (; widx != ChunkNofWords; ++widx,mask=~(uint64_t)0)
+		{
+			uint64_t word = chk[ widx] & mask;
+			if (word)
+			{
+				return (Index)((ci << ChunkShift) + (widx << 6)) + firstBit( word);
+			}
+		}
+	}
+	return 0;
+}
+
+std::size_t AclBitmap::memoryUsage() const
+{
+	return m_nofChunksAllocated * ChunkNofWords * sizeof(uint64_t)
+		+ m_chunks.size() * sizeof(uint64_t*)
+		+ m_fullChunks.size() / 8 + sizeof(*this);
+}
+
+void AclBitmap::load( const DatabaseClientInterface* database, const Index& userno)
+{
+	DatabaseAdapter_UserAclBlock::Cursor dbadapter( database, userno, false);
+	BooleanBlock blk;
+	bool more = dbadapter.loadFirst( blk);
+	for (; more; more = dbadapter.loadNext( blk))
+	{
+		BooleanBlock::NodeCursor cursor;
+		Index from = 0;
+		Index to = 0;
+		bool hasRange = blk.getFirstRange( cursor, from, to);
+		for (; hasRange; hasRange = blk.getNextRange( cursor, from, to))
+		{
+			setRange( from, to);
+		}
+	}
+	compress();
+}
+
+utils::SharedPtr<const AclBitmap> AclBitmapCache::get( const Index& userno)
+{
+	unsigned int generation;
+	{
+		utils::ScopedLock lock( m_mutex);
+		Map::const_iterator mi = m_map.find( userno);
+		if (mi != m_map.end()) return mi->second;
+		generation = m_generation;
+	}
+	// Build the bitmap without holding the lock, reading the database may take a while:
+	AclBitmap* bitmap = new AclBitmap();
+	utils::SharedPtr<const AclBitmap> rt( bitmap);
+	bitmap->load( m_database, userno);
+	std::size_t memoryUsage = bitmap->memoryUsage();
+	{
+		utils::ScopedLock lock( m_mutex);
+		if (generation != m_generation)
+		{
+			// ... the access rights changed while building the bitmap, it is not cached but still valid for the caller that started before the change
+			return rt;
+		}
+		if (m_memoryUsage + memoryUsage > MaxMemoryUsage)
+		{
+			// ... cache full, start again
+			m_map.clear();
+			m_memoryUsage = 0;
+			if (memoryUsage > MaxMemoryUsage) return rt;
+		}
+		std::pair<Map::iterator,bool> ins = m_map.insert( Map::value_type( userno, rt));
+		if (ins.second)
+		{
+			m_memoryUsage += memoryUsage;
+		}
+		return ins.first->second;
+	}
+}
+
+void AclBitmapCache::invalidate()
+{
+	utils::ScopedLock lock( m_mutex);
+	m_map.clear();
+	m_memoryUsage = 0;
+	++m_generation;
+}
+
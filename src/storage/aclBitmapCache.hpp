@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2014 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Cache of the sets of documents users are allowed to see as bitmaps
+/// \file "aclBitmapCache.hpp"
+#ifndef _STRUS_STORAGE_ACL_BITMAP_CACHE_HPP_INCLUDED
+#define _STRUS_STORAGE_ACL_BITMAP_CACHE_HPP_INCLUDED
+#include "strus/index.hpp"
+#include "private/utils.hpp"
+#include <vector>
+#include <map>
+#include <cstddef>
+#include <stdint.h>
+
+namespace strus {
+
+/// \brief Forward declaration
+class DatabaseClientInterface;
+
+/// \brief Set of documents a user is allowed to see as bitmap
+/// \remark Compressed in chunks of 64K documents: chunks without any member are not allocated and chunks with all documents as member share no memory
+class AclBitmap
+{
+public:
+	AclBitmap()
+		:m_chunks(),m_fullChunks(),m_nofChunksAllocated(0){}
+	~AclBitmap();
+
+	/// \brief Build the bitmap of the documents a user is allowed to see from the storage
+	/// \param[in] database database client to read the ACL blocks from
+	/// \param[in] userno number of the user
+	void load( const DatabaseClientInterface* database, const Index& userno);
+
+	/// \brief Add a range of documents to the set
+	/// \param[in] from first document of the range
+	/// \param[in] to last document of the range
+	void setRange( const Index& from, const Index& to);
+	/// \brief Compress the bitmap after all documents have been added
+	void compress();
+
+	/// \brief Test if a document is a member of the set
+	bool test( const Index& docno) const
+	{
+		std::size_t ci = (std::size_t)docno >> ChunkShift;
+		if (ci >= m_chunks.size()) return false;
+		if (m_fullChunks[ ci]) return true;
+		const uint64_t* chk = m_chunks[ ci];
+		if (!chk) return false;
+		return (chk[ ((std::size_t)docno & (ChunkSize-1)) >> 6] & ((uint64_t)1 << (docno & 63))) != 0;
+	}
+
+	/// \brief Get the smallest member of the set bigger than or equal to docno
+	/// \return the document number found or 0, if there is none
+	Index skip( const Index& docno) const;
+
+	/// \brief Get the number of bytes allocated for the bitmap
+	std::size_t memoryUsage() const;
+
+private:
+	AclBitmap( const AclBitmap&){}		//... non copyable
+	void operator=( const AclBitmap&){}	//... non copyable
+
+	enum {
+		ChunkShift=16,				///< number of bits needed to address a document inside a chunk
+		ChunkSize=(1<<ChunkShift),		///< number of documents covered by a chunk
+		ChunkNofWords=(ChunkSize/64)		///< number of 64 bit words of a chunk
+	};
+	uint64_t* chunk( std::size_t ci);
+
+private:
+	std::vector<uint64_t*> m_chunks;		///< chunks of the bitmap, NULL for chunks without any member or for full chunks
+	std::vector<bool> m_fullChunks;			///< flags marking chunks with all documents as members
+	std::size_t m_nofChunksAllocated;		///< number of chunks allocated
+};
+
+/// \brief Cache of the bitmaps of the documents users are allowed to see, built on demand and invalidated with every transaction changing access rights
+class AclBitmapCache
+{
+public:
+	explicit AclBitmapCache( const DatabaseClientInterface* database_)
+		:m_database(database_),m_map(),m_generation(0),m_memoryUsage(0){}
+	~AclBitmapCache(){}
+
+	/// \brief Get the bitmap of a user, build it if it is not cached yet
+	/// \param[in] userno number of the user
+	/// \return the bitmap (shared with the cache)
+	utils::SharedPtr<const AclBitmap> get( const Index& userno);
+
+	/// \brief Invalidate all bitmaps (called after a commit of a transaction changing access rights)
+	void invalidate();
+
+private:
+	enum {
+		MaxMemoryUsage=(256*1024*1024)	///< maximum number of bytes used by the bitmaps cached
+	};
+	typedef std::map<Index,utils::SharedPtr<const AclBitmap> > Map;
+
+	const DatabaseClientInterface* m_database;	///< database to read the ACL blocks from
+	utils::Mutex m_mutex;				///< mutual exclusion for the access of the map
+	Map m_map;					///< map of users to their bitmaps
+	unsigned int m_generation;			///< counter of invalidations, for not inserting bitmaps built from data invalidated while building them
+	std::size_t m_memoryUsage;			///< number of bytes used by the bitmaps cached
+};
+
+}//namespace
+#endif
+
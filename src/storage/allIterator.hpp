@@ -8,6 +8,7 @@
 #ifndef _STRUS_STORAGE_ALL_ITERATOR_HPP_INCLUDED
 #define _STRUS_STORAGE_ALL_ITERATOR_HPP_INCLUDED
 #include "strus/postingIteratorInterface.hpp"
+#include <limits>
 
 namespace strus {
 
@@ -42,6 +43,11 @@ public:
 		return skipDocImpl( docno_);
 	}
 
+	virtual bool skipDocBlock( const Index&, Index*, unsigned int*, std::size_t, std::size_t&)
+	{
+		return false;
+	}
+
 	virtual Index skipPos( const Index& posno_)
 	{
 		return 0;
@@ -52,6 +58,17 @@ public:
 		return 0;
 	}
 
+	virtual Index skipBlockMax( const Index&, unsigned int& maxff)
+	{
+		maxff = 0;
+		return std::numeric_limits<Index>::max();
+	}
+
+	virtual unsigned int nofBlocksLoaded() const
+	{
+		return 0;
+	}
+
 	virtual Index documentFrequency() const
 	{
 		return m_maxDocno;
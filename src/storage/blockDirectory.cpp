@@ -0,0 +1,184 @@
+/*
+ * Copyright (c) 2014 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Directories of the blocks of a term (or of any other block domain) for selecting blocks without a seek in the key/value store
+/// \file "blockDirectory.cpp"
+#include "blockDirectory.hpp"
+#include "private/internationalization.hpp"
+#include <algorithm>
+
+using namespace strus;
+
+void BlockDirectory::load( const DatabaseClientInterface* database, char prefix, const BlockKey& domainKey)
+{
+	// ... the blocks are not copied by the cursor, only the ids are read from the keys
+	DatabaseAdapter_DataBlock::Cursor cursor( prefix, database, domainKey, false);
+	DataBlock blk;
+	bool more = cursor.loadFirst( blk);
+	for (; more; more = cursor.loadNext( blk))
+	{
+		if (!m_ar.empty() && m_ar.back() >= blk.id())
+		{
+			throw strus::runtime_error( "%s", _TXT( "corrupt index (block ids not ascending)"));
+		}
+		m_ar.push_back( blk.id());
+	}
+	std::vector<Index>( m_ar).swap( m_ar);	//... shrink to fit
+}
+
+Index BlockDirectory::upperBound( const Index& elemno) const
+{
+	std::vector<Index>::const_iterator ai = std::lower_bound( m_ar.begin(), m_ar.end(), elemno);
+	return (ai == m_ar.end()) ? 0 : *ai;
+}
+
+utils::SharedPtr<const BlockDirectory> BlockDirectoryCache::get( char prefix, const BlockKey& domainKey, unsigned int& generation_)
+{
+	Key key( prefix, domainKey.index());
+	{
+		utils::ScopedLock lock( m_mutex);
+		generation_ = m_generation.value();
+		Map::iterator mi = m_map.find( key);
+		if (mi != m_map.end())
+		{
+			m_lru.splice( m_lru.begin(), m_lru, mi->second.lruitr);
+			return mi->second.directory;
+		}
+	}
+	// Build the directory without holding the lock, reading the database may take a while:
+	BlockDirectory* directory = new BlockDirectory();
+	utils::SharedPtr<const BlockDirectory> rt( directory);
+	directory->load( m_database, prefix, domainKey);
+	std::size_t memoryUsage = directory->memoryUsage();
+	{
+		utils::ScopedLock lock( m_mutex);
+		if (generation_ != m_generation.value())
+		{
+			// ... blocks were written while building the directory, it is not cached and gets replaced by its user with the next block loaded
+			return rt;
+		}
+		if (memoryUsage > m_maxMemoryUsage)
+		{
+			// ... does not fit into the cache
+			return rt;
+		}
+		Map::iterator mi = m_map.find( key);
+		if (mi != m_map.end())
+		{
+			// ... built concurrently by another thread
+			return mi->second.directory;
+		}
+		while (m_memoryUsage + memoryUsage > m_maxMemoryUsage && !m_lru.empty())
+		{
+			// ... evict the least recently used directories
+			removeEntry( m_map.find( m_lru.back()));
+		}
+		m_lru.push_front( key);
+		m_map.insert( Map::value_type( key, Entry( rt, m_lru.begin())));
+		m_memoryUsage += memoryUsage;
+	}
+	return rt;
+}
+
+void BlockDirectoryCache::removeEntry( Map::iterator mi)
+{
+	m_memoryUsage -= mi->second.directory->memoryUsage();
+	m_lru.erase( mi->second.lruitr);
+	m_map.erase( mi);
+}
+
+void BlockDirectoryCache::invalidate( const std::vector<Key>& keys)
+{
+	utils::ScopedLock lock( m_mutex);
+	std::vector<Key>::const_iterator ki = keys.begin(), ke = keys.end();
+	for (; ki != ke; ++ki)
+	{
+		Map::iterator mi = m_map.find( *ki);
+		if (mi != m_map.end()) removeEntry( mi);
+	}
+	m_generation.increment();
+}
+
+bool BlockDirectoryCursor::readDirectoryBlock( const Index& blkid, DataBlock& blk)
+{
+	if (!m_blockCache) return m_reader.load( blkid, blk);
+
+	m_dbkey.resize( m_domainKeySize);
+	m_dbkey.addElem( blkid);
+	DataBlockCache::Key key( m_dbkey.ptr(), m_dbkey.size());
+	DataBlockCache::BlockRef ref = m_blockCache->get( key);
+	if (!ref.get())
+	{
+		unsigned int generation_ = m_blockCache->generation();
+		DataBlock* newblk = new DataBlock();
+		DataBlockCache::BlockRef newref( newblk);
+		if (!m_reader.load( blkid, *newblk)) return false;
+		ref = m_blockCache->insert( key, newref, generation_);
+	}
+	// ... the block loaded refers to the memory of the block in the cache, kept alive by m_blockRef:
+	blk.init( ref->id(), ref->ptr(), ref->size());
+	m_blockRef = ref;
+	return true;
+}
+
+bool BlockDirectoryCursor::loadDirectoryBlock( const Index& blkid, DataBlock& blk)
+{
+	m_blkid = 0;
+	if (!blkid) return false;
+	if (!readDirectoryBlock( blkid, blk))
+	{
+		// ... the directory is outdated (blocks rewritten after it was built), continue without it
+		m_directory.reset();
+		m_cache = 0;
+		return false;
+	}
+	m_blkid = blkid;
+	++m_nofBlocksRead;
+	return true;
+}
+
+const BlockDirectory* BlockDirectoryCursor::directory()
+{
+	if (m_cache && (!m_directory.get() || m_generation != m_cache->generation()))
+	{
+		m_directory = m_cache->get( m_prefix, m_domainKey, m_generation);
+	}
+	return m_directory.get();
+}
+
+bool BlockDirectoryCursor::loadUpperBound( const Index& elemno, DataBlock& blk)
+{
+	const BlockDirectory* dir = directory();
+	if (dir)
+	{
+		Index blkid = dir->upperBound( elemno);
+		if (!blkid) return false;
+		if (loadDirectoryBlock( blkid, blk)) return true;
+	}
+	if (!m_cursor.loadUpperBound( elemno, blk)) return false;
+	m_blockRef.reset();
+	return true;
+}
+
+bool BlockDirectoryCursor::loadNext( DataBlock& blk)
+{
+	if (m_blkid)
+	{
+		Index prev_blkid = m_blkid;
+		const BlockDirectory* dir = directory();
+		if (dir)
+		{
+			Index blkid = dir->upperBound( prev_blkid+1);
+			if (!blkid) return false;
+			if (loadDirectoryBlock( blkid, blk)) return true;
+		}
+		if (!m_cursor.loadUpperBound( prev_blkid+1, blk)) return false;
+	}
+	else if (!m_cursor.loadNext( blk)) return false;
+	m_blockRef.reset();
+	return true;
+}
@@ -0,0 +1,205 @@
+/*
+ * Copyright (c) 2014 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Directories of the blocks of a term (or of any other block domain) for selecting blocks without a seek in the key/value store
+/// \file "blockDirectory.hpp"
+#ifndef _STRUS_STORAGE_BLOCK_DIRECTORY_HPP_INCLUDED
+#define _STRUS_STORAGE_BLOCK_DIRECTORY_HPP_INCLUDED
+#include "strus/index.hpp"
+#include "private/utils.hpp"
+#include "dataBlock.hpp"
+#include "blockKey.hpp"
+#include "databaseAdapter.hpp"
+#include "databaseKey.hpp"
+#include "dataBlockCache.hpp"
+#include <vector>
+#include <list>
+#include <map>
+#include <utility>
+#include <cstddef>
+
+namespace strus {
+
+/// \brief Forward declaration
+class DatabaseClientInterface;
+
+/// \brief Ascending array of the ids of all blocks of a domain (e.g. the posinfo blocks of a term)
+/// \remark The id of a block is the upper bound of the element numbers (docno) in the block, so the block containing an element is the one with the smallest id bigger than or equal to it
+class BlockDirectory
+{
+public:
+	BlockDirectory()
+		:m_ar(){}
+
+	/// \brief Load the ids of all blocks of a domain from the storage
+	/// \param[in] database database client to read the keys of the blocks from
+	/// \param[in] prefix key prefix of the block type (DatabaseKey::KeyPrefix)
+	/// \param[in] domainKey key of the domain (e.g. [typeno,termno])
+	void load( const DatabaseClientInterface* database, char prefix, const BlockKey& domainKey);
+
+	/// \brief Get the id of the block that contains the element elemno, if it exists
+	/// \return the smallest block id bigger than or equal to elemno or 0, if there is none
+	Index upperBound( const Index& elemno) const;
+
+	/// \brief Get the number of blocks
+	std::size_t size() const					{return m_ar.size();}
+	/// \brief Get the number of bytes used by the directory
+	std::size_t memoryUsage() const					{return sizeof(*this) + m_ar.capacity() * sizeof(Index);}
+
+private:
+	BlockDirectory( const BlockDirectory&){}		//... non copyable
+	void operator=( const BlockDirectory&){}		//... non copyable
+
+private:
+	std::vector<Index> m_ar;				///< ascending block ids
+};
+
+/// \brief Cache of the block directories of a storage client, built on demand, with least recently used eviction and invalidated per domain by transactions writing blocks of it
+/// \remark Only the transactions of the storage client owning the cache invalidate its directories
+class BlockDirectoryCache
+{
+public:
+	/// \brief Key of a block domain in the cache [prefix,domainKey]
+	typedef std::pair<char,BlockKeyIndex> Key;
+	enum {
+		DefaultMaxMemoryUsage=(16*1024*1024)	///< default maximum number of bytes used by the directories cached
+	};
+
+	/// \param[in] database_ database to read the block keys from
+	/// \param[in] maxMemoryUsage_ maximum number of bytes used by the directories cached
+	BlockDirectoryCache( const DatabaseClientInterface* database_, std::size_t maxMemoryUsage_)
+		:m_database(database_),m_map(),m_lru(),m_generation(0),m_memoryUsage(0),m_maxMemoryUsage(maxMemoryUsage_){}
+	~BlockDirectoryCache(){}
+
+	/// \brief Get the directory of a block domain, build it if it is not cached yet
+	/// \param[in] prefix key prefix of the block type (DatabaseKey::KeyPrefix)
+	/// \param[in] domainKey key of the domain (e.g. [typeno,termno])
+	/// \param[out] generation_ generation of the cache the directory returned is valid for
+	/// \return the directory (shared with the cache)
+	utils::SharedPtr<const BlockDirectory> get( char prefix, const BlockKey& domainKey, unsigned int& generation_);
+
+	/// \brief Get the current generation of the cache, incremented with every invalidation
+	/// \remark Users holding a directory of an older generation have to get it again from the cache, because it might be invalidated
+	unsigned int generation() const					{return m_generation.value();}
+
+	/// \brief Invalidate the directories of a list of domains (called after a commit of a transaction writing blocks of them)
+	/// \param[in] keys list of the domains with blocks written
+	void invalidate( const std::vector<Key>& keys);
+
+private:
+	struct Entry
+	{
+		utils::SharedPtr<const BlockDirectory> directory;
+		std::list<Key>::iterator lruitr;
+
+		Entry( const utils::SharedPtr<const BlockDirectory>& directory_, const std::list<Key>::iterator& lruitr_)
+			:directory(directory_),lruitr(lruitr_){}
+		Entry( const Entry& o)
+			:directory(o.directory),lruitr(o.lruitr){}
+	};
+	typedef std::map<Key,Entry> Map;
+
+	void removeEntry( Map::iterator mi);
+
+private:
+	const DatabaseClientInterface* m_database;	///< database to read the block keys from
+	utils::Mutex m_mutex;				///< mutual exclusion for the access of the cache
+	Map m_map;					///< map of domains to their directories
+	std::list<Key> m_lru;				///< domains cached, most recently used first
+	utils::AtomicCounter<unsigned int> m_generation; ///< counter of invalidations, for not inserting directories built from data invalidated while building them and for the detection of outdated directories held
+	std::size_t m_memoryUsage;			///< number of bytes used by the directories cached
+	std::size_t m_maxMemoryUsage;			///< maximum number of bytes used by the directories cached
+};
+
+/// \brief Cursor on the blocks of a domain selecting the blocks with a directory from the cache and reading them with a point read
+/// \remark Gets the directory again from the cache, if the cache was invalidated by a transaction since it got it. Falls back to seeks with a database cursor if there is no cache or if the directory does not match the blocks stored
+/// \remark The blocks selected with the directory are taken from the data block cache, if defined. The block loaded refers then to the memory of the block in the cache, that is kept alive by the cursor until the next block is loaded
+class BlockDirectoryCursor
+{
+public:
+	/// \param[in] cache_ cache of the block directories or NULL, if the blocks are read with seeks only
+	/// \param[in] blockCache_ cache of the blocks selected with the directory or NULL, if every block is read from the database
+	BlockDirectoryCursor( BlockDirectoryCache* cache_, DataBlockCache* blockCache_, char prefix_, const DatabaseClientInterface* database_, const BlockKey& domainKey_, bool useCache_)
+		:m_cache(cache_)
+		,m_blockCache(blockCache_)
+		,m_prefix(prefix_)
+		,m_domainKey(domainKey_)
+		,m_directory()
+		,m_generation(0)
+		,m_reader(prefix_,database_,domainKey_,useCache_)
+		,m_cursor(prefix_,database_,domainKey_,useCache_)
+		,m_blockRef()
+		,m_dbkey(prefix_,domainKey_)
+		,m_domainKeySize(0)
+		,m_blkid(0)
+		,m_nofBlocksRead(0)
+	{
+		m_domainKeySize = m_dbkey.size();
+	}
+
+	/// \brief Load the block with the smallest id bigger than or equal to elemno
+	bool loadUpperBound( const Index& elemno, DataBlock& blk);
+	/// \brief Load the block following the one loaded last
+	bool loadNext( DataBlock& blk);
+
+	/// \brief Evaluate if the last block was selected with the directory
+	/// \remark If true, loadUpperBound for a far away element costs not more than loadNext, because no blocks in between have to be read
+	bool directorySelected() const				{return m_blkid != 0;}
+
+	/// \brief Get the number of blocks loaded with this cursor
+	unsigned int nofBlocksLoaded() const			{return m_cursor.nofBlocksLoaded() + m_nofBlocksRead;}
+
+private:
+	bool loadDirectoryBlock( const Index& elemno, DataBlock& blk);
+	bool readDirectoryBlock( const Index& blkid, DataBlock& blk);
+	const BlockDirectory* directory();
+
+private:
+	BlockDirectoryCache* m_cache;				///< cache of the block directories or NULL
+	DataBlockCache* m_blockCache;				///< cache of the blocks or NULL
+	char m_prefix;						///< key prefix of the block type
+	BlockKey m_domainKey;					///< key of the domain
+	utils::SharedPtr<const BlockDirectory> m_directory;	///< directory of the domain, requested with the first block loaded
+	unsigned int m_generation;				///< generation of the cache m_directory is valid for
+	DatabaseAdapter_DataBlock::Reader m_reader;		///< reader for point reads of the blocks selected with the directory
+	DatabaseAdapter_DataBlock::Cursor m_cursor;		///< cursor for the seeks without directory
+	DataBlockCache::BlockRef m_blockRef;			///< handle of the block in the cache the block loaded last refers to
+	DatabaseKey m_dbkey;					///< buffer for the database key of a block
+	std::size_t m_domainKeySize;				///< size of the database key of the domain (prefix of all block keys)
+	Index m_blkid;						///< id of the block loaded last with the directory, 0 if the last block was loaded with m_cursor
+	unsigned int m_nofBlocksRead;				///< number of blocks loaded with a point read
+};
+
+/// \brief BlockDirectoryCursor for a typed data block
+template <class DataBlockType>
+class TypedBlockDirectoryCursor
+	:public BlockDirectoryCursor
+{
+public:
+	TypedBlockDirectoryCursor( BlockDirectoryCache* cache_, DataBlockCache* blockCache_, char prefix_, const DatabaseClientInterface* database_, const BlockKey& domainKey_, bool useCache_)
+		:BlockDirectoryCursor(cache_,blockCache_,prefix_,database_,domainKey_,useCache_){}
+
+	bool loadUpperBound( const Index& elemno, DataBlockType& blk)
+	{
+		DataBlock blk_;
+		if (!BlockDirectoryCursor::loadUpperBound( elemno, blk_)) return false;
+		blk.swap( blk_);
+		return true;
+	}
+
+	bool loadNext( DataBlockType& blk)
+	{
+		DataBlock blk_;
+		if (!BlockDirectoryCursor::loadNext( blk_)) return false;
+		blk.swap( blk_);
+		return true;
+	}
+};
+
+}//namespace
+#endif
+
@@ -20,7 +20,8 @@ class BooleanBlock
 {
 public:
 	enum {
-		MaxBlockSize=1024
+		MaxBlockSize=1024,		///< size of the blocks of rare terms and of sets not related to terms
+		MaxAdaptiveBlockSize=8192	///< upper limit of the size of the document list blocks of frequent terms
 	};
 
 public:
@@ -76,9 +77,15 @@ public:
 	void defineElement( const Index& elemno);
 	void defineRange( const Index& elemno, const Index& rangesize);
 
-	bool full() const
+	bool full( std::size_t maxBlockSize_=MaxBlockSize) const
 	{
-		return size() >= MaxBlockSize;
+		return size() >= maxBlockSize_;
+	}
+
+	/// \brief Get the size of the document list blocks to write for a term with a given document frequency
+	static std::size_t blockSizeForDf( const Index& df)
+	{
+		return DataBlock::adaptiveBlockSize( MaxBlockSize, MaxAdaptiveBlockSize, df);
 	}
 
 	/// \brief Check if the address 'elemno_', if it exists, is in this block.
@@ -18,7 +18,8 @@ void BooleanBlockBatchWrite::insertNewElements(
 		const std::vector<BooleanBlock::MergeRange>::iterator& ee,
 		BooleanBlock& newblk,
 		const Index& lastInsertBlockId,
-		DatabaseTransactionInterface* transaction)
+		DatabaseTransactionInterface* transaction,
+		std::size_t maxBlockSize)
 {
 	if (ei == ee)
 	{
@@ -32,7 +33,7 @@ void BooleanBlockBatchWrite::insertNewElements(
 	{
 		Index blockid = lastInsertBlockId;
 		std::vector<BooleanBlock::MergeRange>::iterator bi = ei;
-		for (std::size_t mm = newblk.size(); ei != ee && mm < BooleanBlock::MaxBlockSize; ++ei)
+		for (std::size_t mm = newblk.size(); ei != ee && mm < maxBlockSize; ++ei)
 		{
 			// ... estimate block size approximately
 			if (ei->isMember)
@@ -70,7 +71,8 @@ void BooleanBlockBatchWrite::mergeNewElements(
 		std::vector<BooleanBlock::MergeRange>::iterator& ei,
 		const std::vector<BooleanBlock::MergeRange>::iterator& ee,
 		BooleanBlock& newblk,
-		DatabaseTransactionInterface* transaction)
+		DatabaseTransactionInterface* transaction,
+		std::size_t maxBlockSize)
 {
 	BooleanBlock blk;
 	while (ei != ee && dbadapter->loadUpperBound( ei->from, blk))
@@ -106,7 +108,7 @@ void BooleanBlockBatchWrite::mergeNewElements(
 		}
 		else
 		{
-			if (newblk.full())
+			if (newblk.full( maxBlockSize))
 			{
 				// ... it is not the last block, but full, so we store it and start with a new one
 				dbadapter->store( transaction, newblk);
@@ -125,7 +127,7 @@ void BooleanBlockBatchWrite::mergeNewElements(
 		// block and dispose the last block:
 		if (ei != ee && dbadapter->loadLast( blk))
 		{
-			if (!blk.full())
+			if (!blk.full( maxBlockSize))
 			{
 				dbadapter->remove( transaction, blk.id());
 				newblk.swap( blk);
@@ -29,14 +29,16 @@ public:
 			const std::vector<BooleanBlock::MergeRange>::iterator& ee,
 			BooleanBlock& newblk,
 			const Index& lastInsertBlockId,
-			DatabaseTransactionInterface* transaction);
+			DatabaseTransactionInterface* transaction,
+			std::size_t maxBlockSize=BooleanBlock::MaxBlockSize);
 
 	static void mergeNewElements(
 			DatabaseAdapter_BooleanBlock::WriteCursor* dbadapter,
 			std::vector<BooleanBlock::MergeRange>::iterator& ei,
 			const std::vector<BooleanBlock::MergeRange>::iterator& ee,
 			BooleanBlock& newblk,
-			DatabaseTransactionInterface* transaction);
+			DatabaseTransactionInterface* transaction,
+			std::size_t maxBlockSize=BooleanBlock::MaxBlockSize);
 };
 
 }//namespace
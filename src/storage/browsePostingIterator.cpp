@@ -27,13 +27,24 @@ Index BrowsePostingIterator::skipDoc( const Index& docno_)
 {
 	Index dn = (docno_ == 0) ? 1 : docno_;
 	if (dn < 0 || dn > m_maxdocno) return m_docno = 0;
-	while (!m_restriction->match( dn))
-	{
-		++dn;
-		if (dn > m_maxdocno) return m_docno = 0;
-	}
+	dn = m_restriction->skipDoc( dn);
+	if (dn > m_maxdocno) return m_docno = 0;
 	return m_docno = dn;
 }
 
-
+bool BrowsePostingIterator::skipDocBlock( const Index& docno_, Index* docnos, unsigned int* ffs, std::size_t maxsize, std::size_t& size)
+{
+	size = 0;
+	Index dn = (docno_ == 0) ? 1 : docno_;
+	if (dn < 0) return true;
+	for (; size < maxsize && dn <= m_maxdocno; ++size,++dn)
+	{
+		dn = m_restriction->skipDoc( dn);
+		if (!dn || dn > m_maxdocno) break;
+		docnos[ size] = dn;
+		if (ffs) ffs[ size] = m_maxposno;
+	}
+	m_docno = size ? docnos[ size-1] : 0;
+	return true;
+}
 
@@ -12,6 +12,7 @@
 #include "strus/reference.hpp"
 #include "strus/index.hpp"
 #include <string>
+#include <limits>
 
 namespace strus {
 
@@ -35,6 +36,7 @@ public:
 	}
 
 	virtual Index skipDoc( const Index& docno_);
+	virtual bool skipDocBlock( const Index& docno_, Index* docnos, unsigned int* ffs, std::size_t maxsize, std::size_t& size);
 
 	virtual Index skipDocCandidate( const Index& docno_)
 	{
@@ -54,6 +56,18 @@ public:
 		return m_maxposno;
 	}
 
+	virtual Index skipBlockMax( const Index&, unsigned int& maxff)
+	{
+		maxff = m_maxposno;
+		return std::numeric_limits<Index>::max();
+	}
+
+	virtual unsigned int nofBlocksLoaded() const
+	{
+		// ... meta data blocks are read through the meta data block cache and not counted
+		return 0;
+	}
+
 	virtual Index documentFrequency() const
 	{
 		return m_maxdocno;
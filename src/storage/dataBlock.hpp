@@ -11,12 +11,17 @@
 #include "private/internationalization.hpp"
 #include <cstdlib>
 #include <stdexcept>
+#include <limits>
 
 namespace strus {
 
 /// \class DataBlock
 class DataBlock
 {
+public:
+	/// \brief Document frequency from which on the posting blocks of a term get bigger (see adaptiveBlockSize(std::size_t,std::size_t,const Index&))
+	enum {AdaptiveDfThreshold=4096};
+
 public:
 	explicit DataBlock()
 		:m_id(0),m_ptr(0),m_size(0),m_allocsize(0)
@@ -49,6 +54,23 @@ public:
 	}
 	void swap( DataBlock& o);
 
+	/// \brief Get the maximum size of the posting blocks of a term chosen adaptively from its document frequency
+	/// \param[in] minsize block size for terms with a document frequency below AdaptiveDfThreshold
+	/// \param[in] maxsize upper limit of the block size
+	/// \param[in] df document frequency of the term
+	/// \remark The block size doubles with every quadrupling of the df above the threshold, so that the number of blocks of a term grows only with the square root of its df
+	static std::size_t adaptiveBlockSize( std::size_t minsize, std::size_t maxsize, const Index& df)
+	{
+		std::size_t rt = minsize;
+		Index limit = AdaptiveDfThreshold;
+		while (df >= limit && rt < maxsize && limit < (std::numeric_limits<Index>::max() >> 2))
+		{
+			rt <<= 1;
+			limit <<= 2;
+		}
+		return rt < maxsize ? rt : maxsize;
+	}
+
 	void clear()			{m_size=0;}
 	bool empty() const		{return !m_size;}
 	Index id() const		{return m_id;}
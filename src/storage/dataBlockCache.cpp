@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) 2014 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Cache of data blocks shared by all iterators of a storage client
+/// \file "dataBlockCache.cpp"
+#include "dataBlockCache.hpp"
+
+using namespace strus;
+
+/// \brief Estimated number of bytes used for the administration of a block in the cache
+#define BLOCK_ENTRY_OVERHEAD 128
+
+DataBlockCache::Shard& DataBlockCache::shard( const Key& key)
+{
+	// FNV-1a hash of the key, the block id at its end makes the blocks of a term spread over all shards:
+	unsigned int hash = 2166136261U;
+	std::string::const_iterator ki = key.begin(), ke = key.end();
+	for (; ki != ke; ++ki)
+	{
+		hash ^= (unsigned char)*ki;
+		hash *= 16777619U;
+	}
+	return m_shards[ hash % NofShards];
+}
+
+void DataBlockCache::Shard::removeEntry( Map::iterator mi)
+{
+	memoryUsage -= mi->second.memoryUsage;
+	lru.erase( mi->second.lruitr);
+	map.erase( mi);
+}
+
+DataBlockCache::BlockRef DataBlockCache::get( const Key& key)
+{
+	Shard& sh = shard( key);
+	utils::ScopedLock lock( sh.mutex);
+	Map::iterator mi = sh.map.find( key);
+	if (mi == sh.map.end()) return BlockRef();
+	sh.lru.splice( sh.lru.begin(), sh.lru, mi->second.lruitr);
+	return mi->second.block;
+}
+
+DataBlockCache::BlockRef DataBlockCache::insert( const Key& key, const BlockRef& blk, unsigned int generation_)
+{
+	std::size_t memoryUsage = blk->size() + key.size() + sizeof(DataBlock) + BLOCK_ENTRY_OVERHEAD;
+	if (memoryUsage > m_maxShardMemoryUsage)
+	{
+		// ... does not fit into the cache
+		return blk;
+	}
+	Shard& sh = shard( key);
+	utils::ScopedLock lock( sh.mutex);
+	if (generation_ != m_generation.value())
+	{
+		// ... blocks were written since the block was read, it might be outdated
+		return blk;
+	}
+	Map::iterator mi = sh.map.find( key);
+	if (mi != sh.map.end())
+	{
+		// ... inserted concurrently by another thread
+		return mi->second.block;
+	}
+	while (sh.memoryUsage + memoryUsage > m_maxShardMemoryUsage && !sh.lru.empty())
+	{
+		// ... evict the least recently used blocks
+		sh.removeEntry( sh.map.find( sh.lru.back()));
+	}
+	sh.lru.push_front( key);
+	sh.map.insert( Map::value_type( key, Entry( blk, sh.lru.begin(), memoryUsage)));
+	sh.memoryUsage += memoryUsage;
+	return blk;
+}
+
+void DataBlockCache::invalidate( const std::vector<Key>& keys)
+{
+	// The generation is incremented before removing the blocks, so that a block read before the commit is either rejected by insert or inserted before and removed here:
+	m_generation.increment();
+	std::vector<Key>::const_iterator ki = keys.begin(), ke = keys.end();
+	for (; ki != ke; ++ki)
+	{
+		Shard& sh = shard( *ki);
+		utils::ScopedLock lock( sh.mutex);
+		Map::iterator mi = sh.map.find( *ki);
+		if (mi != sh.map.end()) sh.removeEntry( mi);
+	}
+}
+
@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) 2014 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Cache of data blocks shared by all iterators of a storage client
+/// \file "dataBlockCache.hpp"
+#ifndef _STRUS_STORAGE_DATA_BLOCK_CACHE_HPP_INCLUDED
+#define _STRUS_STORAGE_DATA_BLOCK_CACHE_HPP_INCLUDED
+#include "private/utils.hpp"
+#include "dataBlock.hpp"
+#include <vector>
+#include <list>
+#include <map>
+#include <string>
+#include <cstddef>
+
+namespace strus {
+
+/// \brief Thread safe cache of data blocks read from the storage, with least recently used eviction and a limit of the number of bytes used
+/// \remark The blocks are addressed by their database key [prefix,domainKey,blockid], the cache is split into shards by the key, each with its own lock
+/// \remark Iterators refer to the blocks in the cache with a reference counted handle, a block evicted or invalidated stays alive as long as it is referenced
+class DataBlockCache
+{
+public:
+	/// \brief Database key of a block (see DatabaseKey)
+	typedef std::string Key;
+	/// \brief Reference counted handle of a block in the cache
+	typedef utils::SharedPtr<const DataBlock> BlockRef;
+
+	enum {
+		DefaultMaxMemoryUsage=(64*1024*1024),	///< default maximum number of bytes used by the blocks cached
+		NofShards=16				///< number of parts of the cache with a lock of their own
+	};
+
+	/// \param[in] maxMemoryUsage_ maximum number of bytes used by the blocks cached
+	explicit DataBlockCache( std::size_t maxMemoryUsage_)
+		:m_generation(0),m_maxShardMemoryUsage(maxMemoryUsage_ / NofShards){}
+	~DataBlockCache(){}
+
+	/// \brief Get a block from the cache
+	/// \param[in] key database key of the block
+	/// \return the block or an empty reference, if it is not cached
+	BlockRef get( const Key& key);
+
+	/// \brief Get the current generation of the cache, incremented with every invalidation
+	/// \remark Has to be called before reading a block from the storage for inserting it into the cache
+	unsigned int generation() const				{return m_generation.value();}
+
+	/// \brief Insert a block read from the storage
+	/// \param[in] key database key of the block
+	/// \param[in] blk block read (allocated, not referencing database memory)
+	/// \param[in] generation_ generation of the cache before reading the block
+	/// \return the block in the cache, blk if it was inserted or not cached, the block inserted by another thread in the meantime else
+	/// \note The block is not cached, if the cache was invalidated since generation_, because it might have been read before a commit rewriting it
+	BlockRef insert( const Key& key, const BlockRef& blk, unsigned int generation_);
+
+	/// \brief Remove the blocks of a list (called after a commit of a transaction writing or removing them)
+	/// \param[in] keys list of the database keys of the blocks written or removed
+	void invalidate( const std::vector<Key>& keys);
+
+private:
+	struct Entry
+	{
+		BlockRef block;
+		std::list<Key>::iterator lruitr;
+		std::size_t memoryUsage;
+
+		Entry( const BlockRef& block_, const std::list<Key>::iterator& lruitr_, std::size_t memoryUsage_)
+			:block(block_),lruitr(lruitr_),memoryUsage(memoryUsage_){}
+		Entry( const Entry& o)
+			:block(o.block),lruitr(o.lruitr),memoryUsage(o.memoryUsage){}
+	};
+	typedef std::map<Key,Entry> Map;
+
+	struct Shard
+	{
+		utils::Mutex mutex;			///< mutual exclusion for the access of the shard
+		Map map;				///< map of block keys to blocks
+		std::list<Key> lru;			///< blocks cached, most recently used first
+		std::size_t memoryUsage;		///< number of bytes used by the blocks cached
+
+		Shard()
+			:map(),lru(),memoryUsage(0){}
+
+		void removeEntry( Map::iterator mi);
+	};
+
+	Shard& shard( const Key& key);
+
+private:
+	Shard m_shards[ NofShards];			///< parts of the cache selected by a hash of the key
+	utils::AtomicCounter<unsigned int> m_generation;///< counter of invalidations, for not inserting blocks read before a commit that rewrote them
+	std::size_t m_maxShardMemoryUsage;		///< maximum number of bytes used by the blocks cached in one shard
+};
+
+}//namespace
+#endif
+
@@ -8,6 +8,7 @@
 #include "databaseAdapter.hpp"
 #include "indexPacker.hpp"
 #include "metaDataBlock.hpp"
+#include "metaDataZoneMap.hpp"
 #include "strus/databaseClientInterface.hpp"
 #include "strus/databaseTransactionInterface.hpp"
 #include "strus/databaseCursorInterface.hpp"
@@ -141,6 +142,7 @@ void DatabaseAdapter_DataBlock::Writer::store( DatabaseTransactionInterface* tra
 	m_dbkey.resize( m_domainKeySize);
 	m_dbkey.addElem( blk.id());
 	transaction->write( m_dbkey.ptr(), m_dbkey.size(), blk.charptr(), blk.size());
+	if (m_blockRefreshList) m_blockRefreshList->push_back( std::string( m_dbkey.ptr(), m_dbkey.size()));
 }
 
 void DatabaseAdapter_DataBlock::Writer::remove( DatabaseTransactionInterface* transaction, const Index& elemno)
@@ -148,6 +150,7 @@ void DatabaseAdapter_DataBlock::Writer::remove( DatabaseTransactionInterface* tr
 	m_dbkey.resize( m_domainKeySize);
 	m_dbkey.addElem( elemno);
 	transaction->remove( m_dbkey.ptr(), m_dbkey.size());
+	if (m_blockRefreshList) m_blockRefreshList->push_back( std::string( m_dbkey.ptr(), m_dbkey.size()));
 }
 
 void DatabaseAdapter_DataBlock::Writer::removeSubTree( DatabaseTransactionInterface* transaction)
@@ -159,6 +162,7 @@ void DatabaseAdapter_DataBlock::Writer::removeSubTree( DatabaseTransactionInterf
 DatabaseAdapter_DataBlock::Cursor::Cursor( char prefix_, const DatabaseClientInterface* database_, const BlockKey& domainKey_, bool useCache_)
 	:Base(prefix_,domainKey_)
 	,m_cursor(database_->createCursor( useCache_?(DatabaseOptions().useCache()):(DatabaseOptions())))
+	,m_nofBlocksLoaded(0)
 {
 	if (!m_cursor.get()) throw std::runtime_error(_TXT("failed to create database cursor"));
 }
@@ -171,6 +175,7 @@ bool DatabaseAdapter_DataBlock::Cursor::getBlock( const DatabaseCursorInterface:
 	Index elemno = unpackIndex( ki, ke);
 	DatabaseCursorInterface::Slice blkslice = m_cursor->value();
 	blk.init( elemno, blkslice.ptr(), blkslice.size());
+	++m_nofBlocksLoaded;
 	return true;
 }
 
@@ -271,6 +276,28 @@ void DatabaseAdapter_DocMetaData::remove( DatabaseTransactionInterface* transact
 }
 
 
+MetaDataZoneMap* DatabaseAdapter_MetaDataZoneMap::loadPtr( const DatabaseClientInterface* database, const MetaDataDescription* descr, const Index& blockno)
+{
+	std::string blkstr;
+	DatabaseKey dbkey( KeyPrefix, blockno);
+	if (!database->readValue( dbkey.ptr(), dbkey.size(), blkstr, DatabaseOptions())) return 0;
+	if (blkstr.size() != descr->bytesize() * 2) return 0;
+	//... not matching the current description, has to be rebuilt
+	return new MetaDataZoneMap( descr, blockno, blkstr.c_str(), blkstr.size());
+}
+
+void DatabaseAdapter_MetaDataZoneMap::store( DatabaseTransactionInterface* transaction, const MetaDataZoneMap& zonemap)
+{
+	DatabaseKey dbkey( KeyPrefix, zonemap.blockno());
+	transaction->write( dbkey.ptr(), dbkey.size(), zonemap.charptr(), zonemap.bytesize());
+}
+
+void DatabaseAdapter_MetaDataZoneMap::remove( DatabaseTransactionInterface* transaction, const Index& blockno)
+{
+	DatabaseKey dbkey( KeyPrefix, blockno);
+	transaction->remove( dbkey.ptr(), dbkey.size());
+}
+
 bool DatabaseAdapter_DocAttribute::load( const DatabaseClientInterface* database, const Index& docno, const Index& attrno, std::string& value)
 {
 	DatabaseKey dbkey( KeyPrefix, BlockKey( docno, attrno));
@@ -16,11 +16,13 @@
 #include "databaseKey.hpp"
 #include "dataBlock.hpp"
 #include "posinfoBlock.hpp"
+#include "ffBlock.hpp"
 #include "booleanBlock.hpp"
 #include "invTermBlock.hpp"
 #include "forwardIndexBlock.hpp"
 #include "blockKey.hpp"
 #include <utility>
+#include <vector>
 #include <string>
 #include <cstring>
 
@@ -33,8 +35,12 @@ class MetaDataBlock;
 /// \brief Forward declaration
 class MetaDataDescription;
 /// \brief Forward declaration
+class MetaDataZoneMap;
+/// \brief Forward declaration
 class PosinfoBlock;
 /// \brief Forward declaration
+class FfBlock;
+/// \brief Forward declaration
 class BooleanBlock;
 /// \brief Forward declaration
 class InvTermBlock;
@@ -282,14 +288,21 @@ struct DatabaseAdapter_DataBlock
 	{
 	public:
 		Writer( char prefix_, DatabaseClientInterface* database_, const BlockKey& domainKey_)
-			:Base(prefix_,domainKey_),m_database(database_){}
+			:Base(prefix_,domainKey_),m_database(database_),m_blockRefreshList(0){}
 
 		void store( DatabaseTransactionInterface* transaction, const DataBlock& blk);
 		void remove( DatabaseTransactionInterface* transaction, const Index& elemno);
 		void removeSubTree( DatabaseTransactionInterface* transaction);
 
+		/// \brief Define a list where to append the database keys of all blocks stored or removed with this writer (for removing them from caches after commit)
+		void setBlockRefreshList( std::vector<std::string>* blockRefreshList_)
+		{
+			m_blockRefreshList = blockRefreshList_;
+		}
+
 	private:
 		DatabaseClientInterface* m_database;
+		std::vector<std::string>* m_blockRefreshList;
 	};
 
 	class Cursor
@@ -303,11 +316,15 @@ struct DatabaseAdapter_DataBlock
 		bool loadNext( DataBlock& blk);
 		bool loadLast( DataBlock& blk);
 
+		/// \brief Get the number of blocks loaded with this cursor
+		unsigned int nofBlocksLoaded() const	{return m_nofBlocksLoaded;}
+
 	private:
 		bool getBlock( const DatabaseCursorInterface::Slice& key, DataBlock& blk);
 
 	protected:
 		Reference<DatabaseCursorInterface> m_cursor;
+		unsigned int m_nofBlocksLoaded;
 	};
 };
 
@@ -462,6 +479,49 @@ struct DatabaseAdapter_PosinfoBlock
 };
 
 
+struct DatabaseAdapter_FfBlock
+{
+	typedef DatabaseAdapter_TypedDataBlock<
+			DatabaseKey::DocFfBlockPrefix, FfBlock, true> Parent;
+
+	class Reader
+		:public Parent::Reader
+	{
+	public:
+		Reader( const DatabaseClientInterface* database_,
+			const Index& typeno_, const Index& termno_)
+			:Parent::Reader( database_, BlockKey(typeno_,termno_)){}
+	};
+	class Writer
+		:public Parent::Writer
+	{
+	public:
+		Writer( DatabaseClientInterface* database_,
+			const Index& typeno_, const Index& termno_)
+			:Parent::Writer( database_, BlockKey(typeno_,termno_)){}
+	};
+	class Cursor
+		:public Parent::Cursor
+	{
+	public:
+		Cursor( const DatabaseClientInterface* database_,
+			const Index& typeno_, const Index& termno_)
+			:Parent::Cursor( database_, BlockKey(typeno_,termno_)){}
+	};
+
+	class WriteCursor
+		:public Cursor
+		,public Writer
+	{
+	public:
+		WriteCursor( DatabaseClientInterface* database_, 
+				const Index& typeno_, const Index& termno_)
+			:Cursor(database_,typeno_,termno_)
+			,Writer(database_,typeno_,termno_){}
+	};
+};
+
+
 struct DatabaseAdapter_InverseTerm
 {
 	typedef DatabaseAdapter_TypedDataBlock<
@@ -685,6 +745,18 @@ private:
 };
 
 
+class DatabaseAdapter_MetaDataZoneMap
+{
+public:
+	static MetaDataZoneMap* loadPtr( const DatabaseClientInterface* database, const MetaDataDescription* descr, const Index& blockno);
+	static void store( DatabaseTransactionInterface* transaction, const MetaDataZoneMap& zonemap);
+	static void remove( DatabaseTransactionInterface* transaction, const Index& blockno);
+
+private:
+	enum {KeyPrefix=DatabaseKey::MetaDataZoneMapPrefix};
+};
+
+
 class DatabaseAdapter_DocAttribute
 {
 public:
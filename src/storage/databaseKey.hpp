@@ -30,6 +30,7 @@ public:
 
 		ForwardIndexPrefix='r',	///< [typeno,docno,position]   ->  [string]*
 		PosinfoBlockPrefix='p',	///< [typeno,termno,docno]     ->  [pos]*
+		DocFfBlockPrefix='e',	///< [typeno,termno,docno]     ->  [docno,ff]*
 		InverseTermPrefix='i',	///< [docno]                   ->  [typeno,termno,ff,firstpos]*
 
 		UserAclBlockPrefix='u',	///< [userno,docno]            ->  [bit]*
@@ -37,6 +38,7 @@ public:
 		DocListBlockPrefix='d',	///< [typeno,termno,docno]     ->  [bit]*
 
 		DocMetaDataPrefix='m',	///< [docno/1K,nameid]         ->  [float/int32/short/char]*
+		MetaDataZoneMapPrefix='z',///< [docno/1K]                ->  [min record,max record]
 		DocAttributePrefix='a',	///< [docno,nameid]            ->  [string]
 		DocFrequencyPrefix='f',	///< [typeno,termno]           ->  [index]
 
@@ -57,12 +59,14 @@ public:
 
 			case ForwardIndexPrefix: return "forward index";
 			case PosinfoBlockPrefix: return "posinfo posting block";
+			case DocFfBlockPrefix: return "doc/ff posting block";
 			case InverseTermPrefix: return "inverse terminfo block";
 			case UserAclBlockPrefix: return "user ACL block";
 			case AclBlockPrefix: return "inverted ACL block";
 			case DocListBlockPrefix: return "doc posting block";
 
 			case DocMetaDataPrefix: return "metadata";
+			case MetaDataZoneMapPrefix: return "metadata zone map";
 			case DocAttributePrefix: return "document attribute";
 			case DocFrequencyPrefix: return "term document frequency";
 
@@ -11,6 +11,7 @@
 #include "metaDataBlock.hpp"
 #include "forwardIndexBlock.hpp"
 #include "booleanBlock.hpp"
+#include "ffBlock.hpp"
 #include "strus/numericVariant.hpp"
 #include "private/internationalization.hpp"
 #include <stdexcept>
@@ -397,6 +398,46 @@ void DocMetaDataData::print( std::ostream& out)
 	out << std::endl;
 }
 
+MetaDataZoneMapData::MetaDataZoneMapData( const MetaDataDescription* metadescr, const strus::DatabaseCursorInterface::Slice& key, const strus::DatabaseCursorInterface::Slice& value)
+{
+	char const* ki = key.ptr()+1;
+	char const* ke = key.ptr()+key.size();
+
+	if (ki == ke)
+	{
+		throw strus::runtime_error( "%s", _TXT( "unexpected end of metadata zone map key"));
+	}
+	blockno = strus::unpackIndex( ki, ke);/*[blockno]*/
+	if (ki != ke)
+	{
+		throw strus::runtime_error( "%s", _TXT( "unexpected extra bytes at end of metadata zone map key"));
+	}
+	zonemap.reset( new MetaDataZoneMap( metadescr, blockno, value.ptr(), value.size()));
+	descr = metadescr;
+}
+
+void MetaDataZoneMapData::print( std::ostream& out)
+{
+	out << (char)DatabaseKey::MetaDataZoneMapPrefix << ' ' << blockno;
+	if (descr->nofElements())
+	{
+		unsigned int colidx = 0, colend = descr->nofElements();
+		out << ' ';
+		for (; colidx<colend; ++colidx)
+		{
+			if (colidx) out << ',';
+			out << zonemap->minValue( descr->get( colidx)).tostring().c_str();
+		}
+		out << ' ';
+		for (colidx=0; colidx<colend; ++colidx)
+		{
+			if (colidx) out << ',';
+			out << zonemap->maxValue( descr->get( colidx)).tostring().c_str();
+		}
+	}
+	out << std::endl;
+}
+
 
 DocAttributeData::DocAttributeData( const strus::DatabaseCursorInterface::Slice& key, const strus::DatabaseCursorInterface::Slice& value)
 {
@@ -519,6 +560,58 @@ void PosinfoBlockData::print( std::ostream& out)
 }
 
 
+FfBlockData::FfBlockData( const strus::DatabaseCursorInterface::Slice& key, const strus::DatabaseCursorInterface::Slice& value)
+{
+	char const* ki = key.ptr()+1;
+	char const* ke = key.ptr()+key.size();
+	char const* vi = value.ptr();
+	char const* ve = value.ptr()+value.size();
+
+	typeno = strus::unpackIndex( ki, ke);/*[typeno]*/
+	valueno = strus::unpackIndex( ki, ke);/*[valueno]*/
+	docno = strus::unpackIndex( ki, ke);/*[docno]*/
+	if (ki != ke)
+	{
+		throw strus::runtime_error( "%s", _TXT( "unexpected extra bytes at end of term index key"));
+	}
+	FfBlock blk( docno, vi, ve-vi);
+	std::vector<Index> docnoar;
+	std::vector<unsigned int> ffar;
+	blk.decode( docnoar, ffar);
+
+	unsigned int maxff = 0;
+	std::size_t di = 0, de = docnoar.size();
+	for (; di != de; ++di)
+	{
+		if (di && docnoar[ di] <= docnoar[ di-1])
+		{
+			throw strus::runtime_error( "%s", _TXT( "elements in doc/ff block not strictly ascending"));
+		}
+		if (!ffar[ di])
+		{
+			throw strus::runtime_error( "%s", _TXT( "zero ff in doc/ff block"));
+		}
+		if (ffar[ di] > maxff) maxff = ffar[ di];
+		docfflist.push_back( DocFf( docnoar[ di], ffar[ di]));
+	}
+	if (maxff != blk.maxFrequency())
+	{
+		throw strus::runtime_error( "%s", _TXT( "maximum ff in doc/ff block summary does not match to the elements"));
+	}
+}
+
+void FfBlockData::print( std::ostream& out)
+{
+	out << (char)DatabaseKey::DocFfBlockPrefix << ' ' << typeno << ' ' << valueno << ' ' << docfflist.size();
+	std::vector<DocFf>::const_iterator itr = docfflist.begin(), end = docfflist.end();
+	for (; itr != end; ++itr)
+	{
+		out << ' ' << itr->first << ':' << itr->second;
+	}
+	out << std::endl;
+}
+
+
 static std::vector<std::pair<Index,Index> > getRangeListFromBooleanBlock(
 		DatabaseKey::KeyPrefix prefix, const Index& id, char const* vi, const char* ve)
 {
@@ -10,9 +10,11 @@
 #include "strus/databaseCursorInterface.hpp"
 #include "metaDataDescription.hpp"
 #include "metaDataBlock.hpp"
+#include "metaDataZoneMap.hpp"
 #include "posinfoBlock.hpp"
 #include "invTermBlock.hpp"
 #include "strus/index.hpp"
+#include "strus/reference.hpp"
 #include <utility>
 #include <vector>
 #include <string>
@@ -135,6 +137,17 @@ struct DocMetaDataData
 	void print( std::ostream& out);
 };
 
+struct MetaDataZoneMapData
+{
+	Index blockno;
+	const MetaDataDescription* descr;
+	Reference<MetaDataZoneMap> zonemap;
+
+	MetaDataZoneMapData( const MetaDataDescription* metadescr, const strus::DatabaseCursorInterface::Slice& key, const strus::DatabaseCursorInterface::Slice& value);
+
+	void print( std::ostream& out);
+};
+
 struct DocAttributeData
 {
 	Index docno;
@@ -182,6 +195,20 @@ struct PosinfoBlockData
 	void print( std::ostream& out);
 };
 
+struct FfBlockData
+{
+	Index typeno;
+	Index valueno;
+	Index docno;
+
+	typedef std::pair<Index,unsigned int> DocFf;
+	std::vector<DocFf> docfflist;
+
+	FfBlockData( const strus::DatabaseCursorInterface::Slice& key, const strus::DatabaseCursorInterface::Slice& value);
+
+	void print( std::ostream& out);
+};
+
 struct DocListBlockData
 {
 	Index typeno;
@@ -0,0 +1,195 @@
+/*
+ * Copyright (c) 2014 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#include "ffBlock.hpp"
+#include "indexPacker.hpp"
+#include "streamVByte.hpp"
+#include "private/internationalization.hpp"
+#include <cstring>
+
+using namespace strus;
+
+void FfBlock::initFrame()
+{
+	if (size())
+	{
+		char const* itr = charptr();
+		if ((unsigned char)*itr == (unsigned char)FormatMarker)
+		{
+			if (size() < 2) throw strus::runtime_error( "%s", _TXT( "corrupt data in doc/ff block (header)"));
+			unsigned char fmt = (unsigned char)itr[1];
+			if (fmt != FormatStreamVByte)
+			{
+				throw strus::runtime_error( _TXT( "unknown doc/ff block format %u"), (unsigned int)fmt);
+			}
+			m_format = (Format)fmt;
+			itr += 2;
+		}
+		else
+		{
+			m_format = FormatPacked;
+		}
+		m_nofElements = unpackIndex( itr, charend());
+		m_maxff = unpackIndex( itr, charend());
+		m_eltptr = itr;
+	}
+	else
+	{
+		m_format = FormatPacked;
+		m_nofElements = 0;
+		m_maxff = 0;
+		m_eltptr = 0;
+	}
+}
+
+void FfBlock::decode( std::vector<Index>& docnoar, std::vector<unsigned int>& ffar) const
+{
+	docnoar.resize( m_nofElements);
+	ffar.resize( m_nofElements);
+	if (!m_nofElements) return;
+	Index docno = 0;
+
+	switch (m_format)
+	{
+		case FormatPacked:
+		{
+			char const* itr = m_eltptr;
+			const char* end = charend();
+			std::size_t ii = 0;
+			for (; ii < m_nofElements && itr != end; ++ii)
+			{
+				docno += unpackIndex( itr, end);
+				docnoar[ ii] = docno;
+				ffar[ ii] = unpackIndex( itr, end);
+			}
+			if (ii < m_nofElements) throw strus::runtime_error( "%s", _TXT( "corrupt data in doc/ff block"));
+			break;
+		}
+		case FormatStreamVByte:
+		{
+			// ... decode the docno deltas in place and sum them up:
+			uint32_t* deltaar = reinterpret_cast<uint32_t*>( &docnoar[0]);
+			char const* itr = streamVByteDecode( deltaar, m_nofElements, m_eltptr, charend());
+			itr = streamVByteDecode( reinterpret_cast<uint32_t*>( &ffar[0]), m_nofElements, itr, charend());
+			std::size_t ii = 0;
+			for (; ii < m_nofElements; ++ii)
+			{
+				docno += (Index)deltaar[ ii];
+				docnoar[ ii] = docno;
+			}
+			break;
+		}
+	}
+	if (docno != id())
+	{
+		throw strus::runtime_error( "%s", _TXT( "corrupt data in doc/ff block"));
+	}
+}
+
+const char* FfBlock::formatName( Format format_)
+{
+	switch (format_)
+	{
+		case FormatPacked: return "packed";
+		case FormatStreamVByte: return "streamvbyte";
+	}
+	return 0;
+}
+
+FfBlock::Format FfBlock::formatFromName( const std::string& name)
+{
+	if (name == "packed") return FormatPacked;
+	if (name == "streamvbyte") return FormatStreamVByte;
+	throw strus::runtime_error( _TXT( "unknown doc/ff block format '%s'"), name.c_str());
+}
+
+static std::size_t packedIndexSize( const Index& idx)
+{
+	char buf[ 16];
+	std::size_t rt = 0;
+	packIndex( buf, rt, sizeof(buf), idx);
+	return rt;
+}
+
+static std::size_t streamVByteSize( uint32_t val)
+{
+	return (val < (1U<<8)) ? 1 : (val < (1U<<16)) ? 2 : (val < (1U<<24)) ? 3 : 4;
+}
+
+void FfBlockBuilder::append( const Index& docno, unsigned int ff)
+{
+	if (docno <= m_lastDoc) throw strus::logic_error( _TXT( "documents not appended in ascending order to doc/ff block"));
+	if (!ff) throw strus::logic_error( _TXT( "appending document with zero frequency to doc/ff block"));
+	switch (m_format)
+	{
+		case FfBlock::FormatPacked:
+			m_size += packedIndexSize( docno - m_lastDoc) + packedIndexSize( ff);
+			break;
+		case FfBlock::FormatStreamVByte:
+			if (m_docnoar.size() % 4 == 0) m_size += 2;	//... control bytes of docno and ff array
+			m_size += streamVByteSize( docno - m_lastDoc) + streamVByteSize( ff);
+			break;
+	}
+	m_docnoar.push_back( docno);
+	m_ffar.push_back( ff);
+	if (ff > m_maxff) m_maxff = ff;
+	m_lastDoc = docno;
+}
+
+FfBlock FfBlockBuilder::createBlock() const
+{
+	if (empty()) throw strus::runtime_error( "%s",  _TXT( "tried to create empty doc/ff block"));
+	std::string blkmem;
+	blkmem.reserve( m_size + 16);
+	if (m_format != FfBlock::FormatPacked)
+	{
+		blkmem.push_back( (char)(unsigned char)FfBlock::FormatMarker);
+		blkmem.push_back( (char)(unsigned char)m_format);
+	}
+	packIndex( blkmem, m_docnoar.size());
+	packIndex( blkmem, m_maxff);
+
+	std::size_t ii = 0, nn = m_docnoar.size();
+	switch (m_format)
+	{
+		case FfBlock::FormatPacked:
+		{
+			Index prev = 0;
+			for (; ii < nn; ++ii)
+			{
+				packIndex( blkmem, m_docnoar[ ii] - prev);
+				packIndex( blkmem, m_ffar[ ii]);
+				prev = m_docnoar[ ii];
+			}
+			break;
+		}
+		case FfBlock::FormatStreamVByte:
+		{
+			std::vector<uint32_t> deltaar( nn);
+			Index prev = 0;
+			for (; ii < nn; ++ii)
+			{
+				deltaar[ ii] = m_docnoar[ ii] - prev;
+				prev = m_docnoar[ ii];
+			}
+			streamVByteEncode( blkmem, &deltaar[0], nn);
+			streamVByteEncode( blkmem, reinterpret_cast<const uint32_t*>( &m_ffar[0]), nn);
+			break;
+		}
+	}
+	return FfBlock( m_lastDoc, blkmem.c_str(), blkmem.size(), true);
+}
+
+void FfBlockBuilder::clear()
+{
+	m_docnoar.clear();
+	m_ffar.clear();
+	m_size = 0;
+	m_lastDoc = 0;
+	m_maxff = 0;
+}
+
@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) 2014 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#ifndef _STRUS_STORAGE_FF_BLOCK_HPP_INCLUDED
+#define _STRUS_STORAGE_FF_BLOCK_HPP_INCLUDED
+#include "dataBlock.hpp"
+#include <vector>
+#include <string>
+
+namespace strus {
+
+/// \class FfBlock
+/// \brief Block of document numbers with the feature frequency of a term in the document, without the positions
+/// \remark The block id is the last document number in the block
+class FfBlock
+	:public DataBlock
+{
+public:
+	enum {
+		MaxBlockSize=512,		///< size of the blocks of rare terms
+		MaxAdaptiveBlockSize=8192	///< upper limit of the size of the blocks of frequent terms
+	};
+	/// \brief Encoding of the elements of the block
+	enum Format {
+		FormatPacked=0,			///< docno deltas and ffs one by one in the UTF-8 style encoding of 'indexPacker.hpp'
+		FormatStreamVByte=1		///< array of docno deltas and array of ffs Stream VByte encoded (see 'streamVByte.hpp')
+	};
+	/// \brief First byte of blocks with a format other than FormatPacked, followed by the format byte
+	/// \remark Blocks without this marker (never the first byte of a UTF-8 style encoded value) are in FormatPacked
+	enum {FormatMarker=0xFF};
+
+public:
+	explicit FfBlock()
+		:DataBlock(),m_format(FormatPacked),m_nofElements(0),m_maxff(0),m_eltptr(0){}
+	FfBlock( const FfBlock& o)
+		:DataBlock(o)
+		{initFrame();}
+	FfBlock( const Index& id_, const void* ptr_, std::size_t size_, bool allocated_=false)
+		:DataBlock( id_, ptr_, size_, allocated_)
+		{initFrame();}
+
+	FfBlock& operator=( const FfBlock& o)
+	{
+		DataBlock::operator =(o);
+		initFrame();
+		return *this;
+	}
+	void swap( DataBlock& o)
+	{
+		DataBlock::swap( o);
+		initFrame();
+	}
+
+	/// \brief Get the encoding of the elements of the block
+	Format format() const					{return m_format;}
+	/// \brief Get the number of documents in the block
+	std::size_t nofElements() const			{return m_nofElements;}
+	/// \brief Get the maximum feature frequency of all documents in the block (block summary)
+	unsigned int maxFrequency() const			{return m_maxff;}
+
+	/// \brief Decode the block into arrays of document numbers and feature frequencies
+	/// \param[out] docnoar where to write the document numbers to (ascending)
+	/// \param[out] ffar where to write the feature frequencies to
+	void decode( std::vector<Index>& docnoar, std::vector<unsigned int>& ffar) const;
+
+	/// \brief Get the name of a block format
+	static const char* formatName( Format format_);
+	/// \brief Get the block format by its name, throws if the name is not known
+	static Format formatFromName( const std::string& name);
+
+	/// \brief Get the size of the blocks to write for a term with a given document frequency
+	static std::size_t blockSizeForDf( const Index& df)
+	{
+		return DataBlock::adaptiveBlockSize( MaxBlockSize, MaxAdaptiveBlockSize, df);
+	}
+
+private:
+	void initFrame();
+
+private:
+	Format m_format;
+	std::size_t m_nofElements;
+	unsigned int m_maxff;
+	const char* m_eltptr;
+};
+
+class FfBlockBuilder
+{
+public:
+	/// \param[in] maxBlockSize_ size in bytes from which on the block built is considered as full (see FfBlock::blockSizeForDf(const Index&))
+	explicit FfBlockBuilder( FfBlock::Format format_=FfBlock::FormatPacked, std::size_t maxBlockSize_=FfBlock::MaxBlockSize)
+		:m_format(format_),m_maxBlockSize(maxBlockSize_),m_size(0),m_lastDoc(0),m_maxff(0){}
+	FfBlockBuilder( const FfBlockBuilder& o)
+		:m_format(o.m_format)
+		,m_maxBlockSize(o.m_maxBlockSize)
+		,m_docnoar(o.m_docnoar)
+		,m_ffar(o.m_ffar)
+		,m_size(o.m_size)
+		,m_lastDoc(o.m_lastDoc)
+		,m_maxff(o.m_maxff){}
+
+	/// \brief Get the id of the block to create (the last document number)
+	Index id() const						{return m_lastDoc;}
+
+	bool empty() const						{return m_docnoar.empty();}
+	/// \brief Get the size of the encoded elements appended
+	std::size_t size() const					{return m_size;}
+	bool full() const						{return m_size >= m_maxBlockSize;}
+	/// \brief Get the size in bytes from which on the block built is considered as full
+	std::size_t maxBlockSize() const				{return m_maxBlockSize;}
+
+	/// \brief Append a document with its feature frequency
+	/// \param[in] docno document number, has to be bigger than the last one appended
+	/// \param[in] ff feature frequency (non zero)
+	void append( const Index& docno, unsigned int ff);
+
+	FfBlock createBlock() const;
+	void clear();
+
+private:
+	FfBlock::Format m_format;
+	std::size_t m_maxBlockSize;
+	std::vector<Index> m_docnoar;
+	std::vector<unsigned int> m_ffar;
+	std::size_t m_size;
+	Index m_lastDoc;
+	unsigned int m_maxff;
+};
+
+}//namespace
+#endif
+
@@ -0,0 +1,185 @@
+/*
+ * Copyright (c) 2014 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#include "ffIterator.hpp"
+#include "private/internationalization.hpp"
+
+using namespace strus;
+
+FfIterator::FfIterator( BlockDirectoryCache* blockDirectoryCache_, DataBlockCache* dataBlockCache_, const DatabaseClientInterface* database_, Index termtypeno_, Index termvalueno_)
+	:m_dbadapter(blockDirectoryCache_,dataBlockCache_,(char)DatabaseKey::DocFfBlockPrefix,database_,BlockKey(termtypeno_,termvalueno_),true)
+	,m_idx(0)
+	,m_docno(0)
+	,m_docno_start(0)
+	,m_docno_end(0)
+	,m_blockmaxDbAdapter(blockDirectoryCache_,dataBlockCache_,(char)DatabaseKey::DocFfBlockPrefix,database_,BlockKey(termtypeno_,termvalueno_),true)
+	,m_blockmax_start(0)
+	,m_blockmax_end(0)
+	,m_blockmax_ff(0){}
+
+void FfIterator::initBlock( const Index& docno_start_)
+{
+	m_blk.decode( m_docnoar, m_ffar);
+	if (m_docnoar.empty()) throw strus::runtime_error( "%s", _TXT( "corrupt index (empty doc/ff block)"));
+	m_idx = 0;
+	m_docno_start = docno_start_;
+	m_docno_end = m_blk.id();
+}
+
+void FfIterator::resetBlock()
+{
+	m_blk.clear();
+	m_docnoar.clear();
+	m_ffar.clear();
+	m_idx = 0;
+	m_docno_start = 0;
+	m_docno_end = 0;
+}
+
+bool FfIterator::loadBlock( const Index& docno_)
+{
+	if (!m_blk.empty() && !m_dbadapter.directorySelected() && docno_ > m_docno_end && m_docno_end + (m_docno_end - m_docno_start) > docno_)
+	{
+		// Try to get document postings from a follow block (not with a directory, that selects the block without reading the ones in between):
+		for (;;)
+		{
+			Index prev_end = m_docno_end;
+			if (!m_dbadapter.loadNext( m_blk))
+			{
+				resetBlock();
+				return false;
+			}
+			initBlock( prev_end+1);
+			if (docno_ <= m_docno_end) return true;
+			if (m_docno_end + (m_docno_end - m_docno_start) <= docno_) break;
+		}
+	}
+	// Document postings are in a 'far away' block or the block is selected with the directory:
+	if (m_dbadapter.loadUpperBound( docno_, m_blk))
+	{
+		initBlock( docno_);
+		return true;
+	}
+	resetBlock();
+	return false;
+}
+
+Index FfIterator::skipDecoded( const Index& docno_)
+{
+	std::size_t nn = m_docnoar.size();
+	const Index* docnoar = &m_docnoar[0];
+
+	// Gallop forward from the last document, because skips are mostly ascending:
+	std::size_t lo, hi;
+	if (m_idx < nn && docnoar[ m_idx] < docno_)
+	{
+		std::size_t step = 1;
+		lo = m_idx + 1;
+		hi = lo;
+		while (hi < nn && docnoar[ hi] < docno_)
+		{
+			lo = hi + 1;
+			hi += step;
+			step <<= 1;
+		}
+		if (hi > nn) hi = nn;
+	}
+	else
+	{
+		lo = 0;
+		hi = (m_idx < nn) ? m_idx : (nn-1);
+	}
+	// ... then binary search in [lo,hi]:
+	while (lo < hi)
+	{
+		std::size_t mid = (lo + hi) >> 1;
+		if (docnoar[ mid] < docno_)
+		{
+			lo = mid + 1;
+		}
+		else
+		{
+			hi = mid;
+		}
+	}
+	if (lo >= nn) return 0;
+	m_idx = lo;
+	return docnoar[ lo];
+}
+
+Index FfIterator::skipDoc( const Index& docno_)
+{
+	if (m_docno && m_docno == docno_) return m_docno;
+	Index dn = (docno_ <= 0) ? 1 : docno_;
+
+	if (m_blk.empty() || dn < m_docno_start || dn > m_docno_end)
+	{
+		if (!loadBlock( dn)) return m_docno = 0;
+	}
+	m_docno = skipDecoded( dn);
+	if (!m_docno)
+	{
+		throw strus::runtime_error( "%s", _TXT( "corrupt index (doc/ff block id does not match its last element)"));
+	}
+	return m_docno;
+}
+
+std::size_t FfIterator::fetch( const Index& docno_, Index* docnos, unsigned int* ffs, std::size_t maxsize)
+{
+	std::size_t rt = 0;
+	if (!maxsize) return 0;
+
+	Index dn = skipDoc( docno_);
+	while (dn)
+	{
+		// Copy the rest of the current block:
+		std::size_t ii = m_idx, nn = m_docnoar.size();
+		for (; ii < nn && rt < maxsize; ++ii,++rt)
+		{
+			docnos[ rt] = m_docnoar[ ii];
+			if (ffs) ffs[ rt] = m_ffar[ ii];
+		}
+		m_idx = ii-1;
+		m_docno = m_docnoar[ m_idx];
+		if (rt == maxsize) break;
+		dn = skipDoc( m_docno+1);
+	}
+	if (!dn && rt)
+	{
+		// ... position the iterator on the last document fetched
+		skipDoc( docnos[ rt-1]);
+	}
+	return rt;
+}
+
+Index FfIterator::skipBlockMax( const Index& docno_, unsigned int& maxff)
+{
+	if (!m_blk.empty() && m_docno_start <= docno_ && m_docno_end >= docno_)
+	{
+		// ... the block is the one currently loaded for iterating
+		maxff = m_blk.maxFrequency();
+		return m_docno_end;
+	}
+	if (!m_blockmax_start || docno_ < m_blockmax_start || (m_blockmax_end && docno_ > m_blockmax_end))
+	{
+		// ... lookup the block with an own cursor not to change the iterator state
+		m_blockmax_start = docno_;
+		if (m_blockmaxDbAdapter.loadUpperBound( docno_, m_blockmaxBlk))
+		{
+			m_blockmax_end = m_blockmaxBlk.id();
+			m_blockmax_ff = m_blockmaxBlk.maxFrequency();
+		}
+		else
+		{
+			m_blockmax_end = 0;
+			m_blockmax_ff = 0;
+		}
+	}
+	maxff = m_blockmax_ff;
+	return m_blockmax_end;
+}
+
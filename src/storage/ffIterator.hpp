@@ -0,0 +1,69 @@
+/*
+ * Copyright (c) 2014 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#ifndef _STRUS_FF_ITERATOR_HPP_INCLUDED
+#define _STRUS_FF_ITERATOR_HPP_INCLUDED
+#include "ffBlock.hpp"
+#include "databaseAdapter.hpp"
+#include "blockDirectory.hpp"
+#include <vector>
+
+namespace strus {
+
+/// \brief Forward declaration
+class DatabaseClientInterface;
+
+/// \brief Iterator on the doc/ff blocks of a term, for getting documents and feature frequencies without reading the positions
+/// \remark Every block loaded is decoded into arrays, skips inside a block are a galloping search on the array of document numbers
+class FfIterator
+{
+public:
+	/// \param[in] blockDirectoryCache_ cache of the block directories or NULL, if the blocks are read with seeks only
+	/// \param[in] dataBlockCache_ cache of the blocks or NULL, if every block is read from the database
+	FfIterator( BlockDirectoryCache* blockDirectoryCache_, DataBlockCache* dataBlockCache_, const DatabaseClientInterface* database_, Index termtypeno_, Index termvalueno_);
+	~FfIterator(){}
+
+	Index skipDoc( const Index& docno_);
+
+	Index docno() const					{return m_docno;}
+	unsigned int frequency() const				{return m_docno?m_ffar[ m_idx]:0;}
+
+	/// \brief Get the end docno and the maximum ff of the block containing the postings with a document number higher than or equal to docno_ without moving the iterator
+	Index skipBlockMax( const Index& docno_, unsigned int& maxff);
+
+	/// \brief Fetch the next documents with a document number higher than or equal to docno_ and position the iterator on the last one fetched
+	/// \return the number of documents fetched
+	std::size_t fetch( const Index& docno_, Index* docnos, unsigned int* ffs, std::size_t maxsize);
+
+	/// \brief Get the number of doc/ff blocks loaded (including the blocks read for the block maxima)
+	unsigned int nofBlocksLoaded() const			{return m_dbadapter.nofBlocksLoaded() + m_blockmaxDbAdapter.nofBlocksLoaded();}
+
+private:
+	bool loadBlock( const Index& docno_);
+	void initBlock( const Index& docno_start_);
+	void resetBlock();
+	Index skipDecoded( const Index& docno_);
+
+private:
+	TypedBlockDirectoryCursor<FfBlock> m_dbadapter;
+	FfBlock m_blk;
+	std::vector<Index> m_docnoar;		///< document numbers of the block loaded
+	std::vector<unsigned int> m_ffar;	///< feature frequencies of the block loaded
+	std::size_t m_idx;			///< index of the current document in m_docnoar
+	Index m_docno;
+	Index m_docno_start;			///< lower bound of the document numbers the block loaded is the one to look in
+	Index m_docno_end;			///< upper bound of the document numbers the block loaded is the one to look in (block id)
+	TypedBlockDirectoryCursor<FfBlock> m_blockmaxDbAdapter;
+	FfBlock m_blockmaxBlk;
+	Index m_blockmax_start;
+	Index m_blockmax_end;
+	unsigned int m_blockmax_ff;
+};
+
+}
+#endif
+
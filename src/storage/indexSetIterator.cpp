@@ -9,9 +9,12 @@
 
 using namespace strus;
 
-IndexSetIterator::IndexSetIterator( const DatabaseClientInterface* database_, DatabaseKey::KeyPrefix dbprefix_, const BlockKey& key_, bool useCache_)
-	:m_dbadapter( (char)dbprefix_, database_, key_, useCache_)
+IndexSetIterator::IndexSetIterator( const DatabaseClientInterface* database_, DatabaseKey::KeyPrefix dbprefix_, const BlockKey& key_, bool useCache_, BlockDirectoryCache* blockDirectoryCache_, DataBlockCache* dataBlockCache_)
+	:m_dbadapter( blockDirectoryCache_, dataBlockCache_, (char)dbprefix_, database_, key_, useCache_)
 	,m_elemBlk()
+	,m_rangeFrom()
+	,m_rangeTo()
+	,m_rangeIdx(0)
 	,m_elemno(0)
 {}
 
@@ -20,9 +23,8 @@ bool IndexSetIterator::loadBlock( const Index& elemno_)
 	bool rt = true;
 	if (!m_elemBlk.empty())
 	{
-		if (m_elemBlk.isFollowBlockAddress( elemno_))
+		if (!m_dbadapter.directorySelected() && m_elemBlk.isFollowBlockAddress( elemno_))
 		{
-			m_elemCursor.reset();
 			while ((rt=m_dbadapter.loadNext( m_elemBlk)) && elemno_ > m_elemBlk.id())
 			{
 				if (!m_elemBlk.isFollowBlockAddress( elemno_))
@@ -34,24 +36,133 @@ bool IndexSetIterator::loadBlock( const Index& elemno_)
 		}
 		else
 		{
-			m_elemCursor.reset();
 			rt = m_dbadapter.loadUpperBound( elemno_, m_elemBlk);
 		}
 	}
 	else
 	{
-		m_elemCursor.reset();
 		rt = m_dbadapter.loadUpperBound( elemno_, m_elemBlk);
 	}
+	if (rt)
+	{
+		decodeBlock();
+	}
+	else
+	{
+		// ... no block left, the next skip has to seek the block of its element, because the cursor is exhausted:
+		m_elemBlk.clear();
+		m_rangeFrom.clear();
+		m_rangeTo.clear();
+		m_rangeIdx = 0;
+	}
 	return rt;
 }
 
+void IndexSetIterator::decodeBlock()
+{
+	m_rangeFrom.clear();
+	m_rangeTo.clear();
+	m_rangeIdx = 0;
+
+	BooleanBlock::NodeCursor cursor;
+	Index from_;
+	Index to_;
+	bool more = m_elemBlk.getFirstRange( cursor, from_, to_);
+	for (; more; more = m_elemBlk.getNextRange( cursor, from_, to_))
+	{
+		if (!m_rangeTo.empty() && m_rangeTo.back() + 1 == from_)
+		{
+			// ... join adjacent ranges
+			m_rangeTo.back() = to_;
+		}
+		else
+		{
+			m_rangeFrom.push_back( from_);
+			m_rangeTo.push_back( to_);
+		}
+	}
+}
+
+Index IndexSetIterator::skipDecoded( const Index& elemno_)
+{
+	std::size_t nn = m_rangeTo.size();
+	if (!nn) return 0;
+	const Index* toar = &m_rangeTo[0];
+
+	// Find the first range with an upper bound bigger than or equal to elemno_.
+	// Gallop forward from the range of the last skip, because skips are mostly ascending:
+	std::size_t lo, hi;
+	if (m_rangeIdx < nn && toar[ m_rangeIdx] < elemno_)
+	{
+		std::size_t step = 1;
+		lo = m_rangeIdx + 1;
+		hi = lo;
+		while (hi < nn && toar[ hi] < elemno_)
+		{
+			lo = hi + 1;
+			hi += step;
+			step <<= 1;
+		}
+		if (hi > nn) hi = nn;
+	}
+	else
+	{
+		lo = 0;
+		hi = (m_rangeIdx < nn) ? m_rangeIdx : (nn-1);
+	}
+	// ... then binary search in [lo,hi]:
+	while (lo < hi)
+	{
+		std::size_t mid = (lo + hi) >> 1;
+		if (toar[ mid] < elemno_)
+		{
+			lo = mid + 1;
+		}
+		else
+		{
+			hi = mid;
+		}
+	}
+	if (lo >= nn) return 0;
+	m_rangeIdx = lo;
+	return (m_rangeFrom[ lo] > elemno_) ? m_rangeFrom[ lo] : elemno_;
+}
+
 Index IndexSetIterator::skip( const Index& elemno_)
 {
 	if (!m_elemno || !m_elemBlk.isThisBlockAddress( elemno_))
 	{
-		if (!loadBlock( elemno_)) return 0;
+		if (!loadBlock( elemno_)) return m_elemno = 0;
 	}
-	return m_elemno = m_elemBlk.skip( elemno_, m_elemCursor);
+	return m_elemno = skipDecoded( elemno_);
 }
 
+std::size_t IndexSetIterator::fetch( const Index& elemno_, Index* buf, std::size_t maxsize)
+{
+	std::size_t rt = 0;
+	Index elemno = skip( elemno_);
+	while (elemno && rt < maxsize)
+	{
+		// Copy the elements of the decoded ranges of the block from elemno on:
+		std::size_t ri = m_rangeIdx, re = m_rangeTo.size();
+		for (; ri < re; ++ri)
+		{
+			Index ei = (ri == m_rangeIdx) ? elemno : m_rangeFrom[ ri];
+			Index ee = m_rangeTo[ ri];
+			for (; ei <= ee && rt < maxsize; ++ei)
+			{
+				buf[ rt++] = ei;
+			}
+			if (rt == maxsize) break;
+		}
+		if (rt == maxsize)
+		{
+			m_rangeIdx = ri;
+			m_elemno = buf[ rt-1];
+			break;
+		}
+		// ... block exhausted, continue with the following block
+		elemno = skip( buf[ rt-1]+1);
+	}
+	return rt;
+}
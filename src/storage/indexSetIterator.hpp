@@ -9,32 +9,49 @@
 #define _STRUS_STORAGE_INDEX_SET_ITERATOR_HPP_INCLUDED
 #include "booleanBlock.hpp"
 #include "databaseAdapter.hpp"
+#include "blockDirectory.hpp"
+#include <vector>
 
 namespace strus {
 
 /// \brief Forward declaration
 class DatabaseClientInterface;
 
+/// \brief Iterator on a set of indices stored as boolean blocks
+/// \remark Every block loaded is decoded into contiguous arrays of ranges, so that skips inside a block are a galloping search on an array instead of decoding nodes
 class IndexSetIterator
 {
 public:
+	/// \param[in] blockDirectoryCache_ cache of the block directories or NULL, if the blocks are read with seeks only
+	/// \param[in] dataBlockCache_ cache of the blocks or NULL, if every block is read from the database
 	IndexSetIterator(
 			const DatabaseClientInterface* database_,
 			DatabaseKey::KeyPrefix dbprefix_,
 			const BlockKey& key_,
-			bool useCache_);
+			bool useCache_,
+			BlockDirectoryCache* blockDirectoryCache_=0,
+			DataBlockCache* dataBlockCache_=0);
 	~IndexSetIterator(){}
 
 	Index skip( const Index& elemno_);
+	/// \brief Fetch the next elements bigger than or equal to elemno_ into an array
+	/// \return the number of elements fetched, 0 if there are no elements left
+	std::size_t fetch( const Index& elemno_, Index* buf, std::size_t maxsize);
 	Index elemno() const			{return m_elemno;}
+	unsigned int nofBlocksLoaded() const	{return m_dbadapter.nofBlocksLoaded();}
 
 private:
 	bool loadBlock( const Index& elemno_);
+	void decodeBlock();
+	Index skipDecoded( const Index& elemno_);
 
 private:
-	DatabaseAdapter_BooleanBlock::Cursor m_dbadapter;
+	TypedBlockDirectoryCursor<BooleanBlock> m_dbadapter;
 	BooleanBlock m_elemBlk;
-	BooleanBlock::NodeCursor m_elemCursor;
+
+	std::vector<Index> m_rangeFrom;		///< first elements of the ranges of the block loaded
+	std::vector<Index> m_rangeTo;		///< last elements of the ranges of the block loaded, ascending
+	std::size_t m_rangeIdx;			///< index of the range of the last skip
 
 	Index m_elemno;
 };
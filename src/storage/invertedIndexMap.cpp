@@ -18,8 +18,8 @@
 
 using namespace strus;
 
-InvertedIndexMap::InvertedIndexMap( DatabaseClientInterface* database_)
-	:m_dfmap(database_),m_database(database_),m_docno(0)
+InvertedIndexMap::InvertedIndexMap( DatabaseClientInterface* database_, bool withDocFfBlocks_, FfBlock::Format docFfBlockFormat_, bool withLargePositions_)
+	:m_dfmap(database_),m_database(database_),m_withDocFfBlocks(withDocFfBlocks_),m_docFfBlockFormat(docFfBlockFormat_),m_withLargePositions(withLargePositions_),m_docno(0)
 {
 	m_posinfo.push_back( 0);
 }
@@ -56,25 +56,9 @@ void InvertedIndexMap::definePosinfoPosting(
 	{
 		if (pos.size())
 		{
-			if (pos.size() > std::numeric_limits<PosinfoBlock::PositionType>::max())
-			{
-				throw strus::runtime_error( _TXT( "size of document out of range (max %u)"), 65535);
-			}
-			m_map[ key] = m_posinfo.size();
-
-			m_posinfo.push_back( (PosinfoBlock::PositionType)pos.size());	//... ff
-			std::vector<Index>::const_iterator pi = pos.begin(), pe = pos.end();
-			for (; pi != pe; ++pi)
-			{
-				if (*pi > std::numeric_limits<PosinfoBlock::PositionType>::max())
-				{
-					throw strus::runtime_error( _TXT( "token position out of range (max %u)"), 65535);
-				}
-				else
-				{
-					m_posinfo.push_back( (PosinfoBlock::PositionType)*pi);
-				}
-			}
+			std::size_t posidx = m_posinfo.size();
+			PosinfoBlock::encodePositions( m_posinfo, pos, m_withLargePositions);
+			m_map[ key] = posidx;
 		}
 		else
 		{
@@ -91,13 +75,14 @@ void InvertedIndexMap::definePosinfoPosting(
 			if (pidx) posmsg << ",";
 			posmsg << *pi;
 		}
-		std::size_t posidx = mi->second;
-		unsigned int fi=0,fe=m_posinfo[posidx++];
+		std::vector<Index> oldpos;
+		PosinfoBlock::decodePositions( oldpos, m_posinfo.data() + mi->second, m_withLargePositions);
 		posmsg << " | ";
-		for (; fi != fe; ++fi)
+		std::vector<Index>::const_iterator oi = oldpos.begin(), oe = oldpos.end();
+		for (int oidx=0; oi != oe; ++oi,++oidx)
 		{
-			if (!fi) posmsg << ",";
-			posmsg << m_posinfo[posidx+fi];
+			if (oidx) posmsg << ",";
+			posmsg << *oi;
 		}
 		std::string posstr = posmsg.str();
 		// throw exception message:
@@ -264,7 +249,9 @@ void InvertedIndexMap::getWriteBatch(
 			StatisticsBuilderInterface* statisticsBuilder,
 			DocumentFrequencyCache::Batch* dfbatch,
 			const KeyMapInv& termTypeMapInv,
-			const KeyMapInv& termValueMapInv)
+			const KeyMapInv& termValueMapInv,
+			std::vector<BlockDirectoryCache::Key>& blockDomainRefreshList,
+			std::vector<DataBlockCache::Key>& blockRefreshList)
 {
 	DatabaseAdapter_InverseTerm::ReadWriter dbadapter_inv( m_database);
 	// [1] Get deletes:
@@ -371,10 +358,29 @@ void InvertedIndexMap::getWriteBatch(
 			BlockKey blkkey( ei->first.termkey);
 			Index typeno = blkkey.elem(1);
 			Index termno = blkkey.elem(2);
+			blockDomainRefreshList.push_back( BlockDirectoryCache::Key( (char)DatabaseKey::PosinfoBlockPrefix, ei->first.termkey));
+			blockDomainRefreshList.push_back( BlockDirectoryCache::Key( (char)DatabaseKey::DocListBlockPrefix, ei->first.termkey));
+			if (m_withDocFfBlocks)
+			{
+				blockDomainRefreshList.push_back( BlockDirectoryCache::Key( (char)DatabaseKey::DocFfBlockPrefix, ei->first.termkey));
+			}
 			DatabaseAdapter_PosinfoBlock::WriteCursor dbadapter_posinfo( m_database, typeno, termno);
-	
-			PosinfoBlockBuilder newposblk;
+			dbadapter_posinfo.setBlockRefreshList( &blockRefreshList);
+
+			// Choose the block sizes from the document frequency of the term, estimated as the one stored plus the documents inserted:
+			Index df = DatabaseAdapter_DocFrequency::get( m_database, typeno, termno);
+			for (Map::const_iterator ci = ei; ci != ee; ++ci)
+			{
+				if (ci->second) ++df;
+			}
+			PosinfoBlockBuilder newposblk( m_withLargePositions, PosinfoBlock::blockSizeForDf( df));
 			std::vector<BooleanBlock::MergeRange> docrangear;
+
+			if (m_withDocFfBlocks)
+			{
+				// [0] Update the doc/ff blocks of the term:
+				mergeFfBlocks( transaction, typeno, termno, ei, ee, FfBlock::blockSizeForDf( df), blockRefreshList);
+			}
 	
 			// [1] Merge new elements with existing upper bound blocks:
 			mergeNewPosElements( dbadapter_posinfo, transaction, ei, ee, newposblk, docrangear);
@@ -391,12 +397,15 @@ void InvertedIndexMap::getWriteBatch(
 	
 			// [3] Update document list of the term (boolean block) in the database:
 			DatabaseAdapter_DocListBlock::WriteCursor dbadapter_doclist( m_database, typeno, termno);
+			dbadapter_doclist.setBlockRefreshList( &blockRefreshList);
 	
+			std::size_t docBlockSize = BooleanBlock::blockSizeForDf( df);
+
 			// [3.1] Merge new docno boolean block elements
-			BooleanBlockBatchWrite::mergeNewElements( &dbadapter_doclist, di, de, newdocblk, transaction);
+			BooleanBlockBatchWrite::mergeNewElements( &dbadapter_doclist, di, de, newdocblk, transaction, docBlockSize);
 	
 			// [3.2] Insert new docno boolean block elements
-			BooleanBlockBatchWrite::insertNewElements( &dbadapter_doclist, di, de, newdocblk, lastInsertBlockId, transaction);
+			BooleanBlockBatchWrite::insertNewElements( &dbadapter_doclist, di, de, newdocblk, lastInsertBlockId, transaction, docBlockSize);
 		}
 	}{
 		// [4] Get df writes (and df changes to populate, if statisticsBuilder defined):
@@ -439,7 +448,7 @@ void InvertedIndexMap::insertNewPosElements(
 		if (ei->second)
 		{
 			// Define posinfo block elements (PosinfoBlock):
-			if (newposblk.fitsInto( m_posinfo[ ei->second] + 1) || newposblk.empty())
+			if (newposblk.fitsInto( m_posinfo.data() + ei->second) || newposblk.empty())
 			{
 				// Define docno list block elements (BooleanBlock):
 				defineDocnoRangeElement( docrangear, ei->first.docno, true);
@@ -521,7 +530,7 @@ void InvertedIndexMap::mergeNewPosElements(
 		// block and dispose the last block:
 		if (ei != ee && dbadapter_posinfo.loadLast( blk))
 		{
-			newposblk = PosinfoBlockBuilder( blk);
+			newposblk = PosinfoBlockBuilder( blk, newposblk.maxBlockSize());
 			dbadapter_posinfo.remove( transaction, blk.id());
 			newposblk.setId(0);
 		}
@@ -547,7 +556,7 @@ void InvertedIndexMap::mergePosBlock(
 			if (ei->second)
 			{
 				//... append only if not empty (empty => delete)
-				if (!newblk.fitsInto( m_posinfo[ ei->second]))
+				if (!newblk.fitsInto( m_posinfo.data() + ei->second))
 				{
 					newblk.setId(0);
 					if (!newblk.empty())
@@ -568,6 +577,16 @@ void InvertedIndexMap::mergePosBlock(
 		}
 		else
 		{
+			if (!newblk.fitsInto( oldblk.posinfo_at( blkcursor)))
+			{
+				newblk.setId(0);
+				if (!newblk.empty())
+				{
+					dbadapter_posinfo.store( transaction, newblk.createBlock());
+				}
+				newblk.clear();
+				newblk.setId( oldblk.id());
+			}
 			newblk.append( old_docno, oldblk.posinfo_at( blkcursor));
 			old_docno = oldblk.nextDoc( blkcursor);
 		}
@@ -577,7 +596,7 @@ void InvertedIndexMap::mergePosBlock(
 		if (ei->second)
 		{
 			//... append only if not empty (empty => delete)
-			if (!newblk.fitsInto( m_posinfo[ ei->second]))
+			if (!newblk.fitsInto( m_posinfo.data() + ei->second))
 			{
 				newblk.setId(0);
 				if (!newblk.empty())
@@ -593,7 +612,7 @@ void InvertedIndexMap::mergePosBlock(
 	}
 	while (old_docno)
 	{
-		if (!newblk.fitsInto( oldblk.frequency_at( blkcursor)))
+		if (!newblk.fitsInto( oldblk.posinfo_at( blkcursor)))
 		{
 			newblk.setId(0);
 			if (!newblk.empty())
@@ -608,6 +627,106 @@ void InvertedIndexMap::mergePosBlock(
 	}
 }
 
+static void appendFfElement(
+		DatabaseAdapter_FfBlock::WriteCursor& dbadapter_ff,
+		DatabaseTransactionInterface* transaction,
+		FfBlockBuilder& newblk,
+		const Index& docno,
+		unsigned int ff)
+{
+	newblk.append( docno, ff);
+	if (newblk.full())
+	{
+		dbadapter_ff.store( transaction, newblk.createBlock());
+		newblk.clear();
+	}
+}
+
+void InvertedIndexMap::mergeFfBlocks(
+		DatabaseTransactionInterface* transaction,
+		const Index& typeno,
+		const Index& termno,
+		Map::const_iterator ei,
+		const Map::const_iterator& ee,
+		std::size_t maxBlockSize,
+		std::vector<DataBlockCache::Key>& blockRefreshList)
+{
+	if (ei == ee) return;
+	DatabaseAdapter_FfBlock::WriteCursor dbadapter_ff( m_database, typeno, termno);
+	dbadapter_ff.setBlockRefreshList( &blockRefreshList);
+	FfBlockBuilder newblk( m_docFfBlockFormat, maxBlockSize);
+	FfBlock blk;
+	std::vector<Index> docnoar;
+	std::vector<unsigned int> ffar;
+
+	// [1] Rewrite the existing blocks the new elements fall into, merged with the new elements, the blocks in between are not touched:
+	bool rewritten = false;
+	bool more = dbadapter_ff.loadUpperBound( ei->first.docno, blk);
+	while (more)
+	{
+		blk.decode( docnoar, ffar);
+		dbadapter_ff.remove( transaction, blk.id());
+		rewritten = true;
+
+		std::size_t ai = 0, ae = docnoar.size();
+		while (ai != ae)
+		{
+			if (ei != ee && ei->first.docno <= docnoar[ ai])
+			{
+				// ... new element replaces an old one or is inserted before it
+				if (ei->first.docno == docnoar[ ai]) ++ai;
+				unsigned int ff = ei->second ? PosinfoBlock::encodedFrequency( m_posinfo.data() + ei->second, m_withLargePositions) : 0;
+				if (ff) appendFfElement( dbadapter_ff, transaction, newblk, ei->first.docno, ff);
+				++ei;
+			}
+			else
+			{
+				appendFfElement( dbadapter_ff, transaction, newblk, docnoar[ ai], ffar[ ai]);
+				++ai;
+			}
+		}
+		if (!dbadapter_ff.loadNext( blk))
+		{
+			// ... is the last block, the new elements left are appended to the rest of it
+			break;
+		}
+		if (!newblk.empty() && newblk.size() + blk.size() <= maxBlockSize)
+		{
+			// ... join the rest of the block rewritten with the following block if they fit together, to avoid fragmentation
+			continue;
+		}
+		if (!newblk.empty())
+		{
+			dbadapter_ff.store( transaction, newblk.createBlock());
+			newblk.clear();
+		}
+		more = (ei != ee) && dbadapter_ff.loadUpperBound( ei->first.docno, blk);
+	}
+	if (!rewritten && ei != ee && dbadapter_ff.loadLast( blk) && blk.size() < maxBlockSize)
+	{
+		// ... no block rewritten (usual for new documents, that get a docno bigger than any existing),
+		//	fill the first new block with the elements of the last block if it is not full and dispose it.
+		//	If a block was rewritten, the last block might be removed already in this transaction, what loadLast does not see:
+		blk.decode( docnoar, ffar);
+		dbadapter_ff.remove( transaction, blk.id());
+		std::size_t ai = 0, ae = docnoar.size();
+		for (; ai != ae; ++ai)
+		{
+			appendFfElement( dbadapter_ff, transaction, newblk, docnoar[ ai], ffar[ ai]);
+		}
+	}
+	// [2] Append the new elements after the last block:
+	for (; ei != ee; ++ei)
+	{
+		unsigned int ff = ei->second ? PosinfoBlock::encodedFrequency( m_posinfo.data() + ei->second, m_withLargePositions) : 0;
+		if (ff) appendFfElement( dbadapter_ff, transaction, newblk, ei->first.docno, ff);
+	}
+	if (!newblk.empty())
+	{
+		dbadapter_ff.store( transaction, newblk.createBlock());
+	}
+}
+
 void InvertedIndexMap::print( std::ostream& out) const
 {
 	out << "[typeno,termno,docno] to positions map:" << std::endl;
@@ -617,9 +736,9 @@ void InvertedIndexMap::print( std::ostream& out) const
 		Index termno = BlockKey(mi->first.termkey).elem(2);
 		Index docno = mi->first.docno;
 		Index typeno = BlockKey( mi->first.termkey).elem(1);
-		std::vector<PosinfoBlock::PositionType>::const_iterator pi = m_posinfo.begin() + mi->second;
-		std::size_t nofpos = *pi++;
-		std::vector<PosinfoBlock::PositionType>::const_iterator pe = pi + nofpos;
+		std::vector<Index> pos;
+		if (mi->second) PosinfoBlock::decodePositions( pos, m_posinfo.data() + mi->second, m_withLargePositions);
+		std::vector<Index>::const_iterator pi = pos.begin(), pe = pos.end();
 		out << "[termno=" << termno;
 		out << ", typeno=" << typeno;
 		out << ", docno=" << docno << "] ";
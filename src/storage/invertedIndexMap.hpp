@@ -9,12 +9,15 @@
 #define _STRUS_STORAGE_POSINFO_BLOCK_MAP_HPP_INCLUDED
 #include "strus/index.hpp"
 #include "posinfoBlock.hpp"
+#include "ffBlock.hpp"
 #include "booleanBlock.hpp"
 #include "invTermBlock.hpp"
 #include "documentFrequencyMap.hpp"
 #include "documentFrequencyCache.hpp"
 #include "databaseAdapter.hpp"
 #include "blockKey.hpp"
+#include "blockDirectory.hpp"
+#include "dataBlockCache.hpp"
 #include "private/localStructAllocator.hpp"
 #include <vector>
 #include <iostream>
@@ -31,7 +34,10 @@ class DatabaseTransactionInterface;
 class InvertedIndexMap
 {
 public:
-	explicit InvertedIndexMap( DatabaseClientInterface* database_);
+	/// \param[in] withDocFfBlocks_ true, if the doc/ff blocks (documents with feature frequencies without positions) have to be maintained
+	/// \param[in] docFfBlockFormat_ encoding of the doc/ff blocks written
+	/// \param[in] withLargePositions_ true, if documents with positions bigger than 65535 are allowed (see PosinfoBlock::withLargePositions())
+	InvertedIndexMap( DatabaseClientInterface* database_, bool withDocFfBlocks_, FfBlock::Format docFfBlockFormat_, bool withLargePositions_);
 
 	void definePosinfoPosting(
 		const Index& typeno,
@@ -46,12 +52,16 @@ public:
 			const std::map<Index,Index>& docnoUnknownMap,
 			const std::map<Index,Index>& termUnknownMap);
 
+	/// \param[out] blockDomainRefreshList where to append the block domains (posinfo, doc/ff and document list blocks of a term) with blocks written to
+	/// \param[out] blockRefreshList where to append the database keys of the posinfo, doc/ff and document list blocks stored or removed
 	void getWriteBatch(
 			DatabaseTransactionInterface* transaction,
 			StatisticsBuilderInterface* statisticsBuilder,
 			DocumentFrequencyCache::Batch* dfbatch,
 			const KeyMapInv& termTypeMapInv,
-			const KeyMapInv& termValueMapInv);
+			const KeyMapInv& termValueMapInv,
+			std::vector<BlockDirectoryCache::Key>& blockDomainRefreshList,
+			std::vector<DataBlockCache::Key>& blockRefreshList);
 
 	void print( std::ostream& out) const;
 
@@ -116,9 +126,21 @@ private:
 			const PosinfoBlock& oldblk,
 			PosinfoBlockBuilder& newblk);
 
+	void mergeFfBlocks(
+			DatabaseTransactionInterface* transaction,
+			const Index& typeno,
+			const Index& termno,
+			Map::const_iterator ei,
+			const Map::const_iterator& ee,
+			std::size_t maxBlockSize,
+			std::vector<DataBlockCache::Key>& blockRefreshList);
+
 private:
 	DocumentFrequencyMap m_dfmap;
 	DatabaseClientInterface* m_database;
+	bool m_withDocFfBlocks;
+	FfBlock::Format m_docFfBlockFormat;
+	bool m_withLargePositions;
 	Map m_map;
 	std::vector<PosinfoBlock::PositionType> m_posinfo;
 	InvTermMap m_invtermmap;
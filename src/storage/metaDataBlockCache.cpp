@@ -37,15 +37,14 @@ void MetaDataBlockCache::resetBlock( const Index& blockno)
 	std::size_t blkidx = blockno-1;
 
 	m_ar[ blkidx].reset();
+	m_zoneMapAr[ blkidx].reset();
 }
 
 
-const MetaDataRecord MetaDataBlockCache::get( const Index& docno)
+utils::SharedPtr<MetaDataBlock> MetaDataBlockCache::getBlock( const Index& blockno)
 {
-	if (docno > MaxDocno || docno <= 0) throw strus::runtime_error( _TXT( "document number out of range (%s)"), "meta data block cache");
-	std::size_t docidx     = (std::size_t)(docno -1);
-	std::size_t blkidx     = docidx / MetaDataBlock::BlockSize;
-	Index blockno          = blkidx+1;
+	if (blockno > CacheSize || blockno <= 0) throw strus::runtime_error( _TXT( "block number out of range (%s)"), "meta data block cache");
+	std::size_t blkidx = blockno-1;
 
 	// The fact that the reference counting of shared_ptr is
 	// thread safe is used to implement some kind of RCU:
@@ -63,6 +62,32 @@ const MetaDataRecord MetaDataBlockCache::get( const Index& docno)
 		}
 		blkref = m_ar[ blkidx];
 	}
-	return (*blkref)[ MetaDataBlock::index( docno)];
+	return blkref;
+}
+
+utils::SharedPtr<MetaDataZoneMap> MetaDataBlockCache::getZoneMap( const Index& blockno)
+{
+	if (blockno > CacheSize || blockno <= 0) throw strus::runtime_error( _TXT( "block number out of range (%s)"), "meta data block cache");
+	std::size_t blkidx = blockno-1;
+
+	utils::SharedPtr<MetaDataZoneMap> zoneref = m_zoneMapAr[ blkidx];
+	while (!zoneref.get())
+	{
+		MetaDataZoneMap* newzonemap = DatabaseAdapter_MetaDataZoneMap::loadPtr( m_database, &m_descr, blockno);
+		if (!newzonemap)
+		{
+			utils::SharedPtr<MetaDataBlock> blkref = getBlock( blockno);
+			newzonemap = new MetaDataZoneMap( &m_descr, *blkref);
+		}
+		m_zoneMapAr[ blkidx].reset( newzonemap);
+		zoneref = m_zoneMapAr[ blkidx];
+	}
+	return zoneref;
 }
 
+const MetaDataRecord MetaDataBlockCache::get( const Index& docno)
+{
+	if (docno > MaxDocno || docno <= 0) throw strus::runtime_error( _TXT( "document number out of range (%s)"), "meta data block cache");
+	utils::SharedPtr<MetaDataBlock> blkref = getBlock( MetaDataBlock::blockno( docno));
+	return (*blkref)[ MetaDataBlock::index( docno)];
+}
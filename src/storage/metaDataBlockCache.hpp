@@ -10,6 +10,7 @@
 #include "strus/index.hpp"
 #include "metaDataBlock.hpp"
 #include "metaDataRecord.hpp"
+#include "metaDataZoneMap.hpp"
 #include "databaseAdapter.hpp"
 #include <utility>
 #include <stdexcept>
@@ -31,6 +32,17 @@ public:
 
 	const MetaDataRecord get( const Index& docno);
 
+	/// \brief Get a block, load it if it is not cached yet
+	/// \param[in] blockno number of the block (MetaDataBlock::blockno(docno))
+	/// \return the block (shared with the cache)
+	utils::SharedPtr<MetaDataBlock> getBlock( const Index& blockno);
+
+	/// \brief Get the zone map (minimum and maximum values of the elements) of a block, load it if it is not cached yet
+	/// \param[in] blockno number of the block (MetaDataBlock::blockno(docno))
+	/// \return the zone map (shared with the cache)
+	/// \remark Zone maps not stored (storage created before zone maps were introduced) are built from the block
+	utils::SharedPtr<MetaDataZoneMap> getZoneMap( const Index& blockno);
+
 	void declareVoid( const Index& blockno);
 	void refresh();
 
@@ -48,6 +60,7 @@ private:
 	MetaDataDescription m_descr;
 	DatabaseAdapter_DocMetaData m_dbadapter;
 	utils::SharedPtr<MetaDataBlock> m_ar[ CacheSize];
+	utils::SharedPtr<MetaDataZoneMap> m_zoneMapAr[ CacheSize];
 	std::vector<unsigned int> m_voidar;
 };
 
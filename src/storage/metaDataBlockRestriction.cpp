@@ -0,0 +1,358 @@
+/*
+ * Copyright (c) 2014 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#include "metaDataBlockRestriction.hpp"
+#include "metaDataRestriction.hpp"
+#include "metaDataDescription.hpp"
+#include "metaDataZoneMap.hpp"
+#include "floatConversions.hpp"
+#include "strus/base/bitOperations.hpp"
+#include "private/internationalization.hpp"
+#include "private/errorUtils.hpp"
+#include <limits>
+#include <stdexcept>
+
+using namespace strus;
+
+int MetaDataBlockMatchMask::next( std::size_t idx) const
+{
+	std::size_t wi = idx >> 6;
+	if (wi >= (std::size_t)NofWords) return -1;
+	uint64_t word = m_ar[ wi] & (~(uint64_t)0 << (idx & 63));
+	for (;;)
+	{
+		if (word)
+		{
+			return (int)((wi << 6) + BitOperations::bitScanForward( word) - 1);
+		}
+		if (++wi >= (std::size_t)NofWords) return -1;
+		word = m_ar[ wi];
+	}
+}
+
+namespace {
+/// \brief Tag for the element type float16, that is stored as uint16_t
+struct Float16Element {};
+
+/// \brief Copy the values of one element of all records of a block into a contiguous array
+template <typename ElementType, typename ValueType>
+struct ColumnLoader
+{
+	static void load( ValueType* col, const char* blk, std::size_t recsize, unsigned int ofs)
+	{
+		const char* ptr = blk + ofs;
+		for (std::size_t ri=0; ri<(std::size_t)MetaDataBlock::BlockSize; ++ri,ptr+=recsize)
+		{
+			col[ ri] = (ValueType)*(const ElementType*)ptr;
+		}
+	}
+};
+
+template <>
+struct ColumnLoader<Float16Element,double>
+{
+	static void load( double* col, const char* blk, std::size_t recsize, unsigned int ofs)
+	{
+		const char* ptr = blk + ofs;
+		for (std::size_t ri=0; ri<(std::size_t)MetaDataBlock::BlockSize; ++ri,ptr+=recsize)
+		{
+			col[ ri] = floatHalfToSinglePrecision( *(const float16_t*)ptr);
+		}
+	}
+};
+
+// The comparisons are the same as the ones of the record wise evaluation in metaDataRestriction.cpp,
+// with an epsilon of 0 for integers:
+template <typename ValueType>
+struct CompareLess
+{
+	static bool test( ValueType val, ValueType opr, ValueType eps)	{return val + eps < opr;}
+};
+template <typename ValueType>
+struct CompareLessEqual
+{
+	static bool test( ValueType val, ValueType opr, ValueType eps)	{return val <= opr + eps;}
+};
+template <typename ValueType>
+struct CompareEqual
+{
+	static bool test( ValueType val, ValueType opr, ValueType eps)	{return (val + eps >= opr) & (val <= opr + eps);}
+};
+template <typename ValueType>
+struct CompareNotEqual
+{
+	static bool test( ValueType val, ValueType opr, ValueType eps)	{return !CompareEqual<ValueType>::test( val, opr, eps);}
+};
+template <typename ValueType>
+struct CompareGreater
+{
+	static bool test( ValueType val, ValueType opr, ValueType eps)	{return val > opr + eps;}
+};
+template <typename ValueType>
+struct CompareGreaterEqual
+{
+	static bool test( ValueType val, ValueType opr, ValueType eps)	{return val + eps >= opr;}
+};
+
+struct EpsilonNone
+{
+	static double value()	{return 0.0;}
+};
+struct EpsilonFloat16
+{
+	static double value()	{return 0.0004887581f;}
+};
+struct EpsilonFloat32
+{
+	static double value()	{return std::numeric_limits<float>::epsilon();}
+};
+}//anonymous namespace
+
+static inline void getOperandValue( int64_t& res, const NumericVariant& operand)
+{
+	res = operand.toint();
+}
+static inline void getOperandValue( uint64_t& res, const NumericVariant& operand)
+{
+	res = operand.touint();
+}
+static inline void getOperandValue( double& res, const NumericVariant& operand)
+{
+	res = (double)operand;
+}
+
+static void packMatchMask( MetaDataBlockMatchMask& mask, const unsigned char* res)
+{
+	uint64_t* ar = mask.ar();
+	for (int wi=0; wi<MetaDataBlockMatchMask::NofWords; ++wi,res+=64)
+	{
+		uint64_t word = 0;
+		for (int bi=0; bi<64; ++bi)
+		{
+			word |= (uint64_t)res[ bi] << bi;
+		}
+		ar[ wi] = word;
+	}
+}
+
+template <typename ElementType, typename ValueType, class Compare, class Epsilon>
+static void matchKernel(
+		MetaDataBlockMatchMask& mask,
+		const char* blk,
+		std::size_t recsize,
+		unsigned int ofs,
+		const NumericVariant& operand)
+{
+	ValueType col[ MetaDataBlock::BlockSize];
+	unsigned char res[ MetaDataBlock::BlockSize];
+
+	ColumnLoader<ElementType,ValueType>::load( col, blk, recsize, ofs);
+	ValueType opr;
+	getOperandValue( opr, operand);
+	const ValueType eps = (ValueType)Epsilon::value();
+
+	for (std::size_t ri=0; ri<(std::size_t)MetaDataBlock::BlockSize; ++ri)
+	{
+		res[ ri] = Compare::test( col[ ri], opr, eps);
+	}
+	packMatchMask( mask, res);
+}
+
+namespace {
+/// \brief Comparisons of the range of values of an element in a block, true if any value in the range matches
+template <typename ValueType, class Epsilon>
+struct ZoneCompare
+{
+	static bool less( const NumericVariant& minval, const NumericVariant&, const NumericVariant& operand)
+	{
+		ValueType mi,opr;
+		getOperandValue( mi, minval);
+		getOperandValue( opr, operand);
+		return CompareLess<ValueType>::test( mi, opr, (ValueType)Epsilon::value());
+	}
+	static bool lessEqual( const NumericVariant& minval, const NumericVariant&, const NumericVariant& operand)
+	{
+		ValueType mi,opr;
+		getOperandValue( mi, minval);
+		getOperandValue( opr, operand);
+		return CompareLessEqual<ValueType>::test( mi, opr, (ValueType)Epsilon::value());
+	}
+	static bool equal( const NumericVariant& minval, const NumericVariant& maxval, const NumericVariant& operand)
+	{
+		ValueType mi,ma,opr;
+		getOperandValue( mi, minval);
+		getOperandValue( ma, maxval);
+		getOperandValue( opr, operand);
+		const ValueType eps = (ValueType)Epsilon::value();
+		return CompareLessEqual<ValueType>::test( mi, opr, eps) && CompareGreaterEqual<ValueType>::test( ma, opr, eps);
+	}
+	static bool notEqual( const NumericVariant& minval, const NumericVariant& maxval, const NumericVariant& operand)
+	{
+		ValueType mi,ma,opr;
+		getOperandValue( mi, minval);
+		getOperandValue( ma, maxval);
+		getOperandValue( opr, operand);
+		const ValueType eps = (ValueType)Epsilon::value();
+		return CompareNotEqual<ValueType>::test( mi, opr, eps) || CompareNotEqual<ValueType>::test( ma, opr, eps);
+	}
+	static bool greater( const NumericVariant&, const NumericVariant& maxval, const NumericVariant& operand)
+	{
+		ValueType ma,opr;
+		getOperandValue( ma, maxval);
+		getOperandValue( opr, operand);
+		return CompareGreater<ValueType>::test( ma, opr, (ValueType)Epsilon::value());
+	}
+	static bool greaterEqual( const NumericVariant&, const NumericVariant& maxval, const NumericVariant& operand)
+	{
+		ValueType ma,opr;
+		getOperandValue( ma, maxval);
+		getOperandValue( opr, operand);
+		return CompareGreaterEqual<ValueType>::test( ma, opr, (ValueType)Epsilon::value());
+	}
+};
+}//anonymous namespace
+
+template <typename ValueType, class Epsilon>
+static MetaDataBlockRestriction::ZoneFunction getTypedZoneFunction( MetaDataRestrictionInterface::CompareOperator cmpop)
+{
+	switch (cmpop)
+	{
+		case MetaDataRestrictionInterface::CompareLess:
+			return &ZoneCompare<ValueType,Epsilon>::less;
+		case MetaDataRestrictionInterface::CompareLessEqual:
+			return &ZoneCompare<ValueType,Epsilon>::lessEqual;
+		case MetaDataRestrictionInterface::CompareEqual:
+			return &ZoneCompare<ValueType,Epsilon>::equal;
+		case MetaDataRestrictionInterface::CompareNotEqual:
+			return &ZoneCompare<ValueType,Epsilon>::notEqual;
+		case MetaDataRestrictionInterface::CompareGreater:
+			return &ZoneCompare<ValueType,Epsilon>::greater;
+		case MetaDataRestrictionInterface::CompareGreaterEqual:
+			return &ZoneCompare<ValueType,Epsilon>::greaterEqual;
+	}
+	throw strus::runtime_error( "%s", _TXT( "unknown meta data compare function"));
+}
+
+template <typename ElementType, typename ValueType, class Epsilon>
+static MetaDataBlockRestriction::KernelFunction getTypedKernelFunction( MetaDataRestrictionInterface::CompareOperator cmpop)
+{
+	switch (cmpop)
+	{
+		case MetaDataRestrictionInterface::CompareLess:
+			return &matchKernel<ElementType,ValueType,CompareLess<ValueType>,Epsilon>;
+		case MetaDataRestrictionInterface::CompareLessEqual:
+			return &matchKernel<ElementType,ValueType,CompareLessEqual<ValueType>,Epsilon>;
+		case MetaDataRestrictionInterface::CompareEqual:
+			return &matchKernel<ElementType,ValueType,CompareEqual<ValueType>,Epsilon>;
+		case MetaDataRestrictionInterface::CompareNotEqual:
+			return &matchKernel<ElementType,ValueType,CompareNotEqual<ValueType>,Epsilon>;
+		case MetaDataRestrictionInterface::CompareGreater:
+			return &matchKernel<ElementType,ValueType,CompareGreater<ValueType>,Epsilon>;
+		case MetaDataRestrictionInterface::CompareGreaterEqual:
+			return &matchKernel<ElementType,ValueType,CompareGreaterEqual<ValueType>,Epsilon>;
+	}
+	throw strus::runtime_error( "%s", _TXT( "unknown meta data compare function"));
+}
+
+MetaDataBlockRestriction::KernelFunction MetaDataBlockRestriction::getKernelFunction(
+		MetaDataElement::Type type,
+		MetaDataRestrictionInterface::CompareOperator cmpop)
+{
+	switch (type)
+	{
+		case MetaDataElement::Int8:
+			return getTypedKernelFunction<int8_t,int64_t,EpsilonNone>( cmpop);
+		case MetaDataElement::UInt8:
+			return getTypedKernelFunction<uint8_t,uint64_t,EpsilonNone>( cmpop);
+		case MetaDataElement::Int16:
+			return getTypedKernelFunction<int16_t,int64_t,EpsilonNone>( cmpop);
+		case MetaDataElement::UInt16:
+			return getTypedKernelFunction<uint16_t,uint64_t,EpsilonNone>( cmpop);
+		case MetaDataElement::Int32:
+			return getTypedKernelFunction<int32_t,int64_t,EpsilonNone>( cmpop);
+		case MetaDataElement::UInt32:
+			return getTypedKernelFunction<uint32_t,uint64_t,EpsilonNone>( cmpop);
+		case MetaDataElement::Float16:
+			return getTypedKernelFunction<Float16Element,double,EpsilonFloat16>( cmpop);
+		case MetaDataElement::Float32:
+			return getTypedKernelFunction<float,double,EpsilonFloat32>( cmpop);
+	}
+	throw strus::runtime_error( _TXT( "unknown type in meta data restriction: '%d'"), (int)type);
+}
+
+MetaDataBlockRestriction::ZoneFunction MetaDataBlockRestriction::getZoneFunction(
+		MetaDataElement::Type type,
+		MetaDataRestrictionInterface::CompareOperator cmpop)
+{
+	switch (type)
+	{
+		case MetaDataElement::Int8:
+		case MetaDataElement::Int16:
+		case MetaDataElement::Int32:
+			return getTypedZoneFunction<int64_t,EpsilonNone>( cmpop);
+		case MetaDataElement::UInt8:
+		case MetaDataElement::UInt16:
+		case MetaDataElement::UInt32:
+			return getTypedZoneFunction<uint64_t,EpsilonNone>( cmpop);
+		case MetaDataElement::Float16:
+			return getTypedZoneFunction<double,EpsilonFloat16>( cmpop);
+		case MetaDataElement::Float32:
+			return getTypedZoneFunction<double,EpsilonFloat32>( cmpop);
+	}
+	throw strus::runtime_error( _TXT( "unknown type in meta data restriction: '%d'"), (int)type);
+}
+
+MetaDataBlockRestriction::MetaDataBlockRestriction(
+		const MetaDataDescription* description_,
+		const std::vector<MetaDataCompareOperation>& opar_)
+	:m_kernels(),m_recordSize(description_->bytesize())
+{
+	m_kernels.reserve( opar_.size());
+	std::vector<MetaDataCompareOperation>::const_iterator
+		oi = opar_.begin(), oe = opar_.end();
+	for (; oi != oe; ++oi)
+	{
+		const MetaDataElement* elem = description_->get( oi->elementHandle());
+		m_kernels.push_back( Kernel( getKernelFunction( elem->type(), oi->opr()), getZoneFunction( elem->type(), oi->opr()), elem, oi->operand(), oi->newGroup()));
+	}
+}
+
+void MetaDataBlockRestriction::match( MetaDataBlockMatchMask& mask, const MetaDataBlock& block) const
+{
+	mask.fill();
+	MetaDataBlockMatchMask groupmask;
+	MetaDataBlockMatchMask elemmask;
+
+	std::vector<Kernel>::const_iterator ki = m_kernels.begin(), ke = m_kernels.end();
+	while (ki != ke)
+	{
+		ki->func( groupmask, block.charptr(), m_recordSize, ki->elem->ofs(), ki->operand);
+		for (++ki; ki != ke && !ki->newGroup; ++ki)
+		{
+			ki->func( elemmask, block.charptr(), m_recordSize, ki->elem->ofs(), ki->operand);
+			groupmask.unite( elemmask);
+		}
+		mask.join( groupmask);
+		if (mask.empty()) break;
+	}
+}
+
+bool MetaDataBlockRestriction::mayMatch( const MetaDataZoneMap& zonemap) const
+{
+	std::vector<Kernel>::const_iterator ki = m_kernels.begin(), ke = m_kernels.end();
+	while (ki != ke)
+	{
+		bool val = ki->zonefunc( zonemap.minValue( ki->elem), zonemap.maxValue( ki->elem), ki->operand);
+		for (++ki; ki != ke && !ki->newGroup; ++ki)
+		{
+			val = val || ki->zonefunc( zonemap.minValue( ki->elem), zonemap.maxValue( ki->elem), ki->operand);
+		}
+		if (!val) return false;
+	}
+	return true;
+}
+
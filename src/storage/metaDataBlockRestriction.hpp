@@ -0,0 +1,159 @@
+/*
+ * Copyright (c) 2014 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Evaluation of a meta data restriction for all records of a meta data block at once
+/// \file "metaDataBlockRestriction.hpp"
+#ifndef _STRUS_STORAGE_METADATA_BLOCK_RESTRICTION_HPP_INCLUDED
+#define _STRUS_STORAGE_METADATA_BLOCK_RESTRICTION_HPP_INCLUDED
+#include "metaDataBlock.hpp"
+#include "metaDataElement.hpp"
+#include "strus/metaDataRestrictionInterface.hpp"
+#include "strus/numericVariant.hpp"
+#include <vector>
+#include <cstddef>
+#include <stdint.h>
+
+namespace strus {
+
+/// \brief Forward declaration
+class MetaDataDescription;
+/// \brief Forward declaration
+class MetaDataCompareOperation;
+/// \brief Forward declaration
+class MetaDataZoneMap;
+
+/// \brief Bitmask with one bit per record of a meta data block, bit i set if record i matches
+class MetaDataBlockMatchMask
+{
+public:
+	enum {
+		NofWords=(MetaDataBlock::BlockSize/64)	///< number of 64 bit words of the mask
+	};
+
+	MetaDataBlockMatchMask()
+	{
+		clear();
+	}
+
+	void clear()
+	{
+		for (int wi=0; wi<NofWords; ++wi) m_ar[ wi] = 0;
+	}
+	void fill()
+	{
+		for (int wi=0; wi<NofWords; ++wi) m_ar[ wi] = ~(uint64_t)0;
+	}
+	bool empty() const
+	{
+		uint64_t rt = 0;
+		for (int wi=0; wi<NofWords; ++wi) rt |= m_ar[ wi];
+		return !rt;
+	}
+
+	/// \brief Test if the record with index idx (0..BlockSize-1) in the block matches
+	bool test( std::size_t idx) const
+	{
+		return (m_ar[ idx >> 6] & ((uint64_t)1 << (idx & 63))) != 0;
+	}
+
+	/// \brief Get the smallest index of a matching record bigger than or equal to idx
+	/// \return the index found or -1, if there is none
+	int next( std::size_t idx) const;
+
+	void join( const MetaDataBlockMatchMask& o)
+	{
+		for (int wi=0; wi<NofWords; ++wi) m_ar[ wi] &= o.m_ar[ wi];
+	}
+	void unite( const MetaDataBlockMatchMask& o)
+	{
+		for (int wi=0; wi<NofWords; ++wi) m_ar[ wi] |= o.m_ar[ wi];
+	}
+
+	uint64_t* ar()			{return m_ar;}
+	const uint64_t* ar() const	{return m_ar;}
+
+private:
+	uint64_t m_ar[ NofWords];
+};
+
+/// \brief Meta data restriction compiled into compare kernels typed by the meta data element type, that evaluate one condition on all records of a block
+/// \remark The kernels read the column of an element into a contiguous array and compare it in a loop without branches, that the compiler can vectorize
+class MetaDataBlockRestriction
+{
+public:
+	/// \brief Compile a restriction
+	/// \param[in] description_ description of the meta data table
+	/// \param[in] opar_ list of comparison operations as CNF
+	MetaDataBlockRestriction(
+			const MetaDataDescription* description_,
+			const std::vector<MetaDataCompareOperation>& opar_);
+
+	MetaDataBlockRestriction( const MetaDataBlockRestriction& o)
+		:m_kernels(o.m_kernels),m_recordSize(o.m_recordSize){}
+
+	/// \brief Evaluate the restriction for all records of a block
+	/// \param[out] mask the bitmask of the records matching
+	/// \param[in] block block to evaluate
+	void match( MetaDataBlockMatchMask& mask, const MetaDataBlock& block) const;
+
+	/// \brief Evaluate if any record of a block can match the restriction, looking only at the minimum and maximum values of the elements in the block
+	/// \param[in] zonemap zone map of the block
+	/// \return false, if no record of the block can match, true if some may match
+	bool mayMatch( const MetaDataZoneMap& zonemap) const;
+
+	/// \brief Function evaluating one condition for all records of a block
+	/// \param[out] mask the bitmask of the records matching the condition
+	/// \param[in] blk pointer to the first record of the block
+	/// \param[in] recsize size of one record in bytes
+	/// \param[in] ofs offset of the element in the record
+	/// \param[in] operand operand to compare with
+	typedef void (*KernelFunction)(
+			MetaDataBlockMatchMask& mask,
+			const char* blk,
+			std::size_t recsize,
+			unsigned int ofs,
+			const NumericVariant& operand);
+
+	/// \brief Function evaluating if any value in the range of the minimum and the maximum value of an element can match a condition
+	/// \param[in] minval minimum value of the element
+	/// \param[in] maxval maximum value of the element
+	/// \param[in] operand operand to compare with
+	typedef bool (*ZoneFunction)(
+			const NumericVariant& minval,
+			const NumericVariant& maxval,
+			const NumericVariant& operand);
+
+private:
+	static KernelFunction getKernelFunction(
+			MetaDataElement::Type type_,
+			MetaDataRestrictionInterface::CompareOperator opr_);
+	static ZoneFunction getZoneFunction(
+			MetaDataElement::Type type_,
+			MetaDataRestrictionInterface::CompareOperator opr_);
+
+	struct Kernel
+	{
+		KernelFunction func;		///< function implementing the comparison for the element type
+		ZoneFunction zonefunc;		///< function implementing the comparison with the zone map for the element type
+		const MetaDataElement* elem;	///< element compared
+		NumericVariant operand;		///< operand to compare with
+		bool newGroup;			///< true if the condition opens a new OR group in the CNF
+
+		Kernel( KernelFunction func_, ZoneFunction zonefunc_, const MetaDataElement* elem_, const NumericVariant& operand_, bool newGroup_)
+			:func(func_),zonefunc(zonefunc_),elem(elem_),operand(operand_),newGroup(newGroup_){}
+		Kernel( const Kernel& o)
+			:func(o.func),zonefunc(o.zonefunc),elem(o.elem),operand(o.operand),newGroup(o.newGroup){}
+	};
+
+private:
+	std::vector<Kernel> m_kernels;		///< compiled conditions of the CNF
+	std::size_t m_recordSize;		///< size of one meta data record in bytes
+};
+
+}//namespace
+#endif
+
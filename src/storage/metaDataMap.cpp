@@ -11,6 +11,7 @@
 #include "strus/databaseTransactionInterface.hpp"
 #include "dataBlock.hpp"
 #include "databaseAdapter.hpp"
+#include "metaDataZoneMap.hpp"
 #include "keyMap.hpp"
 #include "private/internationalization.hpp"
 #include <cstring>
@@ -90,6 +91,8 @@ void MetaDataMap::getWriteBatch( DatabaseTransactionInterface* transaction, std:
 			if (!blk.empty())
 			{
 				dbadapter.store( transaction, blk);
+				MetaDataZoneMap zonemap( m_descr, blk);
+				DatabaseAdapter_MetaDataZoneMap::store( transaction, zonemap);
 			}
 			if (dbadapter.load( bn, blk))
 			{
@@ -108,6 +111,8 @@ void MetaDataMap::getWriteBatch( DatabaseTransactionInterface* transaction, std:
 	if (!blk.empty())
 	{
 		dbadapter.store( transaction, blk);
+		MetaDataZoneMap zonemap( m_descr, blk);
+		DatabaseAdapter_MetaDataZoneMap::store( transaction, zonemap);
 	}
 }
 
@@ -130,6 +135,8 @@ void MetaDataMap::rewriteMetaData(
 				*m_descr, blk.ptr(), MetaDataBlock::BlockSize);
 		MetaDataBlock newblk( &newDescr, blk.blockno(), newblk_data, newblk_bytesize);
 		dbadapter.store( transaction, newblk);
+		MetaDataZoneMap newzonemap( &newDescr, newblk);
+		DatabaseAdapter_MetaDataZoneMap::store( transaction, newzonemap);
 	}
 }
 
@@ -14,7 +14,12 @@
 #include "strus/errorBufferInterface.hpp"
 #include "strus/index.hpp"
 #include "strus/reference.hpp"
+#include "metaDataBlockCache.hpp"
+#include "metaDataDescription.hpp"
+#include "metaDataZoneMap.hpp"
 #include "private/internationalization.hpp"
+#include "private/utils.hpp"
+#include <limits>
 
 namespace strus
 {
@@ -25,16 +30,21 @@ class MetaDataRangePostingIterator
 	:public PostingIteratorInterface
 {
 public:
-	MetaDataRangePostingIterator( MetaDataReaderInterface* metareader_, Index nofDocuments_, const std::string& name_from, const std::string& name_to, ErrorBufferInterface* errorhnd_)
+	MetaDataRangePostingIterator( MetaDataReaderInterface* metareader_, MetaDataBlockCache* blockCache_, const MetaDataDescription* descr_, Index nofDocuments_, const std::string& name_from, const std::string& name_to, ErrorBufferInterface* errorhnd_)
 		:m_errorhnd(errorhnd_)
 		,m_metareader(metareader_)
+		,m_blockCache(blockCache_)
 		,m_docno(0)
 		,m_handle_lo(name_from.empty()?-1:metareader_->elementHandle(name_from))
 		,m_handle_hi(name_to.empty()?-1:metareader_->elementHandle(name_to))
+		,m_elem_lo(0)
+		,m_elem_hi(0)
 		,m_pos_lo(0)
 		,m_pos_hi(0)
 		,m_posno(0)
 		,m_nofDocuments(nofDocuments_)
+		,m_zoneBlockno(0)
+		,m_zoneMayMatch(true)
 	{
 		m_featureid.append( name_from);
 		m_featureid.push_back( ':');
@@ -44,6 +54,8 @@ public:
 
 		if (m_handle_lo < 0 && !name_from.empty()) throw strus::runtime_error(_TXT("failed to define posting iterator from meta data (lower bound): undefined metadata element '%s'"), name_from.c_str());
 		if (m_handle_hi < 0 && !name_to.empty()) throw strus::runtime_error(_TXT("failed to define posting iterator from meta data (upper bound): undefined metadata element '%s'"), name_to.c_str());
+		if (m_handle_lo >= 0) m_elem_lo = descr_->get( m_handle_lo);
+		if (m_handle_hi >= 0) m_elem_hi = descr_->get( m_handle_hi);
 	}
 
 	virtual ~MetaDataRangePostingIterator()
@@ -59,6 +71,14 @@ public:
 			++m_docno;
 			if (m_docno >= m_nofDocuments) return m_docno = 0;
 
+			Index blockno = MetaDataBlock::blockno( m_docno);
+			if (!blockMayMatch( blockno))
+			{
+				// ... no document of this block defines a range, continue with the next block
+				m_docno = blockno * MetaDataBlock::BlockSize;
+				m_pos_lo = 0;
+				continue;
+			}
 			m_metareader->skipDoc( m_docno);
 			m_pos_lo = m_handle_lo < 0 ? 1 : (Index)m_metareader->getValue( m_handle_lo).toint();
 			m_pos_hi = m_handle_hi < 0 ? std::numeric_limits<Index>::max() : (Index)m_metareader->getValue( m_handle_hi).toint();
@@ -76,6 +96,11 @@ public:
 		return skipDocImpl( docno_);
 	}
 
+	virtual bool skipDocBlock( const Index&, Index*, unsigned int*, std::size_t, std::size_t&)
+	{
+		return false;
+	}
+
 	virtual Index skipPos( const Index& firstpos)
 	{
 		if (firstpos < m_pos_lo) return m_posno = m_pos_lo;
@@ -98,6 +123,19 @@ public:
 		return m_pos_hi - m_pos_lo;
 	}
 
+	virtual Index skipBlockMax( const Index&, unsigned int& maxff)
+	{
+		// ... the frequency depends on the meta data values of the document, no bound known
+		maxff = std::numeric_limits<unsigned int>::max();
+		return std::numeric_limits<Index>::max();
+	}
+
+	virtual unsigned int nofBlocksLoaded() const
+	{
+		// ... meta data blocks are read through the meta data block cache and not counted
+		return 0;
+	}
+
 	virtual Index docno() const
 	{
 		return m_docno;
@@ -113,16 +151,46 @@ public:
 		return m_posno?1:0;
 	}
 
+private:
+	/// \brief Evaluate with the zone map of a block, if any document in the block can define a non empty range
+	bool blockMayMatch( const Index& blockno)
+	{
+		if (blockno != m_zoneBlockno)
+		{
+			utils::SharedPtr<MetaDataZoneMap> zonemap = m_blockCache->getZoneMap( blockno);
+			int64_t lo_min = m_elem_lo ? zonemap->minValue( m_elem_lo).toint() : 1;
+			int64_t lo_max = m_elem_lo ? zonemap->maxValue( m_elem_lo).toint() : 1;
+			int64_t hi_min = m_elem_hi ? zonemap->minValue( m_elem_hi).toint() : std::numeric_limits<Index>::max();
+			int64_t hi_max = m_elem_hi ? zonemap->maxValue( m_elem_hi).toint() : std::numeric_limits<Index>::max();
+
+			bool lo_null = (lo_min == 0 && lo_max == 0);
+			bool hi_null = (hi_min == 0 && hi_max == 0);
+			// ... the comparison of the bounds is only valid if they are not truncated when converted to a position
+			bool inrange = lo_min >= std::numeric_limits<Index>::min() && lo_max <= std::numeric_limits<Index>::max()
+					&& hi_min >= std::numeric_limits<Index>::min() && hi_max <= std::numeric_limits<Index>::max();
+			bool empty = inrange && lo_min >= hi_max;
+
+			m_zoneMayMatch = !lo_null && !hi_null && !empty;
+			m_zoneBlockno = blockno;
+		}
+		return m_zoneMayMatch;
+	}
+
 private:
 	ErrorBufferInterface* m_errorhnd;
 	Reference<MetaDataReaderInterface> m_metareader;
+	MetaDataBlockCache* m_blockCache;		///< cache to read the zone maps of the meta data blocks from
 	Index m_docno;
 	Index m_handle_lo;
 	Index m_handle_hi;
+	const MetaDataElement* m_elem_lo;		///< element defining the start of the range or NULL if undefined
+	const MetaDataElement* m_elem_hi;		///< element defining the end of the range or NULL if undefined
 	Index m_pos_lo;
 	Index m_pos_hi;
 	Index m_posno;
 	Index m_nofDocuments;
+	Index m_zoneBlockno;				///< number of the block m_zoneMayMatch has been evaluated for
+	bool m_zoneMayMatch;				///< false if no document of the block m_zoneBlockno can define a range
 	std::string m_featureid;
 };
 
@@ -6,6 +6,8 @@
  * file, You can obtain one at http://mozilla.org/MPL/2.0/.
  */
 #include "metaDataRestriction.hpp"
+#include "metaDataBlockCache.hpp"
+#include "metaDataDescription.hpp"
 #include "strus/metaDataReaderInterface.hpp"
 #include "strus/errorBufferInterface.hpp"
 #include "strus/storageClientInterface.hpp"
@@ -269,9 +271,15 @@ std::string MetaDataCompareOperation::tostring() const
 MetaDataRestrictionInstance::MetaDataRestrictionInstance(
 		MetaDataReaderInterface* metadata_,
 		const std::vector<MetaDataCompareOperation>& opar_,
+		const Index& maxDocno_,
 		ErrorBufferInterface* errorhnd_)
 	:m_opar(opar_)
 	,m_metadata(metadata_)
+	,m_blockCache(0)
+	,m_blockRestriction()
+	,m_blockno(0)
+	,m_blockMask()
+	,m_maxDocno(maxDocno_)
 	,m_errorhnd(errorhnd_)
 {
 	if (!m_metadata.get())
@@ -280,29 +288,112 @@ MetaDataRestrictionInstance::MetaDataRestrictionInstance(
 	}
 }
 
+MetaDataRestrictionInstance::MetaDataRestrictionInstance(
+		MetaDataBlockCache* blockCache_,
+		const MetaDataDescription* description_,
+		const std::vector<MetaDataCompareOperation>& opar_,
+		const Index& maxDocno_,
+		ErrorBufferInterface* errorhnd_)
+	:m_opar(opar_)
+	,m_metadata()
+	,m_blockCache(blockCache_)
+	,m_blockRestriction( new MetaDataBlockRestriction( description_, opar_))
+	,m_blockno(0)
+	,m_blockMask()
+	,m_maxDocno(maxDocno_)
+	,m_errorhnd(errorhnd_)
+{}
+
+void MetaDataRestrictionInstance::loadBlockMask( const Index& blockno) const
+{
+	utils::SharedPtr<MetaDataZoneMap> zonemap = m_blockCache->getZoneMap( blockno);
+	if (m_blockRestriction->mayMatch( *zonemap))
+	{
+		utils::SharedPtr<MetaDataBlock> block = m_blockCache->getBlock( blockno);
+		m_blockRestriction->match( m_blockMask, *block);
+	}
+	else
+	{
+		// ... no record can match, the block is not evaluated
+		m_blockMask.clear();
+	}
+	m_blockno = blockno;
+}
+
 bool MetaDataRestrictionInstance::match( const Index& docno) const
 {
-	m_metadata->skipDoc( docno);
-	std::vector<MetaDataCompareOperation>::const_iterator
-		oi = m_opar.begin(), oe = m_opar.end();
-	while (oi != oe)
+	try
+	{
+		if (m_blockRestriction.get())
+		{
+			Index blockno = MetaDataBlock::blockno( docno);
+			if (blockno != m_blockno)
+			{
+				loadBlockMask( blockno);
+			}
+			return m_blockMask.test( MetaDataBlock::index( docno));
+		}
+		m_metadata->skipDoc( docno);
+		std::vector<MetaDataCompareOperation>::const_iterator
+			oi = m_opar.begin(), oe = m_opar.end();
+		while (oi != oe)
+		{
+			bool val = oi->match( m_metadata.get());
+			for (++oi; oi != oe && !oi->newGroup(); ++oi)
+			{
+				val |= oi->match( m_metadata.get());
+			}
+			if (!val) return false;
+		}
+		return true;
+	}
+	CATCH_ERROR_MAP_RETURN( _TXT("error in meta data restriction match: %s"), *m_errorhnd, false);
+}
+
+Index MetaDataRestrictionInstance::skipDoc( const Index& docno) const
+{
+	try
 	{
-		bool val = oi->match( m_metadata.get());
-		for (++oi; oi != oe && !oi->newGroup(); ++oi)
+		Index dn = (docno <= 0) ? 1 : docno;
+		if (m_blockRestriction.get())
+		{
+			// ... skip whole blocks without any record matching
+			while (dn <= m_maxDocno)
+			{
+				Index blockno = MetaDataBlock::blockno( dn);
+				if (blockno != m_blockno)
+				{
+					loadBlockMask( blockno);
+				}
+				int idx = m_blockMask.next( MetaDataBlock::index( dn));
+				if (idx >= 0)
+				{
+					Index rt = (blockno-1) * MetaDataBlock::BlockSize + idx + 1;
+					return (rt <= m_maxDocno) ? rt : 0;
+				}
+				dn = blockno * MetaDataBlock::BlockSize + 1;
+			}
+			return 0;
+		}
+		for (; dn <= m_maxDocno; ++dn)
 		{
-			val |= oi->match( m_metadata.get());
+			if (match( dn)) return dn;
 		}
-		if (!val) return false;
+		return 0;
 	}
-	return true;
+	CATCH_ERROR_MAP_RETURN( _TXT("error in meta data restriction skip document: %s"), *m_errorhnd, 0);
 }
 
 
 MetaDataRestriction::MetaDataRestriction(
 		const StorageClientInterface* storage_,
+		MetaDataBlockCache* blockCache_,
+		const MetaDataDescription* description_,
 		ErrorBufferInterface* errorhnd_)
 	:m_opar()
 	,m_storage(storage_)
+	,m_blockCache(blockCache_)
+	,m_description(description_)
 	,m_metadata(storage_->createMetaDataReader())
 	,m_errorhnd(errorhnd_)
 {}
@@ -368,7 +459,7 @@ MetaDataRestrictionInstanceInterface* MetaDataRestriction::createInstance() cons
 {
 	try
 	{
-		return new MetaDataRestrictionInstance( m_storage->createMetaDataReader(), m_opar, m_errorhnd);
+		return new MetaDataRestrictionInstance( m_blockCache, m_description, m_opar, m_storage->maxDocumentNumber(), m_errorhnd);
 	}
 	CATCH_ERROR_MAP_RETURN( _TXT("failed to create meta data restriction instance: %s"), *m_errorhnd, 0);
 }
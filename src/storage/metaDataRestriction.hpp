@@ -12,6 +12,7 @@
 #include "strus/numericVariant.hpp"
 #include "strus/index.hpp"
 #include "strus/reference.hpp"
+#include "metaDataBlockRestriction.hpp"
 #include <vector>
 #include <string>
 
@@ -23,6 +24,10 @@ class StorageClientInterface;
 class MetaDataReaderInterface;
 /// \brief Forward declaration
 class ErrorBufferInterface;
+/// \brief Forward declaration
+class MetaDataBlockCache;
+/// \brief Forward declaration
+class MetaDataDescription;
 
 /// \brief Structure representing one compare operation in a meta data restriction
 class MetaDataCompareOperation
@@ -68,6 +73,13 @@ public:
 	/// \return true if yes
 	bool newGroup() const					{return m_newGroup;}
 
+	/// \brief Get the comparison operator
+	CompareOperator opr() const				{return m_opr;}
+	/// \brief Get the handle of the metadata element compared
+	Index elementHandle() const				{return m_elementHandle;}
+	/// \brief Get the operand to compare with the metadata element
+	const NumericVariant& operand() const			{return m_operand;}
+
 private:
 	static CompareFunction getCompareFunction( const char* type_, CompareOperator opr_);
 
@@ -85,19 +97,47 @@ class MetaDataRestrictionInstance
 	:public MetaDataRestrictionInstanceInterface
 {
 public:
+	/// \brief Constructor for an instance evaluating the restriction record by record
 	/// \param[in] metadata_ metadata reader (ownership passed)
+	/// \param[in] opar_ list of comparison operations as CNF
+	/// \param[in] maxDocno_ maximum document number to search in
+	/// \param[in] errorhnd_ buffer for reporting errors
 	MetaDataRestrictionInstance(
 			MetaDataReaderInterface* metadata_,
 			const std::vector<MetaDataCompareOperation>& opar_,
+			const Index& maxDocno_,
+			ErrorBufferInterface* errorhnd_);
+
+	/// \brief Constructor for an instance evaluating the restriction for a whole meta data block at once
+	/// \param[in] blockCache_ cache to read the meta data blocks from
+	/// \param[in] description_ description of the meta data table
+	/// \param[in] opar_ list of comparison operations as CNF
+	/// \param[in] maxDocno_ maximum document number to search in
+	/// \param[in] errorhnd_ buffer for reporting errors
+	MetaDataRestrictionInstance(
+			MetaDataBlockCache* blockCache_,
+			const MetaDataDescription* description_,
+			const std::vector<MetaDataCompareOperation>& opar_,
+			const Index& maxDocno_,
 			ErrorBufferInterface* errorhnd_);
 
 	virtual ~MetaDataRestrictionInstance(){}
 
 	virtual bool match( const Index& docno) const;
 
+	virtual Index skipDoc( const Index& docno) const;
+
+private:
+	void loadBlockMask( const Index& blockno) const;
+
 private:
 	std::vector<MetaDataCompareOperation> m_opar;		///< list of comparison operations as CNF
-	mutable Reference<MetaDataReaderInterface> m_metadata;	///< we change it only when calling match and there is no other method accessing this metadata reader
+	mutable Reference<MetaDataReaderInterface> m_metadata;	///< we change it only when calling match and there is no other method accessing this metadata reader (record wise evaluation)
+	MetaDataBlockCache* m_blockCache;			///< cache to read the meta data blocks from (block wise evaluation)
+	Reference<MetaDataBlockRestriction> m_blockRestriction;	///< restriction compiled for the block wise evaluation, NULL for the record wise evaluation
+	mutable Index m_blockno;				///< number of the block the match mask has been calculated for
+	mutable MetaDataBlockMatchMask m_blockMask;		///< match mask of the block m_blockno
+	Index m_maxDocno;					///< maximum document number to search in
 	ErrorBufferInterface* m_errorhnd;			///< buffer for reporting errors
 };
 
@@ -106,8 +146,14 @@ class MetaDataRestriction
 	:public MetaDataRestrictionInterface
 {
 public:
+	/// \param[in] storage_ storage reference
+	/// \param[in] blockCache_ cache to read the meta data blocks from
+	/// \param[in] description_ description of the meta data table
+	/// \param[in] errorhnd_ buffer for reporting errors
 	MetaDataRestriction(
 			const StorageClientInterface* storage_,
+			MetaDataBlockCache* blockCache_,
+			const MetaDataDescription* description_,
 			ErrorBufferInterface* errorhnd_);
 
 	virtual ~MetaDataRestriction()
@@ -126,6 +172,8 @@ public:
 private:
 	std::vector<MetaDataCompareOperation> m_opar;		///< list of comparison operations as CNF
 	const StorageClientInterface* m_storage;		///< storage reference
+	MetaDataBlockCache* m_blockCache;			///< cache to read the meta data blocks from
+	const MetaDataDescription* m_description;		///< description of the meta data table
 	Reference<MetaDataReaderInterface> m_metadata;		///< meta data reader for inspecting the table elements
 	ErrorBufferInterface* m_errorhnd;			///< buffer for reporting errors
 };
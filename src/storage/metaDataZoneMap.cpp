@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) 2014 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#include "metaDataZoneMap.hpp"
+#include "metaDataBlock.hpp"
+#include "metaDataElement.hpp"
+#include "floatConversions.hpp"
+#include "private/internationalization.hpp"
+#include "private/errorUtils.hpp"
+#include <cstring>
+#include <cstdlib>
+#include <stdexcept>
+#include <new>
+
+using namespace strus;
+
+namespace {
+/// \brief Access to the value of an element for comparison
+template <typename ElementType>
+struct ElementValue
+{
+	typedef ElementType CompareType;
+	static CompareType get( const char* ptr)	{return *(const ElementType*)ptr;}
+};
+
+/// \brief Tag for the element type float16, that is stored as uint16_t but compared as float
+struct Float16Element {};
+
+template <>
+struct ElementValue<Float16Element>
+{
+	typedef float CompareType;
+	static CompareType get( const char* ptr)	{return floatHalfToSinglePrecision( *(const float16_t*)ptr);}
+};
+}//anonymous namespace
+
+template <typename ElementType>
+static void buildElementMinMax( char* minrec, char* maxrec, const char* blk, std::size_t recsize, unsigned int ofs, std::size_t elemsize)
+{
+	typedef typename ElementValue<ElementType>::CompareType CompareType;
+	const char* ptr = blk + ofs;
+	const char* minptr = ptr;
+	const char* maxptr = ptr;
+	CompareType minval = ElementValue<ElementType>::get( ptr);
+	CompareType maxval = minval;
+
+	std::size_t ri = 1, re = MetaDataBlock::BlockSize;
+	for (ptr += recsize; ri < re; ++ri,ptr+=recsize)
+	{
+		CompareType val = ElementValue<ElementType>::get( ptr);
+		if (val < minval)
+		{
+			minval = val;
+			minptr = ptr;
+		}
+		if (val > maxval)
+		{
+			maxval = val;
+			maxptr = ptr;
+		}
+	}
+	// ... copy the values found as they are stored
+	std::memcpy( minrec + ofs, minptr, elemsize);
+	std::memcpy( maxrec + ofs, maxptr, elemsize);
+}
+
+MetaDataZoneMap::MetaDataZoneMap( const MetaDataDescription* descr_, const MetaDataBlock& blk)
+	:m_descr(descr_),m_blockno(blk.blockno()),m_ptr(0)
+{
+	std::size_t recsize = m_descr->bytesize();
+	m_ptr = (char*)std::calloc( 2, recsize);
+	if (!m_ptr) throw std::bad_alloc();
+	char* minrec = m_ptr;
+	char* maxrec = m_ptr + recsize;
+
+	std::size_t ei = 0, ee = m_descr->nofElements();
+	for (; ei != ee; ++ei)
+	{
+		const MetaDataElement* elem = m_descr->get( ei);
+		switch (elem->type())
+		{
+			case MetaDataElement::Int8:
+				buildElementMinMax<int8_t>( minrec, maxrec, blk.charptr(), recsize, elem->ofs(), elem->size());
+				break;
+			case MetaDataElement::UInt8:
+				buildElementMinMax<uint8_t>( minrec, maxrec, blk.charptr(), recsize, elem->ofs(), elem->size());
+				break;
+			case MetaDataElement::Int16:
+				buildElementMinMax<int16_t>( minrec, maxrec, blk.charptr(), recsize, elem->ofs(), elem->size());
+				break;
+			case MetaDataElement::UInt16:
+				buildElementMinMax<uint16_t>( minrec, maxrec, blk.charptr(), recsize, elem->ofs(), elem->size());
+				break;
+			case MetaDataElement::Int32:
+				buildElementMinMax<int32_t>( minrec, maxrec, blk.charptr(), recsize, elem->ofs(), elem->size());
+				break;
+			case MetaDataElement::UInt32:
+				buildElementMinMax<uint32_t>( minrec, maxrec, blk.charptr(), recsize, elem->ofs(), elem->size());
+				break;
+			case MetaDataElement::Float16:
+				buildElementMinMax<Float16Element>( minrec, maxrec, blk.charptr(), recsize, elem->ofs(), elem->size());
+				break;
+			case MetaDataElement::Float32:
+				buildElementMinMax<float>( minrec, maxrec, blk.charptr(), recsize, elem->ofs(), elem->size());
+				break;
+		}
+	}
+}
+
+MetaDataZoneMap::MetaDataZoneMap( const MetaDataDescription* descr_, const Index& blockno_, const char* ptr_, std::size_t size_)
+	:m_descr(descr_),m_blockno(blockno_),m_ptr(0)
+{
+	if (size_ != bytesize()) throw strus::runtime_error( "%s", _TXT( "meta data zone map size mismatch"));
+	m_ptr = (char*)std::malloc( size_);
+	if (!m_ptr) throw std::bad_alloc();
+	std::memcpy( m_ptr, ptr_, size_);
+}
+
+MetaDataZoneMap::~MetaDataZoneMap()
+{
+	if (m_ptr) std::free( m_ptr);
+}
+
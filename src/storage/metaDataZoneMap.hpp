@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) 2014 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Minimum and maximum values of the meta data elements of a meta data block
+/// \file "metaDataZoneMap.hpp"
+#ifndef _STRUS_STORAGE_METADATA_ZONE_MAP_HPP_INCLUDED
+#define _STRUS_STORAGE_METADATA_ZONE_MAP_HPP_INCLUDED
+#include "strus/index.hpp"
+#include "strus/numericVariant.hpp"
+#include "metaDataDescription.hpp"
+#include "metaDataRecord.hpp"
+#include <cstddef>
+
+namespace strus {
+
+/// \brief Forward declaration
+class MetaDataBlock;
+/// \brief Forward declaration
+class MetaDataElement;
+
+/// \brief Minimum and maximum value of every element over all records of a meta data block (zone map), for skipping blocks that cannot contain a document matching a restriction
+/// \remark Stored as two meta data records, the first with the minimum values and the second with the maximum values of the elements
+class MetaDataZoneMap
+{
+public:
+	/// \brief Constructor, building the zone map of a block
+	/// \param[in] descr_ description of the meta data records of the block
+	/// \param[in] blk block to build the zone map of
+	MetaDataZoneMap( const MetaDataDescription* descr_, const MetaDataBlock& blk);
+	/// \brief Constructor from the stored data
+	/// \param[in] descr_ description of the meta data records
+	/// \param[in] blockno_ number of the meta data block described
+	/// \param[in] ptr_ pointer to the data stored
+	/// \param[in] size_ size of the data stored in bytes
+	MetaDataZoneMap( const MetaDataDescription* descr_, const Index& blockno_, const char* ptr_, std::size_t size_);
+	~MetaDataZoneMap();
+
+	/// \brief Get the number of the meta data block described
+	Index blockno() const						{return m_blockno;}
+
+	/// \brief Get the minimum value of an element
+	NumericVariant minValue( const MetaDataElement* elem) const
+	{
+		return MetaDataRecord( m_descr, m_ptr).getValue( elem);
+	}
+	/// \brief Get the maximum value of an element
+	NumericVariant maxValue( const MetaDataElement* elem) const
+	{
+		return MetaDataRecord( m_descr, m_ptr + m_descr->bytesize()).getValue( elem);
+	}
+
+	const char* charptr() const					{return m_ptr;}
+	std::size_t bytesize() const					{return m_descr->bytesize() * 2;}
+
+private:
+	MetaDataZoneMap( const MetaDataZoneMap&){}			//... non copyable
+	void operator=( const MetaDataZoneMap&){}			//... non copyable
+
+private:
+	const MetaDataDescription* m_descr;	///< description of the meta data records
+	Index m_blockno;			///< number of the meta data block described
+	char* m_ptr;				///< record with the minimum values followed by the record with the maximum values
+};
+
+}//namespace
+#endif
+
@@ -36,6 +36,12 @@ public:
 		return 0;
 	}
 
+	virtual bool skipDocBlock( const Index&, Index*, unsigned int*, std::size_t, std::size_t& size)
+	{
+		size = 0;
+		return true;
+	}
+
 	virtual Index skipPos( const Index&)
 	{
 		return 0;
@@ -46,6 +52,17 @@ public:
 		return 0;
 	}
 
+	virtual Index skipBlockMax( const Index&, unsigned int& maxff)
+	{
+		maxff = 0;
+		return 0;
+	}
+
+	virtual unsigned int nofBlocksLoaded() const
+	{
+		return 0;
+	}
+
 	virtual Index documentFrequency() const
 	{
 		return 0;
@@ -16,6 +16,10 @@
 using namespace strus;
 
 enum {EndPosinfoMarker=(char)0xFE};
+// Flag in the block header marking a block with summary (block maxima) following the header:
+static const unsigned int BlockSummaryFlag = 0x80000000U;
+// Flag in the block header marking a block that may contain documents with large positions (only in blocks with summary):
+static const unsigned int LargePositionsFlag = 0x40000000U;
 
 Index PosinfoBlock::docno_at( const Cursor& cursor) const
 {
@@ -38,20 +42,147 @@ const PosinfoBlock::PositionType* PosinfoBlock::posinfo_at( const Cursor& cursor
 
 std::vector<Index> PosinfoBlock::positions_at( const Cursor& cursor) const
 {
-	const PositionType* pi = posinfo_at( cursor);
-	const PositionType* pe = pi + *pi + 1;
 	std::vector<Index> rt;
-	for (++pi; pi != pe; ++pi)
-	{
-		rt.push_back( *pi);
-	}
+	decodePositions( rt, posinfo_at( cursor), m_withLargePositions);
 	return rt;
 }
 
 unsigned int PosinfoBlock::frequency_at( const Cursor& cursor) const
 {
-	const DocIndexNode& nd = m_docindexptr[ cursor.nodeidx];
-	return m_posinfoptr[ nd.posrefIdx[ cursor.docidx]];
+	return encodedFrequency( posinfo_at( cursor), m_withLargePositions);
+}
+
+PosinfoBlock::PositionScanner PosinfoBlock::positionScanner_at( const Cursor& cursor) const
+{
+	const PositionType* posar = posinfo_at( cursor);
+	if (m_withLargePositions && (posar[0] & LargeEntryFlag) != 0)
+	{
+		decodePositions( m_largePositions, posar, true);
+		if (m_largePositions.empty()) return PositionScanner();
+		return PositionScanner( &m_largePositions[0], m_largePositions.size());
+	}
+	return PositionScanner( posar);
+}
+
+static inline std::size_t largeEntryByteSize( const PosinfoBlock::PositionType* posar)
+{
+	return ((std::size_t)(posar[0] & ~(PosinfoBlock::PositionType)PosinfoBlock::LargeEntryFlag) << 16) | posar[1];
+}
+
+void PosinfoBlock::encodePositions( std::vector<PositionType>& dest, const std::vector<Index>& pos, bool withLargePositions_)
+{
+	const Index maxpos = std::numeric_limits<PositionType>::max();
+	const std::size_t maxff = withLargePositions_ ? (std::size_t)(LargeEntryFlag-1) : (std::size_t)maxpos;
+	bool isSmall = (pos.size() <= maxff);
+	std::vector<Index>::const_iterator pi = pos.begin(), pe = pos.end();
+	for (; isSmall && pi != pe; ++pi)
+	{
+		if (*pi > maxpos) isSmall = false;
+	}
+	if (isSmall)
+	{
+		// ... compact form [ff][pos]*
+		dest.push_back( (PositionType)pos.size());
+		for (pi = pos.begin(); pi != pe; ++pi)
+		{
+			dest.push_back( (PositionType)*pi);
+		}
+	}
+	else if (!withLargePositions_)
+	{
+		if (pos.size() > maxff)
+		{
+			throw strus::runtime_error( _TXT( "size of document out of range (max %u)"), 65535);
+		}
+		throw strus::runtime_error( _TXT( "token position out of range (max %u)"), 65535);
+	}
+	else
+	{
+		// ... large form [LargeEntryFlag|size_hi][size_lo][bytes], bytes = ff and position deltas packed
+		std::string buf;
+		packIndex( buf, pos.size());
+		Index prevpos = 0;
+		for (pi = pos.begin(); pi != pe; ++pi)
+		{
+			if (*pi <= prevpos)
+			{
+				throw strus::runtime_error( "%s", _TXT( "positions of document not strictly ascending"));
+			}
+			packIndex( buf, *pi - prevpos);
+			prevpos = *pi;
+		}
+		std::size_t nofbytes = buf.size();
+		if ((nofbytes >> 31) != 0)
+		{
+			throw strus::runtime_error( "%s", _TXT( "size of document out of range"));
+		}
+		dest.push_back( (PositionType)(LargeEntryFlag | (nofbytes >> 16)));
+		dest.push_back( (PositionType)(nofbytes & 0xFFFF));
+		std::size_t startidx = dest.size();
+		dest.resize( startidx + (nofbytes+1) / 2, 0);
+		std::memcpy( &dest[ startidx], buf.c_str(), nofbytes);
+	}
+}
+
+void PosinfoBlock::decodePositions( std::vector<Index>& dest, const PositionType* posar, bool withLargePositions_)
+{
+	dest.clear();
+	if (withLargePositions_ && (posar[0] & LargeEntryFlag) != 0)
+	{
+		char const* pi = (const char*)(const void*)(posar+2);
+		const char* pe = pi + largeEntryByteSize( posar);
+		Index ff = unpackIndex( pi, pe);
+		dest.reserve( ff);
+		Index pos = 0;
+		for (Index fi = 0; fi < ff; ++fi)
+		{
+			dest.push_back( pos += unpackIndex( pi, pe));
+		}
+	}
+	else
+	{
+		const PositionType* pi = posar + 1;
+		const PositionType* pe = pi + posar[0];
+		for (; pi != pe; ++pi)
+		{
+			dest.push_back( *pi);
+		}
+	}
+}
+
+std::size_t PosinfoBlock::encodedSize( const PositionType* posar, bool withLargePositions_)
+{
+	if (withLargePositions_ && (posar[0] & LargeEntryFlag) != 0)
+	{
+		return 2 + (largeEntryByteSize( posar) + 1) / 2;
+	}
+	return posar[0] + 1;
+}
+
+unsigned int PosinfoBlock::encodedFrequency( const PositionType* posar, bool withLargePositions_)
+{
+	if (withLargePositions_ && (posar[0] & LargeEntryFlag) != 0)
+	{
+		char const* pi = (const char*)(const void*)(posar+2);
+		return unpackIndex( pi, pi + largeEntryByteSize( posar));
+	}
+	return posar[0];
+}
+
+unsigned int PosinfoBlock::maxFrequency() const
+{
+	if (!m_maxff && m_nofDocIndexNodes)
+	{
+		// ... block without summary, calculate it
+		Cursor cursor;
+		Index dn = firstDoc( cursor);
+		for (; dn; dn = nextDoc( cursor))
+		{
+			unsigned int ff = frequency_at( cursor);
+			if (ff > m_maxff) m_maxff = ff;
+		}
+	}
+	return m_maxff;
 }
 
 Index PosinfoBlock::firstDoc( Cursor& cursor) const
@@ -143,31 +274,41 @@ Index PosinfoBlock::skipDoc( const Index& docno_, Cursor& cursor) const
 	}
 }
 
-Index PosinfoBlock::PositionScanner::skip( const Index& pos)
+template <typename ElementType>
+static inline Index skipPositionArray( const ElementType* ar, unsigned int size, unsigned int& itr, const Index& pos)
 {
-	if ((Index)m_ar[ m_itr] >= pos)
+	if ((Index)ar[ itr] >= pos)
 	{
-		while (m_itr > 0 && (Index)m_ar[ m_itr] > pos)
+		while (itr > 0 && (Index)ar[ itr] > pos)
 		{
-			m_itr >>= 1;
+			itr >>= 1;
 		}
-		if (m_ar[ m_itr] >= pos)
+		if ((Index)ar[ itr] >= pos)
 		{
-			return m_ar[ m_itr];
+			return ar[ itr];
 		}
 	}
-	if (pos > (Index)std::numeric_limits<PositionType>::max()) return 0;
+	if (pos > (Index)std::numeric_limits<ElementType>::max()) return 0;
 
-	unsigned int fibres = 0, fib1 = 1, fib2 = 1, ii = m_itr+1, nn = m_size;
-	while (ii < nn && (Index)m_ar[ ii] < pos)
+	unsigned int fibres = 0, fib1 = 1, fib2 = 1, ii = itr+1, nn = size;
+	while (ii < nn && (Index)ar[ ii] < pos)
 	{
 		fibres = fib1 + fib2;
 		ii += fibres;
 		fib1 = fib2;
 		fib2 = fibres;
 	}
-	for (ii -= fibres; ii < nn && (Index)m_ar[ ii] < pos; ++ii){}
-	return ii < nn ? m_ar[ m_itr = (unsigned short)ii]:0;
+	for (ii -= fibres; ii < nn && (Index)ar[ ii] < pos; ++ii){}
+	return ii < nn ? ar[ itr = ii]:0;
+}
+
+Index PosinfoBlock::PositionScanner::skip( const Index& pos)
+{
+	if (m_largear)
+	{
+		return skipPositionArray( m_largear, m_size, m_itr, pos);
+	}
+	return skipPositionArray( m_ar, m_size, m_itr, pos);
 }
 
 void PosinfoBlock::initDocIndexNodeFrame()
@@ -177,11 +318,32 @@ void PosinfoBlock::initDocIndexNodeFrame()
 		m_nofDocIndexNodes = 0;
 		m_docindexptr = 0;
 		m_posinfoptr = 0;
+		m_maxff = 0;
+		m_withLargePositions = false;
 	}
 	else
 	{
-		m_nofDocIndexNodes = *(const unsigned int*)ptr();
-		m_docindexptr = (const DocIndexNode*)( (const unsigned int*)ptr()+1);
+		unsigned int hdr = *(const unsigned int*)ptr();
+		if ((hdr & BlockSummaryFlag) != 0)
+		{
+			// ... block header followed by the block summary (max ff)
+			if (size() < 2*sizeof(unsigned int))
+			{
+				throw strus::runtime_error( "%s",  _TXT( "corrupt index (posinfo block summary)"));
+			}
+			m_nofDocIndexNodes = hdr & ~(BlockSummaryFlag|LargePositionsFlag);
+			m_withLargePositions = (hdr & LargePositionsFlag) != 0;
+			m_maxff = *((const unsigned int*)ptr()+1);
+			m_docindexptr = (const DocIndexNode*)( (const unsigned int*)ptr()+2);
+		}
+		else
+		{
+			// ... old format without block summary
+			m_nofDocIndexNodes = hdr;
+			m_withLargePositions = false;
+			m_maxff = 0;
+			m_docindexptr = (const DocIndexNode*)( (const unsigned int*)ptr()+1);
+		}
 		m_posinfoptr = (const PositionType*)(const void*)(m_docindexptr + m_nofDocIndexNodes);
 	}
 }
@@ -263,8 +425,8 @@ Index PosinfoBlock::DocIndexNode::skipDoc( const Index& docno_, unsigned short&
 }
 
 
-PosinfoBlockBuilder::PosinfoBlockBuilder( const PosinfoBlock& o)
-	:m_id(o.id())
+PosinfoBlockBuilder::PosinfoBlockBuilder( const PosinfoBlock& o, std::size_t maxBlockSize_)
+	:m_lastDoc(0),m_id(o.id()),m_maxff(0),m_withLargePositions(o.withLargePositions()),m_maxBlockSize(maxBlockSize_)
 {
 	PosinfoBlock::Cursor idx;
 	Index docno;
@@ -280,6 +442,10 @@ void PosinfoBlockBuilder::append( const Index& docno, const PositionType* posar)
 {
 	if (m_id && m_id < docno) throw strus::runtime_error( "%s",  _TXT( "assigned illegal id to block"));
 
+	if (m_posinfoArray.size() > std::numeric_limits<unsigned short>::max())
+	{
+		throw strus::logic_error( _TXT( "posinfo block builder overflow"));
+	}
 	if (m_docIndexNodeArray.empty()
 	||  !m_docIndexNodeArray.back().addDocument( docno, m_posinfoArray.size()))
 	{
@@ -289,11 +455,10 @@ void PosinfoBlockBuilder::append( const Index& docno, const PositionType* posar)
 			throw strus::logic_error( _TXT( "corrupt structure in posinfo block builder"));
 		}
 	}
-	PositionType ii=0, nn=posar[0];
-	for (; ii<=nn; ++ii)
-	{
-		m_posinfoArray.push_back( posar[ii]);
-	}
+	std::size_t nn = PosinfoBlock::encodedSize( posar, m_withLargePositions);
+	m_posinfoArray.insert( m_posinfoArray.end(), posar, posar + nn);
+	unsigned int ff = PosinfoBlock::encodedFrequency( posar, m_withLargePositions);
+	if (ff > m_maxff) m_maxff = ff;
 	m_lastDoc = docno;
 }
 
@@ -302,18 +467,29 @@ bool PosinfoBlockBuilder::fitsInto( std::size_t nofpos) const
 	return m_posinfoArray.size() + nofpos <= std::numeric_limits<PositionType>::max();
 }
 
+bool PosinfoBlockBuilder::fitsInto( const PositionType* posar) const
+{
+	// ... a document with large positions exceeding the limit of references to posinfo of a block gets a block on its own
+	if (full()) return false;
+	return m_posinfoArray.size() + PosinfoBlock::encodedSize( posar, m_withLargePositions) <= std::numeric_limits<PositionType>::max();
+}
+
 PosinfoBlock PosinfoBlockBuilder::createBlock() const
 {
 	if (empty()) throw strus::runtime_error( "%s",  _TXT( "tried to create empty posinfo block"));
 
 	std::size_t blksize =
-		sizeof( unsigned int)
+		2 * sizeof( unsigned int)
 		+ m_posinfoArray.size() * sizeof( m_posinfoArray[0])
 		+ m_docIndexNodeArray.size() * sizeof( m_docIndexNodeArray[0]);
 
 	MemBlock blkmem( blksize);
-	unsigned int nofDocIndexNodes = *(unsigned int*)blkmem.ptr() = docIndexNodeArray().size();
-	PosinfoBlock::DocIndexNode* docindexptr = (PosinfoBlock::DocIndexNode*)( (const unsigned int*)blkmem.ptr()+1);
+	unsigned int nofDocIndexNodes = docIndexNodeArray().size();
+	if ((nofDocIndexNodes & BlockSummaryFlag) != 0) throw strus::runtime_error( "%s",  _TXT( "too many elements in posinfo block"));
+	if ((nofDocIndexNodes & LargePositionsFlag) != 0) throw strus::runtime_error( "%s",  _TXT( "too many elements in posinfo block"));
+	*(unsigned int*)blkmem.ptr() = nofDocIndexNodes | BlockSummaryFlag | (m_withLargePositions ? LargePositionsFlag : 0);
+	*((unsigned int*)blkmem.ptr()+1) = m_maxff;
+	PosinfoBlock::DocIndexNode* docindexptr = (PosinfoBlock::DocIndexNode*)( (const unsigned int*)blkmem.ptr()+2);
 	PositionType* posinfoptr = (PositionType*)(const void*)(docindexptr + nofDocIndexNodes);
 	
 	std::vector<DocIndexNode>::const_iterator
@@ -339,6 +515,7 @@ void PosinfoBlockBuilder::clear()
 	m_posinfoArray.clear();
 	m_lastDoc = 0;
 	m_id = 0;
+	m_maxff = 0;
 }
 
 void PosinfoBlockBuilder::setId( const Index& id_)
@@ -14,18 +14,22 @@ namespace strus {
 
 /// \class PosinfoBlock
 /// \brief Block of term occurrence positions
+/// \remark The positions of a document are stored as [ff][pos]* in elements of PositionType. Blocks with large positions (see withLargePositions()) store documents with positions or an ff not fitting into this form as [LargeEntryFlag|size_hi][size_lo][bytes] with the ff and the deltas of the positions in the variable length encoding of 'indexPacker.hpp'
 class PosinfoBlock
 	:public DataBlock
 {
 public:
 	enum {
-		MaxBlockSize=1024
+		MaxBlockSize=1024,		///< size of the blocks of rare terms
+		MaxAdaptiveBlockSize=32768	///< upper limit of the size of the blocks of frequent terms
 	};
 	typedef unsigned short PositionType;
+	/// \brief Flag in the first element of the posinfo of a document with large positions (only in blocks with large positions)
+	enum {LargeEntryFlag=0x8000};
 
 public:
 	explicit PosinfoBlock()
-		:DataBlock(),m_docindexptr(0),m_posinfoptr(0)
+		:DataBlock(),m_nofDocIndexNodes(0),m_docindexptr(0),m_posinfoptr(0),m_maxff(0),m_withLargePositions(false)
 	{}
 	PosinfoBlock( const PosinfoBlock& o)
 		:DataBlock(o)
@@ -70,6 +74,11 @@ public:
 	std::vector<Index> positions_at( const Cursor& cursor) const;
 	/// \brief Get the feature frequency of the current PosinfoBlock::Cursor
 	unsigned int frequency_at( const Cursor& cursor) const;
+	/// \brief Evaluate if the block may contain documents with positions bigger than 65535 or more than 32767 positions
+	bool withLargePositions() const					{return m_withLargePositions;}
+	/// \brief Get the maximum feature frequency of all documents in the block (block summary)
+	/// \remark Blocks written by older versions without block summary get this value calculated on the first call
+	unsigned int maxFrequency() const;
 
 	/// \brief Get the next document with the current cursor
 	Index nextDoc( Cursor& cursor) const;
@@ -93,16 +102,19 @@ public:
 	{
 	public:
 		PositionScanner()
-			:m_ar(0),m_size(0),m_itr(0){}
+			:m_ar(0),m_largear(0),m_size(0),m_itr(0){}
 		PositionScanner( const PositionType* ar_)
-			:m_ar(ar_+1),m_size(ar_[0]),m_itr(0){}
+			:m_ar(ar_+1),m_largear(0),m_size(ar_[0]),m_itr(0){}
+		PositionScanner( const Index* ar_, unsigned int size_)
+			:m_ar(0),m_largear(ar_),m_size(size_),m_itr(0){}
 		PositionScanner( const PositionScanner& o)
-			:m_ar(o.m_ar),m_size(o.m_size),m_itr(o.m_itr){}
+			:m_ar(o.m_ar),m_largear(o.m_largear),m_size(o.m_size),m_itr(o.m_itr){}
 
 		bool initialized() const		{return m_size;}
 
 		void init( const PositionType* ar_)
 		{
+			m_largear = 0;
 			if (ar_)
 			{
 				m_ar = ar_+1;
@@ -119,18 +131,39 @@ public:
 
 		void clear()						{init(0);}
 
-		Index curpos() const					{return (m_itr<m_size)?m_ar[m_itr]:0;}
+		Index curpos() const
+		{
+			return (m_itr<m_size)?(m_largear?m_largear[m_itr]:(Index)m_ar[m_itr]):0;
+		}
 		Index skip( const Index& pos);
 
 	private:
 		const PositionType* m_ar;
-		unsigned short m_size;
-		unsigned short m_itr;
+		const Index* m_largear;			///< decoded positions of a document with large positions, NULL if m_ar is used
+		unsigned int m_size;
+		unsigned int m_itr;
 	};
 
-	PositionScanner positionScanner_at( const Cursor& cursor) const
+	/// \brief Get a scanner on the postions of the current Cursor
+	/// \remark The scanner is valid until the next call of this method or until the block is changed
+	PositionScanner positionScanner_at( const Cursor& cursor) const;
+
+	/// \brief Append the encoded positions of a document [ff][pos]* to a posinfo array
+	/// \param[in,out] dest where to append the encoded positions to
+	/// \param[in] pos positions (ascending) to encode
+	/// \param[in] withLargePositions_ true, if documents with large positions can be encoded, throws if not and the positions do not fit into PositionType
+	static void encodePositions( std::vector<PositionType>& dest, const std::vector<Index>& pos, bool withLargePositions_);
+	/// \brief Decode the positions of a document encoded with encodePositions
+	static void decodePositions( std::vector<Index>& dest, const PositionType* posar, bool withLargePositions_);
+	/// \brief Get the number of elements of the positions of a document encoded with encodePositions
+	static std::size_t encodedSize( const PositionType* posar, bool withLargePositions_);
+	/// \brief Get the feature frequency of the positions of a document encoded with encodePositions
+	static unsigned int encodedFrequency( const PositionType* posar, bool withLargePositions_);
+
+	/// \brief Get the size of the blocks to write for a term with a given document frequency
+	static std::size_t blockSizeForDf( const Index& df)
 	{
-		return PositionScanner( posinfo_at( cursor));
+		return DataBlock::adaptiveBlockSize( MaxBlockSize, MaxAdaptiveBlockSize, df);
 	}
 
 public:/*PosinfoBlockBuilder*/
@@ -156,6 +189,9 @@ private:
 	std::size_t m_nofDocIndexNodes;
 	const DocIndexNode* m_docindexptr;
 	const PositionType* m_posinfoptr;
+	mutable unsigned int m_maxff;		///< maximum feature frequency in the block, 0 if not yet calculated
+	bool m_withLargePositions;		///< true if the block may contain documents with large positions
+	mutable std::vector<Index> m_largePositions; ///< buffer for the decoded positions of a document with large positions
 };
 
 class PosinfoBlockBuilder
@@ -166,13 +202,18 @@ public:
 
 public:
 	PosinfoBlockBuilder( const PosinfoBlock& o);
-	PosinfoBlockBuilder()
-		:m_lastDoc(0),m_id(0){}
+	/// \param[in] maxBlockSize_ size in bytes from which on the block built is considered as full (see PosinfoBlock::blockSizeForDf(const Index&))
+	PosinfoBlockBuilder( const PosinfoBlock& o, std::size_t maxBlockSize_=PosinfoBlock::MaxBlockSize);
+	explicit PosinfoBlockBuilder( bool withLargePositions_=false, std::size_t maxBlockSize_=PosinfoBlock::MaxBlockSize)
+		:m_lastDoc(0),m_id(0),m_maxff(0),m_withLargePositions(withLargePositions_),m_maxBlockSize(maxBlockSize_){}
 	PosinfoBlockBuilder( const PosinfoBlockBuilder& o)
 		:m_docIndexNodeArray(o.m_docIndexNodeArray)
 		,m_posinfoArray(o.m_posinfoArray)
 		,m_lastDoc(o.m_lastDoc)
-		,m_id(o.m_id){}
+		,m_id(o.m_id)
+		,m_maxff(o.m_maxff)
+		,m_withLargePositions(o.m_withLargePositions)
+		,m_maxBlockSize(o.m_maxBlockSize){}
 
 	Index id() const						{return m_id;}
 	void setId( const Index& id_);
@@ -181,16 +222,22 @@ public:
 
 	/// \brief Append document position info
 	/// \param[in] docno document number
-	/// \param[in] posar pointer to posinfo encoded as: posar[0]=length, posar[1..]=posinfo array
+	/// \param[in] posar pointer to posinfo encoded with PosinfoBlock::encodePositions (posar[0]=length, posar[1..]=posinfo array for small documents)
 	void append( const Index& docno, const PositionType* posar);
 
 	bool fitsInto( std::size_t nofpos) const;
+	/// \brief Evaluate if the posinfo of a document encoded with PosinfoBlock::encodePositions can be appended to this block
+	/// \remark Returns false if the block is full
+	bool fitsInto( const PositionType* posar) const;
 	bool full() const
 	{
 		return (m_posinfoArray.size() * sizeof(PositionType)
-				+ m_docIndexNodeArray.size() * sizeof(DocIndexNode))
-			>= PosinfoBlock::MaxBlockSize;
+				+ m_docIndexNodeArray.size() * sizeof(DocIndexNode)
+				+ 2 * sizeof(unsigned int))
+			>= m_maxBlockSize;
 	}
+	/// \brief Get the size in bytes from which on the block built is considered as full
+	std::size_t maxBlockSize() const				{return m_maxBlockSize;}
 
 	const std::vector<DocIndexNode>& docIndexNodeArray() const	{return m_docIndexNodeArray;}
 	const std::vector<PositionType>& posinfoArray() const		{return m_posinfoArray;}
@@ -203,6 +250,9 @@ private:
 	std::vector<PositionType> m_posinfoArray;
 	Index m_lastDoc;
 	Index m_id;
+	unsigned int m_maxff;
+	bool m_withLargePositions;
+	std::size_t m_maxBlockSize;
 };
 }//namespace
 #endif
@@ -13,13 +13,17 @@ using namespace strus;
 
 PosinfoIterator::PosinfoIterator( const StorageClient* storage_, const DatabaseClientInterface* database_, Index termtypeno_, Index termvalueno_)
 	:m_storage(storage_)
-	,m_dbadapter(database_,termtypeno_,termvalueno_)
+	,m_dbadapter(storage_->blockDirectoryCache(),storage_->dataBlockCache(),(char)DatabaseKey::PosinfoBlockPrefix,database_,BlockKey(termtypeno_,termvalueno_),true)
 	,m_termtypeno(termtypeno_)
 	,m_termvalueno(termvalueno_)
 	,m_docno(0)
 	,m_docno_start(0)
 	,m_docno_end(0)
-	,m_documentFrequency(-1){}
+	,m_documentFrequency(-1)
+	,m_blockmaxDbAdapter(storage_->blockDirectoryCache(),storage_->dataBlockCache(),(char)DatabaseKey::PosinfoBlockPrefix,database_,BlockKey(termtypeno_,termvalueno_),true)
+	,m_blockmax_start(0)
+	,m_blockmax_end(0)
+	,m_blockmax_ff(0){}
 
 
 Index PosinfoIterator::skipDoc( const Index& docno_)
@@ -49,9 +53,9 @@ Index PosinfoIterator::skipDoc( const Index& docno_)
 			// [B] Document postings are in the same block as for the last query
 			return m_docno = m_posinfoBlk.skipDoc( docno_, m_posinfoCursor);
 		}
-		else if (docno_ > m_docno_end && m_docno_end + (m_docno_end - m_docno_start) > docno_)
+		else if (!m_dbadapter.directorySelected() && docno_ > m_docno_end && m_docno_end + (m_docno_end - m_docno_start) > docno_)
 		{
-			// [C] Try to get document postings from a follow block
+			// [C] Try to get document postings from a follow block (not with a directory, that selects the block without reading the ones in between)
 			while (m_dbadapter.loadNext( m_posinfoBlk))
 			{
 				m_docno_start = m_posinfoBlk.firstDoc( m_posinfoCursor);
@@ -81,7 +85,7 @@ Index PosinfoIterator::skipDoc( const Index& docno_)
 		}
 		else
 		{
-			// [D] Document postings are in a 'far away' block
+			// [D] Document postings are in a 'far away' block or the block is selected with the directory
 			if (m_dbadapter.loadUpperBound( docno_, m_posinfoBlk))
 			{
 				m_docno_start = m_posinfoBlk.firstDoc( m_posinfoCursor);
@@ -128,3 +132,30 @@ Index PosinfoIterator::documentFrequency() const
 	return m_documentFrequency;
 }
 
+Index PosinfoIterator::skipBlockMax( const Index& docno_, unsigned int& maxff)
+{
+	if (!m_posinfoBlk.empty() && m_docno_start <= docno_ && m_docno_end >= docno_)
+	{
+		// ... the block is the one currently loaded for iterating
+		maxff = m_posinfoBlk.maxFrequency();
+		return m_docno_end;
+	}
+	if (!m_blockmax_start || docno_ < m_blockmax_start || (m_blockmax_end && docno_ > m_blockmax_end))
+	{
+		// ... lookup the block with an own cursor not to change the iterator state
+		m_blockmax_start = docno_;
+		if (m_blockmaxDbAdapter.loadUpperBound( docno_, m_blockmaxBlk))
+		{
+			m_blockmax_end = m_blockmaxBlk.id();
+			m_blockmax_ff = m_blockmaxBlk.maxFrequency();
+		}
+		else
+		{
+			m_blockmax_end = 0;
+			m_blockmax_ff = 0;
+		}
+	}
+	maxff = m_blockmax_ff;
+	return m_blockmax_end;
+}
+
@@ -10,6 +10,7 @@
 #include "strus/reference.hpp"
 #include "posinfoBlock.hpp"
 #include "databaseAdapter.hpp"
+#include "blockDirectory.hpp"
 
 namespace strus {
 
@@ -34,12 +35,18 @@ public:
 	Index documentFrequency() const;
 	unsigned int frequency() const;
 
+	/// \brief Get the end docno and the maximum ff of the block containing the postings with a document number higher than or equal to docno_ without moving the iterator
+	Index skipBlockMax( const Index& docno_, unsigned int& maxff);
+
+	/// \brief Get the number of posinfo blocks loaded (including the blocks read for the block maxima)
+	unsigned int nofBlocksLoaded() const			{return m_dbadapter.nofBlocksLoaded() + m_blockmaxDbAdapter.nofBlocksLoaded();}
+
 private:
 	bool loadBlock( const Index& elemno_);
 
 private:
 	const StorageClient* m_storage;
-	DatabaseAdapter_PosinfoBlock::Cursor m_dbadapter;
+	TypedBlockDirectoryCursor<PosinfoBlock> m_dbadapter;
 	PosinfoBlock m_posinfoBlk;
 	PosinfoBlock::Cursor m_posinfoCursor;
 	PosinfoBlock::PositionScanner m_positionScanner;
@@ -49,6 +56,11 @@ private:
 	Index m_docno_start;
 	Index m_docno_end;
 	mutable Index m_documentFrequency;
+	TypedBlockDirectoryCursor<PosinfoBlock> m_blockmaxDbAdapter;
+	PosinfoBlock m_blockmaxBlk;
+	Index m_blockmax_start;
+	Index m_blockmax_end;
+	unsigned int m_blockmax_ff;
 };
 
 }
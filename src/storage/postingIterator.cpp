@@ -40,8 +40,9 @@ PostingIterator::PostingIterator(
 		const Index& length_,
 		ErrorBufferInterface* errorhnd_)
 #endif
-	:m_docnoIterator(database_, DatabaseKey::DocListBlockPrefix, BlockKey( termtypeno, termvalueno), true)
+	:m_docnoIterator(database_, DatabaseKey::DocListBlockPrefix, BlockKey( termtypeno, termvalueno), true, storage_->blockDirectoryCache(), storage_->dataBlockCache())
 	,m_posinfoIterator(storage_,database_, termtypeno, termvalueno)
+	,m_ffIterator()
 	,m_docno(0)
 	,m_length(length_)
 	,m_errorhnd(errorhnd_)
@@ -56,6 +57,10 @@ PostingIterator::PostingIterator(
 	packIndex( m_featureid, termtypeno);
 	packIndex( m_featureid, termvalueno);
 #endif
+	if (storage_->withDocFfBlocks())
+	{
+		m_ffIterator.reset( new FfIterator( storage_->blockDirectoryCache(), storage_->dataBlockCache(), database_, termtypeno, termvalueno));
+	}
 }
 
 Index PostingIterator::skipDoc( const Index& docno_)
@@ -64,7 +69,11 @@ Index PostingIterator::skipDoc( const Index& docno_)
 	{
 		if (m_docno && m_docno == docno_) return m_docno;
 	
-		if (m_posinfoIterator.isCloseCandidate( docno_))
+		if (m_ffIterator.get())
+		{
+			m_docno = m_ffIterator->skipDoc( docno_);
+		}
+		else if (m_posinfoIterator.isCloseCandidate( docno_))
 		{
 			m_docno = m_posinfoIterator.skipDoc( docno_);
 		}
@@ -83,7 +92,11 @@ Index PostingIterator::skipDocCandidate( const Index& docno_)
 	{
 		if (m_docno && m_docno == docno_) return m_docno;
 	
-		if (m_posinfoIterator.isCloseCandidate( docno_))
+		if (m_ffIterator.get())
+		{
+			m_docno = m_ffIterator->skipDoc( docno_);
+		}
+		else if (m_posinfoIterator.isCloseCandidate( docno_))
 		{
 			m_docno = m_posinfoIterator.skipDoc( docno_);
 		}
@@ -96,6 +109,35 @@ Index PostingIterator::skipDocCandidate( const Index& docno_)
 	CATCH_ERROR_MAP_RETURN( _TXT("error in posting iterator skip document candidate: %s"), *m_errorhnd, 0);
 }
 
+bool PostingIterator::skipDocBlock( const Index& docno_, Index* docnos, unsigned int* ffs, std::size_t maxsize, std::size_t& size)
+{
+	size = 0;
+	try
+	{
+		if (m_ffIterator.get())
+		{
+			// ... documents and frequencies are copied from the decoded doc/ff blocks
+			size = m_ffIterator->fetch( docno_, docnos, ffs, maxsize);
+			m_docno = size ? docnos[ size-1] : 0;
+			return true;
+		}
+		// ... the document numbers are copied from the decoded ranges of the document list block
+		std::size_t nn = m_docnoIterator.fetch( docno_, docnos, maxsize);
+		if (ffs)
+		{
+			for (std::size_t di=0; di < nn; ++di)
+			{
+				m_posinfoIterator.skipDoc( docnos[ di]);
+				ffs[ di] = m_posinfoIterator.frequency();
+			}
+		}
+		m_docno = nn ? docnos[ nn-1] : 0;
+		size = nn;
+		return true;
+	}
+	CATCH_ERROR_MAP_RETURN( _TXT("error in posting iterator skip document block: %s"), *m_errorhnd, true);
+}
+
 Index PostingIterator::skipPos( const Index& firstpos_)
 {
 	try
@@ -127,12 +169,30 @@ unsigned int PostingIterator::frequency()
 		{
 			return 0;
 		}
+		if (m_ffIterator.get())
+		{
+			m_ffIterator->skipDoc( m_docno);
+			return m_ffIterator->frequency();
+		}
 		m_posinfoIterator.skipDoc( m_docno);
 		return m_posinfoIterator.frequency();
 	}
 	CATCH_ERROR_MAP_RETURN( _TXT("error in posting iterator get frequency: %s"), *m_errorhnd, 0);
 }
 
+Index PostingIterator::skipBlockMax( const Index& docno_, unsigned int& maxff)
+{
+	try
+	{
+		if (m_ffIterator.get())
+		{
+			return m_ffIterator->skipBlockMax( docno_, maxff);
+		}
+		return m_posinfoIterator.skipBlockMax( docno_, maxff);
+	}
+	CATCH_ERROR_MAP_RETURN( _TXT("error in posting iterator get block maximum: %s"), *m_errorhnd, 0);
+}
+
 Index PostingIterator::documentFrequency() const
 {
 	try
@@ -10,6 +10,7 @@
 #include "strus/postingIteratorInterface.hpp"
 #include "strus/reference.hpp"
 #include "posinfoIterator.hpp"
+#include "ffIterator.hpp"
 #include "indexSetIterator.hpp"
 
 namespace strus {
@@ -42,9 +43,17 @@ public:
 
 	virtual Index skipDoc( const Index& docno_);
 	virtual Index skipDocCandidate( const Index& docno_);
+	virtual bool skipDocBlock( const Index& docno_, Index* docnos, unsigned int* ffs, std::size_t maxsize, std::size_t& size);
 	virtual Index skipPos( const Index& firstpos_);
 
 	virtual unsigned int frequency();
+	virtual Index skipBlockMax( const Index& docno_, unsigned int& maxff);
+
+	virtual unsigned int nofBlocksLoaded() const
+	{
+		return m_docnoIterator.nofBlocksLoaded() + m_posinfoIterator.nofBlocksLoaded()
+			+ (m_ffIterator.get() ? m_ffIterator->nofBlocksLoaded() : 0);
+	}
 
 	virtual Index documentFrequency() const;
 
@@ -66,6 +75,7 @@ public:
 private:
 	IndexSetIterator m_docnoIterator;
 	PosinfoIterator m_posinfoIterator;
+	Reference<FfIterator> m_ffIterator;	///< iterator on the doc/ff blocks serving documents and frequencies without reading positions, NULL for storages without doc/ff blocks
 
 	Index m_docno;
 	Index m_length;
@@ -90,10 +90,19 @@ StorageClientInterface* Storage::createClient(
 	{
 		std::string cachedterms;
 		std::string databaseConfig = configsource;
+		unsigned int blockDirectoryCacheSize = BlockDirectoryCache::DefaultMaxMemoryUsage;
+		(void)extractUIntFromConfigString( blockDirectoryCacheSize, databaseConfig, "blockdircache", m_errorhnd);
+		unsigned int dataBlockCacheSize = DataBlockCache::DefaultMaxMemoryUsage;
+		(void)extractUIntFromConfigString( dataBlockCacheSize, databaseConfig, "datablockcache", m_errorhnd);
+		if (m_errorhnd->hasError())
+		{
+			m_errorhnd->explain(_TXT("error creating storage client: %s"));
+			return 0;
+		}
 		if (extractStringFromConfigString( cachedterms, databaseConfig, "cachedterms", m_errorhnd))
 		{
 			std::string cachedtermsrc = loadFile( cachedterms);
-			return new StorageClient( database, databaseConfig, cachedtermsrc.c_str(), statisticsProc, m_errorhnd);
+			return new StorageClient( database, databaseConfig, cachedtermsrc.c_str(), statisticsProc, blockDirectoryCacheSize, dataBlockCacheSize, m_errorhnd);
 		}
 		else
 		{
@@ -102,7 +111,7 @@ StorageClientInterface* Storage::createClient(
 				m_errorhnd->explain(_TXT("error creating storage client: %s"));
 				return 0;
 			}
-			return new StorageClient( database, databaseConfig, 0, statisticsProc, m_errorhnd);
+			return new StorageClient( database, databaseConfig, 0, statisticsProc, blockDirectoryCacheSize, dataBlockCacheSize, m_errorhnd);
 		}
 	}
 	CATCH_ERROR_MAP_RETURN( _TXT("error creating storage client: %s"), *m_errorhnd, 0);
@@ -115,13 +124,18 @@ bool Storage::createStorage(
 	try
 	{
 		bool useAcl = false;
+		bool largeDocs = true;
 		std::string metadata;
+		std::string blockcodec;
 		ByteOrderMark byteOrderMark;
 
 		std::string src = configsource;
 		(void)extractStringFromConfigString( metadata, src, "metadata", m_errorhnd);
 		(void)extractBooleanFromConfigString( useAcl, src, "acl", m_errorhnd);
+		(void)extractStringFromConfigString( blockcodec, src, "blockcodec", m_errorhnd);
+		(void)extractBooleanFromConfigString( largeDocs, src, "largedocs", m_errorhnd);
 		if (m_errorhnd->hasError()) return false;
+		FfBlock::Format docFfBlockFormat = blockcodec.empty() ? FfBlock::FormatStreamVByte : FfBlock::formatFromName( blockcodec);
 
 		if (!dbi->createDatabase( src)) throw strus::runtime_error( "%s", _TXT("failed to create key/value store database"));
 		strus::local_ptr<strus::DatabaseClientInterface> database( dbi->createClient( src));
@@ -140,6 +154,13 @@ bool Storage::createStorage(
 		stor.store( transaction.get(), "NofDocs", 0);
 		stor.store( transaction.get(), "ByteOrderMark", byteOrderMark.value());
 		stor.store( transaction.get(), "Version", (STRUS_STORAGE_VERSION_MAJOR * 1000) + STRUS_STORAGE_VERSION_MINOR);
+		// ... storages created by older versions have no doc/ff blocks and read documents and frequencies from the posinfo blocks
+		stor.store( transaction.get(), "DocFfBlocks", 1);
+		stor.store( transaction.get(), "DocFfBlockFormat", docFfBlockFormat);
+		if (largeDocs)
+		{
+			stor.store( transaction.get(), "LargePositions", 1);
+		}
 		if (useAcl)
 		{
 			stor.store( transaction.get(), "UserNo", 1);
@@ -174,18 +195,18 @@ const char* Storage::getConfigDescription( const ConfigType& type) const
 	switch (type)
 	{
 		case CmdCreateClient:
-			return "cachedterms=<file with list of terms to cache>";
+			return "cachedterms=<file with list of terms to cache>\nblockdircache=<maximum number of bytes used for the directories of the blocks of terms, 0 to disable (default 16M)>\ndatablockcache=<maximum number of bytes used for the blocks of terms shared by all queries, used with the block directories only, 0 to disable (default 64M)>";
 
 		case CmdCreate:
-			return "acl=<yes/no, yes if users with different access rights exist>\nmetadata=<comma separated list of meta data def>";
+			return "acl=<yes/no, yes if users with different access rights exist>\nmetadata=<comma separated list of meta data def>\nblockcodec=<encoding of the doc/ff blocks: 'packed' or 'streamvbyte' (default)>\nlargedocs=<yes/no, yes (default) if token positions bigger than 65535 are allowed>";
 	}
 	return 0;
 }
 
 const char** Storage::getConfigParameters( const ConfigType& type) const
 {
-	static const char* keys_CreateStorageClient[]	= {"cachedterms", 0};
-	static const char* keys_CreateStorage[]		= {"acl", "metadata", 0};
+	static const char* keys_CreateStorageClient[]	= {"cachedterms", "blockdircache", "datablockcache", 0};
+	static const char* keys_CreateStorage[]		= {"acl", "metadata", "blockcodec", "largedocs", 0};
 	switch (type)
 	{
 		case CmdCreateClient:	return keys_CreateStorageClient;
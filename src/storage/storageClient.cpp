@@ -57,6 +57,14 @@ using namespace strus;
 
 #define MODULENAME "storageClient"
 
+/// \brief Counter for generations of the storage content unique among all storage clients of the process
+static utils::AtomicCounter<GlobalCounter> g_generationCounter( 0);
+
+static GlobalCounter allocGeneration()
+{
+	return g_generationCounter.allocIncrement() + 1;
+}
+
 void StorageClient::cleanup()
 {
 	if (m_metaDataBlockCache)
@@ -71,6 +79,8 @@ StorageClient::StorageClient(
 		const std::string& databaseConfig,
 		const char* termnomap_source,
 		const StatisticsProcessorInterface* statisticsProc_,
+		std::size_t blockDirectoryCacheSize_,
+		std::size_t dataBlockCacheSize_,
 		ErrorBufferInterface* errorhnd_)
 	:m_database(database_->createClient( databaseConfig))
 	,m_next_typeno(0)
@@ -79,8 +89,15 @@ StorageClient::StorageClient(
 	,m_next_userno(0)
 	,m_next_attribno(0)
 	,m_nof_documents(0)
+	,m_generation(allocGeneration())
 	,m_metaDataBlockCache(0)
+	,m_aclBitmapCache()
+	,m_blockDirectoryCache()
+	,m_dataBlockCache()
 	,m_statisticsProc(statisticsProc_)
+	,m_withDocFfBlocks(false)
+	,m_docFfBlockFormat(FfBlock::FormatPacked)
+	,m_withLargePositions(false)
 	,m_close_called(false)
 	,m_errorhnd(errorhnd_)
 {
@@ -89,6 +106,15 @@ StorageClient::StorageClient(
 		if (!m_database.get()) throw strus::runtime_error(_TXT("failed to create database client: %s"), m_errorhnd->fetchError());
 		m_metadescr.load( m_database.get());
 		m_metaDataBlockCache = new MetaDataBlockCache( m_database.get(), m_metadescr);
+		m_aclBitmapCache.reset( new AclBitmapCache( m_database.get()));
+		if (blockDirectoryCacheSize_)
+		{
+			m_blockDirectoryCache.reset( new BlockDirectoryCache( m_database.get(), blockDirectoryCacheSize_));
+		}
+		if (dataBlockCacheSize_)
+		{
+			m_dataBlockCache.reset( new DataBlockCache( dataBlockCacheSize_));
+		}
 
 		loadVariables( m_database.get());
 		if (termnomap_source) loadTermnoMap( termnomap_source);
@@ -127,8 +153,24 @@ std::string StorageClient::config() const
 	CATCH_ERROR_ARG1_MAP_RETURN( _TXT("error in instance of '%s' mapping configuration to string: %s"), MODULENAME, *m_errorhnd, std::string());
 }
 
-void StorageClient::releaseTransaction( const std::vector<Index>& refreshList)
+void StorageClient::releaseTransaction( const std::vector<Index>& refreshList, const std::vector<BlockDirectoryCache::Key>& blockDomainRefreshList, const std::vector<DataBlockCache::Key>& blockRefreshList, bool committed)
 {
+	if (committed)
+	{
+		// Invalidate cached results depending on the storage content:
+		m_generation.set( allocGeneration());
+	}
+	if (m_dataBlockCache.get() && !blockRefreshList.empty())
+	{
+		// Remove the blocks written or removed from the cache, before the directories referring to them,
+		//	so that a reader getting a fresh directory does not find the stale blocks in the cache:
+		m_dataBlockCache->invalidate( blockRefreshList);
+	}
+	if (m_blockDirectoryCache.get() && !blockDomainRefreshList.empty())
+	{
+		// Invalidate the directories of the terms with blocks written:
+		m_blockDirectoryCache->invalidate( blockDomainRefreshList);
+	}
 	if (m_metaDataBlockCache)
 	{
 		// Refresh all entries touched by the inserts/updates written
@@ -141,6 +183,11 @@ void StorageClient::releaseTransaction( const std::vector<Index>& refreshList)
 	}
 }
 
+void StorageClient::declareAclChanged()
+{
+	m_aclBitmapCache->invalidate();
+}
+
 static Index versionNo( Index major, Index minor)
 {
 	return (major * 1000) + minor;
@@ -166,6 +213,9 @@ void StorageClient::loadVariables( DatabaseClientInterface* database_)
 	Index nof_documents_;
 	Index next_userno_;
 	Index version_;
+	Index docffblocks_ = 0;
+	Index docffblockformat_ = FfBlock::FormatPacked;
+	Index largepositions_ = 0;
 
 	DatabaseAdapter_Variable::Reader varstor( database_);
 	if (!varstor.load( "TermNo", next_termno_)
@@ -187,6 +237,13 @@ void StorageClient::loadVariables( DatabaseClientInterface* database_)
 		throw strus::runtime_error( _TXT( "incompatible storage version %u.%u software is %u.%u. please rebuild your storage"), major, minor, (unsigned int)STRUS_STORAGE_VERSION_MAJOR, (unsigned int)STRUS_STORAGE_VERSION_MINOR);
 	}
 	(void)varstor.load( "UserNo", next_userno_);
+	(void)varstor.load( "DocFfBlocks", docffblocks_);
+	(void)varstor.load( "DocFfBlockFormat", docffblockformat_);
+	(void)varstor.load( "LargePositions", largepositions_);
+	if (docffblockformat_ != FfBlock::FormatPacked && docffblockformat_ != FfBlock::FormatStreamVByte)
+	{
+		throw strus::runtime_error( _TXT( "unknown doc/ff block format %d in storage"), (int)docffblockformat_);
+	}
 	if (varstor.load( "ByteOrderMark", bom))
 	{
 		if (bom != byteOrderMark.value())
@@ -201,6 +258,9 @@ void StorageClient::loadVariables( DatabaseClientInterface* database_)
 	m_next_attribno.set( next_attribno_);
 	m_nof_documents.set( nof_documents_);
 	m_next_userno.set( next_userno_);
+	m_withDocFfBlocks = (docffblocks_ != 0);
+	m_docFfBlockFormat = (FfBlock::Format)docffblockformat_;
+	m_withLargePositions = (largepositions_ != 0);
 }
 
 void StorageClient::storeVariables()
@@ -304,6 +364,7 @@ PostingIteratorInterface*
 	{
 		return new MetaDataRangePostingIterator(
 				new MetaDataReader( m_metaDataBlockCache, &m_metadescr, m_errorhnd),
+				m_metaDataBlockCache, &m_metadescr,
 				m_nof_documents.value(), meta_fieldStart, meta_fieldEnd, m_errorhnd);
 	}
 	CATCH_ERROR_MAP_RETURN( _TXT("error creating field posting iterator defined by meta data: %s"), *m_errorhnd, 0);
@@ -362,24 +423,19 @@ DocumentTermIteratorInterface*
 
 class InvertedAclIterator
 	:public InvAclIteratorInterface
-	,public IndexSetIterator
-	
 {
 public:
-	InvertedAclIterator( const DatabaseClientInterface* database_, const Index& userno_, ErrorBufferInterface* errorhnd_)
-		:IndexSetIterator( database_, DatabaseKey::UserAclBlockPrefix, BlockKey(userno_), true),m_errorhnd(errorhnd_){}
+	explicit InvertedAclIterator( const utils::SharedPtr<const AclBitmap>& bitmap_)
+		:m_bitmap(bitmap_){}
 	virtual ~InvertedAclIterator(){}
 
 	virtual Index skipDoc( const Index& docno_)
 	{
-		try
-		{
-			return skip(docno_);
-		}
-		CATCH_ERROR_MAP_RETURN( _TXT("error in skip doc of inverted ACL iterator: %s"), *m_errorhnd, 0);
+		// ... a membership test for the documents allowed, a bitmap scan to the next one otherwise
+		return m_bitmap->test( docno_) ? docno_ : m_bitmap->skip( docno_);
 	}
 private:
-	ErrorBufferInterface* m_errorhnd;			///< error buffer for exception free interface
+	utils::SharedPtr<const AclBitmap> m_bitmap;		///< bitmap of the documents the user is allowed to see, shared with the cache
 };
 
 class UnknownUserInvertedAclIterator
@@ -407,7 +463,7 @@ InvAclIteratorInterface*
 		}
 		else
 		{
-			return new InvertedAclIterator( m_database.get(), userno, m_errorhnd);
+			return new InvertedAclIterator( m_aclBitmapCache->get( userno));
 		}
 	}
 	CATCH_ERROR_MAP_RETURN( _TXT("error creating inverted ACL iterator: %s"), *m_errorhnd, 0);
@@ -686,6 +742,11 @@ Index StorageClient::documentFrequency( const std::string& type, const std::stri
 	CATCH_ERROR_MAP_RETURN( _TXT("error evaluating term document frequency: %s"), *m_errorhnd, 0);
 }
 
+GlobalCounter StorageClient::generation() const
+{
+	return m_generation.value();
+}
+
 Index StorageClient::maxDocumentNumber() const
 {
 	return m_next_docno.value()-1;
@@ -821,7 +882,7 @@ MetaDataRestrictionInterface* StorageClient::createMetaDataRestriction() const
 {
 	try
 	{
-		return new MetaDataRestriction( this, m_errorhnd);
+		return new MetaDataRestriction( this, m_metaDataBlockCache, &m_metadescr, m_errorhnd);
 	}
 	CATCH_ERROR_MAP_RETURN( _TXT("error creating meta data restriction object: %s"), *m_errorhnd, 0);
 }
@@ -1003,6 +1064,12 @@ static void checkKeyValue(
 				strus::DocMetaDataData( &metadescr, key, value);
 				break;
 			}
+			case strus::DatabaseKey::MetaDataZoneMapPrefix:
+			{
+				strus::MetaDataDescription metadescr( database);
+				strus::MetaDataZoneMapData( &metadescr, key, value);
+				break;
+			}
 			case strus::DatabaseKey::DocFrequencyPrefix:
 			{
 				strus::DocFrequencyData( key, value);
@@ -1013,6 +1080,11 @@ static void checkKeyValue(
 				strus::PosinfoBlockData( key, value);
 				break;
 			}
+			case strus::DatabaseKey::DocFfBlockPrefix:
+			{
+				strus::FfBlockData( key, value);
+				break;
+			}
 			case strus::DatabaseKey::InverseTermPrefix:
 			{
 				strus::InverseTermData( key, value);
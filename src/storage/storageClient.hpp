@@ -13,7 +13,11 @@
 #include "strus/reference.hpp"
 #include "private/utils.hpp"
 #include "metaDataBlockCache.hpp"
+#include "aclBitmapCache.hpp"
+#include "blockDirectory.hpp"
+#include "dataBlockCache.hpp"
 #include "indexSetIterator.hpp"
+#include "ffBlock.hpp"
 #include "strus/statisticsProcessorInterface.hpp"
 namespace strus {
 
@@ -58,12 +62,16 @@ public:
 	/// \param[in] databaseConfig configuration string (not a filename!) of the database interface to create for this storage
 	/// \param[in] termnomap_source end of line separated list of terms to cache for eventually faster lookup
 	/// \param[in] statisticsProc_ statistics message processor interface
+	/// \param[in] blockDirectoryCacheSize_ maximum number of bytes used by the cache of the directories of the blocks of terms, 0 to disable it
+	/// \param[in] dataBlockCacheSize_ maximum number of bytes used by the cache of the blocks of terms, 0 to disable it
 	/// \param[in] errorhnd_ error buffering interface for error handling
 	StorageClient(
 			const DatabaseInterface* database_,
 			const std::string& databaseConfig,
 			const char* termnomap_source,
 			const StatisticsProcessorInterface* statisticsProc_,
+			std::size_t blockDirectoryCacheSize_,
+			std::size_t dataBlockCacheSize_,
 			ErrorBufferInterface* errorhnd_);
 	virtual ~StorageClient();
 
@@ -123,6 +131,8 @@ public:
 			const std::string& type,
 			const std::string& term) const;
 
+	virtual GlobalCounter generation() const;
+
 	virtual Index maxDocumentNumber() const;
 
 	virtual Index documentNumber( const std::string& docid) const;
@@ -163,7 +173,13 @@ public:/*StorageTransaction*/
 			DatabaseTransactionInterface* transaction,
 			int nof_documents_incr);
 
-	void releaseTransaction( const std::vector<Index>& refreshList);
+	/// \param[in] refreshList list of meta data blocks written
+	/// \param[in] blockDomainRefreshList list of block domains (e.g. [prefix,typeno,termno] of posinfo blocks) with blocks written
+	/// \param[in] blockRefreshList list of the database keys of the blocks of terms written or removed
+	/// \param[in] committed true if the transaction was committed
+	void releaseTransaction( const std::vector<Index>& refreshList, const std::vector<BlockDirectoryCache::Key>& blockDomainRefreshList, const std::vector<DataBlockCache::Key>& blockRefreshList, bool committed);
+	/// \brief Invalidate the cached ACL bitmaps after a commit of a transaction changing access rights
+	void declareAclChanged();
 
 	void declareNofDocumentsInserted( int incr);
 	Index nofAttributeTypes();
@@ -175,6 +191,16 @@ public:/*StorageTransaction*/
 	KeyAllocatorInterface* createTermnoAllocator();
 
 	bool withAcl() const;
+	/// \brief Evaluate if the storage has doc/ff blocks (documents with feature frequencies of a term without positions)
+	bool withDocFfBlocks() const						{return m_withDocFfBlocks;}
+	/// \brief Get the encoding of the doc/ff blocks written
+	FfBlock::Format docFfBlockFormat() const				{return m_docFfBlockFormat;}
+	/// \brief Evaluate if the storage accepts documents with token positions bigger than 65535
+	bool withLargePositions() const						{return m_withLargePositions;}
+	/// \brief Get the cache of the directories of the blocks of terms, NULL if disabled
+	BlockDirectoryCache* blockDirectoryCache() const			{return m_blockDirectoryCache.get();}
+	/// \brief Get the cache of the blocks of terms shared by all iterators, NULL if disabled
+	DataBlockCache* dataBlockCache() const					{return m_dataBlockCache.get();}
 
 	Index allocTermno();
 	Index allocDocno();
@@ -239,6 +265,7 @@ private:
 	utils::AtomicCounter<Index> m_next_attribno;		///< next index to assign to a new attribute name
 
 	utils::AtomicCounter<Index> m_nof_documents;		///< number of documents inserted
+	utils::AtomicCounter<GlobalCounter> m_generation;	///< generation of the storage content, changed with every commit
 
 	utils::Mutex m_transaction_mutex;			///< mutual exclusion in the critical part of a transaction
 	utils::Mutex m_immalloc_typeno_mutex;			///< mutual exclusion in the critical part of immediate allocation of typeno s
@@ -247,10 +274,16 @@ private:
 
 	MetaDataDescription m_metadescr;			///< description of the meta data
 	MetaDataBlockCache* m_metaDataBlockCache;		///< read cache for meta data blocks
+	Reference<AclBitmapCache> m_aclBitmapCache;		///< cache of the bitmaps of the documents users are allowed to see
+	Reference<BlockDirectoryCache> m_blockDirectoryCache;	///< cache of the directories of the blocks of terms, NULL if disabled
+	Reference<DataBlockCache> m_dataBlockCache;		///< cache of the blocks of terms selected with their directory, NULL if disabled
 
 	const StatisticsProcessorInterface* m_statisticsProc;	///< statistics message processor
 	Reference<StatisticsBuilderInterface> m_statisticsBuilder; ///< builder of statistics messages from updates by transactions
 	Reference<DocumentFrequencyCache> m_documentFrequencyCache; ///< reference to document frequency cache
+	bool m_withDocFfBlocks;					///< true if the storage maintains doc/ff blocks, false for storages created by older versions
+	FfBlock::Format m_docFfBlockFormat;			///< encoding of the doc/ff blocks written, blocks of all formats are readable
+	bool m_withLargePositions;				///< true if posinfo blocks are written with support of large positions (see PosinfoBlock::withLargePositions())
 	bool m_close_called;					///< true if close was already called
 
 	ErrorBufferInterface* m_errorhnd;			///< error buffer for exception free interface
@@ -93,6 +93,13 @@ static void dumpKeyValue(
 				data.print( out);
 				break;
 			}
+			case DatabaseKey::MetaDataZoneMapPrefix:
+			{
+				MetaDataDescription metadescr( database);
+				MetaDataZoneMapData data( &metadescr, key, value);
+				data.print( out);
+				break;
+			}
 			case DatabaseKey::UserNamePrefix:
 			{
 				UserNameData data( key, value);
@@ -111,6 +118,12 @@ static void dumpKeyValue(
 				data.print( out);
 				break;
 			}
+			case DatabaseKey::DocFfBlockPrefix:
+			{
+				FfBlockData data( key, value);
+				data.print( out);
+				break;
+			}
 			case DatabaseKey::UserAclBlockPrefix:
 			{
 				UserAclBlockData data( key, value);
@@ -38,7 +38,7 @@ StorageTransaction::StorageTransaction(
 	,m_metadescr(metadescr_)
 	,m_attributeMap(database_)
 	,m_metaDataMap(database_,metadescr_)
-	,m_invertedIndexMap(database_)
+	,m_invertedIndexMap(database_,storage_->withDocFfBlocks(),storage_->docFfBlockFormat(),storage_->withLargePositions())
 	,m_forwardIndexMap(database_,maxtypeno_)
 	,m_userAclMap(database_)
 	,m_termTypeMap(database_,DatabaseKey::TermTypePrefix,DatabaseKey::TermTypeInvPrefix,storage_->createTypenoAllocator())
@@ -333,6 +333,8 @@ bool StorageTransaction::commit()
 		m_docIdMap.getWriteBatch( docnoUnknownMap, transaction.get(), &nof_new_documents, &nof_chg_documents);
 		int nof_documents_incr = nof_new_documents - m_nof_deleted_documents;
 		std::vector<Index> refreshList;
+		std::vector<BlockDirectoryCache::Key> blockDomainRefreshList;
+		std::vector<DataBlockCache::Key> blockRefreshList;
 		m_attributeMap.renameNewDocNumbers( docnoUnknownMap);
 		m_attributeMap.getWriteBatch( transaction.get());
 		m_metaDataMap.renameNewDocNumbers( docnoUnknownMap);
@@ -346,7 +348,8 @@ bool StorageTransaction::commit()
 		m_invertedIndexMap.getWriteBatch(
 				transaction.get(),
 				statisticsBuilder, dfcache?&dfbatch:(DocumentFrequencyCache::Batch*)0,
-				m_termTypeMapInv, m_termValueMapInv);
+				m_termTypeMapInv, m_termValueMapInv,
+				blockDomainRefreshList, blockRefreshList);
 		if (statisticsBuilder)
 		{
 			statisticsBuilder->setNofDocumentsInsertedChange( nof_documents_incr);
@@ -359,6 +362,7 @@ bool StorageTransaction::commit()
 						dfcache?&dfbatch:(DocumentFrequencyCache::Batch*)0,
 						m_termTypeMapInv, m_termValueMapInv);
 
+		bool aclChanged = !m_userAclMap.empty();
 		m_userAclMap.renameNewDocNumbers( docnoUnknownMap);
 		m_userAclMap.getWriteBatch( transaction.get());
 
@@ -373,7 +377,11 @@ bool StorageTransaction::commit()
 			dfcache->writeBatch( dfbatch);
 		}
 		m_storage->declareNofDocumentsInserted( nof_documents_incr);
-		m_storage->releaseTransaction( refreshList);
+		if (aclChanged)
+		{
+			m_storage->declareAclChanged();
+		}
+		m_storage->releaseTransaction( refreshList, blockDomainRefreshList, blockRefreshList, true/*committed*/);
 		statisticsBuilderScope.done();
 
 		m_commit = true;
@@ -397,7 +405,9 @@ void StorageTransaction::rollback()
 		return;
 	}
 	std::vector<Index> refreshList;
-	m_storage->releaseTransaction( refreshList);
+	std::vector<BlockDirectoryCache::Key> blockDomainRefreshList;
+	std::vector<DataBlockCache::Key> blockRefreshList;
+	m_storage->releaseTransaction( refreshList, blockDomainRefreshList, blockRefreshList, false/*committed*/);
 	m_rollback = true;
 	m_nof_documents_affected = 0;
 	clearMaps();
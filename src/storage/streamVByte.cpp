@@ -0,0 +1,69 @@
+/*
+ * Copyright (c) 2014 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#include "streamVByte.hpp"
+#include "private/internationalization.hpp"
+
+using namespace strus;
+
+void strus::streamVByteEncode( std::string& buf, const uint32_t* ar, std::size_t size)
+{
+	std::size_t ctrlpos = buf.size();
+	buf.append( (size+3) >> 2, '\0');
+	std::size_t ii = 0;
+	for (; ii < size; ++ii)
+	{
+		uint32_t val = ar[ ii];
+		unsigned int len = (val < (1U<<8)) ? 1 : (val < (1U<<16)) ? 2 : (val < (1U<<24)) ? 3 : 4;
+		buf[ ctrlpos + (ii >> 2)] |= (char)((len-1) << ((ii & 3) << 1));
+		for (; len; --len,val >>= 8)
+		{
+			buf.push_back( (char)(unsigned char)(val & 0xFF));
+		}
+	}
+}
+
+const char* strus::streamVByteDecode( uint32_t* ar, std::size_t size, const char* ptr, const char* end)
+{
+	static const uint32_t mask[4] = {0xFFU,0xFFFFU,0xFFFFFFU,0xFFFFFFFFU};
+	std::size_t ctrlsize = (size+3) >> 2;
+	if ((std::size_t)(end - ptr) < ctrlsize)
+	{
+		throw strus::runtime_error( _TXT( "corrupt data (%s 1)"), __FUNCTION__);
+	}
+	const unsigned char* ctrl = (const unsigned char*)ptr;
+	const unsigned char* di = ctrl + ctrlsize;
+	const unsigned char* de = (const unsigned char*)end;
+
+	// Read 4 bytes for every value and mask them, as long as there are enough bytes left:
+	std::size_t ii = 0;
+	for (; ii < size && de - di >= 4; ++ii)
+	{
+		unsigned int code = (ctrl[ ii >> 2] >> ((ii & 3) << 1)) & 3;
+		uint32_t val = (uint32_t)di[0] | ((uint32_t)di[1] << 8) | ((uint32_t)di[2] << 16) | ((uint32_t)di[3] << 24);
+		ar[ ii] = val & mask[ code];
+		di += code + 1;
+	}
+	// ... decode the last values byte by byte:
+	for (; ii < size; ++ii)
+	{
+		unsigned int len = ((ctrl[ ii >> 2] >> ((ii & 3) << 1)) & 3) + 1;
+		if ((std::size_t)(de - di) < len)
+		{
+			throw strus::runtime_error( _TXT( "corrupt data (%s 2)"), __FUNCTION__);
+		}
+		uint32_t val = 0;
+		for (unsigned int bi = 0; bi < len; ++bi)
+		{
+			val |= (uint32_t)di[ bi] << (bi << 3);
+		}
+		ar[ ii] = val;
+		di += len;
+	}
+	return (const char*)di;
+}
+
@@ -0,0 +1,35 @@
+/*
+ * Copyright (c) 2014 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Stream VByte encoding of arrays of unsigned integers
+/// \remark The length codes of 4 values (2 bits each) are grouped in one control byte and stored separated from the value bytes (little endian). Decoding needs no branch on continuation bits per byte like the UTF-8 style encoding of 'indexPacker.hpp' and works on whole arrays.
+#ifndef _STRUS_STORAGE_STREAM_VBYTE_HPP_INCLUDED
+#define _STRUS_STORAGE_STREAM_VBYTE_HPP_INCLUDED
+#include <stdint.h>
+#include <string>
+#include <cstddef>
+
+namespace strus
+{
+
+/// \brief Append an array of unsigned integers Stream VByte encoded to a buffer
+/// \param[in,out] buf where to append the encoded values to
+/// \param[in] ar array of values to encode
+/// \param[in] size number of values in ar
+void streamVByteEncode( std::string& buf, const uint32_t* ar, std::size_t size);
+
+/// \brief Decode an array of unsigned integers encoded with 'streamVByteEncode'
+/// \param[out] ar where to write the decoded values to (array with at least size elements)
+/// \param[in] size number of values to decode
+/// \param[in] ptr start of the encoded values
+/// \param[in] end end of the buffer with the encoded values
+/// \return pointer to the first byte after the encoded values
+const char* streamVByteDecode( uint32_t* ar, std::size_t size, const char* ptr, const char* end);
+
+}//namespace
+#endif
+
@@ -20,6 +20,9 @@
 #include "storageClient.hpp"
 #include "forwardIndexBlock.hpp"
 #include "forwardIndexMap.hpp"
+#include "posinfoBlock.hpp"
+#include "booleanBlock.hpp"
+#include "ffBlock.hpp"
 #include <stdexcept>
 #include <string>
 #include <vector>
@@ -40,7 +43,7 @@ static void printUsage()
 	std::cout << "-v|--version" << std::endl;
 	std::cout << "    " << _TXT("Print the program version and do nothing else") << std::endl;
 	std::cout << "-c|--commit <N>" << std::endl;
-	std::cout << "    " << _TXT("Set <N> as number of documents inserted per transaction (default 1000)") << std::endl;
+	std::cout << "    " << _TXT("Set <N> as number of documents (forwardindex) or terms (posinfo,doclist,docff) rewritten per transaction (default 1000)") << std::endl;
 	std::cout << "-D|--docno <START>:<END>" << std::endl;
 	std::cout << "    " << _TXT("Process document number range <START> to <END>") << std::endl;
 	std::cout << "-T|--termtype <TYPE>" << std::endl;
@@ -48,7 +51,12 @@ static void printUsage()
 	std::cout << "<config>     : " << _TXT("configuration string of the key/value store database") << std::endl;
 	std::cout << "<blocktype>  : " << _TXT("storage block type. One of the following:") << std::endl;
 	std::cout << "               forwardindex:" << _TXT("forward index block type") << std::endl;
+	std::cout << "               posinfo:" << _TXT("term occurrence position block type") << std::endl;
+	std::cout << "               doclist:" << _TXT("term document list block type") << std::endl;
+	std::cout << "               docff:" << _TXT("term document feature frequency block type") << std::endl;
 	std::cout << "<newsize>    : " << _TXT("new size of the blocks, unit depends on block type.") << std::endl;
+	std::cout << "               " << _TXT("forwardindex: number of tokens, posinfo,doclist,docff: number of bytes.") << std::endl;
+	std::cout << "               " << _TXT("0 for the default, for posinfo,doclist,docff chosen from the df of the term.") << std::endl;
 }
 
 static strus::ErrorBufferInterface* g_errorBuffer = 0;	// error buffer
@@ -107,6 +115,143 @@ static void commitTransaction( strus::DatabaseClientInterface& database, strus::
 	}
 }
 
+static bool isInDocnoRange( const std::pair<unsigned int,unsigned int>& docnorange, const strus::Index& docno)
+{
+	return !docnorange.second || docno <= (strus::Index)docnorange.second;
+}
+
+// Rewrite the posinfo blocks of a term overlapping the document number range with the new block size:
+static unsigned int resizePosinfoBlocks(
+		strus::StorageClient& storage,
+		strus::DatabaseTransactionInterface* transaction,
+		const strus::Index& typeno,
+		const strus::Index& termno,
+		std::size_t blocksize,
+		const std::pair<unsigned int,unsigned int>& docnorange)
+{
+	unsigned int rt = 0;
+	strus::DatabaseAdapter_PosinfoBlock::WriteCursor dbadapter( storage.databaseClient(), typeno, termno);
+	strus::PosinfoBlockBuilder newblk( storage.withLargePositions(), blocksize);
+	strus::PosinfoBlock blk;
+	bool hasmore = dbadapter.loadUpperBound( docnorange.first ? docnorange.first : 1, blk);
+	for (; hasmore; hasmore = dbadapter.loadNext( blk))
+	{
+		strus::PosinfoBlock::Cursor cursor;
+		strus::Index docno = blk.firstDoc( cursor);
+		if (!docno || !isInDocnoRange( docnorange, docno)) break;
+
+		dbadapter.remove( transaction, blk.id());
+		for (; docno; docno = blk.nextDoc( cursor))
+		{
+			const strus::PosinfoBlock::PositionType* posinfo = blk.posinfo_at( cursor);
+			if (!newblk.empty() && !newblk.fitsInto( posinfo))
+			{
+				dbadapter.store( transaction, newblk.createBlock());
+				newblk.clear();
+				++rt;
+			}
+			newblk.append( docno, posinfo);
+		}
+	}
+	if (!newblk.empty())
+	{
+		dbadapter.store( transaction, newblk.createBlock());
+		++rt;
+	}
+	return rt;
+}
+
+// Rewrite the document list blocks of a term overlapping the document number range with the new block size:
+static unsigned int resizeDocListBlocks(
+		strus::StorageClient& storage,
+		strus::DatabaseTransactionInterface* transaction,
+		const strus::Index& typeno,
+		const strus::Index& termno,
+		std::size_t blocksize,
+		const std::pair<unsigned int,unsigned int>& docnorange)
+{
+	strus::DatabaseAdapter_DocListBlock::WriteCursor dbadapter( storage.databaseClient(), typeno, termno);
+	std::vector<strus::BooleanBlock::MergeRange> rangear;
+	strus::BooleanBlock blk;
+	bool hasmore = dbadapter.loadUpperBound( docnorange.first ? docnorange.first : 1, blk);
+	for (; hasmore; hasmore = dbadapter.loadNext( blk))
+	{
+		if (!isInDocnoRange( docnorange, blk.getFirstElem())) break;
+
+		dbadapter.remove( transaction, blk.id());
+		strus::BooleanBlock::NodeCursor cursor;
+		strus::Index from, to;
+		bool haselem = blk.getFirstRange( cursor, from, to);
+		for (; haselem; haselem = blk.getNextRange( cursor, from, to))
+		{
+			rangear.push_back( strus::BooleanBlock::MergeRange( from, to, true));
+		}
+	}
+	unsigned int rt = 0;
+	strus::BooleanBlock newblk;
+	std::vector<strus::BooleanBlock::MergeRange>::const_iterator ri = rangear.begin(), re = rangear.end();
+	for (; ri != re; ++ri)
+	{
+		newblk.defineRange( ri->from, ri->to - ri->from);
+		if (newblk.full( blocksize))
+		{
+			newblk.setId( ri->to);
+			dbadapter.store( transaction, newblk);
+			newblk.clear();
+			++rt;
+		}
+	}
+	if (!newblk.empty())
+	{
+		newblk.setId( rangear.back().to);
+		dbadapter.store( transaction, newblk);
+		++rt;
+	}
+	return rt;
+}
+
+// Rewrite the doc/ff blocks of a term overlapping the document number range with the new block size:
+static unsigned int resizeFfBlocks(
+		strus::StorageClient& storage,
+		strus::DatabaseTransactionInterface* transaction,
+		const strus::Index& typeno,
+		const strus::Index& termno,
+		std::size_t blocksize,
+		const std::pair<unsigned int,unsigned int>& docnorange)
+{
+	unsigned int rt = 0;
+	strus::DatabaseAdapter_FfBlock::WriteCursor dbadapter( storage.databaseClient(), typeno, termno);
+	strus::FfBlockBuilder newblk( storage.docFfBlockFormat(), blocksize);
+	strus::FfBlock blk;
+	std::vector<strus::Index> docnoar;
+	std::vector<unsigned int> ffar;
+	bool hasmore = dbadapter.loadUpperBound( docnorange.first ? docnorange.first : 1, blk);
+	for (; hasmore; hasmore = dbadapter.loadNext( blk))
+	{
+		blk.decode( docnoar, ffar);
+		if (docnoar.empty() || !isInDocnoRange( docnorange, docnoar[0])) break;
+
+		dbadapter.remove( transaction, blk.id());
+		std::size_t ai = 0, ae = docnoar.size();
+		for (; ai != ae; ++ai)
+		{
+			newblk.append( docnoar[ ai], ffar[ ai]);
+			if (newblk.full())
+			{
+				dbadapter.store( transaction, newblk.createBlock());
+				newblk.clear();
+				++rt;
+			}
+		}
+	}
+	if (!newblk.empty())
+	{
+		dbadapter.store( transaction, newblk.createBlock());
+		++rt;
+	}
+	return rt;
+}
+
 static void resizeBlocks(
 		const strus::DatabaseInterface* dbi,
 		const std::string& configsource,
@@ -116,7 +261,7 @@ static void resizeBlocks(
 		unsigned int transactionsize,
 		const std::pair<unsigned int,unsigned int>& docnorange)
 {
-	strus::StorageClient storage( dbi, configsource, 0/*termnomap_source*/, 0/*statisticsProc*/, g_errorBuffer);
+	strus::StorageClient storage( dbi, configsource, 0/*termnomap_source*/, 0/*statisticsProc*/, 0/*blockDirectoryCacheSize*/, 0/*dataBlockCacheSize*/, g_errorBuffer);
 	strus::local_ptr<strus::DatabaseTransactionInterface> transaction( storage.databaseClient()->createTransaction());
 	unsigned int transactionidx = 0;
 	unsigned int blockcount = 0;
@@ -191,6 +336,54 @@ static void resizeBlocks(
 			::fflush( stdout);
 		}
 	}
+	else if (strus::utils::caseInsensitiveEquals( blocktype, "posinfo")
+		|| strus::utils::caseInsensitiveEquals( blocktype, "doclist")
+		|| strus::utils::caseInsensitiveEquals( blocktype, "docff"))
+	{
+		enum BlockType {PosinfoBlockType,DocListBlockType,DocFfBlockType};
+		BlockType blktype = strus::utils::caseInsensitiveEquals( blocktype, "posinfo")
+				? PosinfoBlockType
+				: strus::utils::caseInsensitiveEquals( blocktype, "doclist")
+					? DocListBlockType : DocFfBlockType;
+		if (blktype == DocFfBlockType && !storage.withDocFfBlocks())
+		{
+			throw strus::runtime_error( "%s", _TXT("storage has no doc/ff blocks"));
+		}
+		// Iterate on all terms with their df, the stored df defines the default block size:
+		strus::DatabaseAdapter_DocFrequency::Cursor dfcursor( storage.databaseClient());
+		strus::Index typeno, termno, df;
+		bool hasmore = dfcursor.loadFirst( typeno, termno, df);
+		for (; hasmore; hasmore = dfcursor.loadNext( typeno, termno, df))
+		{
+			if (termtypeno && typeno != termtypeno) continue;
+			switch (blktype)
+			{
+				case PosinfoBlockType:
+					blockcount += resizePosinfoBlocks( storage, transaction.get(), typeno, termno, newsize?newsize:strus::PosinfoBlock::blockSizeForDf( df), docnorange);
+					break;
+				case DocListBlockType:
+					blockcount += resizeDocListBlocks( storage, transaction.get(), typeno, termno, newsize?newsize:strus::BooleanBlock::blockSizeForDf( df), docnorange);
+					break;
+				case DocFfBlockType:
+					blockcount += resizeFfBlocks( storage, transaction.get(), typeno, termno, newsize?newsize:strus::FfBlock::blockSizeForDf( df), docnorange);
+					break;
+			}
+			if (++transactionidx == transactionsize)
+			{
+				commitTransaction( *storage.databaseClient(), transaction);
+				transactionidx = 0;
+				::printf( "\rresized %u        ", blockcount);
+				::fflush( stdout);
+			}
+		}
+		if (transactionidx)
+		{
+			commitTransaction( *storage.databaseClient(), transaction);
+			transactionidx = 0;
+			::printf( "\rresized %u        ", blockcount);
+			::fflush( stdout);
+		}
+	}
 	else
 	{
 		throw strus::runtime_error(_TXT("block resize is not implemented for blocktype '%s'"), blocktype.c_str());
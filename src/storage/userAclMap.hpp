@@ -69,6 +69,11 @@ public:
 	void getWriteBatch( DatabaseTransactionInterface* transaction);
 
 	void clear();
+	/// \brief Evaluate if there are no changes of access rights defined
+	bool empty() const
+	{
+		return m_usrdocmap.empty() && m_docusrmap.empty() && m_usr_deletes.empty() && m_doc_deletes.empty();
+	}
 
 private:
 	void markSetElement(
@@ -0,0 +1,625 @@
+/*
+ * Copyright (c) 2014 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#include "blockDirectory.hpp"
+#include "dataBlockCache.hpp"
+#include "databaseAdapter.hpp"
+#include "databaseKey.hpp"
+#include "blockKey.hpp"
+#include "dataBlock.hpp"
+#include "private/utils.hpp"
+#include "strus/index.hpp"
+#include "strus/databaseClientInterface.hpp"
+#include "strus/databaseTransactionInterface.hpp"
+#include "strus/databaseCursorInterface.hpp"
+#include "strus/databaseOptions.hpp"
+#include <stdexcept>
+#include <iostream>
+#include <sstream>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <map>
+#include <string>
+#include <ctime>
+
+static void initRand()
+{
+	time_t nowtime;
+	struct tm* now;
+
+	::time( &nowtime);
+	now = ::localtime( &nowtime);
+
+	::srand( ((now->tm_year+1) * (now->tm_mon+100) * (now->tm_mday+1)));
+}
+#define RANDINT(MIN,MAX) ((rand()%(MAX-MIN))+MIN)
+
+typedef std::map<std::string,std::string> KeyValueMap;
+
+/// \brief Cursor on a snapshot of the key/value map taken at its creation (as an iterator of LevelDB)
+class MemDatabaseCursor
+	:public strus::DatabaseCursorInterface
+{
+public:
+	explicit MemDatabaseCursor( const KeyValueMap& map_)
+		:m_map(map_),m_itr(m_map.end()),m_domainkey(){}
+	virtual ~MemDatabaseCursor(){}
+
+	virtual Slice seekUpperBound( const char* keystr, std::size_t keysize, std::size_t domainkeysize)
+	{
+		m_domainkey = std::string( keystr, domainkeysize);
+		m_itr = m_map.lower_bound( std::string( keystr, keysize));
+		return currentKey();
+	}
+	virtual Slice seekUpperBoundRestricted( const char* keystr, std::size_t keysize, const char* upkey, std::size_t upkeysize)
+	{
+		m_domainkey.clear();
+		m_itr = m_map.lower_bound( std::string( keystr, keysize));
+		if (m_itr != m_map.end() && m_itr->first >= std::string( upkey, upkeysize)) m_itr = m_map.end();
+		return currentKey();
+	}
+	virtual Slice seekFirst( const char* domainkey, std::size_t domainkeysize)
+	{
+		m_domainkey = std::string( domainkey, domainkeysize);
+		m_itr = m_map.lower_bound( m_domainkey);
+		return currentKey();
+	}
+	virtual Slice seekLast( const char* domainkey, std::size_t domainkeysize)
+	{
+		m_domainkey = std::string( domainkey, domainkeysize);
+		KeyValueMap::const_iterator last = m_map.end();
+		for (m_itr = m_map.lower_bound( m_domainkey); inDomain(); ++m_itr)
+		{
+			last = m_itr;
+		}
+		m_itr = last;
+		return currentKey();
+	}
+	virtual Slice seekNext()
+	{
+		if (m_itr != m_map.end()) ++m_itr;
+		return currentKey();
+	}
+	virtual Slice seekPrev()
+	{
+		if (m_itr == m_map.begin()) m_itr = m_map.end(); else if (m_itr != m_map.end()) --m_itr;
+		return currentKey();
+	}
+	virtual Slice key() const
+	{
+		return currentKey();
+	}
+	virtual Slice value() const
+	{
+		return inDomain() ? Slice( m_itr->second.c_str(), m_itr->second.size()) : Slice();
+	}
+
+private:
+	bool inDomain() const
+	{
+		return m_itr != m_map.end() && 0==std::strncmp( m_itr->first.c_str(), m_domainkey.c_str(), m_domainkey.size());
+	}
+	Slice currentKey() const
+	{
+		return inDomain() ? Slice( m_itr->first.c_str(), m_itr->first.size()) : Slice();
+	}
+
+private:
+	KeyValueMap m_map;
+	KeyValueMap::const_iterator m_itr;
+	std::string m_domainkey;
+};
+
+class MemDatabase;
+
+class MemDatabaseTransaction
+	:public strus::DatabaseTransactionInterface
+{
+public:
+	explicit MemDatabaseTransaction( KeyValueMap* map_)
+		:m_map(map_){}
+	virtual ~MemDatabaseTransaction(){}
+
+	virtual strus::DatabaseCursorInterface* createCursor( const strus::DatabaseOptions&) const
+	{
+		return new MemDatabaseCursor( *m_map);
+	}
+	virtual void write( const char* key, std::size_t keysize, const char* value, std::size_t valuesize)
+	{
+		m_writes.push_back( std::pair<std::string,std::string>( std::string( key, keysize), std::string( value, valuesize)));
+		m_removes.push_back( false);
+	}
+	virtual void remove( const char* key, std::size_t keysize)
+	{
+		m_writes.push_back( std::pair<std::string,std::string>( std::string( key, keysize), std::string()));
+		m_removes.push_back( true);
+	}
+	virtual void removeSubTree( const char*, std::size_t)
+	{
+		throw std::runtime_error( "remove of a subtree not implemented in test database");
+	}
+	virtual bool commit()
+	{
+		std::size_t wi = 0, we = m_writes.size();
+		for (; wi != we; ++wi)
+		{
+			if (m_removes[ wi])
+			{
+				m_map->erase( m_writes[ wi].first);
+			}
+			else
+			{
+				(*m_map)[ m_writes[ wi].first] = m_writes[ wi].second;
+			}
+		}
+		m_writes.clear();
+		m_removes.clear();
+		return true;
+	}
+	virtual void rollback()
+	{
+		m_writes.clear();
+		m_removes.clear();
+	}
+
+private:
+	KeyValueMap* m_map;
+	std::vector<std::pair<std::string,std::string> > m_writes;
+	std::vector<bool> m_removes;
+};
+
+/// \brief Key/value store database in memory
+class MemDatabase
+	:public strus::DatabaseClientInterface
+{
+public:
+	MemDatabase(){}
+	virtual ~MemDatabase(){}
+
+	virtual strus::DatabaseTransactionInterface* createTransaction()
+	{
+		return new MemDatabaseTransaction( &m_map);
+	}
+	virtual strus::DatabaseCursorInterface* createCursor( const strus::DatabaseOptions&) const
+	{
+		return new MemDatabaseCursor( m_map);
+	}
+	virtual strus::DatabaseBackupCursorInterface* createBackupCursor() const
+	{
+		return 0;
+	}
+	virtual void writeImm( const char* key, std::size_t keysize, const char* value, std::size_t valuesize)
+	{
+		m_map[ std::string( key, keysize)] = std::string( value, valuesize);
+	}
+	virtual void removeImm( const char* key, std::size_t keysize)
+	{
+		m_map.erase( std::string( key, keysize));
+	}
+	virtual bool readValue( const char* key, std::size_t keysize, std::string& value, const strus::DatabaseOptions&) const
+	{
+		KeyValueMap::const_iterator mi = m_map.find( std::string( key, keysize));
+		if (mi == m_map.end()) return false;
+		value = mi->second;
+		return true;
+	}
+	virtual void close(){}
+	virtual std::string config() const
+	{
+		return std::string();
+	}
+
+private:
+	KeyValueMap m_map;
+};
+
+static const char g_blockPrefix = (char)strus::DatabaseKey::DocListBlockPrefix;
+
+/// \brief Content of a block derived from its domain, its id and a version, for checking that the block returned is the one expected
+static std::string blockContent( const strus::Index& termno, const strus::Index& blkid, unsigned int version)
+{
+	std::string rt;
+	std::size_t ii = 0, size = 20 + (termno + blkid + version) % 40;
+	for (; ii<size; ++ii)
+	{
+		rt.push_back( (char)((termno * 7 + blkid * 13 + version * 17 + ii) & 0xFF));
+	}
+	return rt;
+}
+
+/// \brief Description of a block in a domain, that is the term termno
+struct BlockDef
+{
+	strus::Index blkid;
+	unsigned int version;
+
+	BlockDef( const strus::Index& blkid_, unsigned int version_)
+		:blkid(blkid_),version(version_){}
+	BlockDef( const BlockDef& o)
+		:blkid(o.blkid),version(o.version){}
+};
+
+/// \brief Simulation of a commit of a transaction of the storage client owning the caches
+class BlockWriter
+{
+public:
+	BlockWriter( MemDatabase* database_, strus::BlockDirectoryCache* dircache_, strus::DataBlockCache* blockcache_)
+		:m_database(database_),m_dircache(dircache_),m_blockcache(blockcache_)
+		,m_transaction(database_->createTransaction()){}
+
+	void store( const strus::Index& termno, const BlockDef& blk)
+	{
+		std::string content = blockContent( termno, blk.blkid, blk.version);
+		writer( termno).store( m_transaction.get(), strus::DataBlock( blk.blkid, content.c_str(), content.size()));
+	}
+	void remove( const strus::Index& termno, const strus::Index& blkid)
+	{
+		writer( termno).remove( m_transaction.get(), blkid);
+	}
+
+	/// \brief Commit with the invalidation of the caches (if invalidate is false, the commit is one of another storage client)
+	void commit( bool invalidate)
+	{
+		if (!m_transaction->commit()) throw std::runtime_error( "commit failed");
+		if (invalidate)
+		{
+			if (m_dircache) m_dircache->invalidate( m_domainRefreshList);
+			if (m_blockcache) m_blockcache->invalidate( m_blockRefreshList);
+		}
+	}
+
+private:
+	strus::DatabaseAdapter_DataBlock::Writer& writer( const strus::Index& termno)
+	{
+		std::map<strus::Index,strus::utils::SharedPtr<strus::DatabaseAdapter_DataBlock::Writer> >::iterator
+			wi = m_writers.find( termno);
+		if (wi != m_writers.end()) return *wi->second;
+		strus::BlockKey domainKey( 1, termno);
+		strus::utils::SharedPtr<strus::DatabaseAdapter_DataBlock::Writer> wr(
+			new strus::DatabaseAdapter_DataBlock::Writer( g_blockPrefix, m_database, domainKey));
+		wr->setBlockRefreshList( &m_blockRefreshList);
+		m_writers[ termno] = wr;
+		m_domainRefreshList.push_back( strus::BlockDirectoryCache::Key( g_blockPrefix, domainKey.index()));
+		return *wr;
+	}
+
+private:
+	MemDatabase* m_database;
+	strus::BlockDirectoryCache* m_dircache;
+	strus::DataBlockCache* m_blockcache;
+	strus::utils::SharedPtr<strus::DatabaseTransactionInterface> m_transaction;
+	std::map<strus::Index,strus::utils::SharedPtr<strus::DatabaseAdapter_DataBlock::Writer> > m_writers;
+	std::vector<strus::BlockDirectoryCache::Key> m_domainRefreshList;
+	std::vector<strus::DataBlockCache::Key> m_blockRefreshList;
+};
+
+/// \brief Create random blocks for the terms 1..nofTerms with ids between 1 and maxBlockId
+static std::map<strus::Index,std::vector<BlockDef> > createRandomBlocks( BlockWriter& writer, unsigned int nofTerms, unsigned int maxBlockId)
+{
+	std::map<strus::Index,std::vector<BlockDef> > rt;
+	strus::Index ti = 1, te = nofTerms+1;
+	for (; ti != te; ++ti)
+	{
+		strus::Index blkid = 0;
+		for (;;)
+		{
+			blkid += RANDINT( 1, 50);
+			if (blkid > (strus::Index)maxBlockId) break;
+			BlockDef blk( blkid, 0);
+			writer.store( ti, blk);
+			rt[ ti].push_back( blk);
+		}
+	}
+	return rt;
+}
+
+static std::string blockString( bool found, const strus::DataBlock& blk)
+{
+	if (!found) return "<none>";
+	std::ostringstream rt;
+	rt << blk.id() << ":";
+	char const* bi = blk.charptr();
+	char const* be = bi + blk.size();
+	for (; bi != be; ++bi)
+	{
+		rt << std::hex << (unsigned int)(unsigned char)*bi;
+	}
+	return rt.str();
+}
+
+/// \brief Cursor reading the blocks of a term with the directory and a cursor reading them with seeks only, for comparing their results
+class CursorPair
+{
+public:
+	CursorPair( strus::BlockDirectoryCache* dircache_, strus::DataBlockCache* blockcache_, const MemDatabase* database_, const strus::Index& termno_)
+		:m_termno(termno_)
+		,m_database(database_)
+		,m_cursor( new strus::BlockDirectoryCursor( dircache_, blockcache_, g_blockPrefix, database_, strus::BlockKey( 1, termno_), false))
+		,m_seekCursor( new strus::DatabaseAdapter_DataBlock::Cursor( g_blockPrefix, database_, strus::BlockKey( 1, termno_), false))
+		,m_lastBlockId(0)
+		,m_seekCursorRenewed(false){}
+
+	/// \brief Renew the seek cursor for seeing the database state after a commit
+	void renewSeekCursor()
+	{
+		m_seekCursor.reset( new strus::DatabaseAdapter_DataBlock::Cursor( g_blockPrefix, m_database, strus::BlockKey( 1, m_termno), false));
+		m_seekCursorRenewed = true;
+	}
+
+	/// \brief Compare the results of loadUpperBound
+	bool loadUpperBound( const strus::Index& elemno)
+	{
+		strus::DataBlock blk, seekblk;
+		bool found = m_cursor->loadUpperBound( elemno, blk);
+		bool seekfound = m_seekCursor->loadUpperBound( elemno, seekblk);
+		m_seekCursorRenewed = false;
+		return check( "loadUpperBound", elemno, found, blk, seekfound, seekblk);
+	}
+
+	/// \brief Compare the results of loadNext (only called after a block was found)
+	bool loadNext()
+	{
+		strus::DataBlock blk, seekblk;
+		bool found = m_cursor->loadNext( blk);
+		// ... a seek cursor renewed after a commit is not positioned, the block following is the upper bound of the successor of the last block id:
+		bool seekfound = m_seekCursorRenewed
+				? m_seekCursor->loadUpperBound( m_lastBlockId+1, seekblk)
+				: m_seekCursor->loadNext( seekblk);
+		m_seekCursorRenewed = false;
+		return check( "loadNext", m_lastBlockId, found, blk, seekfound, seekblk);
+	}
+
+	/// \brief Do random operations and compare their results
+	void randomOperations( unsigned int nofOperations, unsigned int maxBlockId)
+	{
+		bool positioned = false;
+		unsigned int oi = 0, oe = nofOperations;
+		for (; oi != oe; ++oi)
+		{
+			if (positioned && RANDINT( 0, 3) > 0)
+			{
+				positioned = loadNext();
+			}
+			else
+			{
+				positioned = loadUpperBound( RANDINT( 1, maxBlockId + 20));
+			}
+		}
+	}
+
+	const strus::BlockDirectoryCursor& cursor() const	{return *m_cursor;}
+
+private:
+	bool check( const char* method, const strus::Index& elemno, bool found, const strus::DataBlock& blk, bool seekfound, const strus::DataBlock& seekblk)
+	{
+		std::string blkstr = blockString( found, blk);
+		std::string seekblkstr = blockString( seekfound, seekblk);
+		if (blkstr != seekblkstr)
+		{
+			std::ostringstream msg;
+			msg << "block directory cursor " << method << "(" << elemno << ") of term " << m_termno << " returned " << blkstr << " instead of " << seekblkstr << " read with seeks";
+			throw std::runtime_error( msg.str());
+		}
+		if (found) m_lastBlockId = blk.id();
+		return found;
+	}
+
+private:
+	strus::Index m_termno;
+	const MemDatabase* m_database;
+	strus::utils::SharedPtr<strus::BlockDirectoryCursor> m_cursor;
+	strus::utils::SharedPtr<strus::DatabaseAdapter_DataBlock::Cursor> m_seekCursor;
+	strus::Index m_lastBlockId;
+	bool m_seekCursorRenewed;
+};
+
+enum {NofTerms=30,MaxBlockId=2000,NofOperations=2000};
+
+/// \brief Compare the results of cursors on many terms used in an interleaved way with the results of seeks
+/// \param[in] dircacheSize maximum memory usage of the block directory cache or 0, if there is no cache (config blockdircache=0)
+static void testSeekPathEquality( std::size_t dircacheSize, bool withBlockCache)
+{
+	MemDatabase database;
+	{
+		BlockWriter writer( &database, 0, 0);
+		createRandomBlocks( writer, NofTerms, MaxBlockId);
+		writer.commit( false);
+	}
+	strus::utils::SharedPtr<strus::BlockDirectoryCache> dircache;
+	if (dircacheSize) dircache.reset( new strus::BlockDirectoryCache( &database, dircacheSize));
+	strus::utils::SharedPtr<strus::DataBlockCache> blockcache;
+	if (withBlockCache) blockcache.reset( new strus::DataBlockCache( strus::DataBlockCache::DefaultMaxMemoryUsage));
+
+	std::vector<strus::utils::SharedPtr<CursorPair> > cursors;
+	strus::Index ti = 1, te = NofTerms+1;
+	for (; ti != te; ++ti)
+	{
+		cursors.push_back( strus::utils::SharedPtr<CursorPair>( new CursorPair( dircache.get(), blockcache.get(), &database, ti)));
+	}
+	// ... the cursors are used in a random order, so that directories of terms get evicted while their cursors still use them
+	unsigned int oi = 0, oe = NofOperations / 10;
+	for (; oi != oe; ++oi)
+	{
+		cursors[ RANDINT( 0, NofTerms)]->randomOperations( 10, MaxBlockId);
+	}
+	bool directorySelected = false;
+	std::vector<strus::utils::SharedPtr<CursorPair> >::const_iterator ci = cursors.begin(), ce = cursors.end();
+	for (; ci != ce; ++ci)
+	{
+		if ((*ci)->loadUpperBound( 1) && (*ci)->cursor().directorySelected()) directorySelected = true;
+	}
+	if (directorySelected != (dircacheSize != 0))
+	{
+		throw std::runtime_error( dircacheSize ? "blocks not selected with the directory" : "blocks selected with a directory without a block directory cache");
+	}
+}
+
+/// \brief Rewrite and split blocks of a term with a commit while a cursor holds a directory of the term
+static void testCommitWhileHoldingDirectory( bool withBlockCache)
+{
+	MemDatabase database;
+	strus::BlockDirectoryCache dircache( &database, strus::BlockDirectoryCache::DefaultMaxMemoryUsage);
+	strus::utils::SharedPtr<strus::DataBlockCache> blockcache;
+	if (withBlockCache) blockcache.reset( new strus::DataBlockCache( strus::DataBlockCache::DefaultMaxMemoryUsage));
+
+	std::map<strus::Index,std::vector<BlockDef> > blocks;
+	{
+		BlockWriter writer( &database, &dircache, blockcache.get());
+		blocks = createRandomBlocks( writer, 2, MaxBlockId);
+		writer.commit( true);
+	}
+	unsigned int ci = 0, ce = 20;
+	for (; ci != ce; ++ci)
+	{
+		CursorPair cursor( &dircache, blockcache.get(), &database, 1);
+		cursor.randomOperations( 50, MaxBlockId);
+		if (!cursor.loadUpperBound( RANDINT( 1, MaxBlockId/2)))
+		{
+			cursor.loadUpperBound( 1);
+		}
+		{
+			// ... split some blocks (a new block in the range of an existing one with a new version of the existing),
+			//	remove some and rewrite some, the elements to the next block in the directory are changed
+			BlockWriter writer( &database, &dircache, blockcache.get());
+			std::vector<BlockDef> newblocks;
+			strus::Index prev_blkid = 0;
+			std::vector<BlockDef>::const_iterator bi = blocks[1].begin(), be = blocks[1].end();
+			for (; bi != be; ++bi)
+			{
+				switch (RANDINT( 0, 5))
+				{
+					case 0:
+						if (bi->blkid - prev_blkid > 1)
+						{
+							BlockDef splitblk( prev_blkid + (bi->blkid - prev_blkid) / 2, bi->version+1);
+							writer.store( 1, splitblk);
+							newblocks.push_back( splitblk);
+						}
+						/*no break here!*/
+					case 1:
+					{
+						BlockDef rewrittenblk( bi->blkid, bi->version+1);
+						writer.store( 1, rewrittenblk);
+						newblocks.push_back( rewrittenblk);
+						break;
+					}
+					case 2:
+						writer.remove( 1, bi->blkid);
+						break;
+					default:
+						newblocks.push_back( *bi);
+						break;
+				}
+				prev_blkid = bi->blkid;
+			}
+			// ... a block of the other term is rewritten too, its directory is invalidated in the same commit
+			if (!blocks[2].empty())
+			{
+				writer.store( 2, BlockDef( blocks[2].back().blkid, blocks[2].back().version+1));
+				blocks[2].back().version += 1;
+			}
+			writer.commit( true);
+			blocks[1] = newblocks;
+		}
+		cursor.renewSeekCursor();
+		cursor.randomOperations( 50, MaxBlockId);
+		CursorPair othercursor( &dircache, blockcache.get(), &database, 2);
+		othercursor.randomOperations( 20, MaxBlockId);
+		if (!cursor.loadUpperBound( 1) || !cursor.cursor().directorySelected())
+		{
+			throw std::runtime_error( "blocks not selected with the directory after a commit");
+		}
+	}
+}
+
+/// \brief Point reads of blocks in an outdated directory that do not exist anymore (not invalidated, e.g. by a commit of another storage client)
+static void testPointReadMissFallback( bool withLoadNext)
+{
+	MemDatabase database;
+	strus::BlockDirectoryCache dircache( &database, strus::BlockDirectoryCache::DefaultMaxMemoryUsage);
+	std::map<strus::Index,std::vector<BlockDef> > blocks;
+	{
+		BlockWriter writer( &database, &dircache, 0);
+		blocks = createRandomBlocks( writer, 1, MaxBlockId);
+		writer.commit( true);
+	}
+	const std::vector<BlockDef>& termblocks = blocks[1];
+	if (termblocks.size() < 4) return;
+
+	// ... the cursors see the state before the commit removing blocks, as the seek cursor created with them
+	CursorPair cursor( &dircache, 0, &database, 1);
+	if (!cursor.loadUpperBound( 1) || !cursor.cursor().directorySelected())
+	{
+		throw std::runtime_error( "blocks not selected with the directory");
+	}
+	{
+		BlockWriter writer( &database, &dircache, 0);
+		std::size_t bi = 1, be = termblocks.size();
+		for (; bi < be; bi += 2)
+		{
+			writer.remove( 1, termblocks[ bi].blkid);
+		}
+		writer.commit( false);
+	}
+	if (withLoadNext)
+	{
+		// ... the next block is not found anymore with the directory
+		cursor.loadNext();
+	}
+	else
+	{
+		// ... the block containing an element of a block removed is not found anymore with the directory
+		cursor.loadUpperBound( termblocks[ 1].blkid);
+	}
+	if (cursor.cursor().directorySelected())
+	{
+		throw std::runtime_error( "block removed found with the directory");
+	}
+	// ... the cursor continues without the directory:
+	std::size_t bi = 2, be = termblocks.size();
+	for (; bi != be; ++bi)
+	{
+		if (!cursor.loadNext())
+		{
+			throw std::runtime_error( "block missing after the fallback to seeks");
+		}
+	}
+	if (cursor.loadNext())
+	{
+		throw std::runtime_error( "block found after the last block after the fallback to seeks");
+	}
+	cursor.randomOperations( 200, MaxBlockId);
+}
+
+int main( int , const char** )
+{
+	try
+	{
+		initRand();
+
+		// Default cache size, small cache with evictions, cache too small for any directory, no cache (blockdircache=0):
+		static const std::size_t dircacheSizes[] = {strus::BlockDirectoryCache::DefaultMaxMemoryUsage, 2048, 16, 0};
+		for (int si=0; si<4; ++si)
+		{
+			testSeekPathEquality( dircacheSizes[ si], false);
+			testSeekPathEquality( dircacheSizes[ si], true);
+		}
+		testCommitWhileHoldingDirectory( false);
+		testCommitWhileHoldingDirectory( true);
+		testPointReadMissFallback( true);
+		testPointReadMissFallback( false);
+		std::cerr << "OK" << std::endl;
+		return 0;
+	}
+	catch (const std::exception& err)
+	{
+		std::cerr << "EXCEPTION " << err.what() << std::endl;
+	}
+	return -1;
+}
+
@@ -0,0 +1,318 @@
+/*
+ * Copyright (c) 2014 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#include "dataBlockCache.hpp"
+#include "dataBlock.hpp"
+#include "databaseKey.hpp"
+#include "private/utils.hpp"
+#include "strus/index.hpp"
+#include <stdexcept>
+#include <iostream>
+#include <sstream>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <algorithm>
+#include <string>
+#include <ctime>
+
+static void initRand()
+{
+	time_t nowtime;
+	struct tm* now;
+
+	::time( &nowtime);
+	now = ::localtime( &nowtime);
+
+	::srand( ((now->tm_year+1) * (now->tm_mon+100) * (now->tm_mday+1)));
+}
+#define RANDINT(MIN,MAX) ((rand()%(MAX-MIN))+MIN)
+
+static strus::DataBlockCache::Key blockKey( const strus::Index& termno, const strus::Index& blkid)
+{
+	strus::DatabaseKey dbkey( (char)strus::DatabaseKey::PosinfoBlockPrefix, strus::BlockKey( 1, termno), blkid);
+	return strus::DataBlockCache::Key( dbkey.ptr(), dbkey.size());
+}
+
+/// \brief Content of a block derived from its key and a version, for checking that the block returned is the one expected
+static std::string blockContent( const strus::Index& termno, const strus::Index& blkid, unsigned int version, std::size_t size)
+{
+	std::string rt;
+	for (std::size_t ii=0; ii<size; ++ii)
+	{
+		rt.push_back( (char)((termno * 7 + blkid * 13 + version * 17 + ii) & 0xFF));
+	}
+	return rt;
+}
+
+static strus::DataBlockCache::BlockRef createBlock( const strus::Index& termno, const strus::Index& blkid, unsigned int version, std::size_t size)
+{
+	std::string content = blockContent( termno, blkid, version, size);
+	return strus::DataBlockCache::BlockRef( new strus::DataBlock( blkid, content.c_str(), content.size(), true));
+}
+
+static bool isBlock( const strus::DataBlockCache::BlockRef& blk, const strus::Index& termno, const strus::Index& blkid, unsigned int version, std::size_t size)
+{
+	if (!blk.get() || blk->id() != blkid || blk->size() != size) return false;
+	std::string content = blockContent( termno, blkid, version, size);
+	return 0==std::memcmp( blk->ptr(), content.c_str(), size);
+}
+
+static void testInsertGet()
+{
+	strus::DataBlockCache cache( strus::DataBlockCache::DefaultMaxMemoryUsage);
+	strus::Index ti = 1, te = 50;
+	for (; ti != te; ++ti)
+	{
+		strus::Index bi = 1, be = 20;
+		for (; bi != be; ++bi)
+		{
+			strus::DataBlockCache::BlockRef blk = createBlock( ti, bi*100, 0, 100 + bi);
+			strus::DataBlockCache::BlockRef inserted = cache.insert( blockKey( ti, bi*100), blk, cache.generation());
+			if (inserted.get() != blk.get()) throw std::runtime_error( "block not inserted into data block cache");
+		}
+	}
+	for (ti = 1; ti != te; ++ti)
+	{
+		strus::Index bi = 1, be = 20;
+		for (; bi != be; ++bi)
+		{
+			if (!isBlock( cache.get( blockKey( ti, bi*100)), ti, bi*100, 0, 100 + bi))
+			{
+				throw std::runtime_error( "block inserted not found in data block cache");
+			}
+			if (cache.get( blockKey( ti, bi*100+1)).get())
+			{
+				throw std::runtime_error( "block not inserted found in data block cache");
+			}
+		}
+	}
+	// A second insert of the same block returns the block cached:
+	strus::DataBlockCache::BlockRef blk = createBlock( 1, 100, 1, 101);
+	if (!isBlock( cache.insert( blockKey( 1, 100), blk, cache.generation()), 1, 100, 0, 101))
+	{
+		throw std::runtime_error( "block inserted twice into data block cache replaced");
+	}
+}
+
+static void testMemoryLimit()
+{
+	std::size_t maxMemoryUsage = 1024 * 1024;
+	std::size_t blocksize = 1000;
+	strus::DataBlockCache cache( maxMemoryUsage);
+	strus::DataBlockCache::BlockRef firstblk = createBlock( 1, 1, 0, blocksize);
+	cache.insert( blockKey( 1, 1), firstblk, cache.generation());
+
+	strus::Index bi = 2, be = 10000;
+	for (; bi != be; ++bi)
+	{
+		cache.insert( blockKey( 1, bi), createBlock( 1, bi, 0, blocksize), cache.generation());
+	}
+	// The first block is evicted, but stays valid for the holder of its handle:
+	if (cache.get( blockKey( 1, 1)).get())
+	{
+		throw std::runtime_error( "least recently used block not evicted from data block cache");
+	}
+	if (!isBlock( firstblk, 1, 1, 0, blocksize))
+	{
+		throw std::runtime_error( "block evicted from data block cache changed");
+	}
+	unsigned int nofCached = 0;
+	for (bi = 1; bi != be; ++bi)
+	{
+		if (cache.get( blockKey( 1, bi)).get()) ++nofCached;
+	}
+	if (nofCached * blocksize > maxMemoryUsage || nofCached < (maxMemoryUsage / blocksize) / 4)
+	{
+		std::ostringstream msg;
+		msg << "number of blocks cached " << nofCached << " does not match the memory limit of the data block cache";
+		throw std::runtime_error( msg.str());
+	}
+	// A block bigger than the memory limit is not cached:
+	strus::DataBlockCache::BlockRef bigblk = createBlock( 2, 1, 0, maxMemoryUsage);
+	cache.insert( blockKey( 2, 1), bigblk, cache.generation());
+	if (cache.get( blockKey( 2, 1)).get())
+	{
+		throw std::runtime_error( "block bigger than the memory limit inserted into data block cache");
+	}
+}
+
+static void testInvalidate()
+{
+	strus::DataBlockCache cache( strus::DataBlockCache::DefaultMaxMemoryUsage);
+	strus::Index bi = 1, be = 100;
+	for (; bi != be; ++bi)
+	{
+		cache.insert( blockKey( 1, bi), createBlock( 1, bi, 0, 200), cache.generation());
+	}
+	// A block read before an invalidation is not cached:
+	unsigned int generation = cache.generation();
+	std::vector<strus::DataBlockCache::Key> refreshList;
+	for (bi = 1; bi < be; bi += 3)
+	{
+		refreshList.push_back( blockKey( 1, bi));
+	}
+	refreshList.push_back( blockKey( 1, be));
+	cache.invalidate( refreshList);
+	cache.insert( blockKey( 1, be), createBlock( 1, be, 0, 200), generation);
+	if (cache.get( blockKey( 1, be)).get())
+	{
+		throw std::runtime_error( "block read before an invalidation inserted into data block cache");
+	}
+	// Only the blocks invalidated are removed:
+	for (bi = 1; bi != be; ++bi)
+	{
+		bool invalidated = ((bi - 1) % 3 == 0);
+		bool cached = cache.get( blockKey( 1, bi)).get() != 0;
+		if (invalidated == cached)
+		{
+			std::ostringstream msg;
+			msg << "block " << bi << (invalidated ? " invalidated still in data block cache" : " not invalidated removed from data block cache");
+			throw std::runtime_error( msg.str());
+		}
+	}
+	cache.insert( blockKey( 1, 1), createBlock( 1, 1, 1, 300), cache.generation());
+	if (!isBlock( cache.get( blockKey( 1, 1)), 1, 1, 1, 300))
+	{
+		throw std::runtime_error( "block rewritten after invalidation not inserted into data block cache");
+	}
+}
+
+enum {NofTerms=20,NofBlocks=50,BlockSize=300};
+
+/// \brief Thread reading blocks through the cache while the main thread rewrites them
+/// \remark Checks that a block got from the cache is not older than the version before the last commit (whose invalidation might not be finished yet)
+class BlockReader
+{
+public:
+	BlockReader( strus::DataBlockCache* cache_, const unsigned int* versions_, strus::utils::Mutex* mutex_, unsigned int nofReads_, unsigned int seed_, bool* failed_)
+		:m_cache(cache_),m_versions(versions_),m_mutex(mutex_),m_nofReads(nofReads_),m_seed(seed_),m_failed(failed_){}
+	BlockReader( const BlockReader& o)
+		:m_cache(o.m_cache),m_versions(o.m_versions),m_mutex(o.m_mutex),m_nofReads(o.m_nofReads),m_seed(o.m_seed),m_failed(o.m_failed){}
+
+	void operator()()
+	{
+		for (unsigned int ri=0; ri<m_nofReads; ++ri)
+		{
+			strus::Index termno = random( NofTerms) + 1;
+			strus::Index blkid = random( NofBlocks) + 1;
+			strus::DataBlockCache::Key key = blockKey( termno, blkid);
+			unsigned int minversion = version( termno, blkid);
+			if (minversion) --minversion;
+
+			strus::DataBlockCache::BlockRef blk = m_cache->get( key);
+			if (!blk.get())
+			{
+				// ... simulate a read from the storage
+				unsigned int generation = m_cache->generation();
+				blk = m_cache->insert( key, createBlock( termno, blkid, version( termno, blkid), BlockSize), generation);
+			}
+			unsigned int vi = minversion, ve = version( termno, blkid) + 1;
+			for (; vi != ve && !isBlock( blk, termno, blkid, vi, BlockSize); ++vi){}
+			if (vi == ve)
+			{
+				*m_failed = true;
+			}
+		}
+	}
+
+private:
+	unsigned int version( const strus::Index& termno, const strus::Index& blkid) const
+	{
+		strus::utils::ScopedLock lock( *m_mutex);
+		return m_versions[ (termno-1) * NofBlocks + blkid - 1];
+	}
+	strus::Index random( strus::Index range)
+	{
+		m_seed = m_seed * 1103515245U + 12345U;
+		return (m_seed >> 8) % range;
+	}
+
+private:
+	strus::DataBlockCache* m_cache;
+	const unsigned int* m_versions;
+	strus::utils::Mutex* m_mutex;
+	unsigned int m_nofReads;
+	unsigned int m_seed;
+	bool* m_failed;
+};
+
+static void testConcurrentAccess( unsigned int nofThreads, unsigned int nofReads, unsigned int nofCommits)
+{
+	strus::DataBlockCache cache( 256 * 1024);
+	std::vector<unsigned int> versions( NofTerms * NofBlocks, 0);
+	strus::utils::Mutex mutex;
+	bool failed = false;
+	{
+		strus::utils::ThreadGroup threads;
+		for (unsigned int tidx=0; tidx<nofThreads; ++tidx)
+		{
+			threads.create_thread( BlockReader( &cache, &versions[0], &mutex, nofReads, tidx+1, &failed));
+		}
+		for (unsigned int ci=0; ci<nofCommits; ++ci)
+		{
+			// ... simulate a commit rewriting some blocks of a term
+			strus::Index termno = RANDINT( 1, NofTerms+1);
+			std::vector<strus::DataBlockCache::Key> refreshList;
+			{
+				strus::utils::ScopedLock lock( mutex);
+				unsigned int bi = 0, be = RANDINT( 1, 10);
+				for (; bi != be; ++bi)
+				{
+					strus::Index blkid = RANDINT( 1, NofBlocks+1);
+					unsigned int& version = versions[ (termno-1) * NofBlocks + blkid - 1];
+					if (std::find( refreshList.begin(), refreshList.end(), blockKey( termno, blkid)) == refreshList.end())
+					{
+						++version;
+						refreshList.push_back( blockKey( termno, blkid));
+					}
+				}
+			}
+			cache.invalidate( refreshList);
+		}
+		threads.join_all();
+	}
+	if (failed)
+	{
+		throw std::runtime_error( "outdated block returned from data block cache");
+	}
+	// All blocks cached are the current ones:
+	strus::Index ti = 1, te = NofTerms+1;
+	for (; ti != te; ++ti)
+	{
+		strus::Index bi = 1, be = NofBlocks+1;
+		for (; bi != be; ++bi)
+		{
+			strus::DataBlockCache::BlockRef blk = cache.get( blockKey( ti, bi));
+			if (blk.get() && !isBlock( blk, ti, bi, versions[ (ti-1) * NofBlocks + bi - 1], BlockSize))
+			{
+				throw std::runtime_error( "outdated block left in data block cache after invalidation");
+			}
+		}
+	}
+}
+
+int main( int , const char** )
+{
+	try
+	{
+		initRand();
+
+		testInsertGet();
+		testMemoryLimit();
+		testInvalidate();
+		testConcurrentAccess( 8, 20000, 2000);
+		std::cerr << "OK" << std::endl;
+		return 0;
+	}
+	catch (const std::exception& err)
+	{
+		std::cerr << "EXCEPTION " << err.what() << std::endl;
+	}
+	return -1;
+}
+
@@ -0,0 +1,538 @@
+/*
+ * Copyright (c) 2014 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#include "indexSetIterator.hpp"
+#include "booleanBlock.hpp"
+#include "blockDirectory.hpp"
+#include "dataBlockCache.hpp"
+#include "databaseAdapter.hpp"
+#include "databaseKey.hpp"
+#include "blockKey.hpp"
+#include "private/utils.hpp"
+#include "strus/index.hpp"
+#include "strus/databaseClientInterface.hpp"
+#include "strus/databaseTransactionInterface.hpp"
+#include "strus/databaseCursorInterface.hpp"
+#include "strus/databaseOptions.hpp"
+#include <stdexcept>
+#include <iostream>
+#include <sstream>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <map>
+#include <set>
+#include <string>
+#include <ctime>
+
+static void initRand()
+{
+	time_t nowtime;
+	struct tm* now;
+
+	::time( &nowtime);
+	now = ::localtime( &nowtime);
+
+	::srand( ((now->tm_year+1) * (now->tm_mon+100) * (now->tm_mday+1)));
+}
+#define RANDINT(MIN,MAX) ((rand()%(MAX-MIN))+MIN)
+
+typedef std::map<std::string,std::string> KeyValueMap;
+
+/// \brief Cursor on a snapshot of the key/value map taken at its creation (as an iterator of LevelDB)
+class MemDatabaseCursor
+	:public strus::DatabaseCursorInterface
+{
+public:
+	explicit MemDatabaseCursor( const KeyValueMap& map_)
+		:m_map(map_),m_itr(m_map.end()),m_domainkey(){}
+	virtual ~MemDatabaseCursor(){}
+
+	virtual Slice seekUpperBound( const char* keystr, std::size_t keysize, std::size_t domainkeysize)
+	{
+		m_domainkey = std::string( keystr, domainkeysize);
+		m_itr = m_map.lower_bound( std::string( keystr, keysize));
+		return currentKey();
+	}
+	virtual Slice seekUpperBoundRestricted( const char* keystr, std::size_t keysize, const char* upkey, std::size_t upkeysize)
+	{
+		m_domainkey.clear();
+		m_itr = m_map.lower_bound( std::string( keystr, keysize));
+		if (m_itr != m_map.end() && m_itr->first >= std::string( upkey, upkeysize)) m_itr = m_map.end();
+		return currentKey();
+	}
+	virtual Slice seekFirst( const char* domainkey, std::size_t domainkeysize)
+	{
+		m_domainkey = std::string( domainkey, domainkeysize);
+		m_itr = m_map.lower_bound( m_domainkey);
+		return currentKey();
+	}
+	virtual Slice seekLast( const char* domainkey, std::size_t domainkeysize)
+	{
+		m_domainkey = std::string( domainkey, domainkeysize);
+		KeyValueMap::const_iterator last = m_map.end();
+		for (m_itr = m_map.lower_bound( m_domainkey); inDomain(); ++m_itr)
+		{
+			last = m_itr;
+		}
+		m_itr = last;
+		return currentKey();
+	}
+	virtual Slice seekNext()
+	{
+		if (m_itr != m_map.end()) ++m_itr;
+		return currentKey();
+	}
+	virtual Slice seekPrev()
+	{
+		if (m_itr == m_map.begin()) m_itr = m_map.end(); else if (m_itr != m_map.end()) --m_itr;
+		return currentKey();
+	}
+	virtual Slice key() const
+	{
+		return currentKey();
+	}
+	virtual Slice value() const
+	{
+		return inDomain() ? Slice( m_itr->second.c_str(), m_itr->second.size()) : Slice();
+	}
+
+private:
+	bool inDomain() const
+	{
+		return m_itr != m_map.end() && 0==std::strncmp( m_itr->first.c_str(), m_domainkey.c_str(), m_domainkey.size());
+	}
+	Slice currentKey() const
+	{
+		return inDomain() ? Slice( m_itr->first.c_str(), m_itr->first.size()) : Slice();
+	}
+
+private:
+	KeyValueMap m_map;
+	KeyValueMap::const_iterator m_itr;
+	std::string m_domainkey;
+};
+
+class MemDatabase;
+
+class MemDatabaseTransaction
+	:public strus::DatabaseTransactionInterface
+{
+public:
+	explicit MemDatabaseTransaction( KeyValueMap* map_)
+		:m_map(map_){}
+	virtual ~MemDatabaseTransaction(){}
+
+	virtual strus::DatabaseCursorInterface* createCursor( const strus::DatabaseOptions&) const
+	{
+		return new MemDatabaseCursor( *m_map);
+	}
+	virtual void write( const char* key, std::size_t keysize, const char* value, std::size_t valuesize)
+	{
+		m_writes.push_back( std::pair<std::string,std::string>( std::string( key, keysize), std::string( value, valuesize)));
+		m_removes.push_back( false);
+	}
+	virtual void remove( const char* key, std::size_t keysize)
+	{
+		m_writes.push_back( std::pair<std::string,std::string>( std::string( key, keysize), std::string()));
+		m_removes.push_back( true);
+	}
+	virtual void removeSubTree( const char*, std::size_t)
+	{
+		throw std::runtime_error( "remove of a subtree not implemented in test database");
+	}
+	virtual bool commit()
+	{
+		std::size_t wi = 0, we = m_writes.size();
+		for (; wi != we; ++wi)
+		{
+			if (m_removes[ wi])
+			{
+				m_map->erase( m_writes[ wi].first);
+			}
+			else
+			{
+				(*m_map)[ m_writes[ wi].first] = m_writes[ wi].second;
+			}
+		}
+		m_writes.clear();
+		m_removes.clear();
+		return true;
+	}
+	virtual void rollback()
+	{
+		m_writes.clear();
+		m_removes.clear();
+	}
+
+private:
+	KeyValueMap* m_map;
+	std::vector<std::pair<std::string,std::string> > m_writes;
+	std::vector<bool> m_removes;
+};
+
+/// \brief Key/value store database in memory
+class MemDatabase
+	:public strus::DatabaseClientInterface
+{
+public:
+	MemDatabase(){}
+	virtual ~MemDatabase(){}
+
+	virtual strus::DatabaseTransactionInterface* createTransaction()
+	{
+		return new MemDatabaseTransaction( &m_map);
+	}
+	virtual strus::DatabaseCursorInterface* createCursor( const strus::DatabaseOptions&) const
+	{
+		return new MemDatabaseCursor( m_map);
+	}
+	virtual strus::DatabaseBackupCursorInterface* createBackupCursor() const
+	{
+		return 0;
+	}
+	virtual void writeImm( const char* key, std::size_t keysize, const char* value, std::size_t valuesize)
+	{
+		m_map[ std::string( key, keysize)] = std::string( value, valuesize);
+	}
+	virtual void removeImm( const char* key, std::size_t keysize)
+	{
+		m_map.erase( std::string( key, keysize));
+	}
+	virtual bool readValue( const char* key, std::size_t keysize, std::string& value, const strus::DatabaseOptions&) const
+	{
+		KeyValueMap::const_iterator mi = m_map.find( std::string( key, keysize));
+		if (mi == m_map.end()) return false;
+		value = mi->second;
+		return true;
+	}
+	virtual void close(){}
+	virtual std::string config() const
+	{
+		return std::string();
+	}
+
+private:
+	KeyValueMap m_map;
+};
+
+static const char g_blockPrefix = (char)strus::DatabaseKey::DocListBlockPrefix;
+static const strus::BlockKey g_domainKey( 1, 1);
+
+/// \brief Random set of elements stored as boolean blocks, with the blocks and the elements kept for comparing the results of skips
+struct RandomIndexSet
+{
+	std::vector<strus::BooleanBlock> blocks;
+	std::set<strus::Index> elements;
+	strus::Index maxElemNo;
+	unsigned int nofAdjacentRanges;
+
+	RandomIndexSet()
+		:blocks(),elements(),maxElemNo(0),nofAdjacentRanges(0){}
+
+	/// \brief Create the set with ranges and single elements, many of them adjacent (ranges of different nodes that have to be joined when decoded)
+	void create( unsigned int nofBlocks, unsigned int maxNofDefinitionsPerBlock)
+	{
+		strus::Index elemItr = 0;
+		unsigned int bi = 0;
+		for (; bi<nofBlocks; ++bi)
+		{
+			strus::BooleanBlock blk;
+			unsigned int di = 0, de = RANDINT( 1, maxNofDefinitionsPerBlock+1);
+			for (; di<de; ++di)
+			{
+				elemItr += (RANDINT( 0, 3) == 0) ? 1 : RANDINT( 2, 30);
+				strus::Index range = (RANDINT( 0, 2) == 0) ? 0 : RANDINT( 1, 20);
+				blk.defineRange( elemItr, range);
+				strus::Index ri = 0;
+				for (; ri <= range; ++ri)
+				{
+					elements.insert( elemItr + ri);
+				}
+				elemItr += range;
+			}
+			blk.setId( blk.getLast());
+			blocks.push_back( blk);
+			nofAdjacentRanges += countAdjacentRanges( blk);
+		}
+		maxElemNo = elemItr;
+	}
+
+	/// \brief Store the blocks in the database
+	void store( MemDatabase* database) const
+	{
+		strus::utils::SharedPtr<strus::DatabaseTransactionInterface> transaction( database->createTransaction());
+		strus::DatabaseAdapter_DataBlock::Writer writer( g_blockPrefix, database, g_domainKey);
+		std::vector<strus::BooleanBlock>::const_iterator bi = blocks.begin(), be = blocks.end();
+		for (; bi != be; ++bi)
+		{
+			writer.store( transaction.get(), *bi);
+		}
+		if (!transaction->commit()) throw std::runtime_error( "commit failed");
+	}
+
+	/// \brief Expected result of a skip
+	strus::Index upperBound( const strus::Index& elemno) const
+	{
+		std::set<strus::Index>::const_iterator ei = elements.lower_bound( elemno);
+		return ei == elements.end() ? 0 : *ei;
+	}
+
+private:
+	static unsigned int countAdjacentRanges( const strus::BooleanBlock& blk)
+	{
+		unsigned int rt = 0;
+		strus::BooleanBlock::NodeCursor cursor;
+		strus::Index from_, to_, prev_to_ = 0;
+		bool more = blk.getFirstRange( cursor, from_, to_);
+		for (; more; more = blk.getNextRange( cursor, from_, to_))
+		{
+			if (prev_to_ && prev_to_ + 1 == from_) ++rt;
+			prev_to_ = to_;
+		}
+		return rt;
+	}
+};
+
+/// \brief Skip on the blocks with a node cursor, as the index set iterator did before decoding the blocks into arrays of ranges
+class NodeCursorSkip
+{
+public:
+	explicit NodeCursorSkip( const std::vector<strus::BooleanBlock>& blocks_)
+		:m_blocks(blocks_),m_blkidx(blocks_.size()),m_cursor(){}
+
+	strus::Index skip( const strus::Index& elemno)
+	{
+		if (m_blkidx >= m_blocks.size() || !m_blocks[ m_blkidx].isThisBlockAddress( elemno))
+		{
+			// ... load the upper bound block, the first block with an id bigger than or equal to elemno:
+			for (m_blkidx = 0; m_blkidx < m_blocks.size() && m_blocks[ m_blkidx].id() < elemno; ++m_blkidx){}
+			if (m_blkidx >= m_blocks.size()) return 0;
+			m_cursor.reset();
+		}
+		return m_blocks[ m_blkidx].skip( elemno, m_cursor);
+	}
+
+	/// \brief First element of the block of the last skip
+	strus::Index blockFirstElem() const
+	{
+		return m_blkidx < m_blocks.size() ? m_blocks[ m_blkidx].getFirstElem() : 0;
+	}
+
+private:
+	const std::vector<strus::BooleanBlock>& m_blocks;
+	std::size_t m_blkidx;
+	strus::BooleanBlock::NodeCursor m_cursor;
+};
+
+/// \brief Index set iterator and node cursor skip on the same set, for comparing their results
+class SkipPair
+{
+public:
+	SkipPair( const MemDatabase* database, const RandomIndexSet& set_, strus::BlockDirectoryCache* dircache, strus::DataBlockCache* blockcache)
+		:m_set(set_)
+		,m_itr( database, strus::DatabaseKey::DocListBlockPrefix, g_domainKey, false, dircache, blockcache)
+		,m_ref( set_.blocks){}
+
+	strus::Index skip( const strus::Index& elemno, const char* what)
+	{
+		strus::Index result = m_itr.skip( elemno);
+		strus::Index expected = m_ref.skip( elemno);
+		if (result != expected || expected != m_set.upperBound( elemno))
+		{
+			std::ostringstream msg;
+			msg << what << ": skip(" << elemno << ") of index set iterator returned " << result
+				<< ", node cursor skip " << expected << ", expected " << m_set.upperBound( elemno);
+			throw std::runtime_error( msg.str());
+		}
+		if (m_itr.elemno() != result)
+		{
+			std::ostringstream msg;
+			msg << what << ": element of index set iterator " << m_itr.elemno() << " not equal to the result of skip(" << elemno << ") " << result;
+			throw std::runtime_error( msg.str());
+		}
+		return result;
+	}
+
+	strus::Index blockFirstElem() const
+	{
+		return m_ref.blockFirstElem();
+	}
+
+private:
+	const RandomIndexSet& m_set;
+	strus::IndexSetIterator m_itr;
+	NodeCursorSkip m_ref;
+};
+
+static void testAscendingSkips( SkipPair& skipper, const RandomIndexSet& set)
+{
+	// Visit every element:
+	strus::Index elemno = skipper.skip( 1, "ascending");
+	std::size_t cnt = 0;
+	for (; elemno; elemno = skipper.skip( elemno+1, "ascending"))
+	{
+		++cnt;
+	}
+	if (cnt != set.elements.size())
+	{
+		throw std::runtime_error( "number of elements visited with ascending skips does not match");
+	}
+	// Skip with random gaps:
+	for (elemno = 1; elemno <= set.maxElemNo + 50; elemno += RANDINT( 1, 60))
+	{
+		skipper.skip( elemno, "ascending");
+	}
+}
+
+static void testBackwardSkips( SkipPair& skipper, const RandomIndexSet& set, unsigned int nofQueries)
+{
+	unsigned int qi = 0;
+	for (; qi<nofQueries; ++qi)
+	{
+		strus::Index elemno = skipper.skip( RANDINT( 1, set.maxElemNo+1), "backward");
+		if (!elemno) continue;
+		strus::Index first = skipper.blockFirstElem();
+		unsigned int ki = 0, ke = RANDINT( 1, 5);
+		for (; ki<ke && elemno > first; ++ki)
+		{
+			// ... back to an element in the same block, at its start or before the last element found:
+			strus::Index backelemno = (RANDINT( 0, 4) == 0) ? first : (first + RANDINT( 0, elemno - first));
+			skipper.skip( backelemno, "backward in block");
+			skipper.skip( elemno, "forward after backward in block");
+		}
+	}
+}
+
+static void testSkipsPastLastRange( SkipPair& skipper, const RandomIndexSet& set, unsigned int nofQueries)
+{
+	unsigned int qi = 0;
+	for (; qi<nofQueries; ++qi)
+	{
+		skipper.skip( RANDINT( 1, set.maxElemNo+1), "before skip past the last range");
+		if (0!=skipper.skip( set.maxElemNo + RANDINT( 1, 100), "past the last range"))
+		{
+			throw std::runtime_error( "element found after the last range");
+		}
+		skipper.skip( RANDINT( 1, set.maxElemNo+1), "after skip past the last range");
+	}
+	skipper.skip( set.maxElemNo, "last element");
+}
+
+static void testRandomSkips( SkipPair& skipper, const RandomIndexSet& set, unsigned int nofQueries)
+{
+	unsigned int qi = 0;
+	for (; qi<nofQueries; ++qi)
+	{
+		skipper.skip( RANDINT( 1, set.maxElemNo+20), "random");
+	}
+}
+
+static void testFetch( const MemDatabase* database, const RandomIndexSet& set, strus::BlockDirectoryCache* dircache, strus::DataBlockCache* blockcache)
+{
+	strus::IndexSetIterator itr( database, strus::DatabaseKey::DocListBlockPrefix, g_domainKey, false, dircache, blockcache);
+	std::vector<strus::Index> buf( 64);
+	std::set<strus::Index>::const_iterator ei = set.elements.begin(), ee = set.elements.end();
+	strus::Index elemno = 1;
+	for (;;)
+	{
+		std::size_t maxsize = RANDINT( 1, 65);
+		std::size_t nn = itr.fetch( elemno, &buf[0], maxsize);
+		std::size_t ii = 0;
+		for (; ii < nn; ++ii,++ei)
+		{
+			if (ei == ee || *ei != buf[ ii])
+			{
+				std::ostringstream msg;
+				msg << "fetch(" << elemno << ") of index set iterator returned " << buf[ ii] << " instead of " << (ei == ee ? 0 : *ei);
+				throw std::runtime_error( msg.str());
+			}
+		}
+		if (nn < maxsize)
+		{
+			if (ei != ee) throw std::runtime_error( "fetch of index set iterator returned less elements than left");
+			break;
+		}
+		elemno = buf[ nn-1]+1;
+		if (RANDINT( 0, 4) == 0 && ei != ee)
+		{
+			// ... skip some elements between the fetches:
+			unsigned int si = 0, se = RANDINT( 1, 30);
+			for (; si < se && ei != ee; ++si,++ei){}
+			if (ei == ee) break;
+			elemno = *ei;
+		}
+	}
+}
+
+static void testIndexSetIterator( unsigned int times, unsigned int nofBlocks, unsigned int maxNofDefinitionsPerBlock)
+{
+	unsigned int nofAdjacentRanges = 0;
+	unsigned int tt = 0;
+	for (; tt<times; ++tt)
+	{
+		MemDatabase database;
+		RandomIndexSet set;
+		set.create( nofBlocks, maxNofDefinitionsPerBlock);
+		set.store( &database);
+		nofAdjacentRanges += set.nofAdjacentRanges;
+
+		// Read the blocks with seeks only and with the block directory and the data block cache:
+		strus::BlockDirectoryCache dircache( &database, strus::BlockDirectoryCache::DefaultMaxMemoryUsage);
+		strus::DataBlockCache blockcache( strus::DataBlockCache::DefaultMaxMemoryUsage);
+		int ci = 0;
+		for (; ci<2; ++ci)
+		{
+			strus::BlockDirectoryCache* dc = ci ? &dircache : 0;
+			strus::DataBlockCache* bc = ci ? &blockcache : 0;
+			{
+				SkipPair skipper( &database, set, dc, bc);
+				testAscendingSkips( skipper, set);
+			}
+			{
+				SkipPair skipper( &database, set, dc, bc);
+				testBackwardSkips( skipper, set, 300);
+			}
+			{
+				SkipPair skipper( &database, set, dc, bc);
+				testSkipsPastLastRange( skipper, set, 50);
+			}
+			{
+				SkipPair skipper( &database, set, dc, bc);
+				testRandomSkips( skipper, set, 300);
+				testAscendingSkips( skipper, set);
+				testBackwardSkips( skipper, set, 100);
+				testSkipsPastLastRange( skipper, set, 10);
+			}
+			testFetch( &database, set, dc, bc);
+		}
+	}
+	if (!nofAdjacentRanges)
+	{
+		throw std::runtime_error( "no adjacent ranges of different nodes in the blocks tested");
+	}
+	std::cerr << "tested index set iterator " << times << " times with " << nofBlocks << " blocks (" << nofAdjacentRanges << " adjacent ranges joined) with success" << std::endl;
+}
+
+int main( int , const char** )
+{
+	try
+	{
+		initRand();
+		testIndexSetIterator( 20, 1, 200);
+		testIndexSetIterator( 20, 50, 3);
+		testIndexSetIterator( 20, 30, 100);
+		std::cerr << "OK" << std::endl;
+		return 0;
+	}
+	catch (const std::exception& err)
+	{
+		std::cerr << "EXCEPTION " << err.what() << std::endl;
+	}
+	return -1;
+}
+
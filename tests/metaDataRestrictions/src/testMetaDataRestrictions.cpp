@@ -9,6 +9,9 @@
 #include "metaDataDescription.hpp"
 #include "metaDataElement.hpp"
 #include "metaDataRecord.hpp"
+#include "metaDataBlock.hpp"
+#include "metaDataBlockRestriction.hpp"
+#include "metaDataZoneMap.hpp"
 #include "strus/metaDataReaderInterface.hpp"
 #include "strus/metaDataRestrictionInterface.hpp"
 #include "strus/numericVariant.hpp"
@@ -380,9 +383,8 @@ static strus::MetaDataCompareOperation
 			elem->typeName(), opr, hnd, elemName, operand, newGroup);
 }
 
-static strus::Reference<strus::MetaDataRestrictionInstanceInterface>
-	randomMetaDataRestriction(
-		strus::MetaDataReaderInterface* reader,
+static std::vector<strus::MetaDataCompareOperation>
+	randomMetaDataOperations(
 		const strus::MetaDataDescription* descr,
 		const strus::MetaDataRecord& rec,
 		bool positiveResult,
@@ -411,8 +413,20 @@ static strus::Reference<strus::MetaDataRestrictionInstanceInterface>
 			expressionstr.append( ops.back().tostring());
 		}
 	}
+	return ops;
+}
+
+static strus::Reference<strus::MetaDataRestrictionInstanceInterface>
+	randomMetaDataRestriction(
+		strus::MetaDataReaderInterface* reader,
+		const strus::MetaDataDescription* descr,
+		const strus::MetaDataRecord& rec,
+		bool positiveResult,
+		std::string& expressionstr)
+{
+	std::vector<strus::MetaDataCompareOperation> ops = randomMetaDataOperations( descr, rec, positiveResult, expressionstr);
 	strus::Reference<strus::MetaDataRestrictionInstanceInterface>
-		rt( new strus::MetaDataRestrictionInstance( reader, ops, g_errorbuf.get()));
+		rt( new strus::MetaDataRestrictionInstance( reader, ops, 1, g_errorbuf.get()));
 	return rt;
 }
 
@@ -429,6 +443,74 @@ static void reportTest(
 	out << "expecting " << (expectedResult?"positive":"negative") << " result" << std::endl;
 }
 
+// Check the block wise evaluation of random restrictions against the record wise evaluation for all records of a block
+// and that the zone map of the block never excludes a block with a record matching
+static void testBlockEvaluation( const strus::MetaDataDescription* descr, unsigned int nofQueries)
+{
+	strus::MetaDataBlock block( descr, 1);
+	// ... blocks with few distinct records have narrow zone maps that exclude restrictions more often
+	std::size_t nofDistinctRecords = randuint( 0, 2) ? strus::MetaDataBlock::BlockSize : randuint( 1, 4);
+	std::size_t ri=0, re=strus::MetaDataBlock::BlockSize;
+	for (; ri<re; ++ri)
+	{
+		void* recptr = (char*)block.ptr() + ri * descr->bytesize();
+		if (ri < nofDistinctRecords)
+		{
+			(void)randomMetaDataRecord( descr, recptr);
+		}
+		else
+		{
+			std::memcpy( recptr, (char*)block.ptr() + randuint( 0, nofDistinctRecords) * descr->bytesize(), descr->bytesize());
+		}
+	}
+	strus::MetaDataZoneMap zonemap( descr, block);
+
+	std::size_t xi=0, xe=nofQueries;
+	for (; xi<xe; ++xi)
+	{
+		std::string expressionstr;
+		std::vector<strus::MetaDataCompareOperation> ops;
+		try
+		{
+			std::size_t baseidx = randuint( 0, strus::MetaDataBlock::BlockSize);
+			ops = randomMetaDataOperations( descr, block[ baseidx], (bool)randuint(0,2), expressionstr);
+		}
+		catch (const RandomDataException&)
+		{
+			--xi;
+			continue;
+		}
+		strus::MetaDataBlockRestriction blockRestriction( descr, ops);
+		strus::MetaDataBlockMatchMask mask;
+		blockRestriction.match( mask, block);
+
+		int firstMatch = -1;
+		for (ri=0; ri<re; ++ri)
+		{
+			void* recptr = (char*)block.ptr() + ri * descr->bytesize();
+			strus::MetaDataRestrictionInstance recordRestriction( new MetaDataReader( descr, recptr), ops, 1, g_errorbuf.get());
+			bool expectedResult = recordRestriction.match( 1);
+			if (expectedResult && firstMatch < 0)
+			{
+				firstMatch = (int)ri;
+			}
+			if (expectedResult != mask.test( ri))
+			{
+				reportTest( std::cerr, strus::Reference<strus::MetaDataRestrictionInstanceInterface>(), expressionstr, block[ ri], expectedResult);
+				throw std::runtime_error( "block wise evaluation of meta data restriction failed");
+			}
+		}
+		if (mask.next( 0) != firstMatch)
+		{
+			throw std::runtime_error( "skip to next match in block wise evaluation of meta data restriction failed");
+		}
+		if (!blockRestriction.mayMatch( zonemap) && firstMatch >= 0)
+		{
+			throw std::runtime_error( "zone map excludes a meta data block with a record matching the restriction");
+		}
+	}
+}
+
 static unsigned int getUintValue( const char* arg)
 {
 	unsigned int rt = 0, prev = 0;
@@ -529,6 +611,7 @@ int main( int argc, const char* argv[])
 					}
 				}
 			}
+			testBlockEvaluation( &descr, nofQueries);
 		}
 		if (g_errorbuf->hasError())
 		{
@@ -9,6 +9,8 @@
 #include "indexPacker.hpp"
 #include "dataBlock.hpp"
 #include "posinfoBlock.hpp"
+#include "ffBlock.hpp"
+#include "booleanBlock.hpp"
 #include <stdexcept>
 #include <iostream>
 #include <sstream>
@@ -32,9 +34,20 @@ static void initRand()
 }
 #define RANDINT(MIN,MAX) ((rand()%(MAX-MIN))+MIN)
 
-static std::vector<strus::Index> randPosinfo()
+static std::vector<strus::Index> randPosinfo( bool withLargePositions)
 {
 	std::vector<strus::Index> rt;
+	if (withLargePositions && RANDINT(0,100) == 1)
+	{
+		// ... document with positions not fitting into the compact 16 bit form
+		unsigned int tt=0,nofElements=RANDINT(1,40000);
+		strus::Index pp = 0;
+		for (; tt<nofElements; ++tt)
+		{
+			rt.push_back( pp += RANDINT(1,100));
+		}
+		return rt;
+	}
 	unsigned int tt=0,nofElements=RANDINT(1,25);
 	strus::Index pp = 0;
 	
@@ -75,7 +88,7 @@ static std::string indexVectorToString( const std::vector<strus::Index>& ar)
 	return rt.str();
 }
 
-static void testPosinfoBlock( unsigned int times, unsigned int minNofDocs, unsigned int nofQueries)
+static void testPosinfoBlock( unsigned int times, unsigned int minNofDocs, unsigned int nofQueries, bool withLargePositions, std::size_t blockSize)
 {
 	unsigned int tt=0;
 	
@@ -90,30 +103,24 @@ static void testPosinfoBlock( unsigned int times, unsigned int minNofDocs, unsig
 		std::vector<strus::Index> docnoar;
 
 		std::vector<strus::PosinfoBlock> blockar;
-		strus::PosinfoBlockBuilder block;
+		strus::PosinfoBlockBuilder block( withLargePositions, blockSize);
 		unsigned int ii=0,nofDocs=minNofDocs+RANDINT(1,100);
 		for (; ii<nofDocs; ++ii)
 		{
 			maxDocNo += RANDINT(1,25);
-			pmap[ maxDocNo] = randPosinfo();
+			pmap[ maxDocNo] = randPosinfo( withLargePositions);
 			docnoar.push_back( maxDocNo);
 		}
 		PosinfoMap::const_iterator pi = pmap.begin(), pe = pmap.end();
 		for (; pi != pe; ++pi)
 		{
-			if (block.full() || !block.fitsInto( pi->second.size()))
+			std::vector<strus::PosinfoBlock::PositionType> posar;
+			strus::PosinfoBlock::encodePositions( posar, pi->second, withLargePositions);
+			if (!block.empty() && (block.full() || !block.fitsInto( posar.data())))
 			{
 				blockar.push_back( block.createBlock());
 				block.clear();
 			}
-			std::vector<strus::PosinfoBlock::PositionType> posar;
-			std::vector<strus::Index>::const_iterator
-				ci = pi->second.begin(), ce = pi->second.end();
-			posar.push_back( pi->second.size());
-			for (; ci != ce; ++ci)
-			{
-				posar.push_back( *ci);
-			}
 			block.append( pi->first, posar.data());
 		}
 		if (!block.empty())
@@ -144,6 +151,20 @@ static void testPosinfoBlock( unsigned int times, unsigned int minNofDocs, unsig
 		}
 #endif
 
+		for (bi = blockar.begin(); bi != be; ++bi)
+		{
+			unsigned int maxff = 0;
+			strus::Index dn = bi->firstDoc( bidx);
+			for (; dn; dn = bi->nextDoc( bidx))
+			{
+				if (bi->frequency_at( bidx) > maxff) maxff = bi->frequency_at( bidx);
+			}
+			if (maxff != bi->maxFrequency())
+			{
+				throw std::runtime_error( "posinfo block summary does not match, max ff mismatch");
+			}
+		}
+
 		bi = blockar.begin();
 		strus::Index blkdn = bi->firstDoc( bidx);
 
@@ -236,7 +257,102 @@ static void testPosinfoBlock( unsigned int times, unsigned int minNofDocs, unsig
 			}
 		}
 	}
-	std::cerr << "tested posinfo block " << times << " times with " << minNofDocs << " documents with success" << std::endl;
+	std::cerr << "tested posinfo block " << (withLargePositions?"with large positions ":"") << times << " times with " << minNofDocs << " documents with success" << std::endl;
+}
+
+static void testAdaptiveBlockSize()
+{
+	std::size_t prevsize = 0;
+	strus::Index df = 1;
+	for (; df < (1<<30); df <<= 1)
+	{
+		std::size_t blocksize = strus::PosinfoBlock::blockSizeForDf( df);
+		if (blocksize < prevsize
+			|| blocksize < (std::size_t)strus::PosinfoBlock::MaxBlockSize
+			|| blocksize > (std::size_t)strus::PosinfoBlock::MaxAdaptiveBlockSize)
+		{
+			throw std::runtime_error( "adaptive posinfo block size out of range");
+		}
+		prevsize = blocksize;
+	}
+	if (prevsize != (std::size_t)strus::PosinfoBlock::MaxAdaptiveBlockSize
+		|| strus::PosinfoBlock::blockSizeForDf( 1) != (std::size_t)strus::PosinfoBlock::MaxBlockSize
+		|| strus::BooleanBlock::blockSizeForDf( 1) != (std::size_t)strus::BooleanBlock::MaxBlockSize
+		|| strus::FfBlock::blockSizeForDf( 1<<30) != (std::size_t)strus::FfBlock::MaxAdaptiveBlockSize)
+	{
+		throw std::runtime_error( "adaptive block size limits not reached");
+	}
+}
+
+static void testFfBlock( unsigned int times, unsigned int minNofDocs, strus::FfBlock::Format format)
+{
+	unsigned int tt=0;
+	
+	for (; tt<times; ++tt)
+	{
+		typedef std::map<strus::Index,unsigned int> FfMap;
+		FfMap ffmap;
+		strus::Index maxDocNo = 0;
+		unsigned int ii=0,nofDocs=minNofDocs+RANDINT(1,100);
+		for (; ii<nofDocs; ++ii)
+		{
+			// ... with some big values to get all lengths of the variable length encodings:
+			maxDocNo += (RANDINT(0,20) == 0) ? RANDINT(1,1000000) : RANDINT(1,25);
+			ffmap[ maxDocNo] = (RANDINT(0,20) == 0) ? RANDINT(1,100000) : RANDINT(1,100);
+		}
+		std::vector<strus::FfBlock> blockar;
+		strus::FfBlockBuilder block( format);
+		FfMap::const_iterator fi = ffmap.begin(), fe = ffmap.end();
+		for (; fi != fe; ++fi)
+		{
+			block.append( fi->first, fi->second);
+			if (block.full())
+			{
+				blockar.push_back( block.createBlock());
+				block.clear();
+			}
+		}
+		if (!block.empty())
+		{
+			blockar.push_back( block.createBlock());
+			block.clear();
+		}
+		fi = ffmap.begin();
+		std::vector<strus::FfBlock>::const_iterator bi = blockar.begin(), be = blockar.end();
+		for (; bi != be; ++bi)
+		{
+			std::vector<strus::Index> docnoar;
+			std::vector<unsigned int> ffar;
+			bi->decode( docnoar, ffar);
+			if (bi->format() != format)
+			{
+				throw std::runtime_error( "doc/ff block build failed, format mismatch");
+			}
+			if (docnoar.size() != bi->nofElements() || docnoar.empty() || docnoar.back() != bi->id())
+			{
+				throw std::runtime_error( "doc/ff block build failed, block id or size mismatch");
+			}
+			unsigned int maxff = 0;
+			std::size_t di = 0, de = docnoar.size();
+			for (; di != de; ++di,++fi)
+			{
+				if (fi == fe || fi->first != docnoar[ di] || fi->second != ffar[ di])
+				{
+					throw std::runtime_error( "doc/ff block build failed, element mismatch");
+				}
+				if (ffar[ di] > maxff) maxff = ffar[ di];
+			}
+			if (maxff != bi->maxFrequency())
+			{
+				throw std::runtime_error( "doc/ff block summary does not match, max ff mismatch");
+			}
+		}
+		if (fi != fe)
+		{
+			throw std::runtime_error( "doc/ff block build failed, elements missing");
+		}
+	}
+	std::cerr << "tested doc/ff block (" << strus::FfBlock::formatName( format) << ") " << times << " times with " << minNofDocs << " documents with success" << std::endl;
 }
 
 
@@ -246,7 +362,12 @@ int main( int, const char**)
 	{
 		initRand();
 		testDataBlockBuild( 1);
-		testPosinfoBlock( 100, 3000, 1000);
+		testPosinfoBlock( 100, 3000, 1000, false, strus::PosinfoBlock::MaxBlockSize);
+		testPosinfoBlock( 20, 3000, 1000, true, strus::PosinfoBlock::MaxBlockSize);
+		testAdaptiveBlockSize();
+		testPosinfoBlock( 20, 30000, 1000, false, strus::PosinfoBlock::blockSizeForDf( 30000));
+		testFfBlock( 100, 3000, strus::FfBlock::FormatPacked);
+		testFfBlock( 100, 3000, strus::FfBlock::FormatStreamVByte);
 		return 0;
 	}
 	catch (const std::exception& err)
@@ -7,6 +7,7 @@
 #include <cstdio>
 #include <iostream>
 #include <memory>
+#include <limits>
 
 #undef STRUS_LOWLEVEL_DEBUG
 
@@ -37,6 +38,11 @@ public:
 		return m_docno = docno_?docno_:docno_+1;
 	}
 
+	virtual bool skipDocBlock( const strus::Index&, strus::Index*, unsigned int*, std::size_t, std::size_t&)
+	{
+		return false;
+	}
+
 	virtual strus::Index skipPos( const strus::Index& firstpos)
 	{
 		if (m_posarsize == 0) return 0;
@@ -71,6 +77,17 @@ public:
 		return m_posarsize;
 	}
 
+	virtual strus::Index skipBlockMax( const strus::Index&, unsigned int& maxff)
+	{
+		maxff = m_posarsize;
+		return std::numeric_limits<strus::Index>::max();
+	}
+
+	virtual unsigned int nofBlocksLoaded() const
+	{
+		return 0;
+	}
+
 	virtual strus::Index docno() const
 	{
 		return m_docno;
@@ -131,6 +148,36 @@ static void testWinWindow()
 	if (ri->pos) throw std::runtime_error( "test failed: not all matches found");
 }
 
+static void testManyArguments()
+{
+	enum {NofArguments=1000,Range=10,Cardinality=3};
+	std::vector<strus::Reference<SimplePostingIterator> > argbufs;
+	std::vector<strus::PostingIteratorInterface*> args;
+	unsigned int ii=0;
+	for (; ii<NofArguments; ++ii)
+	{
+		// ... every argument with one position, all positions consecutive:
+		unsigned int posar[2];
+		posar[0] = ii+1;
+		posar[1] = 0;
+		argbufs.push_back( new SimplePostingIterator( posar, ii+1));
+		args.push_back( argbufs.back().get());
+	}
+	strus::PositionWindow win( args.data(), args.size(), Range, Cardinality, 0, strus::PositionWindow::MinWin);
+	unsigned int expectpos = 1;
+	bool more=win.first();
+	for (; more; more=win.next(),++expectpos)
+	{
+		if (win.pos() != expectpos || win.size() != Cardinality-1)
+		{
+			std::cerr << "error window position " << win.pos() << " size " << win.size() << ", expected position " << expectpos << " size " << (Cardinality-1) << std::endl;
+			throw std::runtime_error( "test failed");
+		}
+	}
+	if (expectpos != NofArguments - Cardinality + 2) throw std::runtime_error( "test failed: not all matches found");
+	std::cerr << "windows found with " << NofArguments << " arguments: " << (expectpos-1) << std::endl;
+}
+
 int main( int argc, char** argv)
 {
 	try
@@ -139,6 +186,7 @@ int main( int argc, char** argv)
 		g_errorbuf = errorbuf.get();
 
 		testWinWindow();
+		testManyArguments();
 	}
 	catch (const std::exception& err)
 	{
@@ -31,6 +31,11 @@
 #include "strus/summarizerFunctionInstanceInterface.hpp"
 #include "strus/weightingFunctionInterface.hpp"
 #include "strus/weightingFunctionInstanceInterface.hpp"
+#include "strus/weightingFunctionContextInterface.hpp"
+#include "strus/metaDataReaderInterface.hpp"
+#include "strus/globalStatistics.hpp"
+#include "strus/termStatistics.hpp"
+#include "strus/numericVariant.hpp"
 #include "strus/index.hpp"
 #include "private/utils.hpp"
 #include "private/errorUtils.hpp"
@@ -40,6 +45,9 @@
 #include <iostream>
 #include <stdexcept>
 #include <memory>
+#include <sstream>
+#include <vector>
+#include <cmath>
 
 #undef STRUS_LOWLEVEL_DEBUG
 static strus::ErrorBufferInterface* g_errorhnd = 0;
@@ -97,6 +105,79 @@ static void destroyStorage( const char* config)
 	dbi->destroyDatabase( config);
 }
 
+/// \brief Weighting function context delegating to another one, but without batch weighting, for comparing the evaluation with and without batch weighting
+class NoBatchWeightingFunctionContext
+	:public strus::WeightingFunctionContextInterface
+{
+public:
+	explicit NoBatchWeightingFunctionContext( strus::WeightingFunctionContextInterface* context_)
+		:m_context(context_){}
+	virtual ~NoBatchWeightingFunctionContext(){}
+
+	virtual void addWeightingFeature( const std::string& name_, strus::PostingIteratorInterface* postingIterator_, double weight_, const strus::TermStatistics& stats_)
+	{
+		m_context->addWeightingFeature( name_, postingIterator_, weight_, stats_);
+	}
+	virtual void setVariableValue( const std::string& name, double value)
+	{
+		m_context->setVariableValue( name, value);
+	}
+	virtual double call( const strus::Index& docno)
+	{
+		return m_context->call( docno);
+	}
+	virtual bool callBatch( double*, const strus::Index*, std::size_t)
+	{
+		return false;
+	}
+	virtual double maxFeatureWeight( const strus::PostingIteratorInterface* postingIterator_, unsigned int maxff) const
+	{
+		return m_context->maxFeatureWeight( postingIterator_, maxff);
+	}
+	virtual std::string debugCall( const strus::Index& docno)
+	{
+		return m_context->debugCall( docno);
+	}
+
+private:
+	strus::utils::SharedPtr<strus::WeightingFunctionContextInterface> m_context;
+};
+
+/// \brief Weighting function instance creating contexts without batch weighting
+class NoBatchWeightingFunctionInstance
+	:public strus::WeightingFunctionInstanceInterface
+{
+public:
+	explicit NoBatchWeightingFunctionInstance( strus::WeightingFunctionInstanceInterface* instance_)
+		:m_instance(instance_){}
+	virtual ~NoBatchWeightingFunctionInstance(){}
+
+	virtual void addStringParameter( const std::string& name, const std::string& value)
+	{
+		m_instance->addStringParameter( name, value);
+	}
+	virtual void addNumericParameter( const std::string& name, const strus::NumericVariant& value)
+	{
+		m_instance->addNumericParameter( name, value);
+	}
+	virtual strus::WeightingFunctionContextInterface* createFunctionContext( const strus::StorageClientInterface* storage_, strus::MetaDataReaderInterface* metadata_, const strus::GlobalStatistics& stats) const
+	{
+		strus::WeightingFunctionContextInterface* context = m_instance->createFunctionContext( storage_, metadata_, stats);
+		if (!context) return 0;
+		return new NoBatchWeightingFunctionContext( context);
+	}
+	virtual std::vector<std::string> getVariables() const
+	{
+		return m_instance->getVariables();
+	}
+	virtual std::string tostring() const
+	{
+		return m_instance->tostring();
+	}
+
+private:
+	strus::utils::SharedPtr<strus::WeightingFunctionInstanceInterface> m_instance;
+};
 
 class QueryEvaluationEnv
 {
@@ -105,13 +186,12 @@ public:
 	strus::local_ptr<strus::QueryEvalInterface> qeval;
 	strus::local_ptr<strus::QueryInterface> query;
 
-	explicit QueryEvaluationEnv( const strus::QueryProcessorInterface* qpi)
+	explicit QueryEvaluationEnv( const strus::QueryProcessorInterface* qpi, const char* weightingFunctionName="tf", bool pruning=false, unsigned int nofDocs=10, bool batchWeighting=true)
 	{
 		static const unsigned int primes[5] = {2,3,5,7,0};
 		storage.open( "path=storage; metadata=docno UINT16");
 		strus::local_ptr<strus::StorageTransactionInterface> transactionInsert( storage.sci->createTransaction());
-		enum {NofDocs=10};
-		unsigned int di=0,de=NofDocs;
+		unsigned int di=0,de=nofDocs;
 		for (; di < de; ++di)
 		{
 			char docid[10];
@@ -165,13 +245,15 @@ public:
 		qeval->addRestrictionFeature( "res");
 		qeval->addExclusionFeature( "exc");
 	
-		const strus::WeightingFunctionInterface* weighting = qpi->getWeightingFunction( "tf");
+		const strus::WeightingFunctionInterface* weighting = qpi->getWeightingFunction( weightingFunctionName);
 		if (!weighting) throw std::runtime_error("failed to get weighting function");
 		strus::WeightingFunctionInstanceInterface* weightingInstance = weighting->createInstance( qpi);
 		if (!weightingInstance) throw std::runtime_error("failed to create weighting function instance");
+		if (!batchWeighting) weightingInstance = new NoBatchWeightingFunctionInstance( weightingInstance);
 		std::vector<strus::QueryEvalInterface::FeatureParameter> weightingFeatures;
 		weightingFeatures.push_back( strus::QueryEvalInterface::FeatureParameter( "match", "qry"));
 		qeval->addWeightingFunction( "countmatches", weightingInstance, weightingFeatures);
+		qeval->setPruning( pruning);
 	
 		if (g_errorhnd->hasError())
 		{
@@ -390,6 +472,625 @@ static void testSingleTermQueryWithSelectionAndRestriction( const strus::QueryPr
 }
 
 
+static std::string evaluateWeightedPrimeQuery( const strus::QueryProcessorInterface* qpi, bool pruning)
+{
+	QueryEvaluationEnv queryenv( qpi, "constant", pruning);
+	strus::QueryInterface* query = queryenv.query.get();
+	const strus::PostingJoinOperatorInterface* operation_OR = qpi->getPostingJoinOperator( "union");
+	if (!operation_OR) throw std::runtime_error("operation 'union' is not defined");
+
+	query->pushTerm( "prim", "2", 1);
+	query->defineFeature( "qry", 1.0);
+	query->pushTerm( "prim", "3", 1);
+	query->defineFeature( "qry", 2.0);
+	query->pushTerm( "prim", "5", 1);
+	query->defineFeature( "qry", 4.0);
+	query->pushTerm( "prim", "2", 1);
+	query->pushTerm( "prim", "3", 1);
+	query->pushTerm( "prim", "5", 1);
+	query->pushExpression( operation_OR, 3, 0, 0);
+	query->defineFeature( "sel");
+	query->setMaxNofRanks( 2);
+
+	strus::QueryResult result = query->evaluate();
+#ifdef STRUS_LOWLEVEL_DEBUG
+	std::cerr << "result evaluateWeightedPrimeQuery " << (pruning?"with":"without") << " pruning:" << std::endl;
+	printQueryResult( result);
+#endif
+	return getQueryResultMembersString( result);
+}
+
+static void testWeightedQueryWithPruning( const strus::QueryProcessorInterface* qpi)
+{
+	std::string res = evaluateWeightedPrimeQuery( qpi, true);
+	std::string ref = evaluateWeightedPrimeQuery( qpi, false);
+	std::string exp = "5,6";
+#ifdef STRUS_LOWLEVEL_DEBUG
+	std::cerr << "packed result: (" << res << ") without pruning (" << ref << ")" << std::endl;
+	std::cerr << "expected: (" << exp << ")" << std::endl;
+#endif
+	if (res != exp || ref != exp)
+	{
+		throw std::runtime_error("query result not as expected");
+	}
+}
+
+enum {NofParallelEvaluationThreads=4};
+
+static strus::QueryResult evaluateLargeWeightedPrimeQuery( const strus::QueryProcessorInterface* qpi, unsigned int nofThreads, std::size_t nofRanks, bool pruning)
+{
+	QueryEvaluationEnv queryenv( qpi, "tf", pruning, 20000);
+	queryenv.qeval->addSelectionFeature( "sel2");
+	queryenv.qeval->addSelectionFeature( "sel3");
+	strus::QueryInterface* query = queryenv.query.get();
+
+	query->pushTerm( "prim", "2", 1);
+	query->defineFeature( "qry", 1.0);
+	query->pushTerm( "prim", "3", 1);
+	query->defineFeature( "qry", 2.0);
+	query->pushTerm( "prim", "7", 1);
+	query->defineFeature( "qry", 4.0);
+	query->pushTerm( "prim", "7", 1);
+	query->defineFeature( "sel");
+	query->pushTerm( "prim", "3", 1);
+	query->defineFeature( "sel2");
+	query->pushTerm( "prim", "2", 1);
+	query->defineFeature( "sel3");
+	query->setMaxNofRanks( nofRanks);
+	query->setParallelEvaluation( nofThreads);
+
+	strus::QueryResult result = query->evaluate();
+	if (g_errorhnd->hasError())
+	{
+		throw std::runtime_error( g_errorhnd->fetchError());
+	}
+#ifdef STRUS_LOWLEVEL_DEBUG
+	std::cerr << "result evaluateLargeWeightedPrimeQuery with " << nofThreads << " threads, " << nofRanks << " ranks " << (pruning?"with":"without") << " pruning: pass " << result.evaluationPass() << " ranked " << result.nofRanked() << " visited " << result.nofVisited() << std::endl;
+	printQueryResult( result);
+#endif
+	return result;
+}
+
+static void testParallelEvaluation( const strus::QueryProcessorInterface* qpi)
+{
+	// Ranklists complete with the first selection set, with the first two and with all three:
+	static const std::size_t nofRanksAr[] = {20, 5000, 9000, 0};
+	for (int ni=0; nofRanksAr[ni]; ++ni)
+	{
+		for (int pruning=0; pruning<2; ++pruning)
+		{
+			strus::QueryResult res = evaluateLargeWeightedPrimeQuery( qpi, NofParallelEvaluationThreads, nofRanksAr[ni], pruning!=0);
+			strus::QueryResult ref = evaluateLargeWeightedPrimeQuery( qpi, 0, nofRanksAr[ni], pruning!=0);
+#ifdef STRUS_LOWLEVEL_DEBUG
+			std::cerr << "packed result: (" << getQueryResultMembersString( res) << ") sequential (" << getQueryResultMembersString( ref) << ")" << std::endl;
+#endif
+			if (res.ranks().empty()
+			||  getQueryResultMembersString( res) != getQueryResultMembersString( ref)
+			||  res.evaluationPass() != ref.evaluationPass()
+			||  res.evaluationPass() != (unsigned int)ni)
+			{
+				throw std::runtime_error("result of parallel query evaluation differs from sequential evaluation");
+			}
+			// With pruning the counters are only lower bounds depending on the order of evaluation:
+			if (!pruning && (res.nofRanked() != ref.nofRanked() || res.nofVisited() != ref.nofVisited()))
+			{
+				throw std::runtime_error("counters of parallel query evaluation differ from sequential evaluation");
+			}
+		}
+	}
+}
+
+static void testResultCache( const strus::QueryProcessorInterface* qpi)
+{
+	QueryEvaluationEnv queryenv( qpi);
+	queryenv.qeval->defineResultCache( 1<<20);
+	strus::QueryInterface* query = queryenv.query.get();
+
+	query->pushTerm( "word", "hello", 1);
+	query->defineFeature( "qry");
+	query->pushTerm( "word", "hello", 1);
+	query->defineFeature( "sel");
+
+	std::string res1 = getQueryResultMembersString( query->evaluate());
+	std::string res2 = getQueryResultMembersString( query->evaluate());
+	strus::QueryResultCacheStatistics stats = queryenv.qeval->resultCacheStatistics();
+	if (res1 != "0,1,2,3,4,5,6,7,8,9" || res2 != res1 || stats.nofHits() != 1 || stats.nofMisses() != 1 || stats.nofEntries() != 1)
+	{
+		throw std::runtime_error("query result cache lookup not as expected");
+	}
+	// Insert a document, the cached result is not valid anymore:
+	strus::local_ptr<strus::StorageTransactionInterface> transaction( queryenv.storage.sci->createTransaction());
+	strus::local_ptr<strus::StorageDocumentInterface> doc( transaction->createDocument( "DOC10"));
+	doc->addSearchIndexTerm( "word", "hello", 1);
+	doc->setMetaData( "docno", (strus::NumericVariant::IntType)10);
+	doc->setAttribute( "docid", "DOC10");
+	doc->done();
+	if (!transaction->commit()) throw std::runtime_error("failed to insert test document");
+
+	std::string res3 = getQueryResultMembersString( query->evaluate());
+	stats = queryenv.qeval->resultCacheStatistics();
+#ifdef STRUS_LOWLEVEL_DEBUG
+	std::cerr << "packed result after insert: (" << res3 << ") hits " << stats.nofHits() << " misses " << stats.nofMisses() << std::endl;
+#endif
+	if (res3 != "0,1,10,2,3,4,5,6,7,8,9" || stats.nofHits() != 1 || stats.nofMisses() != 2)
+	{
+		throw std::runtime_error("query result cache not invalidated by transaction commit");
+	}
+}
+
+static std::string evaluatePrimeQuery( strus::QueryInterface* query, std::size_t nofRanks)
+{
+	query->setMaxNofRanks( nofRanks);
+	strus::QueryResult result = query->evaluate();
+	if (g_errorhnd->hasError())
+	{
+		throw std::runtime_error( g_errorhnd->fetchError());
+	}
+	return getQueryResultMembersString( result);
+}
+
+static void testPreparedQuery( const strus::QueryProcessorInterface* qpi)
+{
+	QueryEvaluationEnv queryenv( qpi, "tf");
+	strus::QueryInterface* query = queryenv.query.get();
+	strus::local_ptr<strus::QueryInterface> refqueryref( queryenv.qeval->createQuery( queryenv.storage.sci.get()));
+	strus::QueryInterface* refquery = refqueryref.get();
+	if (!refquery) throw std::runtime_error("failed to create query");
+
+	strus::QueryInterface* qar[2] = {query, refquery};
+	for (int qi=0; qi<2; ++qi)
+	{
+		qar[qi]->pushTerm( "prim", "2", 1);
+		qar[qi]->defineFeature( "qry", 1.0);
+		qar[qi]->pushTerm( "prim", "3", 1);
+		qar[qi]->defineFeature( "qry", 2.0);
+		qar[qi]->pushTerm( "word", "hello", 1);
+		qar[qi]->defineFeature( "sel");
+	}
+	query->prepare();
+
+	// Evaluate the prepared query with different parameters and compare it with the query not prepared:
+	std::string res1 = evaluatePrimeQuery( query, 3);
+	std::string ref1 = evaluatePrimeQuery( refquery, 3);
+	std::string res2 = evaluatePrimeQuery( query, 10);
+	std::string ref2 = evaluatePrimeQuery( refquery, 10);
+#ifdef STRUS_LOWLEVEL_DEBUG
+	std::cerr << "packed result: (" << res1 << ") (" << res2 << ") not prepared (" << ref1 << ") (" << ref2 << ")" << std::endl;
+#endif
+	if (res1 != ref1 || res2 != ref2 || res1 == res2 || res2 != "0,1,2,3,4,5,6,7,8,9")
+	{
+		throw std::runtime_error("result of prepared query differs from query not prepared");
+	}
+	// Insert a document, the prepared query has to see it:
+	strus::local_ptr<strus::StorageTransactionInterface> transaction( queryenv.storage.sci->createTransaction());
+	strus::local_ptr<strus::StorageDocumentInterface> doc( transaction->createDocument( "DOC10"));
+	doc->addSearchIndexTerm( "word", "hello", 1);
+	doc->addSearchIndexTerm( "prim", "2", 11);
+	doc->addSearchIndexTerm( "prim", "5", 12);
+	doc->setMetaData( "docno", (strus::NumericVariant::IntType)10);
+	doc->setAttribute( "docid", "DOC10");
+	doc->done();
+	if (!transaction->commit()) throw std::runtime_error("failed to insert test document");
+
+	std::string res3 = evaluatePrimeQuery( query, 20);
+	if (res3 != "0,1,10,2,3,4,5,6,7,8,9")
+	{
+		throw std::runtime_error("prepared query does not see documents inserted after prepare");
+	}
+}
+
+static void testEvaluationPlan( const strus::QueryProcessorInterface* qpi)
+{
+	QueryEvaluationEnv queryenv( qpi, "tf");
+	strus::QueryInterface* query = queryenv.query.get();
+	const strus::PostingJoinOperatorInterface* operation_AND = qpi->getPostingJoinOperator( "intersect");
+	if (!operation_AND) throw std::runtime_error("operation 'intersect' is not defined");
+
+	query->pushTerm( "word", "hello", 1);
+	query->defineFeature( "qry");
+	query->pushTerm( "word", "hello", 1);
+	query->pushTerm( "prim", "3", 1);
+	query->pushExpression( operation_AND, 2, 0, 0);
+	query->defineFeature( "sel");
+	query->setDebugMode( true);
+
+	std::string res = evaluatePrimeQuery( query, 20);
+	std::string plan = query->tostring();
+#ifdef STRUS_LOWLEVEL_DEBUG
+	std::cerr << "packed result: (" << res << ")" << std::endl << plan << std::endl;
+#endif
+	if (res != "3,6,9")
+	{
+		throw std::runtime_error("query result not as expected");
+	}
+	// The rarest argument (prim 3, second argument) has to drive the intersection:
+	std::size_t planidx = plan.find( "evaluation plan:");
+	if (planidx == std::string::npos) throw std::runtime_error("evaluation plan not reported in debug mode");
+	std::size_t rarestidx = plan.find( "[1]", planidx);
+	std::size_t frequentidx = plan.find( "[0]", planidx);
+	if (rarestidx == std::string::npos || frequentidx == std::string::npos || rarestidx > frequentidx
+	||  plan.find( "term prim '3' df=3", planidx) == std::string::npos)
+	{
+		throw std::runtime_error("evaluation plan not as expected");
+	}
+}
+static void testQueryBudget( const strus::QueryProcessorInterface* qpi)
+{
+	QueryEvaluationEnv queryenv( qpi, "tf");
+	strus::QueryInterface* query = queryenv.query.get();
+
+	query->pushTerm( "word", "hello", 1);
+	query->defineFeature( "qry");
+	query->pushTerm( "word", "hello", 1);
+	query->defineFeature( "sel");
+	query->setMaxNofRanks( 20);
+
+	// Budget not exceeded:
+	query->setBudget( strus::QueryBudget( 100, 100000, 60000));
+	strus::QueryResult result = query->evaluate();
+	if (g_errorhnd->hasError()) throw std::runtime_error( g_errorhnd->fetchError());
+	if (result.truncated() || result.ranks().size() != 10)
+	{
+		throw std::runtime_error("query result not as expected");
+	}
+	// Ranking stopped after a limited number of documents visited:
+	query->setBudget( strus::QueryBudget( 3, 0, 0));
+	result = query->evaluate();
+	if (g_errorhnd->hasError()) throw std::runtime_error( g_errorhnd->fetchError());
+#ifdef STRUS_LOWLEVEL_DEBUG
+	std::cerr << "truncated result: (" << getQueryResultMembersString( result) << ") visited " << result.nofVisited() << std::endl;
+#endif
+	if (!result.truncated() || result.ranks().size() != 3 || result.nofVisited() != 3
+	||  getQueryResultMembersString( result) != "0,1,2")
+	{
+		throw std::runtime_error("query result truncated by the budget not as expected");
+	}
+	// Ranking stopped after a limited number of posting operations:
+	query->setBudget( strus::QueryBudget( 0, 4, 0));
+	result = query->evaluate();
+	if (g_errorhnd->hasError()) throw std::runtime_error( g_errorhnd->fetchError());
+	if (!result.truncated() || result.ranks().size() >= 10)
+	{
+		throw std::runtime_error("query result truncated by the budget of posting operations not as expected");
+	}
+}
+
+static void testQueryProfile( const strus::QueryProcessorInterface* qpi)
+{
+	QueryEvaluationEnv queryenv( qpi, "tf");
+	strus::QueryInterface* query = queryenv.query.get();
+
+	query->pushTerm( "word", "hello", 1);
+	query->defineFeature( "qry");
+	query->pushTerm( "word", "hello", 1);
+	query->defineFeature( "sel");
+	query->setMaxNofRanks( 20);
+
+	strus::QueryResult result = query->evaluate();
+	if (g_errorhnd->hasError()) throw std::runtime_error( g_errorhnd->fetchError());
+	if (!result.profile().empty())
+	{
+		throw std::runtime_error("query profile returned without profiling mode enabled");
+	}
+	query->setProfilingMode( true);
+	result = query->evaluate();
+	if (g_errorhnd->hasError()) throw std::runtime_error( g_errorhnd->fetchError());
+	if (result.ranks().size() != 10)
+	{
+		throw std::runtime_error("query result in profiling mode not as expected");
+	}
+	const strus::QueryProfile& profile = result.profile();
+	bool rankingPhaseFound = false;
+	std::vector<strus::QueryProfile::Phase>::const_iterator hi = profile.phases().begin(), he = profile.phases().end();
+	for (; hi != he; ++hi)
+	{
+#ifdef STRUS_LOWLEVEL_DEBUG
+		std::cerr << "phase " << hi->name() << ": " << hi->microseconds() << " us" << std::endl;
+#endif
+		if (hi->name() == "document ranking") rankingPhaseFound = true;
+	}
+	if (!rankingPhaseFound)
+	{
+		throw std::runtime_error("phase of the document ranking missing in the query profile");
+	}
+	bool postingFound = false;
+	std::vector<strus::QueryProfile::PostingNode>::const_iterator pi = profile.postings().begin(), pe = profile.postings().end();
+	for (; pi != pe; ++pi)
+	{
+#ifdef STRUS_LOWLEVEL_DEBUG
+		std::cerr << "posting " << pi->feature() << " " << pi->description() << ": skipDoc " << pi->nofSkipDoc() << ", blocks " << pi->nofBlocksLoaded() << std::endl;
+#endif
+		if (pi->description() == "term word 'hello'" && pi->nofSkipDoc() > 0) postingFound = true;
+	}
+	if (!postingFound)
+	{
+		throw std::runtime_error("operations on the posting iterators missing in the query profile");
+	}
+}
+
+static strus::QueryResult evaluateTwoPassQuery( const strus::QueryProcessorInterface* qpi, bool mergedSelection, std::size_t nofRanks)
+{
+	QueryEvaluationEnv queryenv( qpi, "tf");
+	queryenv.qeval->addSelectionFeature( "sel2");
+	queryenv.qeval->setMergedSelection( mergedSelection);
+	strus::QueryInterface* query = queryenv.query.get();
+
+	query->pushTerm( "word", "hello", 1);
+	query->defineFeature( "qry");
+	query->pushTerm( "prim", "3", 1);
+	query->defineFeature( "sel");
+	query->pushTerm( "prim", "2", 1);
+	query->defineFeature( "sel");
+	query->pushTerm( "word", "hello", 1);
+	query->defineFeature( "sel2");
+	query->setMaxNofRanks( nofRanks);
+
+	strus::QueryResult result = query->evaluate();
+	if (g_errorhnd->hasError()) throw std::runtime_error( g_errorhnd->fetchError());
+#ifdef STRUS_LOWLEVEL_DEBUG
+	std::cerr << (mergedSelection ? "merged" : "sequential") << " selection with " << nofRanks << " ranks: (" << getQueryResultMembersString( result) << ") pass " << result.evaluationPass() << " ranked " << result.nofRanked() << " visited " << result.nofVisited() << std::endl;
+#endif
+	return result;
+}
+
+static void testMergedSelection( const strus::QueryProcessorInterface* qpi)
+{
+	// Ranklist complete with the documents of the first selection set, the second is not used:
+	strus::QueryResult res = evaluateTwoPassQuery( qpi, true, 4);
+	strus::QueryResult ref = evaluateTwoPassQuery( qpi, false, 4);
+	if (getQueryResultMembersString( res) != getQueryResultMembersString( ref)
+	||  res.evaluationPass() != 0 || ref.evaluationPass() != 0)
+	{
+		throw std::runtime_error("result of the query with merged selection differs from the one with sequential selection");
+	}
+	// Documents of both selection sets needed, every document visited once:
+	res = evaluateTwoPassQuery( qpi, true, 20);
+	ref = evaluateTwoPassQuery( qpi, false, 20);
+	if (getQueryResultMembersString( res) != "0,1,2,3,4,5,6,7,8,9"
+	||  getQueryResultMembersString( ref) != getQueryResultMembersString( res)
+	||  res.evaluationPass() != 1 || ref.evaluationPass() != 1
+	||  res.nofVisited() != 10 || ref.nofVisited() != 10)
+	{
+		throw std::runtime_error("result of the query with merged selection over two selection sets not as expected");
+	}
+}
+
+static strus::QueryResult evaluatePrunedTwoPassQuery( const strus::QueryProcessorInterface* qpi, bool mergedSelection, std::size_t nofRanks)
+{
+	QueryEvaluationEnv queryenv( qpi, "constant", true);
+	queryenv.qeval->addSelectionFeature( "sel2");
+	queryenv.qeval->setMergedSelection( mergedSelection);
+	strus::QueryInterface* query = queryenv.query.get();
+
+	// Documents of the second selection set with a higher weight precede the only document of the first one:
+	query->pushTerm( "prim", "2", 1);
+	query->defineFeature( "qry", 4.0);
+	query->pushTerm( "prim", "5", 1);
+	query->defineFeature( "qry", 1.0);
+	query->pushTerm( "prim", "5", 1);
+	query->defineFeature( "sel");
+	query->pushTerm( "prim", "2", 1);
+	query->defineFeature( "sel2");
+	query->setMaxNofRanks( nofRanks);
+
+	strus::QueryResult result = query->evaluate();
+	if (g_errorhnd->hasError()) throw std::runtime_error( g_errorhnd->fetchError());
+#ifdef STRUS_LOWLEVEL_DEBUG
+	std::cerr << (mergedSelection ? "merged" : "sequential") << " selection with pruning and " << nofRanks << " ranks: (" << getQueryResultMembersString( result) << ") pass " << result.evaluationPass() << std::endl;
+#endif
+	return result;
+}
+
+static void testMergedSelectionWithPruning( const strus::QueryProcessorInterface* qpi)
+{
+	for (std::size_t nofRanks=1; nofRanks<=6; ++nofRanks)
+	{
+		strus::QueryResult res = evaluatePrunedTwoPassQuery( qpi, true, nofRanks);
+		strus::QueryResult ref = evaluatePrunedTwoPassQuery( qpi, false, nofRanks);
+		if (getQueryResultMembersString( res) != getQueryResultMembersString( ref)
+		||  res.evaluationPass() != ref.evaluationPass())
+		{
+			throw std::runtime_error("result of the query with merged selection and pruning differs from the one with sequential selection");
+		}
+		if (nofRanks == 1 && (getQueryResultMembersString( res) != "5" || res.evaluationPass() != 0))
+		{
+			throw std::runtime_error("document of the first selection set pruned by documents of the second");
+		}
+	}
+}
+
+enum {WeightingBatchSize=128};	///< number of documents weighted with one call of the weighting functions by the query evaluation (WEIGHTING_BATCH_SIZE)
+
+static strus::WeightingFunctionInstanceInterface* createWeightingFunctionInstance( const strus::QueryProcessorInterface* qpi, const char* functionName)
+{
+	const strus::WeightingFunctionInterface* weighting = qpi->getWeightingFunction( functionName);
+	if (!weighting) throw std::runtime_error("failed to get weighting function");
+	strus::WeightingFunctionInstanceInterface* rt = weighting->createInstance( qpi);
+	if (!rt) throw std::runtime_error("failed to create weighting function instance");
+	if (0==std::strcmp( functionName, "bm25"))
+	{
+		rt->addNumericParameter( "k1", strus::NumericVariant( 1.2));
+		rt->addNumericParameter( "b", strus::NumericVariant( 0.75));
+		rt->addNumericParameter( "avgdoclen", strus::NumericVariant( 500.0));
+		rt->addStringParameter( "metadata_doclen", "docno");
+	}
+	else if (0==std::strcmp( functionName, "constant"))
+	{
+		rt->addNumericParameter( "weight", strus::NumericVariant( 2.5));
+	}
+	else if (0==std::strcmp( functionName, "metadata"))
+	{
+		rt->addStringParameter( "name", "docno");
+		rt->addNumericParameter( "weight", strus::NumericVariant( 0.5));
+	}
+	if (g_errorhnd->hasError()) throw std::runtime_error( g_errorhnd->fetchError());
+	return rt;
+}
+
+/// \brief Calculate the weights of a list of documents with a weighting function, in batches as the query evaluation does or with a call for every document
+static std::vector<double> weightDocuments( const strus::QueryProcessorInterface* qpi, const Storage& storage, const char* functionName, const std::vector<strus::Index>& docnos, bool batch)
+{
+	std::vector<strus::utils::SharedPtr<strus::PostingIteratorInterface> > postings;
+	strus::local_ptr<strus::WeightingFunctionInstanceInterface> instance( createWeightingFunctionInstance( qpi, functionName));
+	strus::local_ptr<strus::MetaDataReaderInterface> metadata( storage.sci->createMetaDataReader());
+	if (!metadata.get()) throw std::runtime_error( g_errorhnd->fetchError());
+	strus::local_ptr<strus::WeightingFunctionContextInterface> context( instance->createFunctionContext( storage.sci.get(), metadata.get(), strus::GlobalStatistics()));
+	if (!context.get()) throw std::runtime_error( g_errorhnd->fetchError());
+
+	if (0!=std::strcmp( functionName, "metadata"))
+	{
+		static const char* primes[] = {"2","3","7",0};
+		static const double weights[] = {1.0,2.0,0.5};
+		for (int pi=0; primes[pi]; ++pi)
+		{
+			strus::utils::SharedPtr<strus::PostingIteratorInterface> itr( storage.sci->createTermPostingIterator( "prim", primes[pi], 1));
+			if (!itr.get()) throw std::runtime_error( g_errorhnd->fetchError());
+			postings.push_back( itr);
+			context->addWeightingFeature( "match", itr.get(), weights[pi], strus::TermStatistics());
+		}
+	}
+	std::vector<double> rt( docnos.size(), 0.0);
+	std::size_t di = 0, de = docnos.size();
+	if (batch)
+	{
+		for (; di < de; di += WeightingBatchSize)
+		{
+			std::size_t nofDocnos = (de - di < (std::size_t)WeightingBatchSize) ? (de - di) : (std::size_t)WeightingBatchSize;
+			if (!context->callBatch( &rt[ di], &docnos[ di], nofDocnos))
+			{
+				throw std::runtime_error( std::string("batch weighting not implemented by weighting function '") + functionName + "'");
+			}
+		}
+	}
+	else
+	{
+		for (; di < de; ++di)
+		{
+			rt[ di] = context->call( docnos[ di]);
+		}
+	}
+	if (g_errorhnd->hasError()) throw std::runtime_error( g_errorhnd->fetchError());
+	return rt;
+}
+
+static void testBatchWeighting( const strus::QueryProcessorInterface* qpi)
+{
+	enum {NofDocs=1000};
+	QueryEvaluationEnv queryenv( qpi, "tf", false, NofDocs);
+
+	// Documents in ascending order and in ascending order within each selection set, as with merged selection:
+	std::vector<std::vector<strus::Index> > docnoLists( 2);
+	strus::Index docno = 1;
+	for (; docno <= NofDocs; ++docno)
+	{
+		docnoLists[0].push_back( docno);
+	}
+	static const strus::Index selectionPrimes[] = {7,3,2,0};
+	for (int si=0; selectionPrimes[si]; ++si)
+	{
+		for (docno = 1; docno <= NofDocs; ++docno)
+		{
+			if (docno % selectionPrimes[si] == 0) docnoLists[1].push_back( docno);
+		}
+	}
+	static const char* functionNames[] = {"bm25","tf","constant","metadata",0};
+	for (int fi=0; functionNames[fi]; ++fi)
+	{
+		std::vector<std::vector<strus::Index> >::const_iterator li = docnoLists.begin(), le = docnoLists.end();
+		for (; li != le; ++li)
+		{
+			std::vector<double> res = weightDocuments( qpi, queryenv.storage, functionNames[fi], *li, true);
+			std::vector<double> ref = weightDocuments( qpi, queryenv.storage, functionNames[fi], *li, false);
+			double sum = 0.0;
+			std::size_t di = 0, de = li->size();
+			for (; di != de; ++di)
+			{
+				if (std::fabs( res[ di] - ref[ di]) > 1e-9 * (1.0 + std::fabs( ref[ di])))
+				{
+					std::ostringstream msg;
+					msg << "batch weighting of document " << (*li)[ di] << " with '" << functionNames[fi] << "' returned " << res[ di] << " instead of " << ref[ di];
+					throw std::runtime_error( msg.str());
+				}
+				sum += ref[ di];
+			}
+			if (sum <= 0.0)
+			{
+				throw std::runtime_error( std::string("no document weighted with '") + functionNames[fi] + "'");
+			}
+		}
+	}
+}
+
+static std::string getQueryResultRankString( const strus::QueryResult& result)
+{
+	std::ostringstream rt;
+	std::vector<strus::ResultDocument>::const_iterator ri = result.ranks().begin(), re = result.ranks().end(); 
+	for (int ridx=0; ri != re; ++ri,++ridx)
+	{
+		std::vector<strus::SummaryElement>::const_iterator si = ri->summaryElements().begin(), se = ri->summaryElements().end();
+		for (; si != se; ++si)
+		{
+			if (si->name() == "docid")
+			{
+				if (ridx) rt << ',';
+				rt << (si->value().c_str()+3) << ':' << ri->weight();
+			}
+		}
+	}
+	return rt.str();
+}
+
+static strus::QueryResult evaluateBatchWeightingQuery( const strus::QueryProcessorInterface* qpi, const char* functionName, bool batchWeighting, bool pruning, std::size_t nofRanks)
+{
+	// More than WeightingBatchSize candidates selected:
+	QueryEvaluationEnv queryenv( qpi, functionName, pruning, 2000, batchWeighting);
+	strus::QueryInterface* query = queryenv.query.get();
+
+	query->pushTerm( "prim", "2", 1);
+	query->defineFeature( "qry", 1.0);
+	query->pushTerm( "prim", "3", 1);
+	query->defineFeature( "qry", 2.0);
+	query->pushTerm( "prim", "7", 1);
+	query->defineFeature( "qry", 4.0);
+	query->pushTerm( "prim", "2", 1);
+	query->defineFeature( "sel");
+	query->setMaxNofRanks( nofRanks);
+
+	strus::QueryResult result = query->evaluate();
+	if (g_errorhnd->hasError()) throw std::runtime_error( g_errorhnd->fetchError());
+#ifdef STRUS_LOWLEVEL_DEBUG
+	std::cerr << "'" << functionName << "' weighting " << (batchWeighting ? "with" : "without") << " batches " << (pruning?"with":"without") << " pruning and " << nofRanks << " ranks: (" << getQueryResultRankString( result) << ")" << std::endl;
+#endif
+	return result;
+}
+
+static void testBatchWeightingRanklist( const strus::QueryProcessorInterface* qpi)
+{
+	static const char* functionNames[] = {"tf","constant",0};
+	static const std::size_t nofRanksAr[] = {20, 300, 900, 0};
+	for (int fi=0; functionNames[fi]; ++fi)
+	{
+		for (int ni=0; nofRanksAr[ni]; ++ni)
+		{
+			for (int pruning=0; pruning<2; ++pruning)
+			{
+				strus::QueryResult res = evaluateBatchWeightingQuery( qpi, functionNames[fi], true, pruning!=0, nofRanksAr[ni]);
+				strus::QueryResult ref = evaluateBatchWeightingQuery( qpi, functionNames[fi], false, pruning!=0, nofRanksAr[ni]);
+				if (res.ranks().size() != nofRanksAr[ni]
+				||  getQueryResultRankString( res) != getQueryResultRankString( ref))
+				{
+					throw std::runtime_error("ranklist of the query evaluation with batch weighting differs from the one without");
+				}
+				// With pruning the counters depend on when the candidates are selected:
+				if (!pruning && (res.nofRanked() != ref.nofRanked() || res.nofVisited() != ref.nofVisited()))
+				{
+					throw std::runtime_error("counters of the query evaluation with batch weighting differ from the ones without");
+				}
+			}
+		}
+	}
+}
+
 #define RUN_TEST( idx, TestName, qpi)\
 	try\
 	{\
@@ -451,7 +1152,7 @@ int main( int argc, const char* argv[])
 				return -1;
 			}
 		}
-		g_errorhnd = strus::createErrorBuffer_standard( stderr, 1);
+		g_errorhnd = strus::createErrorBuffer_standard( stderr, 1 + NofParallelEvaluationThreads);
 		if (!g_errorhnd) return -1;
 	
 		strus::Reference<strus::QueryProcessorInterface> qpi = strus::createQueryProcessor( g_errorhnd);
@@ -473,6 +1174,17 @@ int main( int argc, const char* argv[])
 				case 3: RUN_TEST( ti, SingleTermQueryWithRestriction, qpi.get() ) break;
 				case 4: RUN_TEST( ti, SingleTermQueryWithRestrictionInclMetadata, qpi.get() ) break;
 				case 5: RUN_TEST( ti, SingleTermQueryWithSelectionAndRestriction, qpi.get() ) break;
+				case 6: RUN_TEST( ti, WeightedQueryWithPruning, qpi.get() ) break;
+				case 7: RUN_TEST( ti, ParallelEvaluation, qpi.get() ) break;
+				case 8: RUN_TEST( ti, ResultCache, qpi.get() ) break;
+				case 9: RUN_TEST( ti, PreparedQuery, qpi.get() ) break;
+				case 10: RUN_TEST( ti, EvaluationPlan, qpi.get() ) break;
+				case 11: RUN_TEST( ti, QueryBudget, qpi.get() ) break;
+				case 12: RUN_TEST( ti, QueryProfile, qpi.get() ) break;
+				case 13: RUN_TEST( ti, MergedSelection, qpi.get() ) break;
+				case 14: RUN_TEST( ti, MergedSelectionWithPruning, qpi.get() ) break;
+				case 15: RUN_TEST( ti, BatchWeighting, qpi.get() ) break;
+				case 16: RUN_TEST( ti, BatchWeightingRanklist, qpi.get() ) break;
 				default: goto TESTS_DONE;
 			}
 			if (test_index) break;
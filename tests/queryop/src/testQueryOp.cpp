@@ -22,6 +22,11 @@
 #include <iostream>
 #include <stdexcept>
 #include <memory>
+#include <limits>
+#include <vector>
+#include <set>
+#include <map>
+#include <cstdlib>
 
 #undef STRUS_LOWLEVEL_DEBUG
 static strus::ErrorBufferInterface* g_errorhnd = 0;
@@ -62,6 +67,11 @@ public:
 		return m_docno = rt;
 	}
 
+	virtual bool skipDocBlock( const strus::Index&, strus::Index*, unsigned int*, std::size_t, std::size_t&)
+	{
+		return false;
+	}
+
 	virtual strus::Index skipPos( const strus::Index& firstpos)
 	{
 		if (!m_divisor) return m_posno=0;
@@ -89,6 +99,17 @@ public:
 		return (m_maxposno / m_divisor);
 	}
 
+	virtual strus::Index skipBlockMax( const strus::Index&, unsigned int& maxff)
+	{
+		maxff = (m_maxposno / m_divisor);
+		return std::numeric_limits<strus::Index>::max();
+	}
+
+	virtual unsigned int nofBlocksLoaded() const
+	{
+		return 0;
+	}
+
 	virtual strus::Index docno() const
 	{
 		return m_docno;
@@ -320,6 +341,241 @@ static void testIntersectWithCardinality( const strus::QueryProcessorInterface*
 	}
 }
 
+/// \brief Posting iterator on a sorted list of document numbers with one position per document
+class DocnoListPostingIterator
+	:public strus::PostingIteratorInterface
+{
+public:
+	DocnoListPostingIterator( const std::vector<strus::Index>& docnos_, unsigned int id_)
+		:m_docnos(docnos_),m_itr(0),m_docno(0),m_posno(0)
+	{
+		snprintf( m_featureid, sizeof(m_featureid), "L%u", id_);
+	}
+
+	virtual ~DocnoListPostingIterator(){}
+
+	virtual strus::Index skipDoc( const strus::Index& docno_)
+	{
+		if (m_itr > 0 && m_docnos[ m_itr-1] >= docno_) m_itr = 0;
+		while (m_itr < m_docnos.size() && m_docnos[ m_itr] < docno_) ++m_itr;
+		m_posno = 0;
+		return m_docno = (m_itr < m_docnos.size()) ? m_docnos[ m_itr] : 0;
+	}
+
+	virtual strus::Index skipDocCandidate( const strus::Index& docno_)
+	{
+		return skipDoc( docno_);
+	}
+
+	virtual bool skipDocBlock( const strus::Index&, strus::Index*, unsigned int*, std::size_t, std::size_t&)
+	{
+		return false;
+	}
+
+	virtual strus::Index skipPos( const strus::Index& firstpos)
+	{
+		strus::Index pos = (m_docno % 7) + 1;
+		return m_posno = (m_docno && firstpos <= pos) ? pos : 0;
+	}
+
+	virtual const char* featureid() const
+	{
+		return m_featureid;
+	}
+
+	virtual strus::Index documentFrequency() const
+	{
+		return m_docnos.size();
+	}
+
+	virtual unsigned int frequency()
+	{
+		return m_docno ? 1:0;
+	}
+
+	virtual strus::Index skipBlockMax( const strus::Index&, unsigned int& maxff)
+	{
+		maxff = 1;
+		return std::numeric_limits<strus::Index>::max();
+	}
+
+	virtual unsigned int nofBlocksLoaded() const
+	{
+		return 0;
+	}
+
+	virtual strus::Index docno() const
+	{
+		return m_docno;
+	}
+
+	virtual strus::Index posno() const
+	{
+		return m_posno;
+	}
+
+	virtual strus::Index length() const
+	{
+		return m_posno ? 1:0;
+	}
+
+private:
+	std::vector<strus::Index> m_docnos;
+	std::size_t m_itr;
+	char m_featureid[ 32];
+	strus::Index m_docno;
+	strus::Index m_posno;
+};
+
+/// \brief Reference implementation of a union, scanning all arguments for every document
+static strus::Index scanUnionSkipDoc( std::vector<strus::Reference<strus::PostingIteratorInterface> >& args, const strus::Index& docno)
+{
+	strus::Index rt = 0;
+	std::vector<strus::Reference<strus::PostingIteratorInterface> >::iterator ai = args.begin(), ae = args.end();
+	for (; ai != ae; ++ai)
+	{
+		strus::Index dn = (*ai)->skipDoc( docno);
+		if (dn && (!rt || dn < rt)) rt = dn;
+	}
+	return rt;
+}
+
+/// \brief Compare the union operator against a union scanning all arguments for different numbers of arguments, checking the results and printing the times needed
+static void testUnionArities( const strus::QueryProcessorInterface* qpi)
+{
+	const strus::PostingJoinOperatorInterface* join = qpi->getPostingJoinOperator( "union");
+	typedef strus::Reference<strus::PostingIteratorInterface> PostingIteratorReference;
+	enum {MaxDocno=200000, NofDocsPerTerm=400};
+	static const unsigned int arities[] = {2,4,8,16,32,64,128,256,512,0};
+	::srand( 17);
+
+	unsigned int ai = 0;
+	for (; arities[ai]; ++ai)
+	{
+		unsigned int arity = arities[ai];
+		std::vector<PostingIteratorReference> args;
+		std::vector<PostingIteratorReference> refargs;
+		std::vector<PostingIteratorReference> blkargs;
+		std::set<strus::Index> expected;
+
+		unsigned int ti = 0;
+		for (; ti < arity; ++ti)
+		{
+			std::set<strus::Index> docset;
+			unsigned int di = 0;
+			for (; di < NofDocsPerTerm; ++di)
+			{
+				docset.insert( (strus::Index)(::rand() % MaxDocno) + 1);
+			}
+			std::vector<strus::Index> docnos( docset.begin(), docset.end());
+			expected.insert( docset.begin(), docset.end());
+			args.push_back( new DocnoListPostingIterator( docnos, ti));
+			refargs.push_back( new DocnoListPostingIterator( docnos, ti));
+			blkargs.push_back( new DocnoListPostingIterator( docnos, ti));
+		}
+		strus::Reference<strus::PostingIteratorInterface> result( join->createResultIterator( args, 0/*range*/, 0/*cardinality*/));
+		if (!result.get()) throw std::runtime_error( "failed to create union iterator");
+		strus::Reference<strus::PostingIteratorInterface> blkresult( join->createResultIterator( blkargs, 0/*range*/, 0/*cardinality*/));
+		if (!blkresult.get()) throw std::runtime_error( "failed to create union iterator");
+
+		strus::utils::StopWatch joinWatch;
+		std::set<strus::Index>::const_iterator ei = expected.begin(), ee = expected.end();
+		strus::Index docno = result->skipDoc( 0);
+		for (; docno; docno = result->skipDoc( docno+1),++ei)
+		{
+			if (ei == ee || *ei != docno)
+			{
+				throw strus::runtime_error( "unexpected document number in union of %u arguments: found %d != expected %d", arity, (int)docno, ei == ee ? 0:(int)*ei);
+			}
+			strus::Index pos = result->skipPos( 0);
+			if (pos != (docno % 7) + 1)
+			{
+				throw strus::runtime_error( "unexpected position in union of %u arguments: found %d != expected %d", arity, (int)pos, (int)((docno % 7) + 1));
+			}
+		}
+		if (ei != ee) throw strus::runtime_error( "missing documents in union of %u arguments", arity);
+		int64_t joinTime = joinWatch.elapsedMicroseconds();
+
+		strus::utils::StopWatch blockWatch;
+		enum {BlockSize=50};
+		strus::Index blk[ BlockSize];
+		std::size_t blksize = 0;
+		if (!blkresult->skipDocBlock( 0, blk, 0, BlockSize, blksize)) throw strus::runtime_error( "block fetch not implemented by union");
+		for (ei = expected.begin(); blksize; )
+		{
+			std::size_t bi = 0;
+			for (; bi < blksize; ++bi,++ei)
+			{
+				if (ei == ee || *ei != blk[ bi])
+				{
+					throw strus::runtime_error( "unexpected document number in block of union of %u arguments: found %d != expected %d", arity, (int)blk[ bi], ei == ee ? 0:(int)*ei);
+				}
+			}
+			if (blkresult->docno() != blk[ blksize-1] || blkresult->skipPos( 0) != (blk[ blksize-1] % 7) + 1)
+			{
+				throw strus::runtime_error( "union of %u arguments not positioned on the last document of the block fetched", arity);
+			}
+			if (!blkresult->skipDocBlock( blk[ blksize-1]+1, blk, 0, BlockSize, blksize)) throw strus::runtime_error( "block fetch not implemented by union");
+		}
+		if (ei != ee) throw strus::runtime_error( "missing documents in blocks of union of %u arguments", arity);
+		int64_t blockTime = blockWatch.elapsedMicroseconds();
+
+		strus::utils::StopWatch scanWatch;
+		strus::Index nofScanned = 0;
+		docno = scanUnionSkipDoc( refargs, 0);
+		for (; docno; docno = scanUnionSkipDoc( refargs, docno+1)) ++nofScanned;
+		int64_t scanTime = scanWatch.elapsedMicroseconds();
+		if (nofScanned != (strus::Index)expected.size()) throw strus::runtime_error( "reference union of %u arguments returned %d documents instead of %d", arity, (int)nofScanned, (int)expected.size());
+
+		std::cerr << "union of " << arity << " arguments (" << expected.size() << " documents): union operator "
+				<< joinTime << " us, block fetch " << blockTime << " us, linear scan " << scanTime << " us" << std::endl;
+	}
+}
+
+/// \brief Test the contains operator with a cardinality on more arguments than fit into the local buffers of its priority queue
+static void testContainsManyArguments( const strus::QueryProcessorInterface* qpi)
+{
+	const strus::PostingJoinOperatorInterface* join = qpi->getPostingJoinOperator( "contains");
+	typedef strus::Reference<strus::PostingIteratorInterface> PostingIteratorReference;
+	enum {NofArguments=600, MaxDocno=20000, NofDocsPerTerm=50, Cardinality=3};
+	::srand( 23);
+
+	std::vector<PostingIteratorReference> args;
+	std::map<strus::Index,unsigned int> doccount;
+	unsigned int ti = 0;
+	for (; ti < NofArguments; ++ti)
+	{
+		std::set<strus::Index> docset;
+		unsigned int di = 0;
+		for (; di < NofDocsPerTerm; ++di)
+		{
+			docset.insert( (strus::Index)(::rand() % MaxDocno) + 1);
+		}
+		std::set<strus::Index>::const_iterator si = docset.begin(), se = docset.end();
+		for (; si != se; ++si) ++doccount[ *si];
+		args.push_back( new DocnoListPostingIterator( std::vector<strus::Index>( docset.begin(), docset.end()), ti));
+	}
+	std::vector<strus::Index> expected;
+	std::map<strus::Index,unsigned int>::const_iterator ci = doccount.begin(), ce = doccount.end();
+	for (; ci != ce; ++ci)
+	{
+		if (ci->second >= Cardinality) expected.push_back( ci->first);
+	}
+	strus::Reference<strus::PostingIteratorInterface> result( join->createResultIterator( args, 0/*range*/, Cardinality));
+	if (!result.get()) throw std::runtime_error( "failed to create contains iterator");
+
+	std::vector<strus::Index>::const_iterator ei = expected.begin(), ee = expected.end();
+	strus::Index docno = result->skipDoc( 0);
+	for (; docno; docno = result->skipDoc( docno+1),++ei)
+	{
+		if (ei == ee || *ei != docno)
+		{
+			throw strus::runtime_error( "unexpected document number in contains of %u arguments: found %d != expected %d", (unsigned int)NofArguments, (int)docno, ei == ee ? 0:(int)*ei);
+		}
+	}
+	if (ei != ee) throw strus::runtime_error( "missing documents in contains of %u arguments", (unsigned int)NofArguments);
+}
+
 #define RUN_TEST( idx, TestName, qpi)\
 	try\
 	{\
@@ -393,6 +649,8 @@ int main( int argc, const char* argv[])
 			{
 				case 1: RUN_TEST( ti, UnionJoinErathosthenes, qpi.get() ) break;
 				case 2: RUN_TEST( ti, IntersectWithCardinality, qpi.get() ) break;
+				case 3: RUN_TEST( ti, UnionArities, qpi.get() ) break;
+				case 4: RUN_TEST( ti, ContainsManyArguments, qpi.get() ) break;
 				default: return 0;
 			}
 			if (test_index) break;
@@ -6,6 +6,7 @@
  * file, You can obtain one at http://mozilla.org/MPL/2.0/.
  */
 #include "ranker.hpp"
+#include "private/localStructAllocator.hpp"
 #include "strus/index.hpp"
 #include "strus/weightedDocument.hpp"
 #include <stdexcept>
@@ -52,94 +53,120 @@ static strus::WeightedDocument randomWeightedDocument()
 	return strus::WeightedDocument( ++g_docnum, weight);
 }
 
-int main( int , const char** )
-{
-	try
-	{
-		initRand();
-
-		enum {MaxNofRanks=10,NofWeightedDocs=1000000};
-		strus::Ranker ranker( MaxNofRanks);
-		typedef std::multiset<
-				strus::WeightedDocument,
-				std::less<strus::WeightedDocument>,
-				strus::LocalStructAllocator<strus::WeightedDocument> > RankSet;
-		RankSet test_set;
-
-		std::vector<strus::WeightedDocument> test_docs;
+typedef std::multiset<
+		strus::WeightedDocument,
+		std::less<strus::WeightedDocument>,
+		strus::LocalStructAllocator<strus::WeightedDocument> > RankSet;
 
-		for (std::size_t ii=0; ii<NofWeightedDocs; ++ii)
-		{
-			strus::WeightedDocument wd( randomWeightedDocument());
-			test_docs.push_back( wd);
-		}
+static bool testRanker( const std::vector<strus::WeightedDocument>& test_docs, std::size_t maxNofRanks, std::size_t firstRank)
+{
+	strus::Ranker ranker( maxNofRanks);
+	RankSet test_set;
 
-		// Build and measure reference ranklist based on multiset:
-		std::clock_t start;
-		double duration;
-		start = std::clock();
+	// Build and measure reference ranklist based on multiset:
+	std::clock_t start;
+	double duration;
+	start = std::clock();
 
-		for (std::size_t ii=0; ii<NofWeightedDocs; ++ii)
-		{
-			test_set.insert( test_docs[ii]);
-			if (MaxNofRanks < ii)
-			{
-				test_set.erase( test_set.begin());
-			}
-		}
-		std::vector<strus::WeightedDocument> testlist;
-		std::set<strus::WeightedDocument>::reverse_iterator si = test_set.rbegin(), se = test_set.rend();
-		for (int sidx=0; si != se && sidx < MaxNofRanks; ++si,++sidx)
+	for (std::size_t ii=0; ii<test_docs.size(); ++ii)
+	{
+		test_set.insert( test_docs[ii]);
+		if (maxNofRanks < test_set.size())
 		{
-			testlist.push_back( *si);
+			test_set.erase( test_set.begin());
 		}
+	}
+	std::vector<strus::WeightedDocument> testlist;
+	RankSet::reverse_iterator si = test_set.rbegin(), se = test_set.rend();
+	for (std::size_t sidx=0; si != se && sidx < maxNofRanks; ++si,++sidx)
+	{
+		if (sidx >= firstRank) testlist.push_back( *si);
+	}
 
-		duration = ( std::clock() - start ) / (double) CLOCKS_PER_SEC;
-		std::cerr << "reference ranking of " << (int)NofWeightedDocs << " documents in " << doubleToString(duration) << " seconds" << std::endl;
+	duration = ( std::clock() - start ) / (double) CLOCKS_PER_SEC;
+	std::cerr << "reference ranking of " << test_docs.size() << " documents with " << maxNofRanks << " ranks in " << doubleToString(duration) << " seconds" << std::endl;
 
-		// Build and measure ranklist based on ranker:
-		start = std::clock();
-		for (std::size_t ii=0; ii<NofWeightedDocs; ++ii)
-		{
-			ranker.insert( test_docs[ii]);
-		}
-		std::vector<strus::WeightedDocument> ranklist = ranker.result( 0);
-		duration = ( std::clock() - start ) / (double) CLOCKS_PER_SEC;
-		std::cerr << "ranker ranking of " << (int)NofWeightedDocs << " documents in " << doubleToString(duration) << " seconds" << std::endl;
+	// Build and measure ranklist based on ranker:
+	start = std::clock();
+	for (std::size_t ii=0; ii<test_docs.size(); ++ii)
+	{
+		ranker.insert( test_docs[ii]);
+	}
+	std::vector<strus::WeightedDocument> ranklist = ranker.result( firstRank);
+	duration = ( std::clock() - start ) / (double) CLOCKS_PER_SEC;
+	std::cerr << "ranker ranking of " << test_docs.size() << " documents with " << maxNofRanks << " ranks in " << doubleToString(duration) << " seconds" << std::endl;
 
-		// Check results:
-		std::vector<strus::WeightedDocument>::const_iterator ri = ranklist.begin(), re = ranklist.end();
-		std::vector<strus::WeightedDocument>::const_iterator ti = testlist.begin(), te = testlist.end();
+	// Check results:
+	std::vector<strus::WeightedDocument>::const_iterator ri = ranklist.begin(), re = ranklist.end();
+	std::vector<strus::WeightedDocument>::const_iterator ti = testlist.begin(), te = testlist.end();
 
-		int ridx=0;
+	int ridx=0;
 
 #ifdef STRUS_LOWLEVEL_DEBUG
-		int tidx=0;
+	int tidx=0;
 
-		for (ridx=0,ri=ranklist.begin(); ri != re; ++ri,++ridx)
+	for (ridx=0,ri=ranklist.begin(); ri != re; ++ri,++ridx)
+	{
+		std::cerr << "result [" << ridx << "] "
+				<< " docno " << ri->docno()
+				<< " weight "<< ri->weight()
+				<< std::endl;
+	}
+	for (tidx=0,ti=testlist.begin(); ti != te; ++ti,++tidx)
+	{
+		std::cerr << "expect [" << tidx << "] "
+				<< " docno " << ti->docno()
+				<< " weight "<< ti->weight()
+				<< std::endl;
+	}
+#endif
+	bool rt = true;
+	if (ranklist.size() != testlist.size())
+	{
+		std::cerr << "size of ranklist does not match " << ranklist.size() << " != " << testlist.size() << std::endl;
+		rt = false;
+	}
+	for (ridx=0,ri=ranklist.begin(),ti=testlist.begin(); ri != re && ti != te; ++ri,++ti,++ridx)
+	{
+		if (ti->weight() != ri->weight() || ti->docno() != ri->docno())
 		{
-			std::cerr << "result [" << ridx << "] "
-					<< " docno " << ri->docno()
-					<< " weight "<< ri->weight()
+			std::cerr << "rank does not match [" << ridx << "] "
+					<< " docno " << ti->docno() << "/" << ri->docno()
+					<< " weight " << ti->weight() << "/" << ri->weight()
 					<< std::endl;
+			rt = false;
 		}
-		for (tidx=0,ti=testlist.begin(); ti != te; ++ti,++tidx)
+	}
+	if (ranker.complete() && !ranklist.empty() && ranker.minWeight() != test_set.begin()->weight())
+	{
+		std::cerr << "ranker threshold does not match " << ranker.minWeight() << " != " << test_set.begin()->weight() << std::endl;
+		rt = false;
+	}
+	return rt;
+}
+
+int main( int , const char** )
+{
+	try
+	{
+		initRand();
+
+		enum {NofWeightedDocs=1000000};
+		std::vector<strus::WeightedDocument> test_docs;
+
+		for (std::size_t ii=0; ii<NofWeightedDocs; ++ii)
 		{
-			std::cerr << "expect [" << tidx << "] "
-					<< " docno " << ti->docno()
-					<< " weight "<< ti->weight()
-					<< std::endl;
+			strus::WeightedDocument wd( randomWeightedDocument());
+			test_docs.push_back( wd);
 		}
-#endif
+		// Test and benchmark for ranklists of different sizes, the bigger ones with pagination:
+		static const std::size_t maxNofRanksAr[] = {10, 100, 127, 128, 1000, 10000, 100000, 0};
 		int rt = 0;
-		for (ridx=0,ri=ranklist.begin(),ti=testlist.begin(); ri != re && ti != te; ++ri,++ti,++ridx)
+		for (std::size_t ai=0; maxNofRanksAr[ai]; ++ai)
 		{
-			if (ti->weight() != ri->weight() || ti->docno() != ri->docno())
+			std::size_t firstRank = maxNofRanksAr[ai] > 1000 ? (maxNofRanksAr[ai] - 50) : 0;
+			if (!testRanker( test_docs, maxNofRanksAr[ai], firstRank))
 			{
-				std::cerr << "rank does not match [" << ridx << "] "
-						<< " docno " << ti->docno() << "/" << ri->docno()
-						<< " weight " << ti->weight() << "/" << ri->weight()
-						<< std::endl;
 				rt = 1;
 			}
 		}
@@ -151,5 +178,3 @@ int main( int , const char** )
 	}
 	return -1;
 }
-
-
@@ -8,6 +8,8 @@
 #include "strus/reference.hpp"
 #include "strus/databaseInterface.hpp"
 #include "strus/databaseClientInterface.hpp"
+#include "strus/databaseCursorInterface.hpp"
+#include "strus/databaseOptions.hpp"
 #include "strus/lib/error.hpp"
 #include "strus/lib/database_leveldb.hpp"
 #include "strus/lib/storage.hpp"
@@ -26,6 +28,7 @@
 #include "strus/storageDocumentInterface.hpp"
 #include "strus/storageDocumentUpdateInterface.hpp"
 #include "strus/storageDumpInterface.hpp"
+#include "strus/invAclIteratorInterface.hpp"
 #include "strus/valueIteratorInterface.hpp"
 #include "private/utils.hpp"
 #include "private/errorUtils.hpp"
@@ -37,6 +40,7 @@
 #include <iostream>
 #include <stdexcept>
 #include <memory>
+#include <map>
 
 static strus::ErrorBufferInterface* g_errorhnd = 0;
 static strus::Random g_random;
@@ -196,6 +200,76 @@ static void testSimpleDocumentUpdate()
 	dumpStorage( "path=storage");
 }
 
+static std::string userAccessString( strus::StorageClientInterface* sci, const char* username, unsigned int nofDocs)
+{
+	std::map<strus::Index,std::string> docidmap;
+	for (unsigned int di=1; di<=nofDocs; ++di)
+	{
+		std::string docid( featureString("D",di));
+		docidmap[ sci->documentNumber( docid)] = docid;
+	}
+	strus::local_ptr<strus::InvAclIteratorInterface> itr( sci->createInvAclIterator( username));
+	if (!itr.get()) throw std::runtime_error( g_errorhnd->fetchError());
+	std::string rt;
+	strus::Index docno = itr->skipDoc( 1);
+	for (; docno; docno = itr->skipDoc( docno+1))
+	{
+		if (!rt.empty()) rt.push_back(',');
+		rt.append( docidmap[ docno]);
+	}
+	return rt;
+}
+
+static void testUserAccessRights()
+{
+	Storage storage;
+	storage.open( "path=storage; acl=true", true);
+	{
+		strus::local_ptr<strus::StorageTransactionInterface> transaction( storage.sci->createTransaction());
+		for (unsigned int di=1; di<=6; ++di)
+		{
+			std::string docid( featureString("D",di));
+			strus::local_ptr<strus::StorageDocumentInterface> doc( transaction->createDocument( docid));
+			doc->addSearchIndexTerm( "a", featureString("a", di), 1);
+			doc->setUserAccessRight( "alice");
+			if (di % 2 == 0) doc->setUserAccessRight( "bob");
+			doc->done();
+		}
+		if (!transaction->commit()) throw std::runtime_error( g_errorhnd->fetchError());
+
+		// Read twice, the second time the access rights come from the cache:
+		for (int ii=0; ii<2; ++ii)
+		{
+			std::string alice = userAccessString( storage.sci.get(), "alice", 6);
+			std::string bob = userAccessString( storage.sci.get(), "bob", 6);
+			std::string carol = userAccessString( storage.sci.get(), "carol", 6);
+			if (alice != "D1,D2,D3,D4,D5,D6" || bob != "D2,D4,D6" || !carol.empty())
+			{
+				throw strus::runtime_error( "user access rights not as expected: alice {%s} bob {%s} carol {%s}", alice.c_str(), bob.c_str(), carol.c_str());
+			}
+		}
+		// Change the access rights, the cached ones are not valid anymore:
+		transaction.reset( storage.sci->createTransaction());
+		strus::local_ptr<strus::StorageDocumentUpdateInterface> update( transaction->createDocumentUpdate( storage.sci->documentNumber( featureString("D",3))));
+		update->setUserAccessRight( "bob");
+		update->clearUserAccessRight( "alice");
+		update->done();
+		if (!transaction->commit()) throw std::runtime_error( g_errorhnd->fetchError());
+
+		std::string alice = userAccessString( storage.sci.get(), "alice", 6);
+		std::string bob = userAccessString( storage.sci.get(), "bob", 6);
+		if (alice != "D1,D2,D4,D5,D6" || bob != "D2,D3,D4,D6")
+		{
+			throw strus::runtime_error( "user access rights after update not as expected: alice {%s} bob {%s}", alice.c_str(), bob.c_str());
+		}
+	}
+	storage.close();
+	if (g_errorhnd->hasError())
+	{
+		throw std::runtime_error( g_errorhnd->fetchError());
+	}
+}
+
 struct OccurrenceDef
 {
 	std::string docid;
@@ -784,6 +858,159 @@ static void testTrivialInsert()
 	}
 }
 
+static unsigned int countDatabaseKeys( const char* config, char prefix)
+{
+	strus::local_ptr<strus::DatabaseInterface> dbi( strus::createDatabaseType_leveldb( g_errorhnd));
+	if (!dbi.get()) throw std::runtime_error( g_errorhnd->fetchError());
+	strus::local_ptr<strus::DatabaseClientInterface> database( dbi->createClient( config));
+	if (!database.get()) throw std::runtime_error( g_errorhnd->fetchError());
+	strus::local_ptr<strus::DatabaseCursorInterface> cursor( database->createCursor( strus::DatabaseOptions()));
+	if (!cursor.get()) throw std::runtime_error( g_errorhnd->fetchError());
+
+	unsigned int rt = 0;
+	strus::DatabaseCursorInterface::Slice key = cursor->seekFirst( &prefix, 1);
+	for (; key.defined(); key = cursor->seekNext())
+	{
+		++rt;
+	}
+	return rt;
+}
+
+static void testSingleDocumentCommits()
+{
+	enum {NofDocs=300};
+	Storage storage;
+	storage.open( "path=storage", true);
+	unsigned int di=0,de=NofDocs;
+	for (; di != de; ++di)
+	{
+		strus::local_ptr<strus::StorageTransactionInterface> transaction( storage.sci->createTransaction());
+		strus::local_ptr<strus::StorageDocumentInterface> doc( transaction->createDocument( featureString( "D", di)));
+		doc->addSearchIndexTerm( "word", "hello", 1);
+		doc->addSearchIndexTerm( "word", "hello", 3);
+		doc->done();
+		if (!transaction->commit()) throw std::runtime_error( g_errorhnd->fetchError());
+	}
+	// Every document has to be found with its frequency:
+	strus::local_ptr<strus::PostingIteratorInterface> itr( storage.sci->createTermPostingIterator( "word", "hello", 1));
+	if (!itr.get()) throw std::runtime_error( g_errorhnd->fetchError());
+	unsigned int nofPostings = 0;
+	strus::Index docno = itr->skipDoc( 0);
+	for (; docno; docno = itr->skipDoc( docno+1))
+	{
+		if (itr->frequency() != 2) throw std::runtime_error( "unexpected frequency of a document inserted with a single document commit");
+		++nofPostings;
+	}
+	itr.reset();
+	storage.close();
+	if (g_errorhnd->hasError())
+	{
+		throw std::runtime_error( g_errorhnd->fetchError());
+	}
+	if (nofPostings != NofDocs)
+	{
+		throw strus::runtime_error( "expected %u documents in the postings, got %u", (unsigned int)NofDocs, nofPostings);
+	}
+	// The doc/ff blocks (database key prefix 'e') of the term are appended to instead of getting one block per commit:
+	unsigned int nofDocFfBlocks = countDatabaseKeys( "path=storage", 'e');
+	std::cerr << "number of doc/ff blocks after " << (unsigned int)NofDocs << " single document commits: " << nofDocFfBlocks << std::endl;
+	if (nofDocFfBlocks == 0 || nofDocFfBlocks > NofDocs / 32)
+	{
+		throw strus::runtime_error( "unexpected number of doc/ff blocks after single document commits: %u", nofDocFfBlocks);
+	}
+}
+
+/// \brief Check that the postings of the term "word" "hello" are the documents of a map docid to frequency
+static void checkTermPostings( const Storage& storage, const std::map<std::string,unsigned int>& docmap)
+{
+	std::map<strus::Index,unsigned int> expected;
+	std::map<std::string,unsigned int>::const_iterator mi = docmap.begin(), me = docmap.end();
+	for (; mi != me; ++mi)
+	{
+		strus::Index docno = storage.sci->documentNumber( mi->first);
+		if (!docno) throw strus::runtime_error( "document '%s' not found", mi->first.c_str());
+		expected[ docno] = mi->second;
+	}
+	strus::local_ptr<strus::PostingIteratorInterface> itr( storage.sci->createTermPostingIterator( "word", "hello", 1));
+	if (!itr.get()) throw std::runtime_error( g_errorhnd->fetchError());
+	std::size_t nofPostings = 0;
+	strus::Index docno = itr->skipDoc( 0);
+	for (; docno; docno = itr->skipDoc( docno+1))
+	{
+		std::map<strus::Index,unsigned int>::const_iterator ei = expected.find( docno);
+		if (ei == expected.end()) throw strus::runtime_error( "document %d deleted or never inserted found in the postings", (int)docno);
+		if (ei->second != itr->frequency()) throw strus::runtime_error( "unexpected frequency %u of document %d, expected %u", itr->frequency(), (int)docno, ei->second);
+		++nofPostings;
+	}
+	if (g_errorhnd->hasError())
+	{
+		throw std::runtime_error( g_errorhnd->fetchError());
+	}
+	if (nofPostings != expected.size())
+	{
+		throw strus::runtime_error( "expected %u documents in the postings, got %u", (unsigned int)expected.size(), (unsigned int)nofPostings);
+	}
+}
+
+static void insertTermDocument( strus::StorageTransactionInterface* transaction, const std::string& docid, unsigned int ff)
+{
+	strus::local_ptr<strus::StorageDocumentInterface> doc( transaction->createDocument( docid));
+	unsigned int pi = 0;
+	for (; pi != ff; ++pi)
+	{
+		doc->addSearchIndexTerm( "word", "hello", 2*pi+1);
+	}
+	doc->done();
+}
+
+static void testDeleteLastFfBlockDocuments()
+{
+	// Delete all documents of the term (one doc/ff block) or the documents with the biggest docnos (the last doc/ff blocks) and insert a new document in the same transaction:
+	static const unsigned int nofDocsAr[] = {20, 5000, 0};
+	for (int ni=0; nofDocsAr[ni]; ++ni)
+	{
+		unsigned int nofDocs = nofDocsAr[ni];
+		Storage storage;
+		storage.open( "path=storage", true);
+		std::map<std::string,unsigned int> docmap;
+		{
+			strus::local_ptr<strus::StorageTransactionInterface> transaction( storage.sci->createTransaction());
+			unsigned int di=0;
+			for (; di != nofDocs; ++di)
+			{
+				std::string docid = featureString( "D", di);
+				insertTermDocument( transaction.get(), docid, 1 + di % 3);
+				docmap[ docid] = 1 + di % 3;
+			}
+			if (!transaction->commit()) throw std::runtime_error( g_errorhnd->fetchError());
+		}
+		checkTermPostings( storage, docmap);
+		{
+			strus::local_ptr<strus::StorageTransactionInterface> transaction( storage.sci->createTransaction());
+			strus::Index maxDocno = (nofDocs < 100) ? 0 : (strus::Index)(nofDocs / 2);
+			std::map<std::string,unsigned int>::iterator mi = docmap.begin();
+			while (mi != docmap.end())
+			{
+				if (storage.sci->documentNumber( mi->first) > maxDocno)
+				{
+					transaction->deleteDocument( mi->first);
+					docmap.erase( mi++);
+				}
+				else
+				{
+					++mi;
+				}
+			}
+			std::string docid = featureString( "N", 1);
+			insertTermDocument( transaction.get(), docid, 2);
+			docmap[ docid] = 2;
+			if (!transaction->commit()) throw std::runtime_error( g_errorhnd->fetchError());
+		}
+		checkTermPostings( storage, docmap);
+		storage.close();
+	}
+}
+
 static void testDfCalculation()
 {
 	DocumentBuilder::Dim dim;
@@ -932,6 +1159,9 @@ int main( int argc, const char* argv[])
 			case 4: RUN_TEST( ti, TrivialInsert ) break;
 			case 5: RUN_TEST( ti, SimpleDocumentUpdate) break;
 			case 6: RUN_TEST( ti, DocumentUpdate) break;
+			case 7: RUN_TEST( ti, UserAccessRights) break;
+			case 8: RUN_TEST( ti, SingleDocumentCommits) break;
+			case 9: RUN_TEST( ti, DeleteLastFfBlockDocuments) break;
 			default: goto TESTS_DONE;
 		}
 		if (test_index) break;
@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2014 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#include "visitedSet.hpp"
+#include "strus/index.hpp"
+#include <stdexcept>
+#include <iostream>
+#include <sstream>
+#include <cstdlib>
+#include <set>
+#include <ctime>
+
+static void initRand()
+{
+	time_t nowtime;
+	struct tm* now;
+
+	::time( &nowtime);
+	now = ::localtime( &nowtime);
+
+	::srand( ((now->tm_year+1) * (now->tm_mon+100) * (now->tm_mday+1)));
+}
+#define RANDINT(MIN,MAX) ((rand()%(MAX-MIN))+MIN)
+
+#undef STRUS_LOWLEVEL_DEBUG
+
+static void testInsert( strus::Index minDocno, strus::Index maxDocno, unsigned int nofInserts)
+{
+	strus::VisitedSet visited( minDocno, maxDocno);
+	std::set<strus::Index> reference;
+
+	for (unsigned int ii=0; ii<nofInserts; ++ii)
+	{
+		strus::Index docno = minDocno + RANDINT( 0, maxDocno - minDocno + 1);
+		bool inserted = visited.insert( docno);
+		if (inserted != reference.insert( docno).second)
+		{
+			std::ostringstream msg;
+			msg << "insert of document " << docno << " in visited set [" << minDocno << "," << maxDocno << "] returned " << (inserted?"true":"false") << " for a document " << (inserted?"already visited":"not visited yet");
+			throw std::runtime_error( msg.str());
+		}
+	}
+	// The first and the last document of the range are valid members:
+	if (visited.insert( minDocno) == (reference.count( minDocno) != 0)
+	||  visited.insert( maxDocno) == (reference.count( maxDocno) != 0))
+	{
+		throw std::runtime_error( "insert of the documents at the borders of the visited set range failed");
+	}
+	// Only chunks covering documents inserted got allocated:
+	std::set<strus::Index> chunks;
+	reference.insert( minDocno);
+	reference.insert( maxDocno);
+	std::set<strus::Index>::const_iterator ri = reference.begin(), re = reference.end();
+	for (; ri != re; ++ri)
+	{
+		chunks.insert( (*ri - minDocno) / VISITED_SET_CHUNK_SIZE);
+	}
+#ifdef STRUS_LOWLEVEL_DEBUG
+	std::cerr << "visited set [" << minDocno << "," << maxDocno << "] with " << reference.size() << " documents allocated " << visited.nofChunksAllocated() << " chunks" << std::endl;
+#endif
+	if (chunks.size() != visited.nofChunksAllocated())
+	{
+		throw std::runtime_error( "number of chunks allocated by the visited set not as expected");
+	}
+}
+
+int main( int , const char** )
+{
+	try
+	{
+		initRand();
+
+		// The chunks released by one test are reused by the next one and have to be empty:
+		testInsert( 1, 100, 200);
+		testInsert( 1, 100, 200);
+		testInsert( 1, 200000000, 300);
+		testInsert( 1, 200000000, 300);
+		testInsert( 1000, 2000000, 300000);
+		testInsert( 1000, 2000000, 300000);
+		testInsert( 65536, 65536, 10);
+		std::cerr << "OK" << std::endl;
+		return 0;
+	}
+	catch (const std::exception& err)
+	{
+		std::cerr << "EXCEPTION " << err.what() << std::endl;
+	}
+	return -1;
+}